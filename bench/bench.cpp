@@ -0,0 +1,125 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+volatile uint32_t g_benchSink = 0;
+
+//-----------------------------------------------------------------------------
+void runBenchmark(const Benchmark* p_benchmark, const BenchOptions* p_options, BenchResult* p_result)
+//-----------------------------------------------------------------------------
+{
+    using namespace std::chrono;
+
+    static double s_samples[BENCH_MAX_REPS];
+    const uint16_t reps = std::min<uint16_t>(std::max<uint16_t>(p_options->reps, 1), BENCH_MAX_REPS);
+
+    for (uint16_t i = 0; i < p_options->warmups; i++)
+        g_benchSink = g_benchSink + p_benchmark->run();
+
+    uint32_t operations = 0;
+    for (uint16_t i = 0; i < reps; i++) {
+        const steady_clock::time_point start = steady_clock::now();
+        operations                           = p_benchmark->run();
+        const steady_clock::time_point end   = steady_clock::now();
+
+        const double elapsed_ns = (double)duration_cast<nanoseconds>(end - start).count();
+        s_samples[i]            = elapsed_ns / std::max<uint32_t>(operations, 1);
+    }
+
+    std::sort(s_samples, s_samples + reps);
+    p_result->name       = p_benchmark->name;
+    p_result->operations = operations;
+    p_result->median_ns  = (reps % 2) ? s_samples[reps / 2] : (s_samples[reps / 2 - 1] + s_samples[reps / 2]) / 2;
+    p_result->p99_ns     = s_samples[(99 * reps + 99) / 100 - 1]; // Nearest rank
+    p_result->min_ns     = s_samples[0];
+}
+
+//-----------------------------------------------------------------------------
+void printResults(const BenchResult* p_results, uint8_t p_count)
+//-----------------------------------------------------------------------------
+{
+    printf("%-22s %10s %12s %12s %12s\n", "benchmark", "ops/rep", "median ns", "p99 ns", "min ns");
+    for (uint8_t i = 0; i < p_count; i++) {
+        const BenchResult* result = &p_results[i];
+        printf("%-22s %10u %12.1f %12.1f %12.1f\n", result->name, result->operations, result->median_ns, result->p99_ns, result->min_ns);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool writeResultsJson(const char* p_path, const BenchResult* p_results, uint8_t p_count, const BenchOptions* p_options)
+//-----------------------------------------------------------------------------
+{
+    FILE* file = fopen(p_path, "w");
+    if (nullptr == file) {
+        printf("Unable to write results to %s\n", p_path);
+        return false;
+    }
+
+    // One benchmark per line: the baseline reader relies on it
+    fprintf(file, "{\n  \"warmups\": %u,\n  \"reps\": %u,\n  \"benchmarks\": [\n", p_options->warmups, p_options->reps);
+    for (uint8_t i = 0; i < p_count; i++) {
+        const BenchResult* result = &p_results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"operations\": %u, \"median_ns\": %.2f, \"p99_ns\": %.2f, \"min_ns\": %.2f}%s\n",
+                result->name, result->operations, result->median_ns, result->p99_ns, result->min_ns, (i + 1 < p_count) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static bool readJsonNumber(const char* p_line, const char* p_key, double* p_value)
+//-----------------------------------------------------------------------------
+{
+    const char* key = strstr(p_line, p_key);
+    if (nullptr == key)
+        return false;
+
+    const char* colon = strchr(key + strlen(p_key), ':');
+    if (nullptr == colon)
+        return false;
+
+    *p_value = strtod(colon + 1, nullptr);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+int compareWithBaseline(const char* p_path, const BenchResult* p_results, uint8_t p_count, const BenchOptions* p_options)
+//-----------------------------------------------------------------------------
+{
+    FILE* file = fopen(p_path, "r");
+    if (nullptr == file) {
+        printf("Unable to read baseline %s\n", p_path);
+        return -1;
+    }
+
+    printf("\n%-22s %12s %12s %9s\n", "benchmark", "baseline ns", "median ns", "change");
+    int regressions = 0;
+    char line[512];
+    while (nullptr != fgets(line, sizeof(line), file)) {
+        const char* name = strstr(line, "\"name\": \"");
+        double baseline  = 0;
+        if (nullptr == name || !readJsonNumber(line, "\"median_ns\"", &baseline))
+            continue;
+        name += strlen("\"name\": \"");
+
+        for (uint8_t i = 0; i < p_count; i++) {
+            const size_t length = strlen(p_results[i].name);
+            if (0 != strncmp(name, p_results[i].name, length) || name[length] != '"')
+                continue;
+
+            const double change = (baseline > 0) ? 100.0 * (p_results[i].median_ns - baseline) / baseline : 0;
+            const bool slower   = change > p_options->threshold;
+            printf("%-22s %12.1f %12.1f %+8.1f%%%s\n", p_results[i].name, baseline, p_results[i].median_ns, change, slower ? "  SLOWER" : "");
+            if (slower)
+                regressions++;
+        }
+    }
+
+    fclose(file);
+    return regressions;
+}
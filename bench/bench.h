@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+// Benchmark harness: each benchmark runs a batch over a fixed workload and returns the
+// number of operations done, timings are reported per operation.
+
+constexpr uint8_t BENCH_MAX_BENCHMARKS = 16;
+constexpr uint16_t BENCH_MAX_REPS      = 1000;
+
+// Run the workload once, returns the number of operations
+typedef uint32_t (*BenchFunction)();
+
+typedef struct {
+    const char* name;
+    BenchFunction run;
+} Benchmark;
+
+typedef struct {
+    const char* name;
+    uint32_t operations; // Per repetition
+    double median_ns;    // Per operation
+    double p99_ns;
+    double min_ns;
+} BenchResult;
+
+typedef struct {
+    uint16_t warmups;
+    uint16_t reps;
+    double threshold; // Allowed median regression against the baseline, in percent
+} BenchOptions;
+
+// Run warmup then measured repetitions of a benchmark
+void runBenchmark(const Benchmark* p_benchmark, const BenchOptions* p_options, BenchResult* p_result);
+
+void printResults(const BenchResult* p_results, uint8_t p_count);
+
+// Write results as JSON, returns false if the file cannot be written
+bool writeResultsJson(const char* p_path, const BenchResult* p_results, uint8_t p_count, const BenchOptions* p_options);
+
+// Compare medians with a JSON file written by writeResultsJson(),
+// returns the number of benchmarks slower than the threshold, -1 if the baseline cannot be read
+int compareWithBaseline(const char* p_path, const BenchResult* p_results, uint8_t p_count, const BenchOptions* p_options);
+
+// Keep results alive so that the compiler does not remove benchmarked calls
+extern volatile uint32_t g_benchSink;
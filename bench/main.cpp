@@ -0,0 +1,464 @@
+// Native benchmarks of the chess hot paths, run from the project root:
+//   pio run -e bench && .pio/build/bench/program [options]
+// Options:
+//   --fen <path>        positions file (default test/data/bnilsou.fen)
+//   --warmups <n>       warmup repetitions (default 3)
+//   --reps <n>          measured repetitions (default 31)
+//   --json <path>       write results as JSON
+//   --baseline <path>   compare with a JSON file from --json, exits with 1 on regression
+//   --threshold <pct>   allowed median regression (default 10)
+//   --filter <text>     only run benchmarks whose name contains text
+
+#include "bench.h"
+
+#include <chess.h>
+#include <gamelog.h>
+#include <scan.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils.h>
+
+constexpr uint16_t MAX_POSITIONS     = 2048;
+constexpr uint16_t MAX_SENSOR_STATES = 512;
+constexpr uint16_t MAX_MOVES         = 4096;
+constexpr uint16_t MAX_FEN_LENGTH    = 90;
+
+// Positions from test_check.cpp: checks, checkmates and quiet positions
+static const char* const s_checkFens[] = {
+    "r6r/1b2k1bq/8/8/7B/8/8/R3K2R b KQ - 3 2",
+    "8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 3",
+    "r1b1kbnr/pp1ppppp/n7/q1p5/8/P2P1N2/1PP1PPPP/RNBQKB1R w KQkq - 2 2",
+    "r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 3 2",
+    "2kr3r/p1ppqpb1/bN2Qnp1/3P4/1p2P3/2N5/PPPBBPPP/R3K2R b KQ - 3 2",
+    "rnb2k2/pp1Pbppp/2p5/q7/2B5/6n1/PPPQN1PP/RNB1K2r w Q - 3 9",
+    "2r5/3pk3/1P6/8/8/2K5/8/8 w - - 5 4",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1Q1PP/R4RK1 w - - 0 10",
+    "3k4/3pPK2/8/7r/8/8/8/8 b - - 0 1",
+    "r3k2r/1b5q/8/8/8/2b5/7B/R3K2R w KQkq - 0 1",
+    "8/8/2k5/5q2/8/3n4/5K2/8 w - - 0 1",
+    "8/8/8/8/4k1B1/8/1r6/r5K1 w - - 0 1",
+    "1q5k/8/8/Ppnn4/1nKn4/1nnn4/8/8 w - b6 0 1",
+    "1q5k/8/8/1pPn4/1nKn4/1nnn4/8/8 w - b6 0 1",
+    "8/8/8/8/8/2K5/8/1k5R b - - 0 1",
+    "r6r/1b1k2bq/8/8/7B/8/8/R3K2R b KQ - 3 2",
+    "8/8/8/2kP4/2p5/8/B7/4K3 b - - 0 3",
+    "r1b1kbnr/pp1ppppp/n7/q1p5/8/P1NP1N2/1PP1PPPP/R1BQKB1R w KQkq - 2 2",
+    "r2k3r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQ - 3 2",
+    "2kr3r/p1ppqpb1/b1N1Qnp1/3P4/1p2P3/2N5/PPPBBPPP/R3K2R b KQ - 3 2",
+    "rnb2k2/pp1Pbppp/2p5/q7/2B5/6n1/PPPQNKPP/RNB4r w - - 3 9",
+    "2r5/3pk1K1/1P6/8/8/8/8/8 w - - 5 4",
+    "r4rk1/1pp1qpp1/p1np1n2/2b1p1B1/2B1P1b1/P1NP1NKp/1PP1Q1PP/R4R2 w - - 0 10",
+    "2k5/3pPK2/8/7r/8/8/8/8 b - - 0 1",
+    "r3k2r/1b5q/8/8/8/2r5/7B/R3K2R w KQkq - 0 1",
+    "8/8/2k5/5q2/8/3n4/4KR2/8 w - - 0 1",
+    "8/8/8/2rrr3/2rkb3/2rb4/5B2/6K1 b - - 0 1",
+    "1q5k/q1q5/8/8/8/8/1K6/8 w - - 0 1",
+    "8/8/8/2rrr3/2rkb3/2rbP2Q/8/6K1 b - - 0 1",
+    "8/8/8/2rrrN2/2rkb3/2rbn3/2N5/6K1 b - - 0 1",
+    "8/6q1/8/8/4k1B1/8/1r6/r5K1 w - - 0 1",
+    "1q5k/2r5/8/1pPn4/1nKn4/1nnn4/8/8 w - b6 0 1",
+    "8/3Bk2P/N7/PPP4Q/1K3r2/7r/NP4P1/4B3 w - - 0 1",
+    "3rk2r/pppp1ppp/8/8/1B2Q3/8/PPPPPPPP/RN2KBNR b KQk - 0 1",
+    "7r/6r1/8/8/7K/8/8/6k1 w - - 0 1",
+    "k7/8/8/8/5B2/5B2/8/1K4Q1 b - - 0 1",
+    "8/8/8/8/8/1K6/8/1k5R b - - 0 1",
+    "3rkbnr/1p1bp3/1q1p3p/p5pQ/3n4/PPR5/5PPP/6K1 b - - 2 2",
+    "8/5r2/4K1q1/4p3/3k4/8/8/8 w - - 0 7",
+    "4r2r/p6p/1pnN2p1/kQp5/3pPq2/3P4/PPP3PP/R5K1 b - - 0 2",
+    "r3k2r/ppp2p1p/2n1p1p1/8/2B2P1q/2NPb1n1/PP4PP/R2Q3K w kq - 0 8",
+    "8/6R1/pp1r3p/6p1/P3R1Pk/1P4P1/7K/8 b - - 0 4",
+};
+
+// Sensor scripts played from the initial position: captures, castling, en passant, promotion, checkmate
+static const char* const s_sensorScripts[] = {
+    "-e2 +e4 -e7 +e5 -f1 +c4 -b8 +c6 -d1 +h5 -g8 +f6 -f7 -h5 +f7",
+    "-e2 +e4 -d7 +d5 -d5 -e4 +d5 -d5 -d8 +d5 -b1 +c3 -d5 +a5 -g1 +f3 -g8 +f6 -f1 +e2 -c8 +f5 -e1 +g1 -h1 +f1",
+    "-e2 +e4 -a7 +a6 -e4 +e5 -d7 +d5 -e5 +d6 -d5 -a8 +a7 -c7 -d6 +c7 -a7 +a8 -d8 -c7 +d8 -d8 -e8 +d8",
+    "-f2 +f3 -e7 +e5 -g2 +g4 -d8 +h4",
+};
+
+static Game s_positions[MAX_POSITIONS];
+static char s_fens[MAX_POSITIONS][MAX_FEN_LENGTH];
+static uint16_t s_positionCount = 0;
+
+static uint64_t s_sensorStates[MAX_SENSOR_STATES];
+static uint16_t s_sensorScriptStarts[sizeof(s_sensorScripts) / sizeof(s_sensorScripts[0]) + 1];
+
+static Move s_moves[MAX_MOVES];
+static uint16_t s_moveCount = 0;
+
+//-----------------------------------------------------------------------------
+static void addPosition(const char* p_fen)
+//-----------------------------------------------------------------------------
+{
+    if (s_positionCount >= MAX_POSITIONS)
+        return;
+
+    // A truncated FEN would load as a different (or invalid) position
+    const size_t length = strlen(p_fen);
+    if (length >= MAX_FEN_LENGTH) {
+        printf("Skipping FEN longer than %u characters: %.40s...\n", (unsigned)(MAX_FEN_LENGTH - 1), p_fen);
+        return;
+    }
+
+    memcpy(s_fens[s_positionCount], p_fen, length + 1);
+    initializeFromFEN(&s_positions[s_positionCount], s_fens[s_positionCount]);
+    s_positionCount++;
+}
+
+//-----------------------------------------------------------------------------
+static bool loadPositions(const char* p_path)
+//-----------------------------------------------------------------------------
+{
+    FILE* file = fopen(p_path, "r");
+    if (nullptr == file) {
+        printf("Unable to open %s (run from the project root or use --fen)\n", p_path);
+        return false;
+    }
+
+    char line[128];
+    while (nullptr != fgets(line, sizeof(line), file)) {
+        const size_t end = strcspn(line, "\r\n");
+        if (line[end] == 0 && !feof(file)) {
+            // Longer than the line buffer: drop the rest so it is not read as another line
+            printf("Skipping line longer than %u characters: %.40s...\n", (unsigned)sizeof(line) - 2, line);
+            int c;
+            while ((c = fgetc(file)) != EOF && c != '\n') {
+            }
+            continue;
+        }
+        line[end] = 0;
+        if (line[0] != 0)
+            addPosition(line);
+    }
+    fclose(file);
+
+    for (const char* fen : s_checkFens)
+        addPosition(fen);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static void expandSensorScripts()
+//-----------------------------------------------------------------------------
+{
+    // Same syntax as the test scripts, expanded once so that only evolveGame is timed
+    uint16_t count = 0;
+    uint8_t script = 0;
+    for (; script < sizeof(s_sensorScripts) / sizeof(s_sensorScripts[0]); script++) {
+        s_sensorScriptStarts[script] = count;
+        uint64_t state               = DEFAULT_SENSORS_STATE;
+        for (const char* action = s_sensorScripts[script]; *action != 0 && count < MAX_SENSOR_STATES; action++) {
+            if ((*action != '+' && *action != '-') || action[1] == 0 || action[2] == 0)
+                continue;
+
+            const uint64_t mask     = 1uLL << getSquareFromStr(action + 1);
+            state                   = (*action == '+') ? (state | mask) : (state & ~mask);
+            s_sensorStates[count++] = state;
+        }
+    }
+    s_sensorScriptStarts[script] = count;
+}
+
+//-----------------------------------------------------------------------------
+static void collectMoves()
+//-----------------------------------------------------------------------------
+{
+    for (uint16_t i = 0; i < s_positionCount; i++) {
+        Game* game          = &s_positions[i];
+        const uint8_t color = game->state.status & bits::ColorMask;
+        for (uint8_t square = 0; square < 64 && s_moveCount + 16 <= MAX_MOVES; square++) {
+            Move moves[16];
+            const uint8_t count = findMovesToSquare(game, square, color, false, false, moves);
+            for (uint8_t m = 0; m < count; m++)
+                s_moves[s_moveCount++] = moves[m];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchIsCheck()
+//-----------------------------------------------------------------------------
+{
+    // Reads the checkers of State, computed once per committed position: see benchUpdateCheckersAndPins
+    uint32_t checks = 0;
+    for (uint16_t i = 0; i < s_positionCount; i++)
+        checks += isCheck(&s_positions[i]);
+    g_benchSink = g_benchSink + checks;
+    return s_positionCount;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchUpdateCheckersAndPins()
+//-----------------------------------------------------------------------------
+{
+    // Check detection of a committed position, from its attack maps
+    uint64_t checkers = 0;
+    for (uint16_t i = 0; i < s_positionCount; i++) {
+        updateCheckersAndPins(&s_positions[i]);
+        checkers ^= s_positions[i].state.checkers ^ s_positions[i].state.pinned;
+    }
+    g_benchSink = g_benchSink + (uint32_t)(checkers ^ (checkers >> 32));
+    return s_positionCount;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchIsCheckmate()
+//-----------------------------------------------------------------------------
+{
+    uint32_t checkmates = 0;
+    for (uint16_t i = 0; i < s_positionCount; i++)
+        checkmates += isCheckmate(&s_positions[i]);
+    g_benchSink = g_benchSink + checkmates;
+    return s_positionCount;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchFindMovesToSquare()
+//-----------------------------------------------------------------------------
+{
+    uint32_t found = 0;
+    for (uint16_t i = 0; i < s_positionCount; i++) {
+        Game* game          = &s_positions[i];
+        const uint8_t color = game->state.status & bits::ColorMask;
+        for (uint8_t square = 0; square < 64; square++) {
+            Move moves[16];
+            found += findMovesToSquare(game, square, color, false, false, moves);
+        }
+    }
+    g_benchSink = g_benchSink + found;
+    return s_positionCount * 64;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchIsAttacked()
+//-----------------------------------------------------------------------------
+{
+    uint32_t attacked = 0;
+    for (uint16_t i = 0; i < s_positionCount; i++) {
+        const Game* game = &s_positions[i];
+        for (uint8_t square = 0; square < 64; square++) {
+            if (bits::White == (game->state.status & bits::ColorMask))
+                attacked += isAttacked<bits::Black>(game, square);
+            else
+                attacked += isAttacked<bits::White>(game, square);
+        }
+    }
+    g_benchSink = g_benchSink + attacked;
+    return s_positionCount * 64;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchAttackersTo()
+//-----------------------------------------------------------------------------
+{
+    uint64_t attackers = 0;
+    for (uint16_t i = 0; i < s_positionCount; i++) {
+        const Game* game = &s_positions[i];
+        for (uint8_t square = 0; square < 64; square++) {
+            if (bits::White == (game->state.status & bits::ColorMask))
+                attackers ^= attackersTo<bits::Black>(game, square);
+            else
+                attackers ^= attackersTo<bits::White>(game, square);
+        }
+    }
+    g_benchSink = g_benchSink + (uint32_t)attackers;
+    return s_positionCount * 64;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchMoversTo()
+//-----------------------------------------------------------------------------
+{
+    uint64_t movers = 0;
+    for (uint16_t i = 0; i < s_positionCount; i++) {
+        const Game* game = &s_positions[i];
+        for (uint8_t square = 0; square < 64; square++) {
+            if (bits::White == (game->state.status & bits::ColorMask))
+                movers ^= moversTo<bits::White>(game, square);
+            else
+                movers ^= moversTo<bits::Black>(game, square);
+        }
+    }
+    g_benchSink = g_benchSink + (uint32_t)movers;
+    return s_positionCount * 64;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchEvolveGame()
+//-----------------------------------------------------------------------------
+{
+    uint32_t operations = 0;
+    for (uint8_t script = 0; script < sizeof(s_sensorScripts) / sizeof(s_sensorScripts[0]); script++) {
+        Game game;
+        initializeGame(&game, DEFAULT_SENSORS_STATE);
+        for (uint16_t i = s_sensorScriptStarts[script]; i < s_sensorScriptStarts[script + 1]; i++) {
+            evolveGame(&game, s_sensorStates[i]);
+            operations++;
+        }
+        g_benchSink = g_benchSink + game.state.status;
+    }
+    return operations;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchEvolveLoggedGame()
+//-----------------------------------------------------------------------------
+{
+    // Same calls as evolveGame, with a ring small enough for old calls to be played on the snapshot
+    static GameEvent events[64];
+    uint32_t operations = 0;
+    for (uint8_t script = 0; script < sizeof(s_sensorScripts) / sizeof(s_sensorScripts[0]); script++) {
+        Game game;
+        initializeGame(&game, DEFAULT_SENSORS_STATE);
+        GameLog log;
+        startGameLog(&log, events, sizeof(events) / sizeof(events[0]), &game, DEFAULT_SENSORS_STATE);
+        for (uint16_t i = s_sensorScriptStarts[script]; i < s_sensorScriptStarts[script + 1]; i++) {
+            evolveLoggedGame(&log, nullptr, &game, s_sensorStates[i], i);
+            operations++;
+        }
+        g_benchSink = g_benchSink + game.state.status + log.snapshot.state.status;
+    }
+    return operations;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchInitializeFromFEN()
+//-----------------------------------------------------------------------------
+{
+    Game game;
+    for (uint16_t i = 0; i < s_positionCount; i++) {
+        initializeFromFEN(&game, s_fens[i]);
+        g_benchSink = g_benchSink + game.board[i % 64];
+    }
+    return s_positionCount;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchWriteToFEN()
+//-----------------------------------------------------------------------------
+{
+    char buffer[128];
+    for (uint16_t i = 0; i < s_positionCount; i++)
+        g_benchSink = g_benchSink + writeToFEN(&s_positions[i], buffer);
+    return s_positionCount;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchGetMoveStr()
+//-----------------------------------------------------------------------------
+{
+    for (uint16_t i = 0; i < s_moveCount; i++)
+        g_benchSink = g_benchSink + getMoveStr(s_moves[i])[0];
+    return s_moveCount;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t benchStabilizeValue()
+//-----------------------------------------------------------------------------
+{
+    // Sensor noise every few samples, stable changes every 300 ms at 500 Hz
+    static uint32_t s_now_ms = 0;
+    uint64_t value           = DEFAULT_SENSORS_STATE;
+    for (uint16_t i = 0; i < 1024; i++) {
+        s_now_ms += 2;
+        if (0 == i % 150)
+            value ^= 1uLL << (i % 64);
+        const uint64_t noise = (0 == i % 7) ? (1uLL << 20) : 0;
+        g_benchSink          = g_benchSink + (uint32_t)stabilizeValue(value ^ noise, s_now_ms, 250);
+    }
+    return 1024;
+}
+
+//-----------------------------------------------------------------------------
+template <class Revision>
+static uint32_t benchScanBoard()
+//-----------------------------------------------------------------------------
+{
+    // Scan loop of the firmware on mock shift registers: pin operations cost a few instructions on target
+    typedef MockShiftRegisters<Revision> Gpio;
+    uint8_t layout[64];
+    loadScanLayout(layout, Revision::getLayout());
+    uint64_t sensors = DEFAULT_SENSORS_STATE;
+    for (uint16_t i = 0; i < 1024; i++) {
+        Gpio::reset(sensors ^ (1uLL << (i % 64)));
+        sensors     = scanBoard<Revision, Gpio>(layout);
+        g_benchSink = g_benchSink + (uint32_t)sensors;
+    }
+    return 1024;
+}
+
+static const Benchmark s_benchmarks[] = {
+    {"isCheck (cached)",      &benchIsCheck                   },
+    {"updateCheckersAndPins", &benchUpdateCheckersAndPins     },
+    {"isCheckmate",           &benchIsCheckmate               },
+    {"findMovesToSquare",     &benchFindMovesToSquare         },
+    {"isAttacked",            &benchIsAttacked                },
+    {"attackersTo",           &benchAttackersTo               },
+    {"moversTo",              &benchMoversTo                  },
+    {"evolveGame",            &benchEvolveGame                },
+    {"evolveLoggedGame",      &benchEvolveLoggedGame          },
+    {"initializeFromFEN",     &benchInitializeFromFEN         },
+    {"writeToFEN",            &benchWriteToFEN                },
+    {"getMoveStr",            &benchGetMoveStr                },
+    {"stabilizeValue",        &benchStabilizeValue            },
+    {"scanBoardRevA",         &benchScanBoard<BoardRevA>      },
+    {"scanBoardRevAJ",        &benchScanBoard<BoardRevAJumped>},
+};
+
+int main(int argc, char** argv) {
+    const char* fenPath      = "test/data/bnilsou.fen";
+    const char* jsonPath     = nullptr;
+    const char* baselinePath = nullptr;
+    const char* filter       = nullptr;
+    BenchOptions options     = {3, 31, 10.0};
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1 < argc);
+        if (0 == strcmp(argv[i], "--fen") && hasValue) {
+            fenPath = argv[++i];
+        } else if (0 == strcmp(argv[i], "--warmups") && hasValue) {
+            options.warmups = (uint16_t)atoi(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--reps") && hasValue) {
+            options.reps = (uint16_t)atoi(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--json") && hasValue) {
+            jsonPath = argv[++i];
+        } else if (0 == strcmp(argv[i], "--baseline") && hasValue) {
+            baselinePath = argv[++i];
+        } else if (0 == strcmp(argv[i], "--threshold") && hasValue) {
+            options.threshold = atof(argv[++i]);
+        } else if (0 == strcmp(argv[i], "--filter") && hasValue) {
+            filter = argv[++i];
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (!loadPositions(fenPath))
+        return 2;
+    expandSensorScripts();
+    collectMoves();
+    printf("%u positions, %u sensor states, %u moves\n\n", s_positionCount, s_sensorScriptStarts[sizeof(s_sensorScripts) / sizeof(s_sensorScripts[0])], s_moveCount);
+
+    BenchResult results[BENCH_MAX_BENCHMARKS];
+    uint8_t count = 0;
+    for (const Benchmark& benchmark : s_benchmarks) {
+        if (nullptr != filter && nullptr == strstr(benchmark.name, filter))
+            continue;
+        runBenchmark(&benchmark, &options, &results[count++]);
+    }
+    printResults(results, count);
+
+    if (nullptr != jsonPath && !writeResultsJson(jsonPath, results, count, &options))
+        return 2;
+
+    if (nullptr != baselinePath) {
+        const int regressions = compareWithBaseline(baselinePath, results, count, &options);
+        if (regressions != 0)
+            return (regressions < 0) ? 2 : 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,299 @@
+#include "book.h"
+
+#include <flash.h>
+#include <string.h>
+
+#ifndef ARDUINO_ARCH_AVR
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "book_data.h"
+
+static_assert(sizeof(s_builtinBook) <= BOOK_FLASH_BUDGET, "Built-in opening book does not fit in its flash budget, regenerate it with tools/bookgen");
+
+// FNV-1a
+constexpr uint32_t KEY_BASIS = 2166136261u;
+constexpr uint32_t KEY_PRIME = 16777619u;
+
+//-----------------------------------------------------------------------------
+uint32_t getPositionKey(Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    uint32_t key = KEY_BASIS;
+    for (uint8_t i = 0; i < 64; i++)
+        key = (key ^ (uint8_t)p_game->board[i]) * KEY_PRIME;
+
+    const State* state     = &p_game->state;
+    const uint8_t castling = (state->castlingK[0] << 0) | (state->castlingK[1] << 1) | (state->castlingQ[0] << 2) | (state->castlingQ[1] << 3);
+    key                    = (key ^ (state->status & bits::ColorMask)) * KEY_PRIME;
+    return (key ^ castling) * KEY_PRIME;
+}
+
+//-----------------------------------------------------------------------------
+static inline uint16_t readBook16(const uint8_t* p_address)
+//-----------------------------------------------------------------------------
+{
+    return pgm_read_byte(p_address) | (pgm_read_byte(p_address + 1) << 8);
+}
+
+//-----------------------------------------------------------------------------
+static inline uint32_t readBook32(const uint8_t* p_address)
+//-----------------------------------------------------------------------------
+{
+    return readBook16(p_address) | ((uint32_t)readBook16(p_address + 2) << 16);
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t readVarint(const uint8_t** p_address)
+//-----------------------------------------------------------------------------
+{
+    uint32_t value = 0;
+    uint8_t shift  = 0;
+    uint8_t byte   = 0;
+    do {
+        byte = pgm_read_byte(*p_address);
+        (*p_address)++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while ((byte & 0x80) && shift < 32);
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+bool initializeOpeningBook(OpeningBook* p_book, const uint8_t* p_data, uint32_t p_size)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_book || nullptr == p_data || p_size < BOOK_HEADER_SIZE)
+        return false;
+
+    const char magic[4] = {'E', 'C', 'O', 'B'};
+    for (uint8_t i = 0; i < 4; i++) {
+        if (pgm_read_byte(p_data + i) != (uint8_t)magic[i])
+            return false;
+    }
+
+    p_book->data         = p_data;
+    p_book->size         = p_size;
+    p_book->blockShift   = pgm_read_byte(p_data + 4);
+    p_book->entryCount   = readBook16(p_data + 6);
+    p_book->blockCount   = readBook16(p_data + 8);
+    p_book->openingCount = readBook16(p_data + 10);
+
+    const uint32_t entriesOffset  = BOOK_HEADER_SIZE + (uint32_t)p_book->blockCount * BOOK_BLOCK_SIZE;
+    const uint32_t openingsOffset = entriesOffset + readBook16(p_data + 12);
+    const uint32_t namesOffset    = openingsOffset + (uint32_t)p_book->openingCount * BOOK_OPENING_SIZE;
+    if (namesOffset + readBook16(p_data + 14) > p_size || p_book->blockShift > 15 || namesOffset > 0xFFFF)
+        return false;
+
+    p_book->entriesOffset  = entriesOffset;
+    p_book->openingsOffset = openingsOffset;
+    p_book->namesOffset    = namesOffset;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+const OpeningBook* getBuiltinOpeningBook()
+//-----------------------------------------------------------------------------
+{
+    static OpeningBook s_book;
+    static bool s_initialized = false;
+    if (!s_initialized) {
+        s_initialized = initializeOpeningBook(&s_book, s_builtinBook, sizeof(s_builtinBook));
+        if (!s_initialized)
+            return nullptr;
+    }
+    return &s_book;
+}
+
+//-----------------------------------------------------------------------------
+uint16_t findOpening(const OpeningBook* p_book, uint32_t p_key)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_book || 0 == p_book->blockCount)
+        return BOOK_NO_OPENING;
+
+    // Last block starting at or before the key
+    const uint8_t* blocks = p_book->data + BOOK_HEADER_SIZE;
+    if (readBook32(blocks) > p_key)
+        return BOOK_NO_OPENING;
+
+    uint16_t low  = 0;
+    uint16_t high = p_book->blockCount - 1;
+    while (low < high) {
+        const uint16_t middle = low + (high - low + 1) / 2;
+        if (readBook32(blocks + (uint32_t)middle * BOOK_BLOCK_SIZE) <= p_key)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+
+    // Walk the block
+    const uint8_t* block = blocks + (uint32_t)low * BOOK_BLOCK_SIZE;
+    const uint8_t* entry = p_book->data + p_book->entriesOffset + readBook16(block + 4);
+    const uint32_t first = (uint32_t)low << p_book->blockShift;
+    const uint32_t last  = first + (1uL << p_book->blockShift);
+    uint32_t key         = readBook32(block);
+
+    for (uint32_t i = first; i < last && i < p_book->entryCount; i++) {
+        if (i != first)
+            key += readVarint(&entry);
+        const uint16_t opening = (uint16_t)readVarint(&entry);
+        if (key == p_key)
+            return opening;
+        if (key > p_key)
+            break;
+    }
+    return BOOK_NO_OPENING;
+}
+
+//-----------------------------------------------------------------------------
+void writeOpeningEco(const OpeningBook* p_book, uint16_t p_opening, char* p_buffer)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_book || p_opening >= p_book->openingCount) {
+        p_buffer[0] = 0;
+        return;
+    }
+
+    const uint16_t eco = readBook16(p_book->data + p_book->openingsOffset + (uint32_t)p_opening * BOOK_OPENING_SIZE);
+    p_buffer[0]        = 'A' + eco / 100;
+    p_buffer[1]        = '0' + (eco / 10) % 10;
+    p_buffer[2]        = '0' + eco % 10;
+    p_buffer[3]        = 0;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t writeOpeningName(const OpeningBook* p_book, uint16_t p_opening, char* p_buffer, uint8_t p_size)
+//-----------------------------------------------------------------------------
+{
+    if (0 == p_size)
+        return 0;
+
+    uint8_t length = 0;
+    if (nullptr != p_book && p_opening < p_book->openingCount) {
+        const uint16_t offset = readBook16(p_book->data + p_book->openingsOffset + (uint32_t)p_opening * BOOK_OPENING_SIZE + 2);
+        const uint8_t* name   = p_book->data + p_book->namesOffset + offset;
+        char c;
+        while (length + 1 < p_size && 0 != (c = (char)pgm_read_byte(name + length))) {
+            p_buffer[length] = c;
+            length++;
+        }
+    }
+    p_buffer[length] = 0;
+    return length;
+}
+
+//-----------------------------------------------------------------------------
+static inline void writeBook16(uint8_t* p_address, uint16_t p_value)
+//-----------------------------------------------------------------------------
+{
+    p_address[0] = (uint8_t)p_value;
+    p_address[1] = (uint8_t)(p_value >> 8);
+}
+
+//-----------------------------------------------------------------------------
+static bool writeVarint(uint8_t* p_blob, uint32_t* p_size, uint32_t p_capacity, uint32_t p_value)
+//-----------------------------------------------------------------------------
+{
+    do {
+        if (*p_size >= p_capacity)
+            return false;
+        p_blob[(*p_size)++] = (uint8_t)((p_value & 0x7F) | ((p_value > 0x7F) ? 0x80 : 0));
+        p_value >>= 7;
+    } while (p_value > 0);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t encodeOpeningBook(const BookEntry* p_entries, uint16_t p_entryCount, const uint16_t* p_ecos, const char* const* p_names,
+                           uint16_t p_openingCount, uint8_t p_blockShift, uint8_t* p_blob, uint32_t p_capacity)
+//-----------------------------------------------------------------------------
+{
+    const uint16_t blockSize  = 1u << p_blockShift;
+    const uint16_t blockCount = (p_entryCount + blockSize - 1) >> p_blockShift;
+    uint32_t size             = BOOK_HEADER_SIZE + (uint32_t)blockCount * BOOK_BLOCK_SIZE;
+    if (p_blockShift > 15 || size > p_capacity)
+        return 0;
+
+    const uint32_t entriesOffset = size;
+    for (uint16_t i = 0; i < p_entryCount; i++) {
+        if (i > 0 && p_entries[i].key <= p_entries[i - 1].key)
+            return 0; // Not sorted or duplicated
+
+        if (0 == (i & (blockSize - 1))) {
+            uint8_t* block     = p_blob + BOOK_HEADER_SIZE + (uint32_t)(i >> p_blockShift) * BOOK_BLOCK_SIZE;
+            const uint32_t key = p_entries[i].key;
+            writeBook16(block, (uint16_t)key);
+            writeBook16(block + 2, (uint16_t)(key >> 16));
+            writeBook16(block + 4, (uint16_t)(size - entriesOffset));
+        } else if (!writeVarint(p_blob, &size, p_capacity, p_entries[i].key - p_entries[i - 1].key)) {
+            return 0;
+        }
+        if (!writeVarint(p_blob, &size, p_capacity, p_entries[i].opening))
+            return 0;
+    }
+
+    const uint32_t openingsOffset = size;
+    size += (uint32_t)p_openingCount * BOOK_OPENING_SIZE;
+    const uint32_t namesOffset = size;
+    for (uint16_t i = 0; i < p_openingCount; i++) {
+        const uint32_t length = strlen(p_names[i]) + 1;
+        if (size + length > p_capacity || size - namesOffset > 0xFFFF)
+            return 0;
+        writeBook16(p_blob + openingsOffset + (uint32_t)i * BOOK_OPENING_SIZE, p_ecos[i]);
+        writeBook16(p_blob + openingsOffset + (uint32_t)i * BOOK_OPENING_SIZE + 2, (uint16_t)(size - namesOffset));
+        memcpy(p_blob + size, p_names[i], length);
+        size += length;
+    }
+    if (openingsOffset - entriesOffset > 0xFFFF || size - namesOffset > 0xFFFF || namesOffset > 0xFFFF)
+        return 0;
+
+    memcpy(p_blob, "ECOB", 4);
+    p_blob[4] = p_blockShift;
+    p_blob[5] = 0;
+    writeBook16(p_blob + 6, p_entryCount);
+    writeBook16(p_blob + 8, blockCount);
+    writeBook16(p_blob + 10, p_openingCount);
+    writeBook16(p_blob + 12, (uint16_t)(openingsOffset - entriesOffset));
+    writeBook16(p_blob + 14, (uint16_t)(size - namesOffset));
+    return size;
+}
+
+#ifndef ARDUINO_ARCH_AVR
+//-----------------------------------------------------------------------------
+bool openOpeningBookFile(OpeningBook* p_book, const char* p_path)
+//-----------------------------------------------------------------------------
+{
+    const int file = open(p_path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (0 == fstat(file, &info) && info.st_size > 0)
+        data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (MAP_FAILED == data)
+        return false;
+
+    if (!initializeOpeningBook(p_book, static_cast<const uint8_t*>(data), (uint32_t)info.st_size)) {
+        munmap(data, (size_t)info.st_size);
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void closeOpeningBookFile(OpeningBook* p_book)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr != p_book && nullptr != p_book->data) {
+        munmap(const_cast<uint8_t*>(p_book->data), p_book->size);
+        p_book->data       = nullptr;
+        p_book->blockCount = 0;
+    }
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chess.h>
+#include <stdint.h>
+
+// Openings (ECO code and name) keyed by position, generated by tools/bookgen into a single blob:
+//   header    "ECOB", block shift, 0, entry count, block count, opening count, entries size, names size (16 bytes)
+//   blocks    first key (u32) and offset in entries (u16) of each block of 2^shift entries, sorted by key
+//   entries   per entry: key delta from the previous entry of the block (varint, not stored for the first one)
+//             then opening (varint)
+//   openings  ECO (u16, 0 = A00 to 499 = E99) and name offset (u16)
+//   names     NUL-terminated strings
+// All values are little endian. The blob is in flash on AVR, compiled in or mapped from a file on native.
+constexpr uint8_t BOOK_HEADER_SIZE     = 16;
+constexpr uint8_t BOOK_BLOCK_SIZE      = 6;
+constexpr uint8_t BOOK_OPENING_SIZE    = 4;
+constexpr uint16_t BOOK_NO_OPENING     = 0xFFFF;
+constexpr uint8_t BOOK_ECO_LENGTH      = 3;
+constexpr uint8_t BOOK_MAX_NAME_LENGTH = 63;
+
+// Flash left to the built-in book by the firmware (28 KB usable on the Leonardo), checked at build time
+#ifndef BOOK_FLASH_BUDGET
+#define BOOK_FLASH_BUDGET 4096
+#endif
+
+typedef struct {
+    const uint8_t* data;
+    uint32_t size;
+    uint8_t blockShift;
+    uint16_t entryCount;
+    uint16_t blockCount;
+    uint16_t openingCount;
+    uint16_t entriesOffset;
+    uint16_t openingsOffset;
+    uint16_t namesOffset;
+} OpeningBook;
+
+// Entry given to the encoder
+typedef struct {
+    uint32_t key;
+    uint16_t opening;
+} BookEntry;
+
+// Key of the position to play: pieces, player and castling rights (en passant and clocks are ignored)
+uint32_t getPositionKey(Game* p_game);
+
+// Read the header of a blob, false if it is not a valid book
+bool initializeOpeningBook(OpeningBook* p_book, const uint8_t* p_data, uint32_t p_size);
+
+// Book compiled into the firmware
+const OpeningBook* getBuiltinOpeningBook();
+
+// Opening of a position, BOOK_NO_OPENING if it is not in the book
+uint16_t findOpening(const OpeningBook* p_book, uint32_t p_key);
+
+// ECO code ("C60", p_buffer holds BOOK_ECO_LENGTH + 1 chars) and name (truncated to p_size - 1 chars)
+void writeOpeningEco(const OpeningBook* p_book, uint16_t p_opening, char* p_buffer);
+uint8_t writeOpeningName(const OpeningBook* p_book, uint16_t p_opening, char* p_buffer, uint8_t p_size);
+
+// Encode entries sorted by key with unique keys, openings as ECO numbers and names,
+// returns the blob size or 0 if it does not fit in p_capacity
+uint32_t encodeOpeningBook(const BookEntry* p_entries, uint16_t p_entryCount, const uint16_t* p_ecos, const char* const* p_names,
+                           uint16_t p_openingCount, uint8_t p_blockShift, uint8_t* p_blob, uint32_t p_capacity);
+
+#ifndef ARDUINO_ARCH_AVR
+// Map a blob written by tools/bookgen
+bool openOpeningBookFile(OpeningBook* p_book, const char* p_path);
+void closeOpeningBookFile(OpeningBook* p_book);
+#endif
@@ -0,0 +1,117 @@
+// Generated by tools/bookgen from tools/bookgen/eco.pgn, do not edit
+// 61 positions, 61 openings, 1742 bytes
+#pragma once
+
+#include <stdint.h>
+
+static const uint8_t s_builtinBook[] PROGMEM = {
+    0x45, 0x43, 0x4F, 0x42, 0x03, 0x00, 0x3D, 0x00, 0x08, 0x00, 0x3D, 0x00, 0x10, 0x01, 0x8A, 0x04,
+    0x00, 0xB6, 0x7F, 0x01, 0x00, 0x00, 0x49, 0x1D, 0x5E, 0x3C, 0x25, 0x00, 0x14, 0xDD, 0x1C, 0x4D,
+    0x49, 0x00, 0x5F, 0x3A, 0x8F, 0x62, 0x6D, 0x00, 0x5B, 0x37, 0x7C, 0x8C, 0x91, 0x00, 0x6C, 0x33,
+    0x55, 0xB0, 0xB4, 0x00, 0xE6, 0x33, 0x90, 0xD0, 0xD8, 0x00, 0x9A, 0x30, 0xF2, 0xEE, 0xFB, 0x00,
+    0x1A, 0xCB, 0xF7, 0x9E, 0xD5, 0x01, 0x18, 0xB6, 0xD4, 0xC4, 0x1D, 0x06, 0xB5, 0xCA, 0xA1, 0x29,
+    0x24, 0xD0, 0xD0, 0xEC, 0x2E, 0x21, 0xA6, 0x95, 0xB4, 0x14, 0x2A, 0x98, 0xEF, 0xA5, 0x05, 0x37,
+    0x85, 0xDD, 0xEE, 0x25, 0x34, 0x1F, 0xBB, 0xB8, 0xE4, 0x05, 0x2C, 0xFD, 0x80, 0xF0, 0x01, 0x00,
+    0x93, 0xC1, 0xAE, 0x08, 0x12, 0x8D, 0xA9, 0x80, 0x19, 0x04, 0x91, 0xB0, 0x90, 0x06, 0x08, 0xD7,
+    0xEC, 0x89, 0x01, 0x20, 0xEB, 0x8A, 0xEE, 0x2A, 0x14, 0x35, 0xDF, 0xC7, 0xB6, 0x02, 0x19, 0xAE,
+    0xE0, 0x9E, 0x01, 0x01, 0xF5, 0xEC, 0xA8, 0x0D, 0x3A, 0x9F, 0xFD, 0xD8, 0x3E, 0x1B, 0xEC, 0x9E,
+    0xF2, 0x0D, 0x02, 0xD1, 0xE9, 0xCE, 0x2B, 0x26, 0xC8, 0xEE, 0xBB, 0x01, 0x38, 0x29, 0x92, 0xAF,
+    0xC2, 0x17, 0x1E, 0xE0, 0xB9, 0xA0, 0x2F, 0x0D, 0x98, 0x9C, 0xCA, 0x31, 0x33, 0xF9, 0xC7, 0xFF,
+    0x14, 0x36, 0xA3, 0xED, 0x89, 0x0F, 0x13, 0xC2, 0xCF, 0xD0, 0x1F, 0x27, 0xEE, 0xDE, 0xA6, 0x13,
+    0x2B, 0x09, 0xD6, 0xE8, 0x2A, 0x05, 0xEF, 0xA0, 0xA1, 0x0B, 0x0E, 0xEA, 0xB7, 0xF3, 0x5D, 0x0A,
+    0xD3, 0xF1, 0xCC, 0x13, 0x16, 0xEA, 0xE5, 0xDA, 0x2B, 0x2D, 0xB7, 0xE6, 0xBD, 0x1D, 0x25, 0x83,
+    0xE1, 0x9E, 0x1A, 0x03, 0x10, 0xA1, 0xBE, 0xDE, 0x4A, 0x15, 0xD5, 0x92, 0xED, 0x0E, 0x0B, 0x9B,
+    0xAB, 0x98, 0x1B, 0x1C, 0x88, 0xC7, 0xAA, 0x34, 0x17, 0xCC, 0x8F, 0xD4, 0x04, 0x07, 0xAD, 0xCA,
+    0xDB, 0x2B, 0x30, 0xCE, 0xB6, 0xE7, 0x0C, 0x28, 0x3C, 0xE6, 0xC4, 0xDF, 0x05, 0x0C, 0xC6, 0xF0,
+    0x92, 0x25, 0x2F, 0xC6, 0xC2, 0x35, 0x23, 0x81, 0xB9, 0xA6, 0x27, 0x22, 0xD9, 0x99, 0xE5, 0x65,
+    0x0F, 0xAE, 0xEC, 0x8A, 0x03, 0x1D, 0xC0, 0xB5, 0xD5, 0x04, 0x32, 0x11, 0xEC, 0xB0, 0xA7, 0x0C,
+    0x39, 0xBC, 0xFA, 0xF5, 0x1B, 0x3B, 0x8A, 0xB7, 0xA8, 0x05, 0x2E, 0x85, 0xD3, 0xAF, 0x4F, 0x31,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x01, 0x00, 0x2E, 0x00,
+    0x02, 0x00, 0x42, 0x00, 0x04, 0x00, 0x4F, 0x00, 0x0A, 0x00, 0x5C, 0x00, 0x28, 0x00, 0x6C, 0x00,
+    0x2D, 0x00, 0x7E, 0x00, 0x32, 0x00, 0x8D, 0x00, 0x38, 0x00, 0x9C, 0x00, 0x39, 0x00, 0xAB, 0x00,
+    0x50, 0x00, 0xB8, 0x00, 0x64, 0x00, 0xC6, 0x00, 0x65, 0x00, 0xDA, 0x00, 0x66, 0x00, 0xEF, 0x00,
+    0x6A, 0x00, 0x00, 0x01, 0x6B, 0x00, 0x0F, 0x01, 0x6E, 0x00, 0x1C, 0x01, 0x70, 0x00, 0x2E, 0x01,
+    0x78, 0x00, 0x53, 0x01, 0x7A, 0x00, 0x64, 0x01, 0x7B, 0x00, 0x87, 0x01, 0x85, 0x00, 0xA0, 0x01,
+    0xAA, 0x00, 0xBD, 0x01, 0xBE, 0x00, 0xD6, 0x01, 0xC8, 0x00, 0xF0, 0x01, 0xCA, 0x00, 0xFF, 0x01,
+    0xCB, 0x00, 0x21, 0x02, 0xDC, 0x00, 0x44, 0x02, 0xDF, 0x00, 0x55, 0x02, 0xE1, 0x00, 0x66, 0x02,
+    0xE6, 0x00, 0x72, 0x02, 0xE9, 0x00, 0x80, 0x02, 0xF0, 0x00, 0x97, 0x02, 0xF1, 0x00, 0xAD, 0x02,
+    0xF2, 0x00, 0xBE, 0x02, 0xF4, 0x00, 0xCD, 0x02, 0xF5, 0x00, 0xDE, 0x02, 0xF6, 0x00, 0xEA, 0x02,
+    0xF7, 0x00, 0xFD, 0x02, 0xFA, 0x00, 0x0F, 0x03, 0xFA, 0x00, 0x1C, 0x03, 0xFB, 0x00, 0x29, 0x03,
+    0xFF, 0x00, 0x36, 0x03, 0x04, 0x01, 0x4A, 0x03, 0x09, 0x01, 0x54, 0x03, 0x0C, 0x01, 0x6E, 0x03,
+    0x0E, 0x01, 0x8C, 0x03, 0x1C, 0x01, 0xA6, 0x03, 0x2C, 0x01, 0xB8, 0x03, 0x2E, 0x01, 0xCA, 0x03,
+    0x32, 0x01, 0xDC, 0x03, 0x36, 0x01, 0xEB, 0x03, 0x40, 0x01, 0xF8, 0x03, 0x4A, 0x01, 0x10, 0x04,
+    0x7C, 0x01, 0x28, 0x04, 0x90, 0x01, 0x39, 0x04, 0x9C, 0x01, 0x48, 0x04, 0xA4, 0x01, 0x5F, 0x04,
+    0xCC, 0x01, 0x74, 0x04, 0x50, 0x6F, 0x6C, 0x69, 0x73, 0x68, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69,
+    0x6E, 0x67, 0x00, 0x47, 0x72, 0x6F, 0x62, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69, 0x6E, 0x67, 0x00,
+    0x48, 0x75, 0x6E, 0x67, 0x61, 0x72, 0x69, 0x61, 0x6E, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69, 0x6E,
+    0x67, 0x00, 0x4E, 0x69, 0x6D, 0x7A, 0x6F, 0x2D, 0x4C, 0x61, 0x72, 0x73, 0x65, 0x6E, 0x20, 0x41,
+    0x74, 0x74, 0x61, 0x63, 0x6B, 0x00, 0x42, 0x69, 0x72, 0x64, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69,
+    0x6E, 0x67, 0x00, 0x52, 0x65, 0x74, 0x69, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69, 0x6E, 0x67, 0x00,
+    0x45, 0x6E, 0x67, 0x6C, 0x69, 0x73, 0x68, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69, 0x6E, 0x67, 0x00,
+    0x51, 0x75, 0x65, 0x65, 0x6E, 0x27, 0x73, 0x20, 0x50, 0x61, 0x77, 0x6E, 0x20, 0x47, 0x61, 0x6D,
+    0x65, 0x00, 0x49, 0x6E, 0x64, 0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65,
+    0x00, 0x49, 0x6E, 0x64, 0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00,
+    0x42, 0x65, 0x6E, 0x6F, 0x6E, 0x69, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x42,
+    0x65, 0x6E, 0x6B, 0x6F, 0x20, 0x47, 0x61, 0x6D, 0x62, 0x69, 0x74, 0x00, 0x44, 0x75, 0x74, 0x63,
+    0x68, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x4B, 0x69, 0x6E, 0x67, 0x27, 0x73,
+    0x20, 0x50, 0x61, 0x77, 0x6E, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69, 0x6E, 0x67, 0x00, 0x53, 0x63,
+    0x61, 0x6E, 0x64, 0x69, 0x6E, 0x61, 0x76, 0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E,
+    0x73, 0x65, 0x00, 0x41, 0x6C, 0x65, 0x6B, 0x68, 0x69, 0x6E, 0x65, 0x20, 0x44, 0x65, 0x66, 0x65,
+    0x6E, 0x73, 0x65, 0x00, 0x4D, 0x6F, 0x64, 0x65, 0x72, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E,
+    0x73, 0x65, 0x00, 0x50, 0x69, 0x72, 0x63, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00,
+    0x43, 0x61, 0x72, 0x6F, 0x2D, 0x4B, 0x61, 0x6E, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73,
+    0x65, 0x00, 0x43, 0x61, 0x72, 0x6F, 0x2D, 0x4B, 0x61, 0x6E, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65,
+    0x6E, 0x73, 0x65, 0x3A, 0x20, 0x41, 0x64, 0x76, 0x61, 0x6E, 0x63, 0x65, 0x20, 0x56, 0x61, 0x72,
+    0x69, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x00, 0x53, 0x69, 0x63, 0x69, 0x6C, 0x69, 0x61, 0x6E, 0x20,
+    0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x53, 0x69, 0x63, 0x69, 0x6C, 0x69, 0x61, 0x6E,
+    0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x3A, 0x20, 0x41, 0x6C, 0x61, 0x70, 0x69, 0x6E,
+    0x20, 0x56, 0x61, 0x72, 0x69, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x00, 0x53, 0x69, 0x63, 0x69, 0x6C,
+    0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x3A, 0x20, 0x43, 0x6C, 0x6F,
+    0x73, 0x65, 0x64, 0x00, 0x53, 0x69, 0x63, 0x69, 0x6C, 0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66,
+    0x65, 0x6E, 0x73, 0x65, 0x3A, 0x20, 0x53, 0x76, 0x65, 0x73, 0x68, 0x6E, 0x69, 0x6B, 0x6F, 0x76,
+    0x00, 0x53, 0x69, 0x63, 0x69, 0x6C, 0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73,
+    0x65, 0x3A, 0x20, 0x44, 0x72, 0x61, 0x67, 0x6F, 0x6E, 0x00, 0x53, 0x69, 0x63, 0x69, 0x6C, 0x69,
+    0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x3A, 0x20, 0x4E, 0x61, 0x6A, 0x64,
+    0x6F, 0x72, 0x66, 0x00, 0x46, 0x72, 0x65, 0x6E, 0x63, 0x68, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E,
+    0x73, 0x65, 0x00, 0x46, 0x72, 0x65, 0x6E, 0x63, 0x68, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73,
+    0x65, 0x3A, 0x20, 0x41, 0x64, 0x76, 0x61, 0x6E, 0x63, 0x65, 0x20, 0x56, 0x61, 0x72, 0x69, 0x61,
+    0x74, 0x69, 0x6F, 0x6E, 0x00, 0x46, 0x72, 0x65, 0x6E, 0x63, 0x68, 0x20, 0x44, 0x65, 0x66, 0x65,
+    0x6E, 0x73, 0x65, 0x3A, 0x20, 0x54, 0x61, 0x72, 0x72, 0x61, 0x73, 0x63, 0x68, 0x20, 0x56, 0x61,
+    0x72, 0x69, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x00, 0x4B, 0x69, 0x6E, 0x67, 0x27, 0x73, 0x20, 0x50,
+    0x61, 0x77, 0x6E, 0x20, 0x47, 0x61, 0x6D, 0x65, 0x00, 0x42, 0x69, 0x73, 0x68, 0x6F, 0x70, 0x27,
+    0x73, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69, 0x6E, 0x67, 0x00, 0x56, 0x69, 0x65, 0x6E, 0x6E, 0x61,
+    0x20, 0x47, 0x61, 0x6D, 0x65, 0x00, 0x4B, 0x69, 0x6E, 0x67, 0x27, 0x73, 0x20, 0x47, 0x61, 0x6D,
+    0x62, 0x69, 0x74, 0x00, 0x4B, 0x69, 0x6E, 0x67, 0x27, 0x73, 0x20, 0x47, 0x61, 0x6D, 0x62, 0x69,
+    0x74, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70, 0x74, 0x65, 0x64, 0x00, 0x4B, 0x69, 0x6E, 0x67, 0x27,
+    0x73, 0x20, 0x4B, 0x6E, 0x69, 0x67, 0x68, 0x74, 0x20, 0x4F, 0x70, 0x65, 0x6E, 0x69, 0x6E, 0x67,
+    0x00, 0x50, 0x68, 0x69, 0x6C, 0x69, 0x64, 0x6F, 0x72, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73,
+    0x65, 0x00, 0x50, 0x65, 0x74, 0x72, 0x6F, 0x76, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65,
+    0x00, 0x4B, 0x69, 0x6E, 0x67, 0x27, 0x73, 0x20, 0x50, 0x61, 0x77, 0x6E, 0x20, 0x47, 0x61, 0x6D,
+    0x65, 0x00, 0x53, 0x63, 0x6F, 0x74, 0x63, 0x68, 0x20, 0x47, 0x61, 0x6D, 0x65, 0x00, 0x54, 0x68,
+    0x72, 0x65, 0x65, 0x20, 0x4B, 0x6E, 0x69, 0x67, 0x68, 0x74, 0x73, 0x20, 0x47, 0x61, 0x6D, 0x65,
+    0x00, 0x46, 0x6F, 0x75, 0x72, 0x20, 0x4B, 0x6E, 0x69, 0x67, 0x68, 0x74, 0x73, 0x20, 0x47, 0x61,
+    0x6D, 0x65, 0x00, 0x49, 0x74, 0x61, 0x6C, 0x69, 0x61, 0x6E, 0x20, 0x47, 0x61, 0x6D, 0x65, 0x00,
+    0x47, 0x69, 0x75, 0x6F, 0x63, 0x6F, 0x20, 0x50, 0x69, 0x61, 0x6E, 0x6F, 0x00, 0x45, 0x76, 0x61,
+    0x6E, 0x73, 0x20, 0x47, 0x61, 0x6D, 0x62, 0x69, 0x74, 0x00, 0x54, 0x77, 0x6F, 0x20, 0x4B, 0x6E,
+    0x69, 0x67, 0x68, 0x74, 0x73, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x52, 0x75,
+    0x79, 0x20, 0x4C, 0x6F, 0x70, 0x65, 0x7A, 0x00, 0x52, 0x75, 0x79, 0x20, 0x4C, 0x6F, 0x70, 0x65,
+    0x7A, 0x3A, 0x20, 0x42, 0x65, 0x72, 0x6C, 0x69, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73,
+    0x65, 0x00, 0x52, 0x75, 0x79, 0x20, 0x4C, 0x6F, 0x70, 0x65, 0x7A, 0x3A, 0x20, 0x45, 0x78, 0x63,
+    0x68, 0x61, 0x6E, 0x67, 0x65, 0x20, 0x56, 0x61, 0x72, 0x69, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x00,
+    0x52, 0x75, 0x79, 0x20, 0x4C, 0x6F, 0x70, 0x65, 0x7A, 0x3A, 0x20, 0x4D, 0x6F, 0x72, 0x70, 0x68,
+    0x79, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x52, 0x75, 0x79, 0x20, 0x4C, 0x6F,
+    0x70, 0x65, 0x7A, 0x3A, 0x20, 0x43, 0x6C, 0x6F, 0x73, 0x65, 0x64, 0x00, 0x51, 0x75, 0x65, 0x65,
+    0x6E, 0x27, 0x73, 0x20, 0x50, 0x61, 0x77, 0x6E, 0x20, 0x47, 0x61, 0x6D, 0x65, 0x00, 0x51, 0x75,
+    0x65, 0x65, 0x6E, 0x27, 0x73, 0x20, 0x50, 0x61, 0x77, 0x6E, 0x20, 0x47, 0x61, 0x6D, 0x65, 0x00,
+    0x51, 0x75, 0x65, 0x65, 0x6E, 0x27, 0x73, 0x20, 0x47, 0x61, 0x6D, 0x62, 0x69, 0x74, 0x00, 0x53,
+    0x6C, 0x61, 0x76, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x51, 0x75, 0x65, 0x65,
+    0x6E, 0x27, 0x73, 0x20, 0x47, 0x61, 0x6D, 0x62, 0x69, 0x74, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70,
+    0x74, 0x65, 0x64, 0x00, 0x51, 0x75, 0x65, 0x65, 0x6E, 0x27, 0x73, 0x20, 0x47, 0x61, 0x6D, 0x62,
+    0x69, 0x74, 0x20, 0x44, 0x65, 0x63, 0x6C, 0x69, 0x6E, 0x65, 0x64, 0x00, 0x47, 0x72, 0x75, 0x6E,
+    0x66, 0x65, 0x6C, 0x64, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x49, 0x6E, 0x64,
+    0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x51, 0x75, 0x65, 0x65,
+    0x6E, 0x27, 0x73, 0x20, 0x49, 0x6E, 0x64, 0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E,
+    0x73, 0x65, 0x00, 0x4E, 0x69, 0x6D, 0x7A, 0x6F, 0x2D, 0x49, 0x6E, 0x64, 0x69, 0x61, 0x6E, 0x20,
+    0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00, 0x4B, 0x69, 0x6E, 0x67, 0x27, 0x73, 0x20, 0x49,
+    0x6E, 0x64, 0x69, 0x61, 0x6E, 0x20, 0x44, 0x65, 0x66, 0x65, 0x6E, 0x73, 0x65, 0x00,
+};
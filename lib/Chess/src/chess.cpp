@@ -1,5 +1,9 @@
 #include "chess.h"
+#include "eval.h"
+#include "movegen.h"
 
+#include <flash.h>
+#include <profiler.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +24,14 @@
 #define LOG_INDEX(X, IDX) printf(X " (index %d)\n", IDX)
 #endif
 
+// Benchmarks silence game logs
+#ifdef CHESS_DISABLE_LOG
+#undef LOG
+#undef LOG_INDEX
+#define LOG(X) ((void)0)
+#define LOG_INDEX(X, IDX) ((void)(IDX))
+#endif
+
 const uint64_t DEFAULT_SENSORS_STATE = 0xFFFF00000000FFFFuLL; // (11111111 11111111 00000000 00000000 00000000 00000000 11111111 11111111)
 const uint8_t NULL_INDEX             = 64;
 
@@ -29,13 +41,47 @@ typedef struct {
     uint8_t noColorPiece;
 } CastlingUpdate;
 
-static constexpr CastlingUpdate s_castlingUpdates[4] = {
+static const CastlingUpdate s_castlingUpdates[4] PROGMEM = {
     {0 * 8 + 0 /* A1 */, bits::White, bits::Queen},
     {0 * 8 + 7 /* A8 */, bits::White, bits::King },
     {7 * 8 + 0 /* H1 */, bits::Black, bits::Queen},
     {7 * 8 + 7 /* H8 */, bits::Black, bits::King }
 };
 
+// Neighbour squares, clockwise from the top left one
+static const int8_t s_kingDirCol[8] PROGMEM = {-1, 0, 1, 1, 1, 0, -1, -1};
+static const int8_t s_kingDirRow[8] PROGMEM = {1, 1, 1, 0, -1, -1, -1, 0};
+
+// Lines from a square: col-, col+, row-, row+, diagBL, diagTL, diagBR, diagTR
+static const int8_t s_lineDirCol[8] PROGMEM = {-1, 1, 0, 0, -1, -1, 1, 1};
+static const int8_t s_lineDirRow[8] PROGMEM = {0, 0, -1, 1, -1, 1, -1, 1};
+
+// Knight jumps
+static const int8_t s_knightDirCol[8] PROGMEM = {1, 2, 2, 1, -1, -2, -2, -1};
+static const int8_t s_knightDirRow[8] PROGMEM = {2, 1, -1, -2, -2, -1, 1, 2};
+
+// Status strings, all of equal width to clear LCD screen
+constexpr uint8_t STATUS_STR_SIZE = 16;
+static const char s_statusStrings[][STATUS_STR_SIZE] PROGMEM = {
+    "Illegal: undo  ", // 0
+    "White to play  ", // 1
+    "White playing  ", // 2
+    "White capturing", // 3
+    "White enpassant", // 4
+    "White castling ", // 5
+    "Black to play  ", // 6
+    "Black playing  ", // 7
+    "Black capturing", // 8
+    "Black enpassant", // 9
+    "Black castling ", // 10
+    "Draw           ", // 11
+    "White won      ", // 12
+    "Black won      ", // 13
+    "Undefined      ", // 14
+};
+
+static const char s_castlingMsg[5] PROGMEM = {'O', '-', 'O', '-', 'O'};
+
 //-----------------------------------------------------------------------------
 void initializeGame(Game* p_game, uint64_t p_mask)
 //-----------------------------------------------------------------------------
@@ -80,6 +126,8 @@ void initializeGame(Game* p_game, uint64_t p_mask)
     for (uint8_t i = 0; i < 64; i++)
         if ((p_mask & (1uLL << i)) == 0)
             p_game->board[i] = Empty;
+    initializeEvaluation(&p_game->evaluation, p_game->board);
+    initializeAttackMaps(p_game);
 
     // Game state
     p_game->state.status                 = bits::White | bits::ToPlay;
@@ -96,17 +144,18 @@ void initializeGame(Game* p_game, uint64_t p_mask)
     p_game->lastMoveW.piece              = Empty;
     p_game->fullmoveClock                = 1;
     p_game->halfmoveClock                = 0;
+    updateCheckersAndPins(p_game);
 
     LOG("Game has been initialized");
 }
 
 //-----------------------------------------------------------------------------
-void initializeFromFEN(Game* p_game, const char* p_fen)
+bool initializeFromFEN(Game* p_game, const char* p_fen)
 //-----------------------------------------------------------------------------
 {
     if (NULL == p_game) {
         LOG("Unable to initialize null game");
-        return;
+        return false;
     }
 
     // Game state
@@ -120,6 +169,8 @@ void initializeFromFEN(Game* p_game, const char* p_fen)
     p_game->state.castlingQ[bits::White] = true;
     p_game->state.castlingK[bits::Black] = true;
     p_game->state.castlingQ[bits::Black] = true;
+    p_game->state.checkers               = 0;
+    p_game->state.pinned                 = 0;
     p_game->lastMoveB.piece              = Empty;
     p_game->lastMoveW.piece              = Empty;
     p_game->fullmoveClock                = 1;
@@ -129,20 +180,30 @@ void initializeFromFEN(Game* p_game, const char* p_fen)
     uint8_t rank = 7;
     uint8_t file = 0;
 
-    int index = 0;
+    int index  = 0;
+    bool valid = true;
     while (rank > 0 || file < 8) {
         char c = p_fen[index++];
         if (c == 0) {
             LOG_INDEX("Unexpected end of FEN notation at", index);
-            return;
+            return false;
         } else if (c == '/') {
             if (file < 8) {
                 LOG_INDEX("Unexpected / in FEN notation at", index);
+                valid = false;
+            }
+            if (0 == rank) {
+                LOG_INDEX("Too many ranks in FEN notation at", index);
+                return false;
             }
             rank--;
             file = 0;
         } else if (c >= '1' && c <= '8') {
             const uint8_t emptySquareCount = (c - '0');
+            if (file + emptySquareCount > 8) {
+                LOG_INDEX("Too many squares in FEN notation rank at", index);
+                return false;
+            }
             for (uint8_t i = 0; i < emptySquareCount; i++) {
                 p_game->board[rank * 8 + file] = EPiece::Empty;
                 file++;
@@ -151,12 +212,18 @@ void initializeFromFEN(Game* p_game, const char* p_fen)
             const EPiece piece = charToPiece(c);
             if (piece == EPiece::Empty) {
                 LOG_INDEX("Unexpected character in FEN notation at", index);
+                valid = false;
+            } else if (file >= 8) {
+                LOG_INDEX("Too many squares in FEN notation rank at", index);
+                return false;
             } else {
                 p_game->board[rank * 8 + file] = piece;
                 file++;
             }
         }
     }
+    initializeEvaluation(&p_game->evaluation, p_game->board);
+    initializeAttackMaps(p_game);
 
     // Read the rest of FEN with sscanf
     char playerToMove;
@@ -165,26 +232,29 @@ void initializeFromFEN(Game* p_game, const char* p_fen)
     int halfmoveClock;
     int fullmoveClock;
 
-    if (5 != sscanf(&p_fen[index], " %c%s%s%d%d", &playerToMove, castlingRights, enPassantTarget, &halfmoveClock, &fullmoveClock)) {
+    if (5 != sscanf_P(&p_fen[index], PSTR(" %c%4s%2s%d%d"), &playerToMove, castlingRights, enPassantTarget, &halfmoveClock, &fullmoveClock)) {
         LOG_INDEX("sscanf failed to parse FEN remainder starting at", index);
-        return;
+        return false;
     }
 
-    size_t len                           = strlen(castlingRights);
-    p_game->state.castlingK[bits::White] = (strcspn(castlingRights, "K") != len);
-    p_game->state.castlingQ[bits::White] = (strcspn(castlingRights, "Q") != len);
-    p_game->state.castlingK[bits::Black] = (strcspn(castlingRights, "k") != len);
-    p_game->state.castlingQ[bits::Black] = (strcspn(castlingRights, "q") != len);
+    p_game->state.castlingK[bits::White] = (nullptr != strchr(castlingRights, 'K'));
+    p_game->state.castlingQ[bits::White] = (nullptr != strchr(castlingRights, 'Q'));
+    p_game->state.castlingK[bits::Black] = (nullptr != strchr(castlingRights, 'k'));
+    p_game->state.castlingQ[bits::Black] = (nullptr != strchr(castlingRights, 'q'));
 
     if (playerToMove == 'w') {
         p_game->state.status = bits::White | bits::ToPlay;
     } else if (playerToMove == 'b') {
         p_game->state.status = bits::Black | bits::ToPlay;
+    } else {
+        valid = false;
     }
 
     p_game->state.en_passant = getSquareFromStr(enPassantTarget);
     p_game->fullmoveClock    = fullmoveClock;
     p_game->halfmoveClock    = halfmoveClock;
+    updateCheckersAndPins(p_game);
+    return valid;
 }
 
 //-----------------------------------------------------------------------------
@@ -234,7 +304,7 @@ int writeToFEN(Game* p_game, char* p_buffer)
 
     const char playerToMove = (p_game->state.status & bits::ColorMask) == bits::White ? 'w' : 'b';
 
-    int ret = sprintf(&p_buffer[index], " %c %s %s %d %d", playerToMove, castlingStates, enPassantTarget, p_game->halfmoveClock, p_game->fullmoveClock);
+    int ret = sprintf_P(&p_buffer[index], PSTR(" %c %s %s %d %d"), playerToMove, castlingStates, enPassantTarget, p_game->halfmoveClock, p_game->fullmoveClock);
     if (ret <= 0) {
         LOG_INDEX("Error while writing FEN with sprintf:", ret);
         return 0;
@@ -328,38 +398,59 @@ void writeSquareToStr(uint8_t p_index, char* p_buffer)
 const char* getStatusStr(uint8_t p_status)
 //-----------------------------------------------------------------------------
 {
-    // All strings are of equal width to clear LCD screen
-    switch (p_status) {
-    case bits::White | bits::ToPlay:
-        return "White to play  ";
-    case bits::White | bits::Playing:
-        return "White playing  ";
-    case bits::White | bits::Capturing:
-        return "White capturing";
-    case bits::White | bits::EnPassant:
-        return "White enpassant";
-    case bits::White | bits::Castling:
-        return "White castling ";
-    case bits::Black | bits::ToPlay:
-        return "Black to play  ";
-    case bits::Black | bits::Playing:
-        return "Black playing  ";
-    case bits::Black | bits::Capturing:
-        return "Black capturing";
-    case bits::Black | bits::EnPassant:
-        return "Black enpassant";
-    case bits::Black | bits::Castling:
-        return "Black castling ";
-    case bits::Draw | bits::Finished:
-        return "Draw           ";
-    case bits::White | bits::Finished:
-        return "White won      ";
-    case bits::Black | bits::Finished:
-        return "Black won      ";
+    // Copied from flash to a static buffer, as getMoveStr writes its moves
+    static char status[STATUS_STR_SIZE];
+    uint8_t index = 0;
+    if (0 == (p_status & bits::Illegal)) {
+        switch (p_status) {
+        case bits::White | bits::ToPlay:
+            index = 1;
+            break;
+        case bits::White | bits::Playing:
+            index = 2;
+            break;
+        case bits::White | bits::Capturing:
+            index = 3;
+            break;
+        case bits::White | bits::EnPassant:
+            index = 4;
+            break;
+        case bits::White | bits::Castling:
+            index = 5;
+            break;
+        case bits::Black | bits::ToPlay:
+            index = 6;
+            break;
+        case bits::Black | bits::Playing:
+            index = 7;
+            break;
+        case bits::Black | bits::Capturing:
+            index = 8;
+            break;
+        case bits::Black | bits::EnPassant:
+            index = 9;
+            break;
+        case bits::Black | bits::Castling:
+            index = 10;
+            break;
+        case bits::Draw | bits::Finished:
+            index = 11;
+            break;
+        case bits::White | bits::Finished:
+            index = 12;
+            break;
+        case bits::Black | bits::Finished:
+            index = 13;
+            break;
 
-    default:
-        return "Undefined      ";
-    };
+        default:
+            index = 14;
+            break;
+        };
+    }
+
+    strcpy_P(status, s_statusStrings[index]);
+    return status;
 }
 
 //-----------------------------------------------------------------------------
@@ -381,7 +472,7 @@ void printGame(Game* p_game)
 #else
         Serial.print(8 - i);
         for (uint8_t j = 0; j < 8; j++) {
-            Serial.print(" | ");
+            Serial.print(F(" | "));
             Serial.print(getPieceChar(p_game->board[8 * (8 - i - 1) + j]));
         }
         Serial.print(' ');
@@ -396,7 +487,7 @@ void printGame(Game* p_game)
 #else
     Serial.print('[');
     Serial.print(getStatusStr(p_game->state.status));
-    Serial.print("]\n");
+    Serial.print(F("]\n"));
 #endif
 
     if ((p_game->state.status & bits::MoveMask) == bits::ToPlay) {
@@ -410,135 +501,517 @@ void printGame(Game* p_game)
 #ifdef HAS_PRINTF
         printf("[Last move: %s]\n", getMoveStr(*lastMove));
 #else
-        Serial.print("[Last move: ");
+        Serial.print(F("[Last move: "));
         Serial.print(getMoveStr(*lastMove));
-        Serial.print("]\n");
+        Serial.print(F("]\n"));
 #endif
     }
 }
 
 //-----------------------------------------------------------------------------
-bool isCheck(Game* p_game)
+static inline uint8_t getFirstSquare(uint64_t p_squares)
+//-----------------------------------------------------------------------------
+{
+    return (0 == p_squares) ? NULL_INDEX : (uint8_t)__builtin_ctzll(p_squares);
+}
+
+//-----------------------------------------------------------------------------
+static inline bool hasSeveralSquares(uint64_t p_squares)
+//-----------------------------------------------------------------------------
+{
+    return 0 != (p_squares & (p_squares - 1));
+}
+
+// Attacker queries are specialized on the attacking color (pieces are compared with constants) and on the first
+// attacker only (early return): no runtime flags nor function pointers down the scans.
+
+//-----------------------------------------------------------------------------
+template <uint8_t Color, bool FirstOnly>
+static inline uint64_t scanPawnAttackers(const EPiece* p_board, uint8_t p_targetSquare)
+//-----------------------------------------------------------------------------
+{
+    // Pawns attack forward: look one row behind the target square from the attacker point of view
+    constexpr int8_t dirPRow = (bits::Black == Color) ? 1 : -1;
+    const uint8_t targetCol  = p_targetSquare % 8;
+    const uint8_t row        = p_targetSquare / 8 + dirPRow;
+    uint64_t attackers       = 0;
+
+    if (row < 8) {
+        if (targetCol > 0 && (Color | bits::Pawn) == p_board[8 * row + targetCol - 1]) {
+            attackers |= (1uLL << (8 * row + targetCol - 1));
+            if (FirstOnly)
+                return attackers;
+        }
+        if (targetCol < 7 && (Color | bits::Pawn) == p_board[8 * row + targetCol + 1])
+            attackers |= (1uLL << (8 * row + targetCol + 1));
+    }
+    return attackers;
+}
+
+//-----------------------------------------------------------------------------
+template <uint8_t Color, bool FirstOnly>
+static inline uint64_t scanKnightAttackers(const EPiece* p_board, uint8_t p_targetSquare)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t targetCol = p_targetSquare % 8;
+    const uint8_t targetRow = p_targetSquare / 8;
+    uint64_t attackers      = 0;
+
+    for (uint8_t i = 0; i < 8; i++) {
+        const uint8_t col = targetCol + pgm_read_int8(&s_knightDirCol[i]);
+        const uint8_t row = targetRow + pgm_read_int8(&s_knightDirRow[i]);
+
+        if ((col < 8) && (row < 8) && (Color | bits::Knight) == p_board[8 * row + col]) {
+            attackers |= (1uLL << (8 * row + col));
+            if (FirstOnly)
+                return attackers;
+        }
+    }
+    return attackers;
+}
+
+//-----------------------------------------------------------------------------
+template <uint8_t Color, bool FirstOnly, bool Orthogonal>
+static inline uint64_t scanLineAttackers(const EPiece* p_board, uint8_t p_targetSquare)
+//-----------------------------------------------------------------------------
+{
+    // First piece met in each direction: queen and rook (orthogonal) or bishop (diagonal), or the adjacent king
+    constexpr uint8_t lineFlag  = Orthogonal ? bits::OrthogonalFlag : bits::DiagonalFlag;
+    constexpr uint8_t rangeMask = bits::ColorMask | bits::LongRangeFlag | lineFlag;
+    constexpr uint8_t firstDir  = Orthogonal ? 0 : 4;
+    const uint8_t targetCol     = p_targetSquare % 8;
+    const uint8_t targetRow     = p_targetSquare / 8;
+    uint64_t attackers          = 0;
+
+    for (uint8_t i = firstDir; i < firstDir + 4; i++) {
+        const int8_t dirCol = pgm_read_int8(&s_lineDirCol[i]);
+        const int8_t dirRow = pgm_read_int8(&s_lineDirRow[i]);
+        uint8_t col         = targetCol + dirCol;
+        uint8_t row         = targetRow + dirRow;
+        bool adjacent       = true;
+
+        while ((col < 8) && (row < 8)) {
+            const EPiece piece = p_board[8 * row + col];
+            if (piece != EPiece::Empty) {
+                if ((Color | bits::LongRangeFlag | lineFlag) == (piece & rangeMask) || (adjacent && (Color | bits::King) == piece)) {
+                    attackers |= (1uLL << (8 * row + col));
+                    if (FirstOnly)
+                        return attackers;
+                }
+                break;
+            }
+
+            col += dirCol;
+            row += dirRow;
+            adjacent = false;
+        }
+    }
+    return attackers;
+}
+
+//-----------------------------------------------------------------------------
+template <uint8_t Color>
+bool isAttacked(const Game* p_game, uint8_t p_targetSquare)
 //-----------------------------------------------------------------------------
 {
     if (NULL == p_game) {
-        LOG("Unable to analyze check of null game");
+        LOG("Unable to analyze attackers of null game");
         return false;
     }
 
-    if (0 == (p_game->state.status & bits::ToPlay)) {
-        LOG("Unable to analyze check when neither white nor black has to play");
-        return false;
+    // Cheapest scans first
+    return 0 != scanPawnAttackers<Color, true>(p_game->board, p_targetSquare) ||
+           0 != scanKnightAttackers<Color, true>(p_game->board, p_targetSquare) ||
+           0 != scanLineAttackers<Color, true, true>(p_game->board, p_targetSquare) ||
+           0 != scanLineAttackers<Color, true, false>(p_game->board, p_targetSquare);
+}
+
+//-----------------------------------------------------------------------------
+template <uint8_t Color>
+uint64_t attackersTo(const Game* p_game, uint8_t p_targetSquare)
+//-----------------------------------------------------------------------------
+{
+    if (NULL == p_game) {
+        LOG("Unable to analyze attackers of null game");
+        return 0;
     }
 
-    uint8_t nextPlayer     = (p_game->state.status & bits::ColorMask);
-    uint8_t checkingPlayer = (nextPlayer == bits::White) ? bits::Black : bits::White;
+    return scanPawnAttackers<Color, false>(p_game->board, p_targetSquare) |
+           scanKnightAttackers<Color, false>(p_game->board, p_targetSquare) |
+           scanLineAttackers<Color, false, true>(p_game->board, p_targetSquare) |
+           scanLineAttackers<Color, false, false>(p_game->board, p_targetSquare);
+}
 
-    // Find King
-    uint8_t checkedKingIndex = NULL_INDEX;
-    for (uint8_t i = 0; i < 64; i++) {
-        EPiece piece = p_game->board[i];
-        if ((true == isKing(piece)) && (nextPlayer == (bits::ColorMask & piece))) {
-            checkedKingIndex = i;
+//-----------------------------------------------------------------------------
+template <uint8_t Color>
+uint64_t moversTo(const Game* p_game, uint8_t p_targetSquare)
+//-----------------------------------------------------------------------------
+{
+    if (NULL == p_game) {
+        LOG("Unable to analyze movers of null game");
+        return 0;
+    }
+
+    constexpr uint8_t otherColor = Color ^ bits::ColorMask;
+    constexpr int8_t dirPRow     = (bits::Black == Color) ? 1 : -1;
+    const EPiece targetPiece     = p_game->board[p_targetSquare];
+    const uint8_t targetCol      = p_targetSquare % 8;
+    const uint8_t targetRow      = p_targetSquare / 8;
+
+    // 1. Queens, Rooks, Bishops, Knights and King move as they attack
+    uint64_t movers = scanKnightAttackers<Color, false>(p_game->board, p_targetSquare) |
+                      scanLineAttackers<Color, false, true>(p_game->board, p_targetSquare) |
+                      scanLineAttackers<Color, false, false>(p_game->board, p_targetSquare);
+    for (uint64_t pieces = movers; 0 != pieces; pieces &= pieces - 1) {
+        const uint8_t square = getFirstSquare(pieces);
+        if ((Color | bits::King) == p_game->board[square]) {
+            if (0 != getAttackCount(p_game, p_targetSquare, otherColor))
+                movers &= ~(1uLL << square); // King can't actually move to the target square (defended)
             break;
         }
     }
 
-    if (NULL_INDEX == checkedKingIndex) {
-        LOG("Unable to locate King");
-        return false;
+    // 2. Pawns capture opponent pieces only
+    if (EPiece::Empty != targetPiece && otherColor == (targetPiece & bits::ColorMask))
+        movers |= scanPawnAttackers<Color, false>(p_game->board, p_targetSquare);
+
+    // 3. Pawns (en-passant)
+    if (p_targetSquare == p_game->state.en_passant)
+        movers |= scanPawnAttackers<Color, false>(p_game->board, p_targetSquare);
+
+    // 4. Pawns (forward)
+    if (EPiece::Empty == targetPiece) {
+        uint8_t row = targetRow + dirPRow;
+        if (row < 8) {
+            EPiece piece = p_game->board[8 * row + targetCol];
+            if ((Color | bits::Pawn) == piece) {
+                movers |= (1uLL << (8 * row + targetCol));
+            } else if (EPiece::Empty == piece) {
+                row += dirPRow;
+                if (((bits::White == Color) ? 1 : 6) == row && (Color | bits::Pawn) == p_game->board[8 * row + targetCol])
+                    movers |= (1uLL << (8 * row + targetCol));
+            }
+        }
     }
 
-    Move moves[1];
-    return findMovesToSquare(p_game, checkedKingIndex, checkingPlayer, true /* p_returnOnFirst */, true /* p_includeThreats */, moves);
+    return movers;
 }
 
+template bool isAttacked<bits::White>(const Game* p_game, uint8_t p_targetSquare);
+template bool isAttacked<bits::Black>(const Game* p_game, uint8_t p_targetSquare);
+template uint64_t attackersTo<bits::White>(const Game* p_game, uint8_t p_targetSquare);
+template uint64_t attackersTo<bits::Black>(const Game* p_game, uint8_t p_targetSquare);
+template uint64_t moversTo<bits::White>(const Game* p_game, uint8_t p_targetSquare);
+template uint64_t moversTo<bits::Black>(const Game* p_game, uint8_t p_targetSquare);
+
+// Attack maps hold one count per square and color in a nibble: 12 attackers at most (a slider or the king per
+// direction, two knights and two pawns since promotions are queens).
+
 //-----------------------------------------------------------------------------
-bool isCheckmate(Game* p_game)
+static inline uint8_t getAttackUnit(EPiece p_piece, int8_t p_sign)
 //-----------------------------------------------------------------------------
 {
-    if (NULL == p_game) {
-        LOG("Unable to analyze checkmate of null game");
-        return false;
+    // Added to a map byte: +1 or -1 on the nibble of the piece color (modulo 256)
+    return (uint8_t)(p_sign * (isBlack(p_piece) ? 0x10 : 0x01));
+}
+
+//-----------------------------------------------------------------------------
+static void addRayAttacks(uint8_t* p_attacks, const EPiece* p_board, uint8_t p_square, uint8_t p_direction, uint8_t p_unit)
+//-----------------------------------------------------------------------------
+{
+    // Squares from p_square along the line direction up to the first piece, included
+    const int8_t dirCol = pgm_read_int8(&s_lineDirCol[p_direction]);
+    const int8_t dirRow = pgm_read_int8(&s_lineDirRow[p_direction]);
+    uint8_t col         = p_square % 8 + dirCol;
+    uint8_t row         = p_square / 8 + dirRow;
+
+    while ((col < 8) && (row < 8)) {
+        p_attacks[8 * row + col] += p_unit;
+        if (EPiece::Empty != p_board[8 * row + col])
+            break;
+
+        col += dirCol;
+        row += dirRow;
     }
+}
 
-    if (0 == (p_game->state.status & bits::ToPlay)) {
-        LOG("Unable to analyze checkmate when neither white nor black has to play");
-        return false;
+//-----------------------------------------------------------------------------
+static void addPieceAttacks(uint8_t* p_attacks, const EPiece* p_board, uint8_t p_square, EPiece p_piece, int8_t p_sign)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t unit     = getAttackUnit(p_piece, p_sign);
+    const uint8_t pieceCol = p_square % 8;
+    const uint8_t pieceRow = p_square / 8;
+
+    if (isPawn(p_piece)) {
+        const uint8_t row = pieceRow + (isBlack(p_piece) ? -1 : 1);
+        if (row < 8) {
+            if (pieceCol > 0)
+                p_attacks[8 * row + pieceCol - 1] += unit;
+            if (pieceCol < 7)
+                p_attacks[8 * row + pieceCol + 1] += unit;
+        }
+    } else if (isKnight(p_piece) || isKing(p_piece)) {
+        const int8_t* dirCol = isKnight(p_piece) ? s_knightDirCol : s_kingDirCol;
+        const int8_t* dirRow = isKnight(p_piece) ? s_knightDirRow : s_kingDirRow;
+        for (uint8_t i = 0; i < 8; i++) {
+            const uint8_t col = pieceCol + pgm_read_int8(&dirCol[i]);
+            const uint8_t row = pieceRow + pgm_read_int8(&dirRow[i]);
+            if ((col < 8) && (row < 8))
+                p_attacks[8 * row + col] += unit;
+        }
+    } else {
+        // Orthogonal directions first, then diagonal ones
+        const uint8_t firstDir = (0 != (p_piece & bits::OrthogonalFlag)) ? 0 : 4;
+        const uint8_t lastDir  = (0 != (p_piece & bits::DiagonalFlag)) ? 8 : 4;
+        for (uint8_t i = firstDir; i < lastDir; i++)
+            addRayAttacks(p_attacks, p_board, p_square, i, unit);
     }
+}
+
+//-----------------------------------------------------------------------------
+static void updateLinesThrough(Game* p_game, uint8_t p_square, int8_t p_sign)
+//-----------------------------------------------------------------------------
+{
+    // Queens, rooks and bishops reaching the square attack beyond it once it is empty (p_sign 1), not anymore
+    // once it is occupied (p_sign -1)
+    const uint8_t squareCol = p_square % 8;
+    const uint8_t squareRow = p_square / 8;
 
-    uint8_t checkedPlayer  = (p_game->state.status & bits::ColorMask);
-    uint8_t checkingPlayer = (checkedPlayer == bits::White) ? bits::Black : bits::White;
+    for (uint8_t i = 0; i < 8; i++) {
+        const int8_t dirCol = pgm_read_int8(&s_lineDirCol[i]);
+        const int8_t dirRow = pgm_read_int8(&s_lineDirRow[i]);
+        uint8_t col         = squareCol + dirCol;
+        uint8_t row         = squareRow + dirRow;
+
+        while ((col < 8) && (row < 8) && (EPiece::Empty == p_game->board[8 * row + col])) {
+            col += dirCol;
+            row += dirRow;
+        }
+        if ((col >= 8) || (row >= 8))
+            continue; // No piece on this side
 
-    // 0. Find King
-    uint8_t checkedKingIndex = NULL_INDEX;
+        // Line directions go by pairs: (0, 1), (2, 3), (4, 7) and (5, 6)
+        const EPiece piece        = p_game->board[8 * row + col];
+        const uint8_t lineMask    = bits::LongRangeFlag | ((i < 4) ? bits::OrthogonalFlag : bits::DiagonalFlag);
+        const uint8_t oppositeDir = (i < 4) ? (i ^ 1) : (11 - i);
+        if (lineMask == (piece & lineMask))
+            addRayAttacks(p_game->attacks, p_game->board, p_square, oppositeDir, getAttackUnit(piece, p_sign));
+    }
+}
+
+//-----------------------------------------------------------------------------
+static void setSquareAttacks(Game* p_game, uint8_t p_square, EPiece p_piece)
+//-----------------------------------------------------------------------------
+{
+    // Put p_piece (or nothing) on the square of a board matching the maps, the maps follow
+    const EPiece previous = p_game->board[p_square];
+    if (previous == p_piece)
+        return;
+
+    if (EPiece::Empty != previous)
+        addPieceAttacks(p_game->attacks, p_game->board, p_square, previous, -1);
+    if (EPiece::Empty == previous || EPiece::Empty == p_piece)
+        updateLinesThrough(p_game, p_square, (EPiece::Empty == p_piece) ? 1 : -1);
+    p_game->board[p_square] = p_piece;
+    if (EPiece::Empty != p_piece)
+        addPieceAttacks(p_game->attacks, p_game->board, p_square, p_piece, 1);
+}
+
+//-----------------------------------------------------------------------------
+static void commitAttackMaps(Game* p_game, const Move* p_move, uint8_t p_capturedSquare, EPiece p_captured)
+//-----------------------------------------------------------------------------
+{
+    // The board holds the position after the move: the squares it changed are set back as they were before it,
+    // then changed again one at a time
+    uint8_t squares[4] = {p_move->start, p_move->end, NULL_INDEX, NULL_INDEX};
+    EPiece before[4]   = {p_move->piece, (p_capturedSquare == p_move->end) ? p_captured : EPiece::Empty, EPiece::Empty, EPiece::Empty};
+    uint8_t count      = 2;
+
+    if (NULL_INDEX != p_capturedSquare && p_capturedSquare != p_move->end) {
+        // En passant
+        squares[count]  = p_capturedSquare;
+        before[count++] = p_captured;
+    } else if (isKing(p_move->piece) && 2 == abs(p_move->start - p_move->end)) {
+        // Castling: the rook went from its corner to the square the king passed over
+        const bool kingSide = p_move->end > p_move->start;
+        squares[count]      = kingSide ? p_move->start + 3 : p_move->start - 4;
+        before[count++]     = static_cast<EPiece>((p_move->piece & bits::ColorMask) | bits::Rook);
+        squares[count]      = kingSide ? p_move->end - 1 : p_move->end + 1;
+        before[count++]     = EPiece::Empty;
+    }
+
+    EPiece after[4];
+    for (uint8_t i = 0; i < count; i++) {
+        after[i]                  = p_game->board[squares[i]];
+        p_game->board[squares[i]] = before[i];
+    }
+    for (uint8_t i = 0; i < count; i++)
+        setSquareAttacks(p_game, squares[i], after[i]);
+
+#ifdef CHESS_CHECK_ATTACK_MAPS
+    if (!checkAttackMaps(p_game)) {
+        LOG("Attack maps differ from the board, computed again");
+        initializeAttackMaps(p_game);
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+static void computeAttackMaps(const EPiece* p_board, uint8_t* p_attacks)
+//-----------------------------------------------------------------------------
+{
+    memset(p_attacks, 0, 64);
     for (uint8_t i = 0; i < 64; i++) {
-        EPiece piece = p_game->board[i];
-        if ((true == isKing(piece)) && (checkedPlayer == (bits::ColorMask & piece))) {
-            checkedKingIndex = i;
-            break;
+        if (EPiece::Empty != p_board[i])
+            addPieceAttacks(p_attacks, p_board, i, p_board[i], 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void initializeAttackMaps(Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    computeAttackMaps(p_game->board, p_game->attacks);
+}
+
+//-----------------------------------------------------------------------------
+bool checkAttackMaps(const Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    uint8_t attacks[64];
+    computeAttackMaps(p_game->board, attacks);
+    return 0 == memcmp(attacks, p_game->attacks, sizeof(attacks));
+}
+
+//-----------------------------------------------------------------------------
+void updateCheckersAndPins(Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t player   = p_game->state.status & bits::ColorMask;
+    const uint8_t opponent = player ^ bits::ColorMask;
+    p_game->state.checkers = 0;
+    p_game->state.pinned   = 0;
+
+    uint8_t king = 0;
+    while (king < 64 && (player | bits::King) != p_game->board[king])
+        king++;
+    if (NULL_INDEX == king)
+        return; // No king to protect in test positions
+
+    // Checkers are only looked for when the attack map tells the king is in check
+    if (0 != getAttackCount(p_game, king, opponent))
+        p_game->state.checkers = (bits::White == opponent) ? attackersTo<bits::White>(p_game, king) : attackersTo<bits::Black>(p_game, king);
+
+    // Pinned: first piece from the king on a line, when the next one is an opponent queen, rook or bishop of that line
+    for (uint8_t i = 0; i < 8; i++) {
+        const int8_t dirCol    = pgm_read_int8(&s_lineDirCol[i]);
+        const int8_t dirRow    = pgm_read_int8(&s_lineDirRow[i]);
+        const uint8_t lineMask = bits::LongRangeFlag | ((i < 4) ? bits::OrthogonalFlag : bits::DiagonalFlag);
+        uint8_t col            = king % 8 + dirCol;
+        uint8_t row            = king / 8 + dirRow;
+        uint8_t candidate      = NULL_INDEX;
+
+        while ((col < 8) && (row < 8)) {
+            const EPiece piece = p_game->board[8 * row + col];
+            if (EPiece::Empty != piece) {
+                if (NULL_INDEX != candidate) {
+                    if ((opponent | lineMask) == (piece & (bits::ColorMask | lineMask)))
+                        p_game->state.pinned |= (1uLL << candidate);
+                    break;
+                }
+                if (player != (piece & bits::ColorMask))
+                    break; // Opponent piece next to the king on the line: checking or harmless
+                candidate = 8 * row + col;
+            }
+
+            col += dirCol;
+            row += dirRow;
         }
     }
+}
 
-    if (NULL_INDEX == checkedKingIndex) {
-        LOG("Unable to locate King");
+//-----------------------------------------------------------------------------
+bool isCheck(Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    if (NULL == p_game) {
+        LOG("Unable to analyze check of null game");
+        return false;
+    }
+
+    if (0 == (p_game->state.status & bits::ToPlay)) {
+        LOG("Unable to analyze check when neither white nor black has to play");
         return false;
     }
 
-    // 1. Find all moves threatening the King
-    Move threatenKing[16];
-    uint8_t threatenSize = findMovesToSquare(p_game, checkedKingIndex, checkingPlayer, false /* p_returnOnFirst */, true /* p_includeThreats */, threatenKing);
+    return 0 != p_game->state.checkers;
+}
+
+//-----------------------------------------------------------------------------
+template <uint8_t CheckedPlayer>
+static bool isKingCheckmated(Game* p_game, uint8_t p_kingIndex)
+//-----------------------------------------------------------------------------
+{
+    constexpr uint8_t checkingPlayer = CheckedPlayer ^ bits::ColorMask;
+
+    // 1. Find all pieces threatening the King
+    const uint64_t threats = p_game->state.checkers;
 
-    if (threatenSize == 0) {
+    if (threats == 0) {
         return false; // No opponent piece are threatening the King, not checkmate
     }
 
-    // 2. Look for a square for the King to escape
-    uint8_t kingCol         = checkedKingIndex % 8;
-    uint8_t kingRow         = checkedKingIndex / 8;
-    static int8_t dirCol[8] = {-1, 0, 1, 1, 1, 0, -1, -1};
-    static int8_t dirRow[8] = {1, 1, 1, 0, -1, -1, -1, 0};
+    // 2. Look for a square for the King to escape. The King hides the square behind it on the line of a checking
+    // queen, rook or bishop from the attack map: it is not an escape either.
+    uint8_t kingCol   = p_kingIndex % 8;
+    uint8_t kingRow   = p_kingIndex / 8;
+    uint64_t shadowed = 0;
+    for (uint64_t pieces = threats; 0 != pieces; pieces &= pieces - 1) {
+        const uint8_t square = getFirstSquare(pieces);
+        const EPiece piece   = p_game->board[square];
+        if (isThreateningOrthogonal(piece) || isThreateningDiagonal(piece)) {
+            const uint8_t col = kingCol + ((kingCol > square % 8) ? 1 : 0) - ((kingCol < square % 8) ? 1 : 0);
+            const uint8_t row = kingRow + ((kingRow > square / 8) ? 1 : 0) - ((kingRow < square / 8) ? 1 : 0);
+            if ((col < 8) && (row < 8))
+                shadowed |= (1uLL << (8 * row + col));
+        }
+    }
+
     for (uint8_t i = 0; i < 8; i++) {
-        uint8_t col = kingCol + dirCol[i];
-        uint8_t row = kingRow + dirRow[i];
+        uint8_t col = kingCol + pgm_read_int8(&s_kingDirCol[i]);
+        uint8_t row = kingRow + pgm_read_int8(&s_kingDirRow[i]);
         if (col >= 8 || row >= 8)
             continue; // Out of board
 
         uint8_t escapeSquare = 8 * row + col;
         uint8_t onSquare     = p_game->board[escapeSquare];
-        if ((EPiece::Empty != onSquare) && (checkedPlayer == (onSquare & bits::ColorMask)))
+        if ((EPiece::Empty != onSquare) && (CheckedPlayer == (onSquare & bits::ColorMask)))
             continue; // Checked player piece is occupying the square
 
-        // Temporary remove King from the board
-        p_game->board[checkedKingIndex] = EPiece::Empty;
-
         // Look for pieces threatening/defending the escape square
-        Move moves[1];
-        uint8_t size = findMovesToSquare(p_game, escapeSquare, checkingPlayer, true /* p_returnOnFirst */, true /* p_includeThreats */, moves);
-
-        // Replace the King on the board
-        p_game->board[checkedKingIndex] = static_cast<EPiece>(bits::King | checkedPlayer);
-
-        if (size == 0) {
+        const bool defended = (0 != getAttackCount(p_game, escapeSquare, checkingPlayer)) || (0 != (shadowed & (1uLL << escapeSquare)));
+        if (false == defended) {
             return false; // Found an escape square not threaten by any opponent piece, no checkmate
         }
     }
 
     // 3. If checked by several pieces with no escape square: checkmate
-    if (threatenSize >= 2) {
+    if (hasSeveralSquares(threats)) {
         return true;
     }
 
-    // 4. If checked by a knight, try to capture it
-    if (isKnight(threatenKing[0].piece)) {
-        Move threatenKnight[16];
-        uint8_t size = findMovesToSquare(p_game, threatenKing[0].start, checkedPlayer, false /* p_returnOnFirst */, false /* p_includeThreats */, threatenKnight);
+    // King moves were all tried as escapes
+    const uint8_t threatenSquare = getFirstSquare(threats);
+    const EPiece threatenPiece   = p_game->board[threatenSquare];
+    const uint64_t notKing       = ~(1uLL << p_kingIndex);
 
+    // 4. If checked by a knight, try to capture it
+    if (isKnight(threatenPiece)) {
         // Verify capturing piece is not pinned
-        for (uint8_t i = 0; i < size; i++) {
-            if (false == isPinned(p_game, threatenKnight[i].start, checkedKingIndex, checkingPlayer)) {
-                return false; // Found a piece to capture the checking knight
-            }
+        const uint64_t capturing = moversTo<CheckedPlayer>(p_game, threatenSquare) & notKing & ~p_game->state.pinned;
+        if (0 != capturing) {
+            return false; // Found a piece to capture the checking knight
         }
 
         // 4.1 No escape square, no capture/intercept of the checking knight: checkmate
@@ -546,8 +1019,8 @@ bool isCheckmate(Game* p_game)
     }
 
     // 5. Try to capture or intercept the threatening piece
-    uint8_t threatenCol = threatenKing[0].start % 8;
-    uint8_t threatenRow = threatenKing[0].start / 8;
+    uint8_t threatenCol = threatenSquare % 8;
+    uint8_t threatenRow = threatenSquare / 8;
 
     int diffCol = kingCol - threatenCol;
     int diffRow = kingRow - threatenRow;
@@ -555,15 +1028,10 @@ bool isCheckmate(Game* p_game)
     uint8_t col = threatenCol;
     uint8_t row = threatenRow;
     while (col != kingCol || row != kingRow) {
-        uint8_t index = 8 * row + col;
-        Move intercept[16];
-        uint8_t size = findMovesToSquare(p_game, index, checkedPlayer, false /* p_returnOnFirst */, false /* p_includeThreats */, intercept);
-
         // Verify intercepting/capturing piece is not pinned
-        for (uint8_t i = 0; i < size; i++) {
-            if (false == isPinned(p_game, intercept[i].start, checkedKingIndex, checkingPlayer)) {
-                return false; // Found a piece to capture/intercept the checking piece
-            }
+        const uint64_t intercepting = moversTo<CheckedPlayer>(p_game, 8 * row + col) & notKing & ~p_game->state.pinned;
+        if (0 != intercepting) {
+            return false; // Found a piece to capture/intercept the checking piece
         }
 
         if (diffCol != 0)
@@ -573,23 +1041,22 @@ bool isCheckmate(Game* p_game)
     }
 
     // 6. If checked by a pawn, try to capture with en-passant
-    if (isPawn(threatenKing[0].piece)) {
-        const int8_t dirPRow = (bits::Black == checkingPlayer) ? 1 : -1;
+    if (isPawn(threatenPiece)) {
+        constexpr int8_t dirPRow = (bits::Black == checkingPlayer) ? 1 : -1;
 
-        col = threatenKing[0].start % 8;
-        row = threatenKing[0].start / 8;
+        col = threatenCol;
+        row = threatenRow;
 
         if (p_game->state.en_passant == (8 * (row + dirPRow) + col)) {
-            const int8_t posPCol[2] = {-1, 1};
             for (uint8_t i = 0; i < 2; i++) {
-                uint8_t pawnCol = col + posPCol[i];
+                uint8_t pawnCol = col + pgm_read_int8(&s_lineDirCol[i]);
 
                 if (pawnCol >= 8)
                     continue;
 
                 uint8_t index = 8 * row + pawnCol;
                 EPiece piece  = p_game->board[index];
-                if (isPawn(piece) && (checkedPlayer == (piece & bits::ColorMask)) && !isPinned(p_game, index, checkedKingIndex, checkingPlayer)) {
+                if (isPawn(piece) && (CheckedPlayer == (piece & bits::ColorMask)) && 0 == (p_game->state.pinned & (1uLL << index))) {
                     // En-passant is saving from checkmate!
                     return false;
                 }
@@ -601,6 +1068,40 @@ bool isCheckmate(Game* p_game)
     return true;
 }
 
+//-----------------------------------------------------------------------------
+bool isCheckmate(Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    if (NULL == p_game) {
+        LOG("Unable to analyze checkmate of null game");
+        return false;
+    }
+
+    if (0 == (p_game->state.status & bits::ToPlay)) {
+        LOG("Unable to analyze checkmate when neither white nor black has to play");
+        return false;
+    }
+
+    uint8_t checkedPlayer = (p_game->state.status & bits::ColorMask);
+
+    // 0. Find King
+    uint8_t checkedKingIndex = NULL_INDEX;
+    for (uint8_t i = 0; i < 64; i++) {
+        EPiece piece = p_game->board[i];
+        if ((true == isKing(piece)) && (checkedPlayer == (bits::ColorMask & piece))) {
+            checkedKingIndex = i;
+            break;
+        }
+    }
+
+    if (NULL_INDEX == checkedKingIndex) {
+        LOG("Unable to locate King");
+        return false;
+    }
+
+    return (bits::White == checkedPlayer) ? isKingCheckmated<bits::White>(p_game, checkedKingIndex) : isKingCheckmated<bits::Black>(p_game, checkedKingIndex);
+}
+
 //-----------------------------------------------------------------------------
 uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color, bool p_returnOnFirst, bool p_includeThreats, Move* p_moves)
 //-----------------------------------------------------------------------------
@@ -615,15 +1116,13 @@ uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color,
     uint8_t targetRow = p_targetSquare / 8;
 
     // 1. Moves with Queens, Rooks, Bishops
-    // Prepare directions: col-, col+, row-, row+, diagBL, diagTL, diagBR, diagTR
-    const int8_t dirCol[8] = {-1, 1, 0, 0, -1, -1, 1, 1};
-    const int8_t dirRow[8] = {0, 0, -1, 1, -1, 1, -1, 1};
-
     bool (*matchingFunc[2])(EPiece) = {&isThreateningOrthogonal, &isThreateningDiagonal};
 
     for (uint8_t i = 0; i < 8; i++) {
-        uint8_t col = targetCol + dirCol[i];
-        uint8_t row = targetRow + dirRow[i];
+        const int8_t dirCol = pgm_read_int8(&s_lineDirCol[i]);
+        const int8_t dirRow = pgm_read_int8(&s_lineDirRow[i]);
+        uint8_t col         = targetCol + dirCol;
+        uint8_t row         = targetRow + dirRow;
 
         bool pieceFound = false;
         EPiece piece    = Empty;
@@ -635,8 +1134,8 @@ uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color,
                 break;
             }
 
-            col += dirCol[i];
-            row += dirRow[i];
+            col += dirCol;
+            row += dirRow;
         }
 
         if (true == pieceFound) {
@@ -653,12 +1152,9 @@ uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color,
     }
 
     // 2. Moves with Knights
-    const int8_t posNCol[8] = {1, 2, 2, 1, -1, -2, -2, -1};
-    const int8_t posNRow[8] = {2, 1, -1, -2, -2, -1, 1, 2};
-
     for (uint8_t i = 0; i < 8; i++) {
-        uint8_t col = targetCol + posNCol[i];
-        uint8_t row = targetRow + posNRow[i];
+        uint8_t col = targetCol + pgm_read_int8(&s_knightDirCol[i]);
+        uint8_t row = targetRow + pgm_read_int8(&s_knightDirRow[i]);
 
         if ((col < 8) && (row < 8)) {
             EPiece piece = p_game->board[8 * row + col];
@@ -675,12 +1171,11 @@ uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color,
     }
 
     // 3. Move with Pawns (threaten / capture)
-    const int8_t posPCol[2]  = {-1, 1};
     const int8_t dirPRow     = (bits::Black == p_color) ? 1 : -1;
     const EPiece targetPiece = p_game->board[p_targetSquare];
 
     for (uint8_t i = 0; i < 2; i++) {
-        uint8_t col = targetCol + posPCol[i];
+        uint8_t col = targetCol + pgm_read_int8(&s_lineDirCol[i]);
         uint8_t row = targetRow + dirPRow;
 
         if ((col < 8) && (row < 8)) {
@@ -704,7 +1199,7 @@ uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color,
     // 4. Move with Pawns (en-passant)
     if (p_targetSquare == p_game->state.en_passant) {
         for (uint8_t i = 0; i < 2; i++) {
-            uint8_t col = targetCol + dirCol[i];
+            uint8_t col = targetCol + pgm_read_int8(&s_lineDirCol[i]);
             uint8_t row = targetRow + dirPRow;
 
             if ((col < 8) && (row < 8)) {
@@ -755,8 +1250,8 @@ uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color,
 
     // 6. Moves with King
     for (uint8_t i = 0; i < 8; i++) {
-        uint8_t col = targetCol + dirCol[i];
-        uint8_t row = targetRow + dirRow[i];
+        uint8_t col = targetCol + pgm_read_int8(&s_lineDirCol[i]);
+        uint8_t row = targetRow + pgm_read_int8(&s_lineDirRow[i]);
 
         if (col >= 8 || row >= 8)
             continue; // Out of board
@@ -765,12 +1260,7 @@ uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color,
         if (isKing(piece) && (p_color == (piece & bits::ColorMask))) {
             if (!p_includeThreats) {
                 // Verify if the King can actually move to the target square
-                uint8_t blockSize = 0;
-                Move blockMoves[1];
-                uint8_t otherColor = (bits::White == p_color) ? bits::Black : bits::White;
-                blockSize          = findMovesToSquare(p_game, 8 * row + col, otherColor, true /* p_returnOnFirst */, true /* p_includeThreats */, blockMoves);
-
-                if (blockSize > 0)
+                if (0 != getAttackCount(p_game, p_targetSquare, p_color ^ bits::ColorMask))
                     continue; // King can't actually move to the target square (defended)
             }
 
@@ -787,50 +1277,6 @@ uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color,
     return size;
 }
 
-//-----------------------------------------------------------------------------
-bool isPinned(Game* p_game, uint8_t p_piece, uint8_t p_king, uint8_t p_pinningColor)
-//-----------------------------------------------------------------------------
-{
-    if (NULL == p_game) {
-        LOG("Unable to analyze pinned piece of null game");
-        return false;
-    }
-
-    uint8_t pieceCol = p_piece % 8;
-    uint8_t pieceRow = p_piece / 8;
-    uint8_t kingCol  = p_king % 8;
-    uint8_t kingRow  = p_king / 8;
-
-    int diffCol = kingCol - pieceCol;
-    int diffRow = kingRow - pieceRow;
-
-    bool orthogonal = (diffCol == 0 || diffRow == 0) && (diffCol != diffRow);
-    bool diagonal   = abs(diffCol) == abs(diffRow);
-
-    if (!orthogonal && !diagonal)
-        return false; // Not orthogonally neither diagonally placed
-
-    uint8_t col = pieceCol;
-    uint8_t row = pieceRow;
-    while (col < 8 && row < 8) {
-        EPiece piece = p_game->board[8 * row + col];
-        if (EPiece::Empty != piece && (p_pinningColor == (piece & bits::ColorMask))) {
-            if (orthogonal && 0 != (piece & (bits::LongRangeFlag | bits::OrthogonalFlag))) {
-                return true;
-            } else if (diagonal && 0 != (piece & (bits::LongRangeFlag | bits::DiagonalFlag))) {
-                return true;
-            }
-        }
-
-        if (diffCol != 0)
-            col += (diffCol < 0) ? 1 : -1;
-        if (diffRow != 0)
-            row += (diffRow < 0) ? 1 : -1;
-    }
-
-    return false;
-}
-
 //-----------------------------------------------------------------------------
 uint8_t findEnPassantSquare(Move* p_move)
 //-----------------------------------------------------------------------------
@@ -911,7 +1357,8 @@ void updateCastlingAvailability(Game* p_game)
     }
 
     for (uint8_t i = 0; i < 4; i++) {
-        CastlingUpdate cu = s_castlingUpdates[i];
+        CastlingUpdate cu;
+        memcpy_P(&cu, &s_castlingUpdates[i], sizeof(cu));
         // If any piece moved from or to an initial rook square, castling is not allowed anymore on this side
         if ((lastMove->start == cu.square) || (lastMove->end == cu.square)) {
             if (bits::King == cu.noColorPiece) {
@@ -923,6 +1370,59 @@ void updateCastlingAvailability(Game* p_game)
     }
 }
 
+//-----------------------------------------------------------------------------
+static bool isLegalCommit(Game* p_game, uint8_t p_start, uint8_t p_end, EPiece p_piece)
+//-----------------------------------------------------------------------------
+{
+    // Validated on the board before the move: lifted pieces are put back meanwhile
+    const uint32_t start_us = beginStage();
+    Removed* removed[2]     = {&p_game->state.removed_1, &p_game->state.removed_2};
+    for (uint8_t i = 0; i < 2; i++) {
+        if (NULL_INDEX != removed[i]->index)
+            p_game->board[removed[i]->index] = removed[i]->piece;
+    }
+
+    const bool legal = isLegalMove(p_game, BUILD_MOVE(p_start, p_end, p_piece));
+
+    for (uint8_t i = 0; i < 2; i++) {
+        if (NULL_INDEX != removed[i]->index)
+            p_game->board[removed[i]->index] = Empty;
+    }
+    endStage(StageValidateMove, start_us);
+    return legal;
+}
+
+//-----------------------------------------------------------------------------
+static bool arePiecesRestored(Game* p_game, uint64_t p_sensors)
+//-----------------------------------------------------------------------------
+{
+    // Board before the illegal move: lifted pieces back on their squares and nothing where the move ended
+    uint64_t expected = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+        if (Empty != p_game->board[i])
+            expected |= (1uLL << i);
+    }
+    if (NULL_INDEX != p_game->state.removed_1.index)
+        expected |= (1uLL << p_game->state.removed_1.index);
+    if (NULL_INDEX != p_game->state.removed_2.index)
+        expected |= (1uLL << p_game->state.removed_2.index);
+    return expected == p_sensors;
+}
+
+//-----------------------------------------------------------------------------
+static void restorePieces(Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    if (NULL_INDEX != p_game->state.removed_1.index)
+        p_game->board[p_game->state.removed_1.index] = p_game->state.removed_1.piece;
+    if (NULL_INDEX != p_game->state.removed_2.index)
+        p_game->board[p_game->state.removed_2.index] = p_game->state.removed_2.piece;
+    p_game->state.removed_1.index = NULL_INDEX;
+    p_game->state.removed_1.piece = Empty;
+    p_game->state.removed_2.index = NULL_INDEX;
+    p_game->state.removed_2.piece = Empty;
+}
+
 //-----------------------------------------------------------------------------
 bool evolveGame(Game* p_game, uint64_t p_sensors)
 //-----------------------------------------------------------------------------
@@ -972,6 +1472,16 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
         isOtherPlayerColor = &isWhite;
     }
 
+    // Illegal move: nothing else is followed until its pieces are back where they were
+    if (0 != (currentMove & bits::Illegal)) {
+        if (arePiecesRestored(p_game, p_sensors)) {
+            LOG("-> Pieces restored after illegal move");
+            restorePieces(p_game);
+            p_game->state.status &= ~bits::Illegal;
+        }
+        return false;
+    }
+
     // Decision flow
     switch (currentMove) {
     // ========================= GAME FINISHED
@@ -1017,10 +1527,16 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
             } else {
                 // The piece moved to a different location
                 LOG_INDEX("-> Piece is placed", indexPlaced);
+                if (!isLegalCommit(p_game, p_game->state.removed_1.index, indexPlaced, p_game->state.removed_1.piece)) {
+                    LOG("-> Illegal move, restore pieces");
+                    p_game->state.status = player | bits::ToPlay | bits::Illegal;
+                    return false;
+                }
 
                 uint8_t diff = abs(p_game->state.removed_1.index - indexPlaced);
                 if ((true == isKing(p_game->state.removed_1.piece)) && (2 == diff)) {
                     // King replaced two cells away on the same row: player is castling (1/3)
+                    movePieceEvaluation(&p_game->evaluation, p_game->state.removed_1.piece, p_game->state.removed_1.index, indexPlaced);
                     *lastMovePtr                  = BUILD_MOVE(p_game->state.removed_1.index, indexPlaced, p_game->state.removed_1.piece);
                     p_game->board[indexPlaced]    = p_game->state.removed_1.piece;
                     p_game->state.removed_1.index = NULL_INDEX;
@@ -1028,6 +1544,7 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
                     p_game->state.status          = player | bits::Castling;
                 } else {
                     // Player has played
+                    movePieceEvaluation(&p_game->evaluation, p_game->state.removed_1.piece, p_game->state.removed_1.index, indexPlaced);
                     p_game->board[indexPlaced]    = p_game->state.removed_1.piece;
                     *lastMovePtr                  = BUILD_MOVE(p_game->state.removed_1.index, indexPlaced, p_game->state.removed_1.piece);
                     p_game->state.removed_1.index = NULL_INDEX;
@@ -1053,8 +1570,12 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
                     if (true == isPromotion(lastMovePtr)) {
                         lastMovePtr->promotion     = true;
                         p_game->board[indexPlaced] = static_cast<EPiece>(player | bits::Queen);
+                        removePieceEvaluation(&p_game->evaluation, lastMovePtr->piece, indexPlaced);
+                        addPieceEvaluation(&p_game->evaluation, p_game->board[indexPlaced], indexPlaced);
                     }
 
+                    commitAttackMaps(p_game, lastMovePtr, NULL_INDEX, Empty);
+                    updateCheckersAndPins(p_game);
                     updateCheckState(p_game, lastMovePtr);
                     p_game->fullmoveClock += (player == bits::Black ? 1 : 0);
 
@@ -1088,18 +1609,28 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
             } else {
                 // The piece has been placed where one was removed, player has played
                 LOG_INDEX("-> Player captured", indexPlaced);
+                const Removed* capturing = isPlayerColor(p_game->state.removed_1.piece) ? &p_game->state.removed_1 : &p_game->state.removed_2;
+                if (!isLegalCommit(p_game, capturing->index, indexPlaced, capturing->piece)) {
+                    LOG("-> Illegal capture, restore pieces");
+                    p_game->state.status = player | bits::ToPlay | bits::Illegal;
+                    return false;
+                }
 
                 // Check which piece has been removed first (capturing piece or captured piece)
                 if (true == isPlayerColor(p_game->state.removed_1.piece)) {
                     // The capturing piece was removed first
                     *lastMovePtr               = BUILD_MOVE(p_game->state.removed_1.index, indexPlaced, p_game->state.removed_1.piece);
                     p_game->board[indexPlaced] = p_game->state.removed_1.piece;
+                    removePieceEvaluation(&p_game->evaluation, p_game->state.removed_2.piece, p_game->state.removed_2.index);
                 } else if (true == isOtherPlayerColor(p_game->state.removed_1.piece)) {
                     // The captured piece was removed first
                     p_game->board[indexPlaced] = p_game->state.removed_2.piece;
                     *lastMovePtr               = BUILD_MOVE(p_game->state.removed_2.index, indexPlaced, p_game->state.removed_2.piece);
+                    removePieceEvaluation(&p_game->evaluation, p_game->state.removed_1.piece, p_game->state.removed_1.index);
                 }
                 lastMovePtr->captured = true;
+                movePieceEvaluation(&p_game->evaluation, lastMovePtr->piece, lastMovePtr->start, indexPlaced);
+                const EPiece captured = (lastMovePtr->start == p_game->state.removed_1.index) ? p_game->state.removed_2.piece : p_game->state.removed_1.piece;
 
                 p_game->state.removed_1.index = NULL_INDEX;
                 p_game->state.removed_1.piece = Empty;
@@ -1112,8 +1643,12 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
                 if (true == isPromotion(lastMovePtr)) {
                     lastMovePtr->promotion     = true;
                     p_game->board[indexPlaced] = static_cast<EPiece>(player | bits::Queen);
+                    removePieceEvaluation(&p_game->evaluation, lastMovePtr->piece, indexPlaced);
+                    addPieceEvaluation(&p_game->evaluation, p_game->board[indexPlaced], indexPlaced);
                 }
 
+                commitAttackMaps(p_game, lastMovePtr, indexPlaced, captured);
+                updateCheckersAndPins(p_game);
                 updateCheckState(p_game, lastMovePtr);
                 p_game->fullmoveClock += (player == bits::Black ? 1 : 0);
                 p_game->halfmoveClock = 0;
@@ -1133,12 +1668,16 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
         if (NULL_INDEX != indexPlaced) {
             LOG_INDEX("-> Additional piece placed during en passant!", indexPlaced);
         } else if (indexRemoved == p_game->state.en_passant) {
+            const EPiece captured = p_game->board[indexRemoved];
+            removePieceEvaluation(&p_game->evaluation, captured, indexRemoved);
             p_game->board[indexRemoved] = Empty;
             lastMovePtr->captured       = true;
             p_game->state.en_passant    = NULL_INDEX;
             p_game->state.status        = otherPlayer | bits::ToPlay;
             p_game->fullmoveClock += (player == bits::Black ? 1 : 0);
             p_game->halfmoveClock = 0;
+            commitAttackMaps(p_game, lastMovePtr, indexRemoved, captured);
+            updateCheckersAndPins(p_game);
             updateCheckState(p_game, lastMovePtr);
             // updateCastlingAvailability(p_game); // -> en-passant can't change castling availability
             return true;
@@ -1163,11 +1702,25 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
         }
 
         if (NULL_INDEX != indexPlaced) {
+            // Rook expected from its corner to the square the king passed over
+            const bool kingSide     = lastMovePtr->end > lastMovePtr->start;
+            const uint8_t rookStart = kingSide ? lastMovePtr->start + 3 : lastMovePtr->start - 4;
+            const uint8_t rookEnd   = kingSide ? lastMovePtr->end - 1 : lastMovePtr->end + 1;
+            const bool rookCastling = (rookStart == p_game->state.removed_1.index) && ((player | bits::Rook) == p_game->state.removed_1.piece) &&
+                                      (rookEnd == indexPlaced);
+
             if (NULL_INDEX == p_game->state.removed_1.index) {
                 LOG_INDEX("-> Additional piece is placed during castling!", indexPlaced);
+            } else if (indexPlaced == p_game->state.removed_1.index) {
+                LOG("-> Piece put back during castling");
+                restorePieces(p_game);
+            } else if (!rookCastling) {
+                LOG("-> Illegal castling, restore pieces");
+                p_game->state.status = player | bits::Castling | bits::Illegal;
             } else {
                 // Player is castling (3/3)
                 LOG_INDEX("-> Piece is placed", indexPlaced);
+                movePieceEvaluation(&p_game->evaluation, p_game->state.removed_1.piece, p_game->state.removed_1.index, indexPlaced);
                 p_game->board[indexPlaced]    = p_game->state.removed_1.piece;
                 p_game->state.removed_1.index = NULL_INDEX;
                 p_game->state.removed_1.piece = Empty;
@@ -1175,6 +1728,8 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
                 p_game->state.status          = otherPlayer | bits::ToPlay;
                 p_game->fullmoveClock += (player == bits::Black ? 1 : 0);
                 p_game->halfmoveClock++;
+                commitAttackMaps(p_game, lastMovePtr, NULL_INDEX, Empty);
+                updateCheckersAndPins(p_game);
                 updateCheckState(p_game, lastMovePtr);
                 updateCastlingAvailability(p_game);
                 return true;
@@ -1202,10 +1757,13 @@ bool evolveGame(Game* p_game, uint64_t p_sensors)
 const char* getMoveStr(Move p_move)
 //-----------------------------------------------------------------------------
 {
-    if (p_move.piece == EPiece::Empty)
-        return "-";
     static char msg[7];
     uint8_t i = 0;
+    if (p_move.piece == EPiece::Empty) {
+        msg[i++] = '-';
+        msg[i]   = 0;
+        return msg;
+    }
 
     switch (p_move.piece & bits::TypeMask) {
     case bits::King:
@@ -1237,13 +1795,12 @@ const char* getMoveStr(Move p_move)
     msg[i++] = '1' + (p_move.end / 8);
 
     // Override message with castling
-    static const char CastlingMsg[5] = {'O', '-', 'O', '-', 'O'};
     if (isKing(p_move.piece)) {
         if (p_move.start + 2 == p_move.end) {
-            memcpy(msg, CastlingMsg, i = 3);
+            memcpy_P(msg, s_castlingMsg, i = 3);
         }
         if (p_move.start == 2 + p_move.end) {
-            memcpy(msg, CastlingMsg, i = 5);
+            memcpy_P(msg, s_castlingMsg, i = 5);
         }
     }
 
@@ -1269,6 +1826,80 @@ void updateCheckState(Game* p_game, Move* p_move)
         return;
     }
 
-    p_move->check     = isCheck(p_game);
-    p_move->checkmate = p_move->check ? isCheckmate(p_game) : false;
-}
\ No newline at end of file
+    const uint32_t start_us = beginStage();
+    p_move->check           = isCheck(p_game);
+    p_move->checkmate       = p_move->check ? isCheckmate(p_game) : false;
+    endStage(StageUpdateCheck, start_us);
+}
+
+//-----------------------------------------------------------------------------
+void playMove(Game* p_game, Move p_move)
+//-----------------------------------------------------------------------------
+{
+    if (NULL == p_game) {
+        LOG("Unable to play move on null game");
+        return;
+    }
+
+    const uint8_t player       = (p_game->state.status & bits::ColorMask);
+    const uint8_t otherPlayer  = bits::White == player ? bits::Black : bits::White;
+    Move* lastMovePtr          = (bits::White == player) ? &(p_game->lastMoveW) : &(p_game->lastMoveB);
+    const uint8_t diff         = abs(p_move.start - p_move.end);
+    const bool enPassant       = isPawn(p_move.piece) && (p_move.start % 8) != (p_move.end % 8) && (Empty == p_game->board[p_move.end]);
+    const bool captured        = enPassant || (Empty != p_game->board[p_move.end]);
+    const uint8_t capturedAt   = enPassant ? (p_move.start / 8) * 8 + (p_move.end % 8) : (captured ? p_move.end : NULL_INDEX);
+    const EPiece capturedPiece = captured ? p_game->board[capturedAt] : Empty;
+
+    if (!enPassant)
+        removePieceEvaluation(&p_game->evaluation, p_game->board[p_move.end], p_move.end);
+    movePieceEvaluation(&p_game->evaluation, p_move.piece, p_move.start, p_move.end);
+
+    *lastMovePtr                  = BUILD_MOVE(p_move.start, p_move.end, p_move.piece);
+    lastMovePtr->captured         = captured;
+    p_game->board[p_move.end]     = p_move.piece;
+    p_game->board[p_move.start]   = Empty;
+    p_game->state.status          = otherPlayer | bits::ToPlay;
+    p_game->state.en_passant      = NULL_INDEX;
+    p_game->state.removed_1.index = NULL_INDEX;
+    p_game->state.removed_1.piece = Empty;
+    p_game->state.removed_2.index = NULL_INDEX;
+    p_game->state.removed_2.piece = Empty;
+    p_game->fullmoveClock += (player == bits::Black ? 1 : 0);
+
+    if (enPassant) {
+        removePieceEvaluation(&p_game->evaluation, capturedPiece, capturedAt);
+        p_game->board[capturedAt] = Empty;
+        p_game->halfmoveClock     = 0;
+        commitAttackMaps(p_game, lastMovePtr, capturedAt, capturedPiece);
+        updateCheckersAndPins(p_game);
+        return; // En passant can't change castling availability
+    }
+
+    if (isKing(p_move.piece) && 2 == diff) {
+        // Castling: the rook jumps over the king
+        const bool kingSide   = p_move.end > p_move.start;
+        const uint8_t rook    = kingSide ? p_move.start + 3 : p_move.start - 4;
+        const uint8_t rookEnd = kingSide ? rook - 2 : rook + 3;
+        movePieceEvaluation(&p_game->evaluation, p_game->board[rook], rook, rookEnd);
+        p_game->board[rookEnd] = p_game->board[rook];
+        p_game->board[rook]    = Empty;
+        p_game->halfmoveClock++;
+    } else {
+        if (!captured)
+            p_game->state.en_passant = findEnPassantSquare(lastMovePtr);
+        if (true == isPromotion(lastMovePtr)) {
+            lastMovePtr->promotion    = true;
+            p_game->board[p_move.end] = static_cast<EPiece>(player | bits::Queen);
+            removePieceEvaluation(&p_game->evaluation, p_move.piece, p_move.end);
+            addPieceEvaluation(&p_game->evaluation, p_game->board[p_move.end], p_move.end);
+        }
+        if (captured || isPawn(p_move.piece))
+            p_game->halfmoveClock = 0;
+        else
+            p_game->halfmoveClock++;
+    }
+
+    commitAttackMaps(p_game, lastMovePtr, capturedAt, capturedPiece);
+    updateCheckersAndPins(p_game);
+    updateCastlingAvailability(p_game);
+}
@@ -22,7 +22,7 @@ constexpr uint8_t Queen  = LongRangeFlag | DiagonalFlag | OrthogonalFlag;
 
 constexpr uint8_t White = 0, Black = ColorMask;
 
-constexpr uint8_t MoveMask  = 0b01111110;
+constexpr uint8_t MoveMask  = 0b11111110;
 constexpr uint8_t ToPlay    = 0b00000010;
 constexpr uint8_t Playing   = 0b00000100;
 constexpr uint8_t Capturing = 0b00001000;
@@ -30,6 +30,7 @@ constexpr uint8_t EnPassant = 0b00001010;
 constexpr uint8_t Castling  = 0b00010000;
 constexpr uint8_t Finished  = 0b00100000;
 constexpr uint8_t Draw      = 0b01000000;
+constexpr uint8_t Illegal   = 0b10000000; // Added to the status to return to once the pieces are restored
 } // namespace bits
 
 typedef enum {
@@ -100,6 +101,8 @@ typedef struct {
     uint8_t status;
     bool castlingK[2];
     bool castlingQ[2];
+    uint64_t checkers; // Pieces giving check to the player to play in the committed position (squares as the sensors)
+    uint64_t pinned;   // Pieces of the player to play pinned to their king in the committed position
 } State;
 
 typedef struct {
@@ -113,6 +116,13 @@ typedef struct {
 } Move;
 #define BUILD_MOVE(p_start, p_end, p_piece) {p_start, p_end, p_piece, false, false, false, false}
 
+// Material and piece-square scores of the committed position, white point of view (see eval.h)
+typedef struct {
+    int16_t middlegame;
+    int16_t endgame;
+    uint8_t phase;
+} Evaluation;
+
 typedef struct {
     EPiece board[64]; // a1, b1, c1..., a2, b2, c2...
     State state;
@@ -120,10 +130,12 @@ typedef struct {
     Move lastMoveB;
     uint8_t fullmoveClock;
     uint8_t halfmoveClock;
+    Evaluation evaluation; // Updated on each committed move
+    uint8_t attacks[64];   // Pieces attacking each square in the committed position: white in the low nibble, black in the high one
 } Game;
 
 void initializeGame(Game* p_game, uint64_t p_mask /* = 0xffff00000000ffffuLL */);
-void initializeFromFEN(Game* p_game, const char* p_fen);
+bool initializeFromFEN(Game* p_game, const char* p_fen); // false if the FEN is malformed
 int writeToFEN(Game* p_game, char* p_buffer);
 bool isWhite(EPiece p_piece);
 bool isBlack(EPiece p_piece);
@@ -137,8 +149,43 @@ void printGame(Game* p_game);
 bool isCheck(Game* p_game);
 bool isCheckmate(Game* p_game);
 uint8_t findMovesToSquare(Game* p_game, uint8_t p_targetSquare, uint8_t p_color, bool p_returnOnFirst, bool p_includeThreats, Move* p_moves);
-bool isPinned(Game* p_game, uint8_t p_piece, uint8_t p_king, uint8_t p_pinningColor);
+
+// Square queries specialized on the color of the pieces (bits::White or bits::Black), squares as the sensors (bit 0 = a1)
+// Whether a piece of Color attacks p_targetSquare, stopping at the first attacker
+template <uint8_t Color>
+bool isAttacked(const Game* p_game, uint8_t p_targetSquare);
+
+// Squares of the pieces of Color attacking p_targetSquare, whatever is on it
+template <uint8_t Color>
+uint64_t attackersTo(const Game* p_game, uint8_t p_targetSquare);
+
+// Squares of the pieces of Color that can move to p_targetSquare, pins aside. The king only moves to undefended squares.
+template <uint8_t Color>
+uint64_t moversTo(const Game* p_game, uint8_t p_targetSquare);
+
+// Attack maps (Game::attacks) of the committed position, updated by evolveGame and playMove on each committed move:
+// only the lines through the squares the move changed are scanned again. Built with CHESS_CHECK_ATTACK_MAPS, the maps
+// are compared with a computation from scratch after each update.
+inline uint8_t getAttackCount(const Game* p_game, uint8_t p_square, uint8_t p_color) {
+    return (bits::White == p_color) ? (p_game->attacks[p_square] & 0x0F) : (p_game->attacks[p_square] >> 4);
+}
+void initializeAttackMaps(Game* p_game);
+bool checkAttackMaps(const Game* p_game); // false if the maps differ from the board
+
+// Checkers and pinned pieces of State, computed once per committed position from its attack maps: lifting pieces
+// during a move leaves them as they are until the next commit. Check, mate and move legality queries read them.
+void updateCheckersAndPins(Game* p_game);
+
 void updateCheckState(Game* p_game, Move* p_move);
 
 // The sensors status are stored in a 64-bits variable: b63 = h8, b62 = g8..., b55 = h7, b54 = g7..., b1 = b1, b0 = a1
+// Stack: no recursion nor move arrays down the call tree, 320 bytes at most on x86-64 at -O2 (deepest path
+// evolveGame > isLegalCommit > isLegalMove > leavesKingSafe > isSquareAttacked, see tools/stackdepth). The game task
+// of the firmware starts at evolveJournaledGame (journal.h), 528 bytes at most: evolveJournaledGame >
+// evolveGameWithSignatures > playMove > commitAttackMaps > addPieceAttacks > addRayAttacks. Serial command 'M' gives
+// the stack peak measured on the board.
 bool evolveGame(Game* p_game, uint64_t p_sensors);
+
+// Play a legal move directly, leaving the game as evolveGame does after the sensor sequence of the move
+// (check flags of the move are not computed)
+void playMove(Game* p_game, Move p_move);
@@ -0,0 +1,162 @@
+#include "eval.h"
+
+#include <flash.h>
+
+// Indexed by piece type >> 1: -, -, pawn, king, knight, rook, bishop, queen
+static const int16_t s_middlegameValues[8] PROGMEM = {0, 0, 82, 0, 337, 477, 365, 1025};
+static const int16_t s_endgameValues[8] PROGMEM    = {0, 0, 94, 0, 281, 512, 297, 936};
+static const uint8_t s_phases[8] PROGMEM           = {0, 0, 0, 0, 1, 2, 1, 4};
+
+// Square tables from white point of view, a8 first (as the board is drawn). Pieces other than
+// pawns and kings use the same table for both phases, which keeps the tables at 512 bytes of flash.
+// Values are clipped to 8 bits.
+constexpr uint8_t ENDGAME_PAWN_TABLE = 6;
+constexpr uint8_t ENDGAME_KING_TABLE = 7;
+
+static const int8_t s_squareTables[8][64] PROGMEM = {
+    // Pawn
+    {0,   0,   0,   0,   0,   0,   0,   0,   //
+     98,  120, 60,  95,  68,  126, 34,  -11, //
+     -6,  7,   26,  31,  65,  56,  25,  -20, //
+     -14, 13,  6,   21,  23,  12,  17,  -23, //
+     -27, -2,  -5,  12,  17,  6,   10,  -25, //
+     -26, -4,  -4,  -10, 3,   3,   33,  -12, //
+     -35, -1,  -20, -23, -15, 24,  38,  -22, //
+     0,   0,   0,   0,   0,   0,   0,   0},  //
+    // King
+    {-65, 23,  16,  -15, -56, -34, 2,   13,  //
+     29,  -1,  -20, -7,  -8,  -4,  -38, -29, //
+     -9,  24,  2,   -16, -20, 6,   22,  -22, //
+     -17, -20, -12, -27, -30, -25, -14, -36, //
+     -49, -1,  -27, -39, -46, -44, -33, -51, //
+     -14, -14, -22, -46, -44, -30, -15, -27, //
+     1,   7,   -8,  -64, -43, -16, 9,   8,   //
+     -15, 36,  12,  -54, 8,   -28, 24,  14},  //
+    // Knight
+    {-127, -89, -34, -49, 61,  -97, -15, -107, //
+     -73,  -41, 72,  36,  23,  62,  7,   -17,  //
+     -47,  60,  37,  65,  84,  127, 73,  44,   //
+     -9,   17,  19,  53,  37,  69,  18,  22,   //
+     -13,  4,   16,  13,  28,  19,  21,  -8,   //
+     -23,  -9,  12,  10,  19,  17,  25,  -16,  //
+     -29,  -53, -12, -3,  -1,  18,  -14, -19,  //
+     -105, -21, -58, -33, -17, -28, -19, -23}, //
+    // Rook
+    {32,  42,  32,  51,  63,  9,   31,  43,  //
+     27,  32,  58,  62,  80,  67,  26,  44,  //
+     -5,  19,  26,  36,  17,  45,  61,  16,  //
+     -24, -11, 7,   26,  24,  35,  -8,  -20, //
+     -36, -26, -12, -1,  9,   -7,  6,   -23, //
+     -45, -25, -16, -17, 3,   0,   -5,  -33, //
+     -44, -16, -20, -9,  -1,  11,  -6,  -71, //
+     -19, -13, 1,   17,  16,  7,   -37, -26}, //
+    // Bishop
+    {-29, 4,   -82, -37, -25, -42, 7,   -8,  //
+     -26, 16,  -18, -13, 30,  59,  18,  -47, //
+     -16, 37,  43,  40,  35,  50,  37,  -2,  //
+     -4,  5,   19,  50,  37,  37,  7,   -2,  //
+     -6,  13,  13,  26,  34,  12,  10,  4,   //
+     0,   15,  15,  15,  14,  27,  18,  10,  //
+     4,   15,  16,  0,   7,   21,  33,  1,   //
+     -33, -3,  -14, -21, -13, -12, -39, -21}, //
+    // Queen
+    {-28, 0,   29,  12,  59,  44,  43,  45,  //
+     -24, -39, -5,  1,   -16, 57,  28,  54,  //
+     -13, -17, 7,   8,   29,  56,  47,  57,  //
+     -27, -27, -16, -16, -1,  17,  -2,  1,   //
+     -9,  -26, -9,  -10, -2,  -4,  3,   -3,  //
+     -14, 2,   -11, -2,  -5,  2,   14,  5,   //
+     -35, -8,  11,  2,   8,   15,  -3,  1,   //
+     -1,  -18, -9,  10,  -15, -25, -31, -50}, //
+    // Pawn, endgame
+    {0,   0,   0,   0,   0,   0,   0,   0,   //
+     127, 127, 127, 127, 127, 127, 127, 127, //
+     94,  100, 85,  67,  56,  53,  82,  84,  //
+     32,  24,  13,  5,   -2,  4,   17,  17,  //
+     13,  9,   -3,  -7,  -7,  -8,  3,   -1,  //
+     4,   7,   -6,  1,   0,   -5,  -1,  -8,  //
+     13,  8,   8,   10,  13,  0,   2,   -7,  //
+     0,   0,   0,   0,   0,   0,   0,   0},  //
+    // King, endgame
+    {-74, -35, -18, -18, -11, 15,  4,   -17, //
+     -12, 17,  14,  17,  17,  38,  23,  11,  //
+     10,  17,  23,  15,  20,  45,  44,  13,  //
+     -8,  22,  24,  27,  26,  33,  26,  3,   //
+     -18, -4,  21,  24,  27,  23,  9,   -11, //
+     -19, -3,  11,  21,  23,  16,  7,   -9,  //
+     -27, -11, 4,   13,  14,  4,   -5,  -17, //
+     -53, -34, -21, -11, -28, -14, -24, -43}, //
+};
+
+//-----------------------------------------------------------------------------
+static void updateEvaluation(Evaluation* p_evaluation, EPiece p_piece, uint8_t p_square, int8_t p_sign)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t type   = (p_piece & bits::TypeMask) >> 1;
+    const bool white     = isWhite(p_piece);
+    const uint8_t square = white ? (p_square ^ 56) : p_square;
+
+    // Table index of the type in the middlegame: pawn, king, knight, rook, bishop, queen
+    const uint8_t table        = type - 2;
+    const uint8_t endgameTable = isPawn(p_piece) ? ENDGAME_PAWN_TABLE : (isKing(p_piece) ? ENDGAME_KING_TABLE : table);
+    const int16_t middlegame   = (int16_t)pgm_read_word(&s_middlegameValues[type]) + (int8_t)pgm_read_byte(&s_squareTables[table][square]);
+    const int16_t endgame      = (int16_t)pgm_read_word(&s_endgameValues[type]) + (int8_t)pgm_read_byte(&s_squareTables[endgameTable][square]);
+    const int8_t sign          = white ? p_sign : -p_sign;
+    p_evaluation->middlegame += sign * middlegame;
+    p_evaluation->endgame += sign * endgame;
+    p_evaluation->phase += p_sign * (int8_t)pgm_read_byte(&s_phases[type]);
+}
+
+//-----------------------------------------------------------------------------
+void initializeEvaluation(Evaluation* p_evaluation, const EPiece* p_board)
+//-----------------------------------------------------------------------------
+{
+    p_evaluation->middlegame = 0;
+    p_evaluation->endgame    = 0;
+    p_evaluation->phase      = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+        if (Empty != p_board[i])
+            updateEvaluation(p_evaluation, p_board[i], i, 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void addPieceEvaluation(Evaluation* p_evaluation, EPiece p_piece, uint8_t p_square)
+//-----------------------------------------------------------------------------
+{
+    if (Empty != p_piece)
+        updateEvaluation(p_evaluation, p_piece, p_square, 1);
+}
+
+//-----------------------------------------------------------------------------
+void removePieceEvaluation(Evaluation* p_evaluation, EPiece p_piece, uint8_t p_square)
+//-----------------------------------------------------------------------------
+{
+    if (Empty != p_piece)
+        updateEvaluation(p_evaluation, p_piece, p_square, -1);
+}
+
+//-----------------------------------------------------------------------------
+void movePieceEvaluation(Evaluation* p_evaluation, EPiece p_piece, uint8_t p_start, uint8_t p_end)
+//-----------------------------------------------------------------------------
+{
+    removePieceEvaluation(p_evaluation, p_piece, p_start);
+    addPieceEvaluation(p_evaluation, p_piece, p_end);
+}
+
+//-----------------------------------------------------------------------------
+int16_t getEvaluation(const Evaluation* p_evaluation)
+//-----------------------------------------------------------------------------
+{
+    // Promotions can raise the phase above its initial value
+    const int32_t phase = (p_evaluation->phase > EVAL_MAX_PHASE) ? EVAL_MAX_PHASE : p_evaluation->phase;
+    return (int16_t)(((int32_t)p_evaluation->middlegame * phase + (int32_t)p_evaluation->endgame * (EVAL_MAX_PHASE - phase)) / EVAL_MAX_PHASE);
+}
+
+//-----------------------------------------------------------------------------
+int16_t getPlayerEvaluation(const Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    const int16_t evaluation = getEvaluation(&p_game->evaluation);
+    return (bits::White == (p_game->state.status & bits::ColorMask)) ? evaluation : -evaluation;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "chess.h"
+#include <stdint.h>
+
+// Tapered evaluation: material and piece-square scores for the middlegame and the endgame,
+// blended by the phase (remaining knights and bishops count 1, rooks 2, queens 4).
+// The accumulator of a game is updated by evolveGame and playMove on each committed move.
+constexpr uint8_t EVAL_MAX_PHASE = 24;
+
+// Compute the accumulator of a board from scratch
+void initializeEvaluation(Evaluation* p_evaluation, const EPiece* p_board);
+
+// Incremental updates
+void addPieceEvaluation(Evaluation* p_evaluation, EPiece p_piece, uint8_t p_square);
+void removePieceEvaluation(Evaluation* p_evaluation, EPiece p_piece, uint8_t p_square);
+void movePieceEvaluation(Evaluation* p_evaluation, EPiece p_piece, uint8_t p_start, uint8_t p_end);
+
+// Centipawns from white point of view
+int16_t getEvaluation(const Evaluation* p_evaluation);
+
+// Centipawns from the point of view of the player to play
+int16_t getPlayerEvaluation(const Game* p_game);
@@ -0,0 +1,156 @@
+#include "gamelog.h"
+
+//-----------------------------------------------------------------------------
+static void playLoggedEvent(Game* p_game, uint64_t* p_sensors, const GameEvent* p_event)
+//-----------------------------------------------------------------------------
+{
+    if (0 == (p_event->square & GAMELOG_STEP)) {
+        const uint64_t mask = 1uLL << (p_event->square & GAMELOG_SQUARE_MASK);
+        *p_sensors          = (p_event->square & GAMELOG_PLACED) ? (*p_sensors | mask) : (*p_sensors & ~mask);
+    }
+    if (GAMELOG_JOINED == p_event->moveStart)
+        return; // The call is played with its last event
+
+    // Castling and en passant end with an evolveGame step
+    const uint8_t fromMove = p_event->fromStatus & bits::MoveMask;
+    if (GAMELOG_NO_MOVE == p_event->moveStart || bits::Castling == fromMove || bits::EnPassant == fromMove) {
+        evolveGame(p_game, *p_sensors);
+        return;
+    }
+
+    // Other moves are played at once from the board before them, as signature commits do: evolveGame
+    // leaves the same game after the last step of the move
+    Removed* removed[2] = {&p_game->state.removed_1, &p_game->state.removed_2};
+    for (uint8_t i = 0; i < 2; i++) {
+        if (removed[i]->index < 64)
+            p_game->board[removed[i]->index] = removed[i]->piece;
+    }
+    const uint8_t color = p_game->state.status & bits::ColorMask;
+    playMove(p_game, BUILD_MOVE(p_event->moveStart, p_event->moveEnd, p_game->board[p_event->moveStart]));
+    updateCheckState(p_game, (bits::White == color) ? &p_game->lastMoveW : &p_game->lastMoveB);
+}
+
+//-----------------------------------------------------------------------------
+static void dropOldestCall(GameLog* p_log)
+//-----------------------------------------------------------------------------
+{
+    // The events of the call are played on the snapshot
+    bool joined = true;
+    while (joined && p_log->count > 0) {
+        const GameEvent* event = &p_log->events[p_log->first];
+        joined                 = (GAMELOG_JOINED == event->moveStart);
+        playLoggedEvent(&p_log->snapshot, &p_log->snapshotSensors, event);
+        p_log->first = (p_log->first + 1) % p_log->capacity;
+        p_log->count--;
+        p_log->start++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void startGameLog(GameLog* p_log, GameEvent* p_events, uint16_t p_capacity, const Game* p_game, uint64_t p_sensors)
+//-----------------------------------------------------------------------------
+{
+    p_log->events          = p_events;
+    p_log->capacity        = p_capacity;
+    p_log->first           = 0;
+    p_log->count           = 0;
+    p_log->start           = 0;
+    p_log->snapshot        = *p_game;
+    p_log->snapshotSensors = p_sensors;
+    p_log->sensors         = p_sensors;
+}
+
+//-----------------------------------------------------------------------------
+bool evolveLoggedGame(GameLog* p_log, SignatureTable* p_table, Game* p_game, uint64_t p_sensors, uint32_t p_tick)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_log || nullptr == p_game)
+        return evolveGameWithSignatures(p_table, p_game, p_sensors);
+
+    const uint8_t fromStatus = p_game->state.status;
+    const uint8_t removed_1  = p_game->state.removed_1.index;
+    const uint8_t removed_2  = p_game->state.removed_2.index;
+    const bool evolved       = evolveGameWithSignatures(p_table, p_game, p_sensors);
+    const uint8_t toStatus   = p_game->state.status;
+
+    // Calls leaving the sensors and the game as they were are not logged
+    const uint64_t changed = p_sensors ^ p_log->sensors;
+    if (0 == changed && fromStatus == toStatus && removed_1 == p_game->state.removed_1.index && removed_2 == p_game->state.removed_2.index)
+        return evolved;
+
+    uint8_t squares = 0;
+    for (uint64_t remaining = changed; 0 != remaining; remaining &= remaining - 1)
+        squares++;
+    const uint8_t eventCount = (0 == squares) ? 1 : squares;
+    p_log->sensors           = p_sensors;
+
+    if (eventCount > p_log->capacity) {
+        // Too many changes at once (e.g. the board was set up again): the log starts after the call
+        const uint32_t start = p_log->start + p_log->count + eventCount;
+        startGameLog(p_log, p_log->events, p_log->capacity, p_game, p_sensors);
+        p_log->start = start;
+        return evolved;
+    }
+    while (p_log->count + eventCount > p_log->capacity)
+        dropOldestCall(p_log);
+
+    GameEvent event = {p_tick, GAMELOG_STEP, fromStatus, toStatus, GAMELOG_JOINED, GAMELOG_NO_MOVE};
+    uint8_t square  = 0;
+    for (uint8_t i = 0; i < eventCount; i++) {
+        if (0 != squares) {
+            while (0 == ((changed >> square) & 1))
+                square++;
+            event.square = square | (((p_sensors >> square) & 1) ? GAMELOG_PLACED : 0);
+            square++;
+        }
+        if (i + 1 == eventCount) {
+            // The player changes once the move is completed
+            const bool moved = (0 != ((fromStatus ^ toStatus) & bits::ColorMask));
+            const Move* move = (bits::White == (fromStatus & bits::ColorMask)) ? &p_game->lastMoveW : &p_game->lastMoveB;
+            event.moveStart  = moved ? move->start : GAMELOG_NO_MOVE;
+            event.moveEnd    = moved ? move->end : GAMELOG_NO_MOVE;
+        }
+        p_log->events[(p_log->first + p_log->count) % p_log->capacity] = event;
+        p_log->count++;
+    }
+    return evolved;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t getGameLogStart(const GameLog* p_log)
+//-----------------------------------------------------------------------------
+{
+    return p_log->start;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t getGameLogEnd(const GameLog* p_log)
+//-----------------------------------------------------------------------------
+{
+    return p_log->start + p_log->count;
+}
+
+//-----------------------------------------------------------------------------
+const GameEvent* getGameLogEvent(const GameLog* p_log, uint32_t p_index)
+//-----------------------------------------------------------------------------
+{
+    if (p_index < p_log->start || p_index >= p_log->start + p_log->count)
+        return nullptr;
+    return &p_log->events[(p_log->first + (p_index - p_log->start)) % p_log->capacity];
+}
+
+//-----------------------------------------------------------------------------
+bool rebuildLoggedGame(const GameLog* p_log, uint32_t p_index, Game* p_game, uint64_t* p_sensors)
+//-----------------------------------------------------------------------------
+{
+    if (p_index < p_log->start || p_index > p_log->start + p_log->count)
+        return false;
+
+    uint64_t sensors = p_log->snapshotSensors;
+    *p_game          = p_log->snapshot;
+    for (uint32_t i = p_log->start; i < p_index; i++)
+        playLoggedEvent(p_game, &sensors, getGameLogEvent(p_log, i));
+    if (p_sensors)
+        *p_sensors = sensors;
+    return true;
+}
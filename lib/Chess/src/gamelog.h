@@ -0,0 +1,56 @@
+#pragma once
+
+#include "chess.h"
+#include "signature.h"
+#include <stdint.h>
+
+// Event log of a game: each evolve call that changes the sensors or the game is recorded as compact events in
+// a ring given by the caller, after a snapshot of the game before the oldest event. Any game of the ring is
+// rebuilt by playing the events again on the snapshot: the whole history without a copy of the game per ply.
+// Once the ring is full, the oldest call is played on the snapshot to make room.
+// One event per changed square, the events of a call share its tick and statuses, the last one holds the move
+// the call completed. Squares are encoded as in sensor scripts (replay.h).
+constexpr uint8_t GAMELOG_PLACED      = 0x80; // A piece was placed on the square, lifted otherwise
+constexpr uint8_t GAMELOG_STEP        = 0x40; // Call without sensor change, e.g. a change left pending by the previous call
+constexpr uint8_t GAMELOG_SQUARE_MASK = 0x3F;
+constexpr uint8_t GAMELOG_NO_MOVE     = 0xFF;
+constexpr uint8_t GAMELOG_JOINED      = 0xFE; // Move of an event followed by another one of the same call
+
+// 9 bytes on the board
+typedef struct {
+    uint32_t tick;      // Caller clock of the call
+    uint8_t square;     // Sensor change, see above
+    uint8_t fromStatus; // Before the call
+    uint8_t toStatus;   // After the call
+    uint8_t moveStart;  // Move completed by the call, GAMELOG_NO_MOVE or GAMELOG_JOINED otherwise
+    uint8_t moveEnd;
+} GameEvent;
+
+typedef struct {
+    GameEvent* events;
+    uint16_t capacity;
+    uint16_t first;           // Ring index of the oldest event
+    uint16_t count;           // Events in the ring
+    uint32_t start;           // History index of the oldest event
+    Game snapshot;            // Game before the oldest event
+    uint64_t snapshotSensors; // Sensors before the oldest event
+    uint64_t sensors;         // Sensors after the newest event
+} GameLog;
+
+// Start the log of p_game on p_sensors, in the ring p_events of p_capacity events
+void startGameLog(GameLog* p_log, GameEvent* p_events, uint16_t p_capacity, const Game* p_game, uint64_t p_sensors);
+
+// Evolve the game as evolveGameWithSignatures does (p_table optional: evolveGame) and log the call.
+// A call changing more squares than the ring holds starts the log again after it.
+bool evolveLoggedGame(GameLog* p_log, SignatureTable* p_table, Game* p_game, uint64_t p_sensors, uint32_t p_tick);
+
+// History indexes of the oldest event and after the newest one
+uint32_t getGameLogStart(const GameLog* p_log);
+uint32_t getGameLogEnd(const GameLog* p_log);
+
+// Event at history index p_index, nullptr if it is not in the ring
+const GameEvent* getGameLogEvent(const GameLog* p_log, uint32_t p_index);
+
+// Game and sensors (optional) before the event at history index p_index, from getGameLogStart to getGameLogEnd
+// (the current game). false if p_index is not in the ring.
+bool rebuildLoggedGame(const GameLog* p_log, uint32_t p_index, Game* p_game, uint64_t* p_sensors);
@@ -0,0 +1,358 @@
+#include "movegen.h"
+
+#include <flash.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Steps as {file, rank} offsets, orthogonal directions at even indices
+static const int8_t s_kingSteps[8][2] PROGMEM   = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+static const int8_t s_knightSteps[8][2] PROGMEM = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+
+//-----------------------------------------------------------------------------
+static inline bool isOnBoard(int8_t p_file, int8_t p_rank)
+//-----------------------------------------------------------------------------
+{
+    return (p_file >= 0) && (p_file < 8) && (p_rank >= 0) && (p_rank < 8);
+}
+
+//-----------------------------------------------------------------------------
+static inline bool isColor(EPiece p_piece, uint8_t p_color)
+//-----------------------------------------------------------------------------
+{
+    return (Empty != p_piece) && (p_color == (p_piece & bits::ColorMask));
+}
+
+//-----------------------------------------------------------------------------
+bool isSquareAttacked(const EPiece* p_board, uint8_t p_square, uint8_t p_color)
+//-----------------------------------------------------------------------------
+{
+    const int8_t file = p_square % 8;
+    const int8_t rank = p_square / 8;
+
+    // Pawns attack forward: look one rank behind the square from the attacker point of view
+    const int8_t pawnRank = (bits::White == p_color) ? rank - 1 : rank + 1;
+    for (int8_t side = -1; side <= 1; side += 2) {
+        if (isOnBoard(file + side, pawnRank)) {
+            const EPiece piece = p_board[pawnRank * 8 + file + side];
+            if (isColor(piece, p_color) && isPawn(piece))
+                return true;
+        }
+    }
+
+    for (uint8_t i = 0; i < 8; i++) {
+        const int8_t knightFile = file + pgm_read_int8(&s_knightSteps[i][0]);
+        const int8_t knightRank = rank + pgm_read_int8(&s_knightSteps[i][1]);
+        if (isOnBoard(knightFile, knightRank)) {
+            const EPiece piece = p_board[knightRank * 8 + knightFile];
+            if (isColor(piece, p_color) && isKnight(piece))
+                return true;
+        }
+    }
+
+    for (uint8_t i = 0; i < 8; i++) {
+        const bool orthogonal = (0 == (i % 2));
+        const int8_t stepFile = pgm_read_int8(&s_kingSteps[i][0]);
+        const int8_t stepRank = pgm_read_int8(&s_kingSteps[i][1]);
+        int8_t f              = file + stepFile;
+        int8_t r              = rank + stepRank;
+        bool adjacent         = true;
+
+        // First piece met in each direction
+        while (isOnBoard(f, r)) {
+            const EPiece piece = p_board[r * 8 + f];
+            if (Empty != piece) {
+                if (isColor(piece, p_color)) {
+                    if (adjacent && isKing(piece))
+                        return true;
+                    if (orthogonal ? isThreateningOrthogonal(piece) : isThreateningDiagonal(piece))
+                        return true;
+                }
+                break;
+            }
+            f += stepFile;
+            r += stepRank;
+            adjacent = false;
+        }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+static bool leavesKingSafe(Game* p_game, const Move* p_move, uint8_t p_color)
+//-----------------------------------------------------------------------------
+{
+    // Checkers and pins of the position (of the player to play) answer for the other pieces when the king is not in
+    // check and the piece is not pinned. Other moves are played on the game board and taken back, without a board
+    // copy on the stack.
+    EPiece* board         = p_game->board;
+    const EPiece moved    = board[p_move->start];
+    const EPiece captured = board[p_move->end];
+    uint8_t passed        = 64;
+    if (isPawn(p_move->piece) && p_move->captured && Empty == captured) {
+        // En passant: the captured pawn is next to the start square
+        passed = (p_move->start / 8) * 8 + (p_move->end % 8);
+    } else if (!isKing(p_move->piece) && 0 == p_game->state.checkers && 0 == (p_game->state.pinned & (1uLL << p_move->start))) {
+        return true;
+    }
+    const EPiece passedPiece = (passed < 64) ? board[passed] : Empty;
+    if (passed < 64)
+        board[passed] = Empty;
+    board[p_move->end]   = p_move->piece;
+    board[p_move->start] = Empty;
+
+    uint8_t king = p_move->end;
+    if (!isKing(p_move->piece)) {
+        for (king = 0; king < 64; king++) {
+            if (isColor(board[king], p_color) && isKing(board[king]))
+                break;
+        }
+    }
+
+    // No king to protect in test positions
+    const bool safe = (64 == king) || !isSquareAttacked(board, king, p_color ^ bits::ColorMask);
+
+    board[p_move->start] = moved;
+    board[p_move->end]   = captured;
+    if (passed < 64)
+        board[passed] = passedPiece;
+    return safe;
+}
+
+//-----------------------------------------------------------------------------
+static void addMove(Game* p_game, uint8_t p_start, uint8_t p_end, Move* p_moves, uint8_t* p_count)
+//-----------------------------------------------------------------------------
+{
+    const EPiece piece = p_game->board[p_start];
+    const uint8_t rank = p_end / 8;
+    Move move          = BUILD_MOVE(p_start, p_end, piece);
+    move.captured      = (Empty != p_game->board[p_end]) || (isPawn(piece) && (p_start % 8) != (p_end % 8));
+    move.promotion     = isPawn(piece) && (0 == rank || 7 == rank);
+
+    if (*p_count < MOVEGEN_MAX_MOVES && leavesKingSafe(p_game, &move, piece & bits::ColorMask)) {
+        p_moves[*p_count] = move;
+        (*p_count)++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+static void addPawnMoves(Game* p_game, uint8_t p_square, uint8_t p_color, Move* p_moves, uint8_t* p_count)
+//-----------------------------------------------------------------------------
+{
+    const int8_t file      = p_square % 8;
+    const int8_t rank      = p_square / 8;
+    const int8_t forward   = (bits::White == p_color) ? 1 : -1;
+    const int8_t startRank = (bits::White == p_color) ? 1 : 6;
+    const int8_t nextRank  = rank + forward;
+    if (!isOnBoard(file, nextRank))
+        return;
+
+    if (Empty == p_game->board[nextRank * 8 + file]) {
+        addMove(p_game, p_square, nextRank * 8 + file, p_moves, p_count);
+        if (startRank == rank && Empty == p_game->board[(nextRank + forward) * 8 + file])
+            addMove(p_game, p_square, (nextRank + forward) * 8 + file, p_moves, p_count);
+    }
+
+    for (int8_t side = -1; side <= 1; side += 2) {
+        if (!isOnBoard(file + side, nextRank))
+            continue;
+        const uint8_t target = nextRank * 8 + file + side;
+        const EPiece passed  = p_game->board[rank * 8 + file + side];
+        const bool enPassant = (target == p_game->state.en_passant) && Empty == p_game->board[target] && isPawn(passed) &&
+                               isColor(passed, p_color ^ bits::ColorMask);
+        if (isColor(p_game->board[target], p_color ^ bits::ColorMask) || enPassant)
+            addMove(p_game, p_square, target, p_moves, p_count);
+    }
+}
+
+//-----------------------------------------------------------------------------
+static bool canCastle(Game* p_game, uint8_t p_king, uint8_t p_color, bool p_kingSide)
+//-----------------------------------------------------------------------------
+{
+    // Rights, empty squares up to the rook, king neither in check nor passing through an attacked square
+    // (the destination square is checked with the other moves)
+    const uint8_t home     = (bits::White == p_color) ? 4 : 60; // e1 or e8
+    const uint8_t opponent = p_color ^ bits::ColorMask;
+    const EPiece rook      = static_cast<EPiece>(p_color | bits::Rook);
+    const EPiece* board    = p_game->board;
+    if (home != p_king || isSquareAttacked(board, home, opponent))
+        return false;
+
+    if (p_kingSide)
+        return p_game->state.castlingK[p_color] && rook == board[home + 3] && Empty == board[home + 1] && Empty == board[home + 2] &&
+               !isSquareAttacked(board, home + 1, opponent);
+    return p_game->state.castlingQ[p_color] && rook == board[home - 4] && Empty == board[home - 1] && Empty == board[home - 2] &&
+           Empty == board[home - 3] && !isSquareAttacked(board, home - 1, opponent);
+}
+
+//-----------------------------------------------------------------------------
+static void addCastlingMoves(Game* p_game, uint8_t p_king, uint8_t p_color, Move* p_moves, uint8_t* p_count)
+//-----------------------------------------------------------------------------
+{
+    if (canCastle(p_game, p_king, p_color, true))
+        addMove(p_game, p_king, p_king + 2, p_moves, p_count);
+    if (canCastle(p_game, p_king, p_color, false))
+        addMove(p_game, p_king, p_king - 2, p_moves, p_count);
+}
+
+//-----------------------------------------------------------------------------
+uint8_t generateLegalMoves(Game* p_game, Move* p_moves)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_game || nullptr == p_moves)
+        return 0;
+
+    if (bits::ToPlay != (p_game->state.status & bits::MoveMask))
+        return 0;
+
+    const uint8_t color = p_game->state.status & bits::ColorMask;
+    uint8_t count       = 0;
+
+    for (uint8_t square = 0; square < 64; square++) {
+        const EPiece piece = p_game->board[square];
+        if (!isColor(piece, color))
+            continue;
+
+        if (isPawn(piece)) {
+            addPawnMoves(p_game, square, color, p_moves, &count);
+            continue;
+        }
+
+        const int8_t file = square % 8;
+        const int8_t rank = square / 8;
+
+        if (isKnight(piece)) {
+            for (uint8_t i = 0; i < 8; i++) {
+                const int8_t f = file + pgm_read_int8(&s_knightSteps[i][0]);
+                const int8_t r = rank + pgm_read_int8(&s_knightSteps[i][1]);
+                if (isOnBoard(f, r) && !isColor(p_game->board[r * 8 + f], color))
+                    addMove(p_game, square, r * 8 + f, p_moves, &count);
+            }
+            continue;
+        }
+
+        // King, rook, bishop and queen
+        const bool slides = (0 != (piece & bits::LongRangeFlag));
+        for (uint8_t i = 0; i < 8; i++) {
+            const bool orthogonal = (0 == (i % 2));
+            if (0 == (piece & (orthogonal ? bits::OrthogonalFlag : bits::DiagonalFlag)))
+                continue;
+
+            const int8_t stepFile = pgm_read_int8(&s_kingSteps[i][0]);
+            const int8_t stepRank = pgm_read_int8(&s_kingSteps[i][1]);
+            int8_t f              = file + stepFile;
+            int8_t r              = rank + stepRank;
+            while (isOnBoard(f, r)) {
+                const EPiece target = p_game->board[r * 8 + f];
+                if (isColor(target, color))
+                    break;
+                addMove(p_game, square, r * 8 + f, p_moves, &count);
+                if (Empty != target || !slides)
+                    break;
+                f += stepFile;
+                r += stepRank;
+            }
+        }
+
+        if (isKing(piece))
+            addCastlingMoves(p_game, square, color, p_moves, &count);
+    }
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+bool isLegalMove(Game* p_game, Move p_move)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_game || p_move.start >= 64 || p_move.end >= 64 || p_move.start == p_move.end)
+        return false;
+
+    const uint8_t color = p_game->state.status & bits::ColorMask;
+    const EPiece* board = p_game->board;
+    const EPiece piece  = p_move.piece;
+    if (board[p_move.start] != piece || !isColor(piece, color) || isColor(board[p_move.end], color))
+        return false;
+
+    const int8_t file      = p_move.start % 8;
+    const int8_t rank      = p_move.start / 8;
+    const int8_t fileDelta = (int8_t)(p_move.end % 8) - file;
+    const int8_t rankDelta = (int8_t)(p_move.end / 8) - rank;
+    const bool capture     = (Empty != board[p_move.end]);
+
+    if (isPawn(piece)) {
+        const int8_t forward = (bits::White == color) ? 1 : -1;
+        if (0 == fileDelta) {
+            const bool single = (forward == rankDelta);
+            const bool twice  = (2 * forward == rankDelta) && ((bits::White == color) ? 1 : 6) == rank &&
+                               Empty == board[p_move.start + 8 * forward];
+            if (capture || !(single || twice))
+                return false;
+        } else {
+            if (forward != rankDelta || (1 != fileDelta && -1 != fileDelta))
+                return false;
+            const EPiece passed = board[p_move.start + fileDelta];
+            const bool enPassant =
+                !capture && p_move.end == p_game->state.en_passant && isPawn(passed) && isColor(passed, color ^ bits::ColorMask);
+            if (!capture && !enPassant)
+                return false;
+        }
+    } else if (isKnight(piece)) {
+        if (!((1 == abs(fileDelta) && 2 == abs(rankDelta)) || (2 == abs(fileDelta) && 1 == abs(rankDelta))))
+            return false;
+    } else if (isKing(piece) && 0 == rankDelta && 2 == abs(fileDelta)) {
+        if (!canCastle(p_game, p_move.start, color, fileDelta > 0))
+            return false;
+    } else {
+        // King, rook, bishop and queen: along a line their flags allow, with nothing in between
+        const bool orthogonal = (0 == fileDelta) || (0 == rankDelta);
+        const bool diagonal   = (abs(fileDelta) == abs(rankDelta));
+        if (!(orthogonal ? (piece & bits::OrthogonalFlag) : (diagonal && (piece & bits::DiagonalFlag))))
+            return false;
+
+        const int8_t distance = (abs(fileDelta) > abs(rankDelta)) ? abs(fileDelta) : abs(rankDelta);
+        if (isKing(piece) && distance > 1)
+            return false;
+        const int8_t step = ((rankDelta > 0) - (rankDelta < 0)) * 8 + ((fileDelta > 0) - (fileDelta < 0));
+        for (int8_t i = 1; i < distance; i++) {
+            if (Empty != board[p_move.start + i * step])
+                return false;
+        }
+    }
+
+    p_move.captured = capture || (isPawn(piece) && 0 != fileDelta);
+    return leavesKingSafe(p_game, &p_move, color);
+}
+
+//-----------------------------------------------------------------------------
+EPosition classifyPosition(Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_game || bits::ToPlay != (p_game->state.status & bits::MoveMask))
+        return PositionIllegal;
+
+    uint8_t kings[2]     = {0, 0};
+    uint8_t kingIndex[2] = {0, 0};
+    for (uint8_t square = 0; square < 64; square++) {
+        const EPiece piece = p_game->board[square];
+        if (isKing(piece)) {
+            kings[piece & bits::ColorMask]++;
+            kingIndex[piece & bits::ColorMask] = square;
+        } else if (isPawn(piece) && (square < 8 || square >= 56)) {
+            return PositionIllegal;
+        }
+    }
+    if (1 != kings[bits::White] || 1 != kings[bits::Black])
+        return PositionIllegal;
+
+    const uint8_t color    = p_game->state.status & bits::ColorMask;
+    const uint8_t opponent = color ^ bits::ColorMask;
+    if (isSquareAttacked(p_game->board, kingIndex[opponent], color))
+        return PositionIllegal;
+
+    Move moves[MOVEGEN_MAX_MOVES];
+    const bool check = isSquareAttacked(p_game->board, kingIndex[color], opponent);
+    if (0 == generateLegalMoves(p_game, moves))
+        return check ? PositionCheckmate : PositionStalemate;
+    return check ? PositionCheck : PositionNormal;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "chess.h"
+#include <stdint.h>
+
+// Most legal moves a chess position can have
+constexpr uint8_t MOVEGEN_MAX_MOVES = 218;
+
+typedef enum {
+    PositionIllegal = 0, // Missing or extra king, pawn on a back rank or player not to play in check
+    PositionNormal,
+    PositionCheck,
+    PositionCheckmate,
+    PositionStalemate,
+} EPosition;
+
+// Whether a piece of p_color attacks p_square on p_board
+bool isSquareAttacked(const EPiece* p_board, uint8_t p_square, uint8_t p_color);
+
+// Legal moves of the player to play, 0 if the game is not waiting for a move.
+// Castling moves the king two squares, en passant moves are flagged as captures to an empty square,
+// pawns reaching the last rank are only promoted to queens (as the board does).
+uint8_t generateLegalMoves(Game* p_game, Move* p_moves);
+
+// Whether a move of the player to play follows the rules, on the board before the move.
+// Checks a single move without generating the others, for the game to validate each commit.
+// Both read the checkers and pins of the committed position (State).
+bool isLegalMove(Game* p_game, Move p_move);
+
+// Classify the position of a game waiting for a move, from its legal moves
+EPosition classifyPosition(Game* p_game);
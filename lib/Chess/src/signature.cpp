@@ -0,0 +1,182 @@
+#include "signature.h"
+#include "movegen.h"
+
+// Kind of move, in the high bits of SignatureSlot.start
+constexpr uint8_t KIND_NORMAL     = 0x00;
+constexpr uint8_t KIND_CAPTURE    = 0x40;
+constexpr uint8_t KIND_EN_PASSANT = 0x80;
+constexpr uint8_t KIND_CASTLING   = 0xC0;
+constexpr uint8_t KIND_MASK       = 0xC0;
+constexpr uint8_t SQUARE_MASK     = 0x3F;
+
+//-----------------------------------------------------------------------------
+static uint64_t getChanges(uint8_t p_start, uint8_t p_end)
+//-----------------------------------------------------------------------------
+{
+    // Squares whose sensor differs from the board before the move
+    const uint8_t start = p_start & SQUARE_MASK;
+    switch (p_start & KIND_MASK) {
+    case KIND_CAPTURE:
+        return (1uLL << start);
+    case KIND_EN_PASSANT:
+        return (1uLL << start) | (1uLL << p_end) | (1uLL << ((start / 8) * 8 + (p_end % 8)));
+    case KIND_CASTLING: {
+        const uint8_t rook    = (p_end > start) ? start + 3 : start - 4;
+        const uint8_t rookEnd = (p_end > start) ? rook - 2 : rook + 3;
+        return (1uLL << start) | (1uLL << p_end) | (1uLL << rook) | (1uLL << rookEnd);
+    }
+    default:
+        return (1uLL << start) | (1uLL << p_end);
+    }
+}
+
+//-----------------------------------------------------------------------------
+static uint8_t hashChanges(uint64_t p_changes)
+//-----------------------------------------------------------------------------
+{
+    // Few bits are set: fold them to 32 bits (cheaper on 8-bit targets) and keep the top bits of a multiplicative hash
+    const uint32_t folded = (uint32_t)p_changes ^ (uint32_t)(p_changes >> 32);
+    return (uint8_t)((folded * 2654435761u) >> (32 - SIGNATURE_BITS));
+}
+
+//-----------------------------------------------------------------------------
+static uint64_t getOccupancy(const EPiece* p_board)
+//-----------------------------------------------------------------------------
+{
+    uint64_t occupancy = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+        if (Empty != p_board[i])
+            occupancy |= (1uLL << i);
+    }
+    return occupancy;
+}
+
+//-----------------------------------------------------------------------------
+static bool findSignature(const SignatureTable* p_table, uint64_t p_sensors, SignatureSlot* p_slot)
+//-----------------------------------------------------------------------------
+{
+    const uint64_t changes = p_table->occupancy ^ p_sensors;
+    if (0 == changes)
+        return false;
+
+    // Captures by the same piece share a signature, only the one whose captured piece was lifted matches
+    bool found        = false;
+    const uint8_t key = hashChanges(changes);
+    for (uint8_t i = 0; i < SIGNATURE_SLOTS; i++) {
+        const SignatureSlot* slot = &p_table->slots[(key + i) & (SIGNATURE_SLOTS - 1)];
+        if (SIGNATURE_EMPTY == slot->start)
+            break;
+        if (changes != getChanges(slot->start, slot->end))
+            continue;
+        if (KIND_CAPTURE == (slot->start & KIND_MASK) && 0 == (p_table->lifted & (1uLL << slot->end)))
+            continue;
+        if (found)
+            return false; // Ambiguous: left to evolveGame steps
+        found   = true;
+        *p_slot = *slot;
+    }
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+void resetSignatureTable(SignatureTable* p_table)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr != p_table)
+        p_table->status = 0;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t buildSignatureTable(SignatureTable* p_table, Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_table)
+        return 0;
+
+    for (uint8_t i = 0; i < SIGNATURE_SLOTS; i++)
+        p_table->slots[i].start = SIGNATURE_EMPTY;
+    p_table->status = 0;
+    if (nullptr == p_game || bits::ToPlay != (p_game->state.status & bits::MoveMask))
+        return 0;
+
+    p_table->occupancy = getOccupancy(p_game->board);
+    p_table->lifted    = 0;
+    p_table->status    = p_game->state.status;
+
+    // Every square of every piece of the player, without a move list (too large for the board stack)
+    const uint8_t color = p_game->state.status & bits::ColorMask;
+    uint8_t count       = 0;
+    for (uint8_t start = 0; start < 64; start++) {
+        const EPiece piece = p_game->board[start];
+        if (Empty == piece || color != (piece & bits::ColorMask))
+            continue;
+
+        for (uint8_t end = 0; end < 64; end++) {
+            if (!isLegalMove(p_game, BUILD_MOVE(start, end, piece)))
+                continue;
+
+            uint8_t kind = KIND_NORMAL;
+            if (Empty != p_game->board[end])
+                kind = KIND_CAPTURE;
+            else if (isPawn(piece) && (start % 8) != (end % 8))
+                kind = KIND_EN_PASSANT;
+            else if (isKing(piece) && (start + 2 == end || end + 2 == start))
+                kind = KIND_CASTLING;
+
+            const uint8_t key = hashChanges(getChanges(start | kind, end));
+            for (uint8_t i = 0; i < SIGNATURE_SLOTS; i++) {
+                SignatureSlot* slot = &p_table->slots[(key + i) & (SIGNATURE_SLOTS - 1)];
+                if (SIGNATURE_EMPTY == slot->start) {
+                    slot->start = start | kind;
+                    slot->end   = end;
+                    count++;
+                    break;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+bool evolveGameWithSignatures(SignatureTable* p_table, Game* p_game, uint64_t p_sensors)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_table || nullptr == p_game)
+        return evolveGame(p_game, p_sensors);
+
+    // Built again when the game waits for a move of another position (e.g. it was initialized again)
+    const uint8_t currentMove = p_game->state.status & bits::MoveMask;
+    if (bits::ToPlay == currentMove && (p_table->status != p_game->state.status || p_table->occupancy != getOccupancy(p_game->board)))
+        buildSignatureTable(p_table, p_game);
+
+    // Only while the pieces of the move are lifted from the position of the table
+    const bool started = (bits::ToPlay == currentMove || bits::Playing == currentMove || bits::Capturing == currentMove);
+    if (started && p_table->status == ((p_game->state.status & bits::ColorMask) | bits::ToPlay)) {
+        if (p_sensors == p_table->occupancy)
+            p_table->lifted = 0;
+        p_table->lifted |= p_table->occupancy & ~p_sensors;
+
+        SignatureSlot slot;
+        if (findSignature(p_table, p_sensors, &slot)) {
+            // Back to the board before the move, then the whole move at once
+            Removed* removed[2] = {&p_game->state.removed_1, &p_game->state.removed_2};
+            for (uint8_t i = 0; i < 2; i++) {
+                if (removed[i]->index < 64)
+                    p_game->board[removed[i]->index] = removed[i]->piece;
+            }
+
+            const uint8_t start = slot.start & SQUARE_MASK;
+            const uint8_t color = p_game->state.status & bits::ColorMask;
+            playMove(p_game, BUILD_MOVE(start, slot.end, p_game->board[start]));
+            updateCheckState(p_game, (bits::White == color) ? &p_game->lastMoveW : &p_game->lastMoveB);
+            buildSignatureTable(p_table, p_game);
+            return true;
+        }
+    }
+
+    const bool committed = evolveGame(p_game, p_sensors);
+    if (committed)
+        buildSignatureTable(p_table, p_game); // Not built (yet) for en passant and castling waiting for their last step
+    return committed;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "chess.h"
+#include <stdint.h>
+
+// Sensor signatures of the legal moves: the squares each move changes on the board it starts from, built
+// once per committed position so that a stable sensor word is resolved to a move in a single lookup,
+// whatever the scans in between (lift and placement in one debounced scan, both lifts of a capture...).
+// A capture only empties the square the capturing piece leaves, as lifting that piece does: it is
+// resolved once the captured piece has been seen lifted.
+constexpr uint8_t SIGNATURE_BITS  = 6;
+constexpr uint8_t SIGNATURE_SLOTS = 1 << SIGNATURE_BITS; // Moves beyond are left to evolveGame steps
+
+typedef struct {
+    uint8_t start; // Bits 0-5 square, bits 6-7 kind of move, SIGNATURE_EMPTY when free
+    uint8_t end;
+} SignatureSlot;
+
+constexpr uint8_t SIGNATURE_EMPTY = 0xFF;
+
+typedef struct {
+    SignatureSlot slots[SIGNATURE_SLOTS];
+    uint64_t occupancy; // Board the moves start from
+    uint64_t lifted;    // Squares of that board seen empty since it was last complete
+    uint8_t status;     // Status the table was built for, 0 when it has to be built again
+} SignatureTable;
+
+// Forget the moves of the previous position (e.g. the game was initialized again)
+void resetSignatureTable(SignatureTable* p_table);
+
+// Store the legal moves of a game waiting for a move, returns how many were stored
+uint8_t buildSignatureTable(SignatureTable* p_table, Game* p_game);
+
+// Evolve the game as evolveGame does, committing a whole move at once when the sensors match its signature.
+// The table is built again after each commit.
+bool evolveGameWithSignatures(SignatureTable* p_table, Game* p_game, uint64_t p_sensors);
@@ -0,0 +1,488 @@
+#ifndef ARDUINO_ARCH_AVR
+
+#include "engine.h"
+
+#include <chrono>
+#include <eval.h>
+#include <movegen.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+// Transposition table data: score (16 bits), depth (8), bound (2), move start (6) and end (6), generation (8)
+typedef enum {
+    BoundNone  = 0,
+    BoundUpper = 1, // All moves failed low
+    BoundLower = 2, // A move failed high
+    BoundExact = 3,
+} EBound;
+
+// Per thread search state
+typedef struct {
+    Engine* engine;
+    uint8_t id;
+    bool main;
+    bool aborted;
+    uint64_t nodes; // Not yet added to the engine count
+    uint64_t nodeLimit;
+    std::chrono::steady_clock::time_point deadline;
+    bool timeLimit;
+    uint64_t path[ENGINE_MAX_DEPTH + 1]; // Keys of the positions from the root, for repetitions
+    Move killers[ENGINE_MAX_DEPTH][2];
+    Move rootBest; // Of the last iteration
+} SearchThread;
+
+// Nodes between two checks of the stop flag and limits
+constexpr uint16_t CHECK_PERIOD = 1024;
+
+constexpr int16_t MATE_BOUND = ENGINE_MATE_SCORE - ENGINE_MAX_DEPTH - 1;
+
+// No square, as NULL_INDEX of the chess core
+constexpr uint8_t NO_SQUARE = 64;
+
+// Piece values for move ordering, indexed by EPiece
+static const int16_t s_pieceValues[16] = {
+    0, 0, 0, 0, 100, 100, 0, 0, 320, 320, 500, 500, 330, 330, 900, 900,
+};
+
+// Zobrist keys: piece on square, black to play, castling rights, en passant file
+typedef struct {
+    uint64_t pieces[16][64];
+    uint64_t black;
+    uint64_t castling[4];
+    uint64_t enPassant[8];
+} ZobristKeys;
+
+//-----------------------------------------------------------------------------
+static uint64_t splitmix64(uint64_t* p_state)
+//-----------------------------------------------------------------------------
+{
+    uint64_t z = (*p_state += 0x9E3779B97F4A7C15uLL);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9uLL;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBuLL;
+    return z ^ (z >> 31);
+}
+
+//-----------------------------------------------------------------------------
+static ZobristKeys buildZobristKeys()
+//-----------------------------------------------------------------------------
+{
+    ZobristKeys keys;
+    uint64_t seed = 0x436865737342524FuLL;
+    for (uint8_t piece = 0; piece < 16; piece++) {
+        for (uint8_t square = 0; square < 64; square++)
+            keys.pieces[piece][square] = splitmix64(&seed);
+    }
+    keys.black = splitmix64(&seed);
+    for (uint8_t i = 0; i < 4; i++)
+        keys.castling[i] = splitmix64(&seed);
+    for (uint8_t i = 0; i < 8; i++)
+        keys.enPassant[i] = splitmix64(&seed);
+    return keys;
+}
+
+static const ZobristKeys s_zobrist = buildZobristKeys();
+
+//-----------------------------------------------------------------------------
+int16_t evaluatePosition(const Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    // Kept up to date by playMove: no scan of the board
+    return getPlayerEvaluation(p_game);
+}
+
+//-----------------------------------------------------------------------------
+uint64_t getZobristKey(const Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    uint64_t key = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+        if (Empty != p_game->board[i])
+            key ^= s_zobrist.pieces[p_game->board[i]][i];
+    }
+
+    const State* state = &p_game->state;
+    if (bits::Black == (state->status & bits::ColorMask))
+        key ^= s_zobrist.black;
+    key ^= state->castlingK[0] ? s_zobrist.castling[0] : 0;
+    key ^= state->castlingK[1] ? s_zobrist.castling[1] : 0;
+    key ^= state->castlingQ[0] ? s_zobrist.castling[2] : 0;
+    key ^= state->castlingQ[1] ? s_zobrist.castling[3] : 0;
+    if (state->en_passant < 64)
+        key ^= s_zobrist.enPassant[state->en_passant % 8];
+    return key;
+}
+
+//-----------------------------------------------------------------------------
+void initializeEngine(Engine* p_engine, uint8_t p_threads, uint32_t p_tableSize_MB)
+//-----------------------------------------------------------------------------
+{
+    p_engine->threads = (0 == p_threads) ? 1 : (p_threads > ENGINE_MAX_THREADS ? ENGINE_MAX_THREADS : p_threads);
+
+    // Largest power of 2 slot count that fits
+    size_t slots      = 1;
+    const size_t size = (size_t)(0 == p_tableSize_MB ? 1 : p_tableSize_MB) << 20;
+    while (slots * 2 * sizeof(TranspositionSlot) <= size)
+        slots *= 2;
+    p_engine->table = std::vector<TranspositionSlot>(slots);
+    clearEngine(p_engine);
+}
+
+//-----------------------------------------------------------------------------
+void clearEngine(Engine* p_engine)
+//-----------------------------------------------------------------------------
+{
+    for (TranspositionSlot& slot : p_engine->table) {
+        slot.check.store(0, std::memory_order_relaxed);
+        slot.data.store(0, std::memory_order_relaxed);
+    }
+    p_engine->stop.store(false);
+    p_engine->nodes.store(0);
+    p_engine->generation = 0;
+}
+
+//-----------------------------------------------------------------------------
+void stopSearch(Engine* p_engine)
+//-----------------------------------------------------------------------------
+{
+    p_engine->stop.store(true, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+static bool probeTable(Engine* p_engine, uint64_t p_key, uint64_t* p_data)
+//-----------------------------------------------------------------------------
+{
+    const TranspositionSlot& slot = p_engine->table[p_key & (p_engine->table.size() - 1)];
+    const uint64_t data           = slot.data.load(std::memory_order_relaxed);
+    if ((slot.check.load(std::memory_order_relaxed) ^ data) != p_key || BoundNone == ((data >> 24) & 3))
+        return false;
+    *p_data = data;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static void storeTable(Engine* p_engine, uint64_t p_key, int16_t p_score, uint8_t p_depth, EBound p_bound, Move p_move)
+//-----------------------------------------------------------------------------
+{
+    TranspositionSlot& slot = p_engine->table[p_key & (p_engine->table.size() - 1)];
+    const uint64_t old      = slot.data.load(std::memory_order_relaxed);
+
+    // Keep a deeper result of the same position from the current search
+    const bool same = (slot.check.load(std::memory_order_relaxed) ^ old) == p_key;
+    if (same && ((old >> 38) & 0xFF) == p_engine->generation && ((old >> 16) & 0xFF) > p_depth && BoundExact != p_bound)
+        return;
+
+    const uint64_t data = (uint64_t)(uint16_t)p_score | ((uint64_t)p_depth << 16) | ((uint64_t)p_bound << 24) | ((uint64_t)(p_move.start & 63) << 26) |
+                          ((uint64_t)(p_move.end & 63) << 32) | ((uint64_t)p_engine->generation << 38);
+    slot.check.store(p_key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+static inline int16_t toTableScore(int16_t p_score, uint8_t p_ply)
+//-----------------------------------------------------------------------------
+{
+    // Mate scores are stored relative to the position, not to the root
+    if (p_score >= MATE_BOUND)
+        return p_score + p_ply;
+    if (p_score <= -MATE_BOUND)
+        return p_score - p_ply;
+    return p_score;
+}
+
+//-----------------------------------------------------------------------------
+static inline int16_t fromTableScore(int16_t p_score, uint8_t p_ply)
+//-----------------------------------------------------------------------------
+{
+    if (p_score >= MATE_BOUND)
+        return p_score - p_ply;
+    if (p_score <= -MATE_BOUND)
+        return p_score + p_ply;
+    return p_score;
+}
+
+//-----------------------------------------------------------------------------
+static bool isInCheck(const Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t player = p_game->state.status & bits::ColorMask;
+    const EPiece king    = static_cast<EPiece>(player | bits::King);
+    for (uint8_t i = 0; i < 64; i++) {
+        if (king == p_game->board[i])
+            return isSquareAttacked(p_game->board, i, player ^ bits::ColorMask);
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+static inline bool isSameMove(Move p_first, Move p_second)
+//-----------------------------------------------------------------------------
+{
+    return p_first.start == p_second.start && p_first.end == p_second.end;
+}
+
+//-----------------------------------------------------------------------------
+static void scoreMoves(SearchThread* p_thread, const Game* p_game, const Move* p_moves, uint8_t p_count, Move p_tableMove, uint8_t p_ply,
+                       int16_t* p_scores)
+//-----------------------------------------------------------------------------
+{
+    // Table move, then captures by most valuable victim / least valuable attacker, then killers
+    for (uint8_t i = 0; i < p_count; i++) {
+        const Move move = p_moves[i];
+        int16_t score   = 0;
+        if (isSameMove(move, p_tableMove)) {
+            score = 30000;
+        } else if (move.captured) {
+            const EPiece victim = p_game->board[move.end];
+            score               = 10000 + (Empty == victim ? 100 : s_pieceValues[victim]) - s_pieceValues[move.piece] / 100;
+        } else if (isPawn(move.piece) && (move.end < 8 || move.end >= 56)) {
+            score = 9000;
+        } else if (p_ply < ENGINE_MAX_DEPTH && isSameMove(move, p_thread->killers[p_ply][0])) {
+            score = 8000;
+        } else if (p_ply < ENGINE_MAX_DEPTH && isSameMove(move, p_thread->killers[p_ply][1])) {
+            score = 7000;
+        }
+        p_scores[i] = score;
+    }
+}
+
+//-----------------------------------------------------------------------------
+static Move pickMove(Move* p_moves, int16_t* p_scores, uint8_t p_count, uint8_t p_index)
+//-----------------------------------------------------------------------------
+{
+    // Selection sort step: cutoffs usually happen before the list is sorted
+    uint8_t best = p_index;
+    for (uint8_t i = p_index + 1; i < p_count; i++) {
+        if (p_scores[i] > p_scores[best])
+            best = i;
+    }
+    const Move move   = p_moves[best];
+    const int16_t tmp = p_scores[best];
+    p_moves[best]     = p_moves[p_index];
+    p_scores[best]    = p_scores[p_index];
+    p_moves[p_index]  = move;
+    p_scores[p_index] = tmp;
+    return move;
+}
+
+//-----------------------------------------------------------------------------
+static bool checkLimits(SearchThread* p_thread)
+//-----------------------------------------------------------------------------
+{
+    Engine* engine       = p_thread->engine;
+    const uint64_t nodes = engine->nodes.fetch_add(p_thread->nodes, std::memory_order_relaxed) + p_thread->nodes;
+    p_thread->nodes      = 0;
+
+    if (p_thread->main) {
+        if ((0 != p_thread->nodeLimit && nodes >= p_thread->nodeLimit) ||
+            (p_thread->timeLimit && std::chrono::steady_clock::now() >= p_thread->deadline))
+            stopSearch(engine);
+    }
+    p_thread->aborted = engine->stop.load(std::memory_order_relaxed);
+    return p_thread->aborted;
+}
+
+//-----------------------------------------------------------------------------
+static int16_t quiesce(SearchThread* p_thread, const Game* p_game, int16_t p_alpha, int16_t p_beta, uint8_t p_ply)
+//-----------------------------------------------------------------------------
+{
+    if (++p_thread->nodes >= CHECK_PERIOD && checkLimits(p_thread))
+        return 0;
+    if (p_thread->aborted)
+        return 0;
+
+    Game game = *p_game;
+    Move moves[MOVEGEN_MAX_MOVES];
+    const uint8_t count = generateLegalMoves(&game, moves);
+    const bool inCheck  = isInCheck(&game);
+    if (0 == count)
+        return inCheck ? -(ENGINE_MATE_SCORE - p_ply) : 0;
+    if (p_ply >= ENGINE_MAX_DEPTH)
+        return evaluatePosition(&game);
+
+    // Stand pat, unless in check where every evasion is searched
+    if (!inCheck) {
+        const int16_t standPat = evaluatePosition(&game);
+        if (standPat >= p_beta)
+            return standPat;
+        if (standPat > p_alpha)
+            p_alpha = standPat;
+    }
+
+    int16_t scores[MOVEGEN_MAX_MOVES];
+    scoreMoves(p_thread, &game, moves, count, BUILD_MOVE(NO_SQUARE, NO_SQUARE, Empty), ENGINE_MAX_DEPTH, scores);
+    for (uint8_t i = 0; i < count; i++) {
+        const Move move = pickMove(moves, scores, count, i);
+        if (!inCheck && !move.captured && !(isPawn(move.piece) && (move.end < 8 || move.end >= 56)))
+            continue;
+
+        Game child = game;
+        playMove(&child, move);
+        const int16_t score = -quiesce(p_thread, &child, -p_beta, -p_alpha, p_ply + 1);
+        if (p_thread->aborted)
+            return 0;
+        if (score >= p_beta)
+            return score;
+        if (score > p_alpha)
+            p_alpha = score;
+    }
+    return p_alpha;
+}
+
+//-----------------------------------------------------------------------------
+static int16_t search(SearchThread* p_thread, const Game* p_game, int16_t p_alpha, int16_t p_beta, uint8_t p_depth, uint8_t p_ply)
+//-----------------------------------------------------------------------------
+{
+    if (++p_thread->nodes >= CHECK_PERIOD && checkLimits(p_thread))
+        return 0;
+    if (p_thread->aborted)
+        return 0;
+
+    // Draws by the fifty-move rule and by repetition since the root
+    const uint64_t key      = getZobristKey(p_game);
+    p_thread->path[p_ply]   = key;
+    const uint8_t halfmoves = p_game->halfmoveClock;
+    if (p_ply > 0) {
+        if (halfmoves >= 100)
+            return 0;
+        for (int16_t i = p_ply - 2; i >= 0 && i >= p_ply - halfmoves; i -= 2) {
+            if (p_thread->path[i] == key)
+                return 0;
+        }
+    }
+
+    if (0 == p_depth || p_ply >= ENGINE_MAX_DEPTH)
+        return quiesce(p_thread, p_game, p_alpha, p_beta, p_ply);
+
+    Move tableMove = BUILD_MOVE(NO_SQUARE, NO_SQUARE, Empty);
+    uint64_t data;
+    if (probeTable(p_thread->engine, key, &data)) {
+        tableMove.start     = (data >> 26) & 63;
+        tableMove.end       = (data >> 32) & 63;
+        const int16_t score = fromTableScore((int16_t)(uint16_t)data, p_ply);
+        const EBound bound  = static_cast<EBound>((data >> 24) & 3);
+        const uint8_t depth = (data >> 16) & 0xFF;
+        if (p_ply > 0 && depth >= p_depth &&
+            (BoundExact == bound || (BoundLower == bound && score >= p_beta) || (BoundUpper == bound && score <= p_alpha)))
+            return score;
+    }
+
+    Game game = *p_game;
+    Move moves[MOVEGEN_MAX_MOVES];
+    const uint8_t count = generateLegalMoves(&game, moves);
+    if (0 == count)
+        return isInCheck(&game) ? -(ENGINE_MATE_SCORE - p_ply) : 0;
+
+    int16_t scores[MOVEGEN_MAX_MOVES];
+    scoreMoves(p_thread, &game, moves, count, tableMove, p_ply, scores);
+
+    const int16_t alpha = p_alpha;
+    int16_t best        = -ENGINE_INFINITE;
+    Move bestMove       = moves[0];
+    for (uint8_t i = 0; i < count; i++) {
+        const Move move = pickMove(moves, scores, count, i);
+        Game child      = game;
+        playMove(&child, move);
+        const int16_t score = -search(p_thread, &child, -p_beta, -p_alpha, p_depth - 1, p_ply + 1);
+        if (p_thread->aborted)
+            return 0;
+
+        if (score > best) {
+            best     = score;
+            bestMove = move;
+            if (0 == p_ply)
+                p_thread->rootBest = move;
+        }
+        if (score > p_alpha)
+            p_alpha = score;
+        if (p_alpha >= p_beta) {
+            if (!move.captured && !isSameMove(move, p_thread->killers[p_ply][0])) {
+                p_thread->killers[p_ply][1] = p_thread->killers[p_ply][0];
+                p_thread->killers[p_ply][0] = move;
+            }
+            break;
+        }
+    }
+
+    const EBound bound = (best >= p_beta) ? BoundLower : ((best > alpha) ? BoundExact : BoundUpper);
+    storeTable(p_thread->engine, key, toTableScore(best, p_ply), p_depth, bound, bestMove);
+    return best;
+}
+
+//-----------------------------------------------------------------------------
+static void iterate(SearchThread* p_thread, const Game* p_game, uint8_t p_maxDepth, SearchResult* p_result)
+//-----------------------------------------------------------------------------
+{
+    // Helpers start one ply deeper every other thread, so that they fill the table ahead of the main thread
+    const uint8_t firstDepth = 1 + (p_thread->id & 1);
+    for (uint8_t depth = firstDepth; depth <= p_maxDepth; depth++) {
+        const int16_t score = search(p_thread, p_game, -ENGINE_INFINITE, ENGINE_INFINITE, depth, 0);
+        if (p_thread->aborted)
+            break;
+
+        if (nullptr != p_result) {
+            p_result->best  = p_thread->rootBest;
+            p_result->score = score;
+            p_result->depth = depth;
+
+            // No deeper search can find a shorter mate
+            if (score >= MATE_BOUND || score <= -MATE_BOUND) {
+                if (ENGINE_MATE_SCORE - abs(score) <= depth)
+                    break;
+            }
+        }
+    }
+    checkLimits(p_thread);
+}
+
+//-----------------------------------------------------------------------------
+bool searchPosition(Engine* p_engine, const Game* p_game, const SearchLimits* p_limits, SearchResult* p_result)
+//-----------------------------------------------------------------------------
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Game game = *p_game;
+    Move moves[MOVEGEN_MAX_MOVES];
+    const uint8_t count = generateLegalMoves(&game, moves);
+    memset(p_result, 0, sizeof(SearchResult));
+    p_result->best = BUILD_MOVE(NO_SQUARE, NO_SQUARE, Empty);
+    if (0 == count || p_engine->table.empty())
+        return false;
+
+    p_engine->stop.store(false);
+    p_engine->nodes.store(0);
+    p_engine->generation++;
+
+    const uint8_t maxDepth = (0 == p_limits->depth || p_limits->depth > ENGINE_MAX_DEPTH) ? ENGINE_MAX_DEPTH : p_limits->depth;
+    std::vector<SearchThread> threads(p_engine->threads);
+    for (uint8_t i = 0; i < p_engine->threads; i++) {
+        SearchThread* thread = &threads[i];
+        thread->engine    = p_engine;
+        thread->id        = i;
+        thread->main      = (0 == i);
+        thread->nodeLimit = p_limits->nodes;
+        thread->timeLimit = (0 != p_limits->time_ms);
+        thread->deadline  = start + std::chrono::milliseconds(p_limits->time_ms);
+    }
+
+    // Fallback if the first iteration is stopped
+    p_result->best  = moves[0];
+    p_result->score = 0;
+
+    std::vector<std::thread> helpers;
+    for (uint8_t i = 1; i < p_engine->threads; i++)
+        helpers.emplace_back(iterate, &threads[i], p_game, ENGINE_MAX_DEPTH, nullptr);
+    iterate(&threads[0], p_game, maxDepth, p_result);
+    stopSearch(p_engine);
+    for (std::thread& helper : helpers)
+        helper.join();
+    for (SearchThread& thread : threads)
+        p_engine->nodes.fetch_add(thread.nodes);
+
+    p_result->stopped = (p_result->depth < maxDepth) && !(p_result->score >= MATE_BOUND || p_result->score <= -MATE_BOUND);
+    p_result->nodes   = p_engine->nodes.load();
+    p_result->time_ms = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+#endif
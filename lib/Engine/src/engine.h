@@ -0,0 +1,64 @@
+#pragma once
+
+#ifndef ARDUINO_ARCH_AVR
+
+#include <atomic>
+#include <chess.h>
+#include <stdint.h>
+#include <vector>
+
+// Host-side analysis: iterative deepening alpha-beta on the chess core positions and moves
+// (generateLegalMoves and playMove), so that hints are always moves evolveGame accepts.
+// Threads share a lock-free transposition table (Lazy SMP), the main thread result is reported.
+constexpr uint8_t ENGINE_MAX_THREADS = 64;
+constexpr uint8_t ENGINE_MAX_DEPTH   = 64;
+constexpr int16_t ENGINE_MATE_SCORE  = 30000; // Mate in n plies scores ENGINE_MATE_SCORE - n
+constexpr int16_t ENGINE_INFINITE    = 32000;
+
+typedef struct {
+    uint32_t time_ms; // 0 = no limit
+    uint64_t nodes;   // 0 = no limit
+    uint8_t depth;    // 0 = ENGINE_MAX_DEPTH
+} SearchLimits;
+
+typedef struct {
+    Move best;      // best.piece is Empty when there is no legal move
+    int16_t score;  // Centipawns for the player to play
+    uint8_t depth;  // Last completed iteration
+    uint64_t nodes; // All threads
+    uint32_t time_ms;
+    bool stopped; // Stopped by stopSearch() or a limit before the requested depth
+} SearchResult;
+
+// Transposition table slot: key XOR data, so that a torn write is seen as a miss
+typedef struct {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+} TranspositionSlot;
+
+typedef struct {
+    uint8_t threads;
+    std::vector<TranspositionSlot> table; // Power of 2 slots
+    std::atomic<bool> stop;
+    std::atomic<uint64_t> nodes;
+    uint8_t generation;
+} Engine;
+
+// Tapered material and piece-square evaluation (eval.h), in centipawns for the player to play
+int16_t evaluatePosition(const Game* p_game);
+
+// 64-bit key of the position: pieces, player, castling rights and en passant square
+uint64_t getZobristKey(const Game* p_game);
+
+void initializeEngine(Engine* p_engine, uint8_t p_threads, uint32_t p_tableSize_MB);
+
+// Forget previous searches
+void clearEngine(Engine* p_engine);
+
+// Blocking search, returns false if the player to play has no legal move
+bool searchPosition(Engine* p_engine, const Game* p_game, const SearchLimits* p_limits, SearchResult* p_result);
+
+// Stop the running search from another thread (e.g. the board position changed), its best move so far is returned
+void stopSearch(Engine* p_engine);
+
+#endif
@@ -1,5 +1,10 @@
 #include "hardware.h"
 
+#include <EEPROM.h>
+#include <avr/eeprom.h>
+#include <avr/sleep.h>
+#include <flash.h>
+#include <scan.h>
 #include <utils.h>
 
 #if defined(USE_FAST_GPIO)
@@ -9,8 +14,41 @@
 // Delay to validate board state
 constexpr uint32_t STABLE_BOARD_DELAY_MS = 250;
 
+// Calibrated layout of the sensors: a magic byte followed by the raw bit of each square
+constexpr int EEPROM_LAYOUT_ADDRESS   = 0;
+constexpr uint8_t EEPROM_LAYOUT_MAGIC = 0xC1;
+
+// Game journal, after the layout
+constexpr uint16_t EEPROM_JOURNAL_ADDRESS = 96;
+static_assert(EEPROM_JOURNAL_ADDRESS + JOURNAL_SIZE <= E2END + 1, "Game journal does not fit in EEPROM");
+
+// LCD buttons: ADC started by each timer 0 overflow (1024 us), one sample out of 3 is debounced
+constexpr uint8_t KEYPAD_DECIMATION = 3;
+
+// Display transfers
+constexpr uint16_t LCD_QUEUE_SIZE = 128;
+constexpr uint16_t I2C_QUEUE_SIZE = 128;
+constexpr uint16_t LCD_TICK_US    = 50;                       // Timer 3 period
+constexpr uint8_t TWI_BITRATE     = (F_CPU / 400000 - 16) / 2; // 400 kHz
+
+// TWI control values
+constexpr uint8_t TWI_START      = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE);
+constexpr uint8_t TWI_SEND       = _BV(TWINT) | _BV(TWEN) | _BV(TWIE);
+constexpr uint8_t TWI_STOP       = _BV(TWINT) | _BV(TWSTO) | _BV(TWEN);
+constexpr uint8_t TWI_STOP_START = _BV(TWINT) | _BV(TWSTO) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE);
+
+static uint8_t s_lcdQueue[LCD_QUEUE_SIZE];
+static uint8_t s_i2cQueue[I2C_QUEUE_SIZE];
+static DisplayTransfers s_transfers;
+static volatile bool s_i2cBusy      = false;
+static volatile uint8_t s_i2cAddress = 0;
+static uint32_t s_lcdClock_us       = 0;
+static uint8_t s_layout[64];
+static Keypad s_keypad;
+static uint8_t s_keypadDecimation = 0;
+
 // Pin definitions
-constexpr uint8_t PIN_LCD_BTN = A0;
+constexpr uint8_t ADC_LCD_BTN = 7;  // A0, ADC7 on the ATmega32U4
 constexpr uint8_t PIN_HALL_EN = A5; // Active low
 constexpr uint8_t PIN_LOAD    = 12; // Active low, shifts when high
 constexpr uint8_t PIN_CLOCK   = 11; // Rising edge trigger
@@ -20,32 +58,37 @@ constexpr uint8_t PIN_DATA_2  = A3;
 constexpr uint8_t PIN_DATA_3  = A4;
 
 LCD_KEY getLcdKeyPressed() {
-    // Values are not exact but sufficiently precise
-    const int val = analogRead(PIN_LCD_BTN);
-    if (val < 100)
-        return LCD_KEY::Right;
-    else if (val < 250)
-        return LCD_KEY::Up;
-    else if (val < 380)
-        return LCD_KEY::Down;
-    else if (val < 600)
-        return LCD_KEY::Left;
-    else if (val < 900)
-        return LCD_KEY::Select;
-    else
-        return LCD_KEY::None;
+    return s_keypad.key;
 }
 
 LCD_KEY getLastLcdKeyPressed() {
-    static LCD_KEY s_lastKey = LCD_KEY::None;
-    LCD_KEY currentKey       = getLcdKeyPressed();
-    if (currentKey != s_lastKey) {
-        s_lastKey = currentKey;
-        return currentKey;
+    KeypadEvent event;
+    while (popKeypadEvent(&s_keypad, &event)) {
+        if (KeypadPress == event.type)
+            return event.key;
     }
     return LCD_KEY::None;
 }
 
+bool getLcdKeyEvent(KeypadEvent* p_event) {
+    return popKeypadEvent(&s_keypad, p_event);
+}
+
+uint8_t getLcdKeyDroppedCount() {
+    return s_keypad.dropped;
+}
+
+static void initLcdKeypad() {
+    initializeKeypad(&s_keypad);
+
+    // Auto triggered conversions, no analogRead busy wait: AVcc reference, ADC clock 16 MHz / 128
+    noInterrupts();
+    ADMUX  = _BV(REFS0) | ADC_LCD_BTN;
+    ADCSRB = _BV(ADTS2); // Timer 0 overflow, which already wakes the MCU from idle sleep
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+    interrupts();
+}
+
 void initChessboard() {
 #ifdef USE_POWER_CTRL
     // Sensor power control (active low)
@@ -64,86 +107,374 @@ void initChessboard() {
     pinMode(PIN_DATA_1, INPUT);
     pinMode(PIN_DATA_2, INPUT);
     pinMode(PIN_DATA_3, INPUT);
+
+    initLcdKeypad();
+    loadChessboardLayout();
 }
 
-uint64_t readChessboard() {
+// Data lines by connector index
+constexpr uint8_t DATA_PINS[4] = {PIN_DATA_0, PIN_DATA_1, PIN_DATA_2, PIN_DATA_3};
+
+#if defined(USE_FAST_GPIO)
+struct BoardGpio {
+    static inline void powerOn() {
 #if defined(USE_POWER_CTRL)
-    // Enable sensors and wait for current to stabilize
-    digitalWrite(PIN_HALL_EN, LOW);
-    delayMicroseconds(15);
+        // Enable sensors and wait for current to stabilize
+        FastGPIO::Pin<PIN_HALL_EN>::setOutputValueLow();
+        delayMicroseconds(15);
 #endif
+    }
 
-    // Load the data into the registers
-    digitalWrite(PIN_LOAD, LOW);
-    digitalWrite(PIN_LOAD, HIGH);
-
+    static inline void powerOff() {
 #if defined(USE_POWER_CTRL)
-    // Turn off sensors
-    digitalWrite(PIN_HALL_EN, HIGH);
+        FastGPIO::Pin<PIN_HALL_EN>::setOutputValueHigh();
 #endif
+    }
 
-    // Read data
-    uint64_t state = 0;
+    static inline void load() {
+        FastGPIO::Pin<PIN_LOAD>::setOutputValueLow();
+        FastGPIO::Pin<PIN_LOAD>::setOutputValueHigh();
+    }
 
-#if defined(CHESSBOARD_REV_A) or defined(CHESSBOARD_REV_A_JUMPED)
-    constexpr uint64_t baseOffset0 = 1uLL << 0;
-    constexpr uint64_t baseOffset1 = 1uLL << 4;
-    constexpr uint64_t baseOffset2 = 1uLL << 32;
-    constexpr uint64_t baseOffset3 = 1uLL << 36;
+    template <uint8_t Line>
+    static inline bool isDataHigh() {
+        return FastGPIO::Pin<DATA_PINS[Line]>::isInputHigh();
+    }
 
-#if defined(CHESSBOARD_REV_A_JUMPED)
-    for (byte i = 0; i < 32; i++) {
-        const byte bitshift = ((i >> 2) | ((i & 3) << 3)) ^ 0b11011; // Optimized with C++23
-#else
-    for (byte i = 0; i < 16; i++) {
-        const byte bitshift = (3 - (i >> 2)) | ((3 - (i & 0b11)) << 3);
-#endif
-#if defined(USE_FAST_GPIO)
-        if (FastGPIO::Pin<PIN_DATA_0>::isInputHigh())
-            state |= (baseOffset0 << bitshift);
-#if defined(CHESSBOARD_REV_A_JUMPED)
-        if (FastGPIO::Pin<PIN_DATA_2>::isInputHigh())
-            state |= (baseOffset2 << bitshift);
-#else
-        if (FastGPIO::Pin<PIN_DATA_1>::isInputHigh())
-            state |= (baseOffset1 << bitshift);
-        if (FastGPIO::Pin<PIN_DATA_2>::isInputHigh())
-            state |= (baseOffset2 << bitshift);
-        if (FastGPIO::Pin<PIN_DATA_3>::isInputHigh())
-            state |= (baseOffset3 << bitshift);
-#endif // Rev A jumped
-
-        // Clock tick
+    static inline void clock() {
         FastGPIO::Pin<PIN_CLOCK>::setOutputValueHigh();
         FastGPIO::Pin<PIN_CLOCK>::setOutputValueLow();
+    }
+};
 #else
-        if (digitalRead(PIN_DATA_0) == HIGH)
-            state |= (baseOffset0 << bitshift);
-#if defined(CHESSBOARD_REV_A_JUMPED)
-        if (digitalRead(PIN_DATA_2) == HIGH)
-            state |= (baseOffset2 << bitshift);
-#else
-        if (digitalRead(PIN_DATA_1) == HIGH)
-            state |= (baseOffset1 << bitshift);
-        if (digitalRead(PIN_DATA_2) == HIGH)
-            state |= (baseOffset2 << bitshift);
-        if (digitalRead(PIN_DATA_3) == HIGH)
-            state |= (baseOffset3 << bitshift);
-#endif // Rev A jumped
-
-        // Clock tick
+struct BoardGpio {
+    static inline void powerOn() {
+#if defined(USE_POWER_CTRL)
+        // Enable sensors and wait for current to stabilize
+        digitalWrite(PIN_HALL_EN, LOW);
+        delayMicroseconds(15);
+#endif
+    }
+
+    static inline void powerOff() {
+#if defined(USE_POWER_CTRL)
+        digitalWrite(PIN_HALL_EN, HIGH);
+#endif
+    }
+
+    static inline void load() {
+        digitalWrite(PIN_LOAD, LOW);
+        digitalWrite(PIN_LOAD, HIGH);
+    }
+
+    template <uint8_t Line>
+    static inline bool isDataHigh() {
+        return digitalRead(DATA_PINS[Line]) == HIGH;
+    }
+
+    static inline void clock() {
         digitalWrite(PIN_CLOCK, HIGH);
         digitalWrite(PIN_CLOCK, LOW);
-#endif // USE_FAST_GPIO
     }
+};
+#endif // USE_FAST_GPIO
 
+#if defined(CHESSBOARD_REV_A_JUMPED)
+typedef BoardRevAJumped BoardRevision;
+#elif defined(CHESSBOARD_REV_A)
+typedef BoardRevA BoardRevision;
 #else
-    Unknown_board_revision;
-#endif // CHESSBOARD_REV_*
+Unknown_board_revision;
+#endif
+
+uint64_t readChessboard() {
+    return scanBoard<BoardRevision, BoardGpio>(s_layout);
+}
+
+void readRawChessboard(uint8_t* p_raw) {
+    scanRawBoard<BoardRevision, BoardGpio>(p_raw);
+}
+
+void loadChessboardLayout() {
+    // Calibrated layout if any, otherwise the one of the revision
+    if (EEPROM_LAYOUT_MAGIC == EEPROM.read(EEPROM_LAYOUT_ADDRESS)) {
+        for (uint8_t square = 0; square < 64; square++)
+            s_layout[square] = EEPROM.read(EEPROM_LAYOUT_ADDRESS + 1 + square);
+        if (isScanLayoutValid(s_layout))
+            return;
+    }
+    loadScanLayout(s_layout, BoardRevision::getLayout());
+}
+
+bool saveChessboardLayout(const uint8_t* p_layout) {
+    if (!isScanLayoutValid(p_layout))
+        return false;
+
+    for (uint8_t square = 0; square < 64; square++) {
+        s_layout[square] = p_layout[square];
+        EEPROM.update(EEPROM_LAYOUT_ADDRESS + 1 + square, p_layout[square]);
+    }
+    EEPROM.update(EEPROM_LAYOUT_ADDRESS, EEPROM_LAYOUT_MAGIC);
+    return true;
+}
+
+static uint8_t readJournalByte(uint16_t p_address) {
+    return EEPROM.read(p_address);
+}
+
+static void writeJournalByte(uint16_t p_address, uint8_t p_value) {
+    // Unchanged bytes are not written again
+    EEPROM.update(p_address, p_value);
+}
+
+static bool isJournalReady() {
+    return eeprom_is_ready();
+}
 
-    return state;
+static const JournalStorage s_journalStorage = {&readJournalByte, &writeJournalByte, &isJournalReady, EEPROM_JOURNAL_ADDRESS};
+
+const JournalStorage* getJournalStorage() {
+    return &s_journalStorage;
 }
 
 uint64_t stabilizeBoardState(uint64_t p_boardState) {
     return stabilizeValue(p_boardState, millis(), STABLE_BOARD_DELAY_MS);
-}
\ No newline at end of file
+}
+
+// Sections placed in RAM by the linker
+extern "C" char __data_start;
+extern "C" char __data_end;
+extern "C" char __bss_start;
+extern "C" char __bss_end;
+extern "C" char __heap_start;
+extern "C" char* __brkval;
+extern "C" char __stack; // Last byte of RAM
+
+// Free RAM is painted once, the stack peak is where the paint ends
+constexpr uint8_t STACK_PAINT        = 0xC5;
+constexpr uint8_t STACK_PAINT_MARGIN = 16; // Frame of paintStack
+
+static const char* getHeapEnd() {
+    return (nullptr != __brkval) ? __brkval : &__heap_start;
+}
+
+void paintStack() {
+    char* end = reinterpret_cast<char*>(SP) - STACK_PAINT_MARGIN;
+    for (char* byte = const_cast<char*>(getHeapEnd()); byte < end; byte++)
+        *byte = STACK_PAINT;
+}
+
+void getRamUsage(RamUsage* p_usage) {
+    const char* stack   = reinterpret_cast<const char*>(SP);
+    const char* heapEnd = getHeapEnd();
+    const char* peak    = heapEnd;
+    while (peak < stack && STACK_PAINT == (uint8_t)*peak)
+        peak++;
+
+    p_usage->data      = &__data_end - &__data_start;
+    p_usage->bss       = &__bss_end - &__bss_start;
+    p_usage->heap      = heapEnd - &__heap_start;
+    p_usage->free      = stack - heapEnd;
+    p_usage->stackPeak = &__stack - peak + 1;
+}
+
+void sleepUntilInterrupt() {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+}
+
+static void writeLcdNibble(uint8_t p_nibble, bool p_data) {
+#if defined(USE_FAST_GPIO)
+    FastGPIO::Pin<PIN_LCD_RS>::setOutputValue(p_data);
+    FastGPIO::Pin<PIN_LCD_D0>::setOutputValue(p_nibble & 0x01);
+    FastGPIO::Pin<PIN_LCD_D1>::setOutputValue(p_nibble & 0x02);
+    FastGPIO::Pin<PIN_LCD_D2>::setOutputValue(p_nibble & 0x04);
+    FastGPIO::Pin<PIN_LCD_D3>::setOutputValue(p_nibble & 0x08);
+    FastGPIO::Pin<PIN_LCD_EN>::setOutputValueHigh();
+    delayMicroseconds(1);
+    FastGPIO::Pin<PIN_LCD_EN>::setOutputValueLow();
+#else
+    digitalWrite(PIN_LCD_RS, p_data ? HIGH : LOW);
+    digitalWrite(PIN_LCD_D0, (p_nibble & 0x01) ? HIGH : LOW);
+    digitalWrite(PIN_LCD_D1, (p_nibble & 0x02) ? HIGH : LOW);
+    digitalWrite(PIN_LCD_D2, (p_nibble & 0x04) ? HIGH : LOW);
+    digitalWrite(PIN_LCD_D3, (p_nibble & 0x08) ? HIGH : LOW);
+    digitalWrite(PIN_LCD_EN, HIGH);
+    delayMicroseconds(1);
+    digitalWrite(PIN_LCD_EN, LOW);
+#endif
+}
+
+static void waitTwi() {
+    while (0 == (TWCR & _BV(TWINT))) {
+    }
+}
+
+static void writeI2cPolled(EI2cAction p_action, uint8_t p_byte) {
+    switch (p_action) {
+    case I2cStart:
+        TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN);
+        waitTwi();
+        TWDR = p_byte;
+        TWCR = _BV(TWINT) | _BV(TWEN);
+        waitTwi();
+        break;
+    case I2cWrite:
+        TWDR = p_byte;
+        TWCR = _BV(TWINT) | _BV(TWEN);
+        waitTwi();
+        break;
+    case I2cStop:
+        TWCR = TWI_STOP;
+        break;
+    default:
+        break;
+    }
+}
+
+static const DisplayBus s_polledBus PROGMEM = {&writeLcdNibble, &writeI2cPolled};
+
+void initDisplayTransfers() {
+    initializeDisplayTransfers(&s_transfers, s_lcdQueue, LCD_QUEUE_SIZE, s_i2cQueue, I2C_QUEUE_SIZE);
+
+    // I2C at 400 kHz
+    TWSR = 0;
+    TWBR = TWI_BITRATE;
+    TWCR = _BV(TWEN);
+
+#if defined(USE_DISPLAY_INTERRUPTS)
+    // Timer 3 in CTC mode: 16 MHz / 8 / 100 = 50 us period for LCD nibbles, its interrupt is only enabled while
+    // nibbles are queued (kickLcdTransfers) so that it does not wake the idle sleep
+    noInterrupts();
+    TCCR3A = 0;
+    TCCR3B = _BV(WGM32) | _BV(CS31);
+    OCR3A  = (F_CPU / 8 / 1000000) * LCD_TICK_US - 1;
+    interrupts();
+#endif
+}
+
+DisplayTransfers* getDisplayTransfers() {
+    return &s_transfers;
+}
+
+void kickLcdTransfers() {
+#if defined(USE_DISPLAY_INTERRUPTS)
+    if (0 == getTransferCount(&s_transfers.lcd))
+        return;
+
+    noInterrupts();
+    TIMSK3 |= _BV(OCIE3A);
+    interrupts();
+#endif
+}
+
+void kickI2cTransfers() {
+#if defined(USE_DISPLAY_INTERRUPTS)
+    if (s_i2cBusy)
+        return;
+
+    uint8_t address = 0;
+    if (I2cStart == nextI2cAction(&s_transfers, &address)) {
+        s_i2cAddress = address;
+        s_i2cBusy    = true;
+        TWCR         = TWI_START;
+    }
+#endif
+}
+
+void serviceDisplayTransfers(uint16_t p_budget_us) {
+#if !defined(USE_DISPLAY_INTERRUPTS)
+    DisplayBus bus;
+    memcpy_P(&bus, &s_polledBus, sizeof(bus));
+    serviceTransferSlice(&s_transfers, micros(), p_budget_us, &bus);
+#endif
+}
+
+static void waitI2cSpace(uint8_t p_space) {
+    // Only happens when displays are initialized, runtime writers check the space first
+    while (getTransferSpace(&s_transfers.i2c) < p_space) {
+#if defined(USE_DISPLAY_INTERRUPTS)
+        kickI2cTransfers();
+#else
+        serviceDisplayTransfers(1000);
+#endif
+    }
+}
+
+extern "C" uint8_t u8x8_byte_queued_i2c(u8x8_t* p_u8x8, uint8_t p_msg, uint8_t p_argInt, void* p_argPtr) {
+    switch (p_msg) {
+    case U8X8_MSG_BYTE_SEND:
+        queueWaitingI2cBytes(&s_transfers, static_cast<const uint8_t*>(p_argPtr), p_argInt, &waitI2cSpace);
+        break;
+    case U8X8_MSG_BYTE_START_TRANSFER:
+        beginWaitingI2cFrame(&s_transfers, u8x8_GetI2CAddress(p_u8x8), &waitI2cSpace);
+        break;
+    case U8X8_MSG_BYTE_END_TRANSFER:
+        endI2cFrame(&s_transfers);
+        kickI2cTransfers();
+        break;
+    case U8X8_MSG_BYTE_INIT:
+    case U8X8_MSG_BYTE_SET_DC:
+        break;
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+#if defined(USE_DISPLAY_INTERRUPTS)
+ISR(TIMER3_COMPA_vect) {
+    // Send LCD nibbles until the controller is busy
+    s_lcdClock_us += LCD_TICK_US;
+    uint32_t now_us = s_lcdClock_us;
+    uint16_t used   = 0;
+    while ((used = serviceLcdTransfer(&s_transfers, now_us, &writeLcdNibble)) > 0)
+        now_us += used;
+
+    // Stopped once the queue is sent, kickLcdTransfers starts it again. The LCD clock stands still meanwhile: the
+    // end of the last instruction is still waited for after the restart.
+    if (0 == getTransferCount(&s_transfers.lcd))
+        TIMSK3 &= ~_BV(OCIE3A);
+}
+
+ISR(TWI_vect) {
+    const uint8_t status = TWSR & 0xF8;
+    if (status == 0x08 || status == 0x10) {
+        // (Repeated) start sent: send address
+        TWDR = s_i2cAddress;
+        TWCR = TWI_SEND;
+        return;
+    }
+
+    if (status != 0x18 && status != 0x28) {
+        // Address or data not acknowledged, arbitration lost: skip the frame
+        abortI2cFrame(&s_transfers);
+    }
+
+    uint8_t byte = 0;
+    if (I2cWrite == nextI2cAction(&s_transfers, &byte)) {
+        TWDR = byte;
+        TWCR = TWI_SEND;
+        return;
+    }
+
+    // End of frame: chain the next one if any
+    if (I2cStart == nextI2cAction(&s_transfers, &byte)) {
+        s_i2cAddress = byte;
+        TWCR         = TWI_STOP_START;
+    } else {
+        TWCR      = TWI_STOP;
+        s_i2cBusy = false;
+    }
+}
+#endif
+
+ISR(ADC_vect) {
+    const uint16_t value = ADC;
+    if (++s_keypadDecimation < KEYPAD_DECIMATION)
+        return;
+    s_keypadDecimation = 0;
+    updateKeypad(&s_keypad, value);
+}
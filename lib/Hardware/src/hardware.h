@@ -3,6 +3,9 @@
 #include <Arduino.h>
 #include <LiquidCrystal.h>
 #include <U8g2lib.h>
+#include <journal.h>
+#include <keypad.h>
+#include <transfer.h>
 
 // Whether sensor power should be controlled
 #define USE_POWER_CTRL
@@ -13,6 +16,9 @@
 // Hardware revision of the chessboard
 #define CHESSBOARD_REV_A_JUMPED
 
+// Whether display transfers are sent from interrupts (TWI and timer 3), otherwise serviceDisplayTransfers() must be called
+#define USE_DISPLAY_INTERRUPTS
+
 // Pin definitions for LCD (not sure how to move these to .cpp file)
 constexpr uint8_t PIN_LCD_RS = 8;
 constexpr uint8_t PIN_LCD_EN = 9;
@@ -21,27 +27,78 @@ constexpr uint8_t PIN_LCD_D1 = 5;
 constexpr uint8_t PIN_LCD_D2 = 6;
 constexpr uint8_t PIN_LCD_D3 = 7;
 
-// LCD buttons
-enum LCD_KEY {
-    None = 0,
-    Select,
-    Up,
-    Down,
-    Left,
-    Right,
-};
-
-// Gets current pressed LCD button
+// Gets current pressed LCD button (debounced)
 LCD_KEY getLcdKeyPressed();
 
-// Gets last rising edge on an LCD button
+// Gets last rising edge on an LCD button, other events are skipped
 LCD_KEY getLastLcdKeyPressed();
 
+// Gets next LCD button event (press, release, long press), false if there is none
+bool getLcdKeyEvent(KeypadEvent* p_event);
+
+// Number of LCD button events lost because the main loop did not consume them
+uint8_t getLcdKeyDroppedCount();
+
 // Initialize chessboard
 void initChessboard();
 
 // Read current state of chessboard, LSB=A1, B1... MSB = H8
 uint64_t readChessboard();
 
+// Read the sensors in scan order (SCAN_RAW_BYTES bytes), for calibration
+void readRawChessboard(uint8_t* p_raw);
+
+// Use the calibrated layout saved in EEPROM, or the one of the board revision
+void loadChessboardLayout();
+
+// Use a calibrated layout and save it to EEPROM, false if it is not a valid layout
+bool saveChessboardLayout(const uint8_t* p_layout);
+
+// EEPROM bytes of the game journal, after the calibrated layout (each byte is written in the background)
+const JournalStorage* getJournalStorage();
+
 // Stabilize the chessboard state
 uint64_t stabilizeBoardState(uint64_t p_boardState);
+
+// RAM usage in bytes: constants left out of flash are part of data
+typedef struct {
+    uint16_t data;      // Initialized variables
+    uint16_t bss;       // Zero-initialized variables
+    uint16_t heap;
+    uint16_t free;      // Between the heap and the current stack
+    uint16_t stackPeak; // Deepest stack since paintStack()
+} RamUsage;
+
+// Paint the free RAM for the stack peak of getRamUsage(), first thing in setup()
+void paintStack();
+
+void getRamUsage(RamUsage* p_usage);
+
+// Idle sleep until the next interrupt (timer 0 wakes the MCU every 1024 us), peripherals keep running
+void sleepUntilInterrupt();
+
+// Initialize display transfer queues and bus interrupts, to be called before displays are started
+void initDisplayTransfers();
+
+// Get display transfer queues
+DisplayTransfers* getDisplayTransfers();
+
+// Start sending queued LCD nibbles if the timer interrupt is stopped
+void kickLcdTransfers();
+
+// Start sending queued I2C frames if the bus is idle
+void kickI2cTransfers();
+
+// Send queued display transfers for at most p_budget_us (without display interrupts)
+void serviceDisplayTransfers(uint16_t p_budget_us);
+
+// u8x8 byte procedure queuing I2C frames instead of waiting for the bus
+extern "C" uint8_t u8x8_byte_queued_i2c(u8x8_t* p_u8x8, uint8_t p_msg, uint8_t p_argInt, void* p_argPtr);
+
+// SSD1306 128x32 OLED sent through the display transfer queues
+class U8X8_SSD1306_128X32_UNIVISION_QUEUED_I2C : public U8X8 {
+  public:
+    U8X8_SSD1306_128X32_UNIVISION_QUEUED_I2C() : U8X8() {
+        u8x8_Setup(getU8x8(), u8x8_d_ssd1306_128x32_univision, u8x8_cad_ssd13xx_fast_i2c, u8x8_byte_queued_i2c, u8x8_gpio_and_delay_arduino);
+    }
+};
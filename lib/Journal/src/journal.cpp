@@ -0,0 +1,362 @@
+#include "journal.h"
+
+#include <eval.h>
+#include <movegen.h>
+
+// Checkpoint record: position after the move record sequence - 1, the move records continue at moveSlot
+constexpr uint8_t CHECKPOINT_GENERATION = 0;  // 2 bytes, the last checkpoint has the highest one
+constexpr uint8_t CHECKPOINT_SEQUENCE   = 2;  // 2 bytes
+constexpr uint8_t CHECKPOINT_MOVE_SLOT  = 4;
+constexpr uint8_t CHECKPOINT_BOARD      = 5;  // 32 bytes, two squares per byte (a1 in the low nibble)
+constexpr uint8_t CHECKPOINT_STATUS     = 37;
+constexpr uint8_t CHECKPOINT_EN_PASSANT = 38;
+constexpr uint8_t CHECKPOINT_CASTLING   = 39; // castlingK then castlingQ, white in the lower bit
+constexpr uint8_t CHECKPOINT_FULLMOVE   = 40;
+constexpr uint8_t CHECKPOINT_HALFMOVE   = 41;
+constexpr uint8_t CHECKPOINT_LAST_MOVES = 42; // 3 bytes each, white then black
+constexpr uint8_t CHECKPOINT_CRC        = 48; // 2 bytes, CRC-16 of the bytes before
+
+// Move record: sequence (12 bits), start and end squares (6 bits each), then CRC-8 of the 3 bytes
+constexpr uint8_t MOVE_CRC = 3;
+
+// CRCs start from all ones: erased (0xFF) and zeroed records are not valid
+constexpr uint8_t CRC8_POLYNOMIAL   = 0x07;
+constexpr uint16_t CRC16_POLYNOMIAL = 0x1021; // CCITT
+
+constexpr uint8_t NO_SQUARE = 64;
+
+//-----------------------------------------------------------------------------
+static uint8_t updateCrc8(uint8_t p_crc, uint8_t p_byte)
+//-----------------------------------------------------------------------------
+{
+    p_crc ^= p_byte;
+    for (uint8_t bit = 0; bit < 8; bit++)
+        p_crc = (p_crc & 0x80) ? (p_crc << 1) ^ CRC8_POLYNOMIAL : (p_crc << 1);
+    return p_crc;
+}
+
+//-----------------------------------------------------------------------------
+static uint16_t updateCrc16(uint16_t p_crc, uint8_t p_byte)
+//-----------------------------------------------------------------------------
+{
+    p_crc ^= (uint16_t)p_byte << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+        p_crc = (p_crc & 0x8000) ? (p_crc << 1) ^ CRC16_POLYNOMIAL : (p_crc << 1);
+    return p_crc;
+}
+
+//-----------------------------------------------------------------------------
+static uint16_t getCheckpointAddress(const JournalStorage* p_storage, uint8_t p_slot)
+//-----------------------------------------------------------------------------
+{
+    return p_storage->address + p_slot * JOURNAL_CHECKPOINT_SIZE;
+}
+
+//-----------------------------------------------------------------------------
+static uint16_t getMoveAddress(const JournalStorage* p_storage, uint8_t p_slot)
+//-----------------------------------------------------------------------------
+{
+    return p_storage->address + JOURNAL_CHECKPOINT_SLOTS * JOURNAL_CHECKPOINT_SIZE + p_slot * JOURNAL_MOVE_SIZE;
+}
+
+//-----------------------------------------------------------------------------
+static uint16_t readWord(const JournalStorage* p_storage, uint16_t p_address)
+//-----------------------------------------------------------------------------
+{
+    return p_storage->read(p_address) | ((uint16_t)p_storage->read(p_address + 1) << 8);
+}
+
+//-----------------------------------------------------------------------------
+static uint64_t getOccupancy(const EPiece* p_board)
+//-----------------------------------------------------------------------------
+{
+    uint64_t occupancy = 0;
+    for (uint8_t i = 0; i < 64; i++) {
+        if (Empty != p_board[i])
+            occupancy |= (1uLL << i);
+    }
+    return occupancy;
+}
+
+//-----------------------------------------------------------------------------
+static void encodeMove(const Move* p_move, uint8_t* p_bytes)
+//-----------------------------------------------------------------------------
+{
+    p_bytes[0] = p_move->start | (p_move->captured << 6) | (p_move->check << 7);
+    p_bytes[1] = p_move->end | (p_move->promotion << 6) | (p_move->checkmate << 7);
+    p_bytes[2] = (uint8_t)p_move->piece;
+}
+
+//-----------------------------------------------------------------------------
+static void decodeMove(const JournalStorage* p_storage, uint16_t p_address, Move* p_move)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t start = p_storage->read(p_address);
+    const uint8_t end   = p_storage->read(p_address + 1);
+    p_move->start       = start & 0x3F;
+    p_move->end         = end & 0x3F;
+    p_move->piece       = static_cast<EPiece>(p_storage->read(p_address + 2) & 0x0F);
+    p_move->captured    = 0 != (start & 0x40);
+    p_move->check       = 0 != (start & 0x80);
+    p_move->promotion   = 0 != (end & 0x40);
+    p_move->checkmate   = 0 != (end & 0x80);
+}
+
+//-----------------------------------------------------------------------------
+static bool isCheckpointValid(const JournalStorage* p_storage, uint8_t p_slot)
+//-----------------------------------------------------------------------------
+{
+    const uint16_t address = getCheckpointAddress(p_storage, p_slot);
+    uint16_t crc           = 0xFFFF;
+    for (uint8_t i = 0; i < CHECKPOINT_CRC; i++)
+        crc = updateCrc16(crc, p_storage->read(address + i));
+    return crc == readWord(p_storage, address + CHECKPOINT_CRC);
+}
+
+//-----------------------------------------------------------------------------
+static void loadCheckpoint(const JournalStorage* p_storage, uint8_t p_slot, Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    const uint16_t address = getCheckpointAddress(p_storage, p_slot);
+    for (uint8_t i = 0; i < 32; i++) {
+        const uint8_t squares    = p_storage->read(address + CHECKPOINT_BOARD + i);
+        p_game->board[2 * i]     = static_cast<EPiece>(squares & 0x0F);
+        p_game->board[2 * i + 1] = static_cast<EPiece>(squares >> 4);
+    }
+
+    const uint8_t castling        = p_storage->read(address + CHECKPOINT_CASTLING);
+    p_game->state.removed_1.index = NO_SQUARE;
+    p_game->state.removed_1.piece = Empty;
+    p_game->state.removed_2.index = NO_SQUARE;
+    p_game->state.removed_2.piece = Empty;
+    p_game->state.status          = p_storage->read(address + CHECKPOINT_STATUS);
+    p_game->state.en_passant      = p_storage->read(address + CHECKPOINT_EN_PASSANT);
+    p_game->state.castlingK[0]    = 0 != (castling & 0x01);
+    p_game->state.castlingK[1]    = 0 != (castling & 0x02);
+    p_game->state.castlingQ[0]    = 0 != (castling & 0x04);
+    p_game->state.castlingQ[1]    = 0 != (castling & 0x08);
+    p_game->fullmoveClock         = p_storage->read(address + CHECKPOINT_FULLMOVE);
+    p_game->halfmoveClock         = p_storage->read(address + CHECKPOINT_HALFMOVE);
+    decodeMove(p_storage, address + CHECKPOINT_LAST_MOVES, &p_game->lastMoveW);
+    decodeMove(p_storage, address + CHECKPOINT_LAST_MOVES + 3, &p_game->lastMoveB);
+    initializeEvaluation(&p_game->evaluation, p_game->board);
+    initializeAttackMaps(p_game);
+    updateCheckersAndPins(p_game);
+}
+
+//-----------------------------------------------------------------------------
+static bool readMoveRecord(const JournalStorage* p_storage, uint8_t p_slot, uint16_t p_sequence, uint8_t* p_start, uint8_t* p_end)
+//-----------------------------------------------------------------------------
+{
+    const uint16_t address = getMoveAddress(p_storage, p_slot);
+    uint8_t bytes[MOVE_CRC];
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < MOVE_CRC; i++) {
+        bytes[i] = p_storage->read(address + i);
+        crc      = updateCrc8(crc, bytes[i]);
+    }
+    if (crc != p_storage->read(address + MOVE_CRC))
+        return false; // Torn or never written
+
+    const uint32_t record = bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16);
+    *p_start              = (record >> 12) & 0x3F;
+    *p_end                = (record >> 18) & 0x3F;
+    return p_sequence == (record & JOURNAL_SEQUENCE_MASK); // Otherwise left from a previous round of the ring
+}
+
+//-----------------------------------------------------------------------------
+static void queueCheckpoint(Journal* p_journal, Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    uint8_t* record = &p_journal->pending[JOURNAL_MOVE_SIZE];
+    p_journal->generation++;
+
+    record[CHECKPOINT_GENERATION]     = p_journal->generation & 0xFF;
+    record[CHECKPOINT_GENERATION + 1] = p_journal->generation >> 8;
+    record[CHECKPOINT_SEQUENCE]       = p_journal->sequence & 0xFF;
+    record[CHECKPOINT_SEQUENCE + 1]   = p_journal->sequence >> 8;
+    record[CHECKPOINT_MOVE_SLOT]      = p_journal->moveSlot;
+    for (uint8_t i = 0; i < 32; i++)
+        record[CHECKPOINT_BOARD + i] = (uint8_t)p_game->board[2 * i] | ((uint8_t)p_game->board[2 * i + 1] << 4);
+    record[CHECKPOINT_STATUS]     = p_game->state.status;
+    record[CHECKPOINT_EN_PASSANT] = p_game->state.en_passant;
+    record[CHECKPOINT_CASTLING]   = (p_game->state.castlingK[0] << 0) | (p_game->state.castlingK[1] << 1) | (p_game->state.castlingQ[0] << 2) | (p_game->state.castlingQ[1] << 3);
+    record[CHECKPOINT_FULLMOVE]   = p_game->fullmoveClock;
+    record[CHECKPOINT_HALFMOVE]   = p_game->halfmoveClock;
+    encodeMove(&p_game->lastMoveW, &record[CHECKPOINT_LAST_MOVES]);
+    encodeMove(&p_game->lastMoveB, &record[CHECKPOINT_LAST_MOVES + 3]);
+
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < CHECKPOINT_CRC; i++)
+        crc = updateCrc16(crc, record[i]);
+    record[CHECKPOINT_CRC]     = crc & 0xFF;
+    record[CHECKPOINT_CRC + 1] = crc >> 8;
+
+    p_journal->pendingCheckpointAddress = getCheckpointAddress(p_journal->storage, p_journal->checkpointSlot);
+    p_journal->pendingEnd               = JOURNAL_MOVE_SIZE + JOURNAL_CHECKPOINT_SIZE;
+    p_journal->checkpointSlot           = (p_journal->checkpointSlot + 1) % JOURNAL_CHECKPOINT_SLOTS;
+    p_journal->movesSinceCheckpoint     = 0;
+}
+
+//-----------------------------------------------------------------------------
+static void writePendingByte(Journal* p_journal)
+//-----------------------------------------------------------------------------
+{
+    // Bytes in record order: the CRC is written last
+    const uint8_t index = p_journal->pendingIndex++;
+    if (index < JOURNAL_MOVE_SIZE)
+        p_journal->storage->write(p_journal->pendingMoveAddress + index, p_journal->pending[index]);
+    else
+        p_journal->storage->write(p_journal->pendingCheckpointAddress + index - JOURNAL_MOVE_SIZE, p_journal->pending[index]);
+}
+
+//-----------------------------------------------------------------------------
+bool resumeJournal(Journal* p_journal, const JournalStorage* p_storage, Game* p_game, uint64_t p_sensors)
+//-----------------------------------------------------------------------------
+{
+    p_journal->storage              = p_storage;
+    p_journal->generation           = 0;
+    p_journal->sequence             = 0;
+    p_journal->moveSlot             = 0;
+    p_journal->checkpointSlot       = 0;
+    p_journal->movesSinceCheckpoint = 0;
+    p_journal->pendingIndex         = 0;
+    p_journal->pendingEnd           = 0;
+
+    // 1. Last checkpoint
+    uint8_t last = JOURNAL_CHECKPOINT_SLOTS;
+    for (uint8_t slot = 0; slot < JOURNAL_CHECKPOINT_SLOTS; slot++) {
+        if (!isCheckpointValid(p_storage, slot))
+            continue;
+
+        const uint16_t generation = readWord(p_storage, getCheckpointAddress(p_storage, slot) + CHECKPOINT_GENERATION);
+        if (JOURNAL_CHECKPOINT_SLOTS == last || (int16_t)(generation - p_journal->generation) > 0) {
+            last                  = slot;
+            p_journal->generation = generation;
+        }
+    }
+    if (JOURNAL_CHECKPOINT_SLOTS == last)
+        return false;
+
+    const uint16_t address    = getCheckpointAddress(p_storage, last);
+    p_journal->checkpointSlot = (last + 1) % JOURNAL_CHECKPOINT_SLOTS;
+    p_journal->sequence       = readWord(p_storage, address + CHECKPOINT_SEQUENCE) & JOURNAL_SEQUENCE_MASK;
+    p_journal->moveSlot       = p_storage->read(address + CHECKPOINT_MOVE_SLOT) % JOURNAL_MOVE_SLOTS;
+
+    // 2. Its position, then the moves after it up to the first torn or older record. Replayed in p_game: a Game on
+    // the stack would take more than the game analysis does.
+    loadCheckpoint(p_storage, last, p_game);
+    while (p_journal->movesSinceCheckpoint < JOURNAL_MOVE_SLOTS) {
+        uint8_t start;
+        uint8_t end;
+        if (!readMoveRecord(p_storage, p_journal->moveSlot, p_journal->sequence, &start, &end))
+            break;
+
+        const Move move = BUILD_MOVE(start, end, p_game->board[start]);
+        if (!isLegalMove(p_game, move))
+            break;
+
+        const bool white = (bits::White == (p_game->state.status & bits::ColorMask));
+        playMove(p_game, move);
+        updateCheckState(p_game, white ? &p_game->lastMoveW : &p_game->lastMoveB);
+
+        p_journal->sequence = (p_journal->sequence + 1) & JOURNAL_SEQUENCE_MASK;
+        p_journal->moveSlot = (p_journal->moveSlot + 1) % JOURNAL_MOVE_SLOTS;
+        p_journal->movesSinceCheckpoint++;
+    }
+
+    // 3. Only if the pieces are where they were
+    return p_sensors == getOccupancy(p_game->board);
+}
+
+//-----------------------------------------------------------------------------
+void recordJournalCheckpoint(Journal* p_journal, Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_journal || nullptr == p_journal->storage || nullptr == p_game)
+        return;
+
+    flushJournal(p_journal);
+    queueCheckpoint(p_journal, p_game);
+    p_journal->pendingIndex = JOURNAL_MOVE_SIZE;
+}
+
+//-----------------------------------------------------------------------------
+void recordJournalMove(Journal* p_journal, Game* p_game, const Move* p_move)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_journal || nullptr == p_journal->storage || nullptr == p_game || nullptr == p_move)
+        return;
+
+    flushJournal(p_journal);
+    const uint32_t record = p_journal->sequence | ((uint32_t)p_move->start << 12) | ((uint32_t)p_move->end << 18);
+    uint8_t crc           = 0xFF;
+    for (uint8_t i = 0; i < MOVE_CRC; i++) {
+        p_journal->pending[i] = (record >> (8 * i)) & 0xFF;
+        crc                   = updateCrc8(crc, p_journal->pending[i]);
+    }
+    p_journal->pending[MOVE_CRC] = crc;
+
+    p_journal->pendingMoveAddress = getMoveAddress(p_journal->storage, p_journal->moveSlot);
+    p_journal->pendingIndex       = 0;
+    p_journal->pendingEnd         = JOURNAL_MOVE_SIZE;
+    p_journal->sequence           = (p_journal->sequence + 1) & JOURNAL_SEQUENCE_MASK;
+    p_journal->moveSlot           = (p_journal->moveSlot + 1) % JOURNAL_MOVE_SLOTS;
+    p_journal->movesSinceCheckpoint++;
+
+    // Checkpoint written after the move: if it is torn, the previous one and the moves after it are replayed
+    if (p_journal->movesSinceCheckpoint >= JOURNAL_CHECKPOINT_MOVES)
+        queueCheckpoint(p_journal, p_game);
+}
+
+//-----------------------------------------------------------------------------
+bool evolveJournaledGame(Journal* p_journal, SignatureTable* p_table, Game* p_game, uint64_t p_sensors, bool* p_changed)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr != p_changed)
+        *p_changed = false;
+    if (nullptr == p_game)
+        return false;
+
+    const uint8_t fromStatus = p_game->state.status;
+    const uint8_t removed_1  = p_game->state.removed_1.index;
+    const uint8_t removed_2  = p_game->state.removed_2.index;
+    const bool evolved       = evolveGameWithSignatures(p_table, p_game, p_sensors);
+    const uint8_t status     = p_game->state.status;
+
+    // Steps change the status or the lifted pieces, as for evolveLoggedGame
+    if (nullptr != p_changed)
+        *p_changed = evolved || fromStatus != status || removed_1 != p_game->state.removed_1.index || removed_2 != p_game->state.removed_2.index;
+
+    // The last move of the player changes on intermediate steps too (landing of an en passant pawn or of a
+    // castling king): only a call giving the turn to the other player completes it
+    const uint8_t player = fromStatus & bits::ColorMask;
+    if (!evolved || bits::ToPlay != (status & bits::MoveMask) || player == (status & bits::ColorMask))
+        return false;
+
+    recordJournalMove(p_journal, p_game, (bits::White == player) ? &p_game->lastMoveW : &p_game->lastMoveB);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool serviceJournal(Journal* p_journal)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_journal || nullptr == p_journal->storage)
+        return false;
+
+    while (p_journal->pendingIndex < p_journal->pendingEnd && p_journal->storage->isReady())
+        writePendingByte(p_journal);
+    return p_journal->pendingIndex < p_journal->pendingEnd;
+}
+
+//-----------------------------------------------------------------------------
+void flushJournal(Journal* p_journal)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_journal || nullptr == p_journal->storage)
+        return;
+
+    while (p_journal->pendingIndex < p_journal->pendingEnd)
+        writePendingByte(p_journal);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chess.h>
+#include <signature.h>
+#include <stdint.h>
+
+// Game journal in EEPROM, to resume the game after a power loss. Committed moves are appended as 4-byte
+// records, and the position is saved as a checkpoint every JOURNAL_CHECKPOINT_MOVES moves and on new games.
+// Moves and checkpoints go round their own ring of slots: every slot is written once per JOURNAL_MOVE_SLOTS
+// moves. Records are protected by a CRC, a record torn by a power loss is ignored along with the moves after it.
+// Portable, the firmware gives the EEPROM access functions.
+constexpr uint8_t JOURNAL_MOVE_SIZE        = 4;
+constexpr uint8_t JOURNAL_CHECKPOINT_SIZE  = 50;
+constexpr uint8_t JOURNAL_MOVE_SLOTS       = 128;
+constexpr uint8_t JOURNAL_CHECKPOINT_SLOTS = 8;
+constexpr uint8_t JOURNAL_CHECKPOINT_MOVES = JOURNAL_MOVE_SLOTS / JOURNAL_CHECKPOINT_SLOTS; // Same wear as moves
+constexpr uint16_t JOURNAL_SIZE            = JOURNAL_CHECKPOINT_SLOTS * JOURNAL_CHECKPOINT_SIZE + JOURNAL_MOVE_SLOTS * JOURNAL_MOVE_SIZE;
+constexpr uint16_t JOURNAL_SEQUENCE_MASK   = 0x0FFF; // Move records are numbered on 12 bits
+
+typedef uint8_t (*JournalReader)(uint16_t p_address);
+typedef void (*JournalWriter)(uint16_t p_address, uint8_t p_value);
+typedef bool (*JournalReadyCheck)(); // Whether a byte can be written without waiting for the previous one
+
+typedef struct {
+    JournalReader read;
+    JournalWriter write;
+    JournalReadyCheck isReady;
+    uint16_t address; // First of the JOURNAL_SIZE bytes
+} JournalStorage;
+
+typedef struct {
+    const JournalStorage* storage;
+    uint16_t generation;          // Of the last checkpoint
+    uint16_t sequence;            // Of the next move record
+    uint8_t moveSlot;             // Of the next move record
+    uint8_t checkpointSlot;       // Of the next checkpoint
+    uint8_t movesSinceCheckpoint; // Moves to replay after the last checkpoint
+
+    // Records waiting to be written in the background: a move record then a checkpoint, either can be left out
+    uint8_t pending[JOURNAL_MOVE_SIZE + JOURNAL_CHECKPOINT_SIZE];
+    uint16_t pendingMoveAddress;
+    uint16_t pendingCheckpointAddress;
+    uint8_t pendingIndex; // Next byte to write
+    uint8_t pendingEnd;
+} Journal;
+
+// Read the journal at boot: the last checkpoint and the moves after it are played on p_game. Returns false if there
+// is no checkpoint (p_game untouched), or if the pieces are not on the squares of p_sensors (board changed while
+// switched off, p_game is left with the journaled game and has to be initialized again); the journal then goes on
+// after its last records.
+bool resumeJournal(Journal* p_journal, const JournalStorage* p_storage, Game* p_game, uint64_t p_sensors);
+
+// Journal a new game, or any position the moves do not lead to
+void recordJournalCheckpoint(Journal* p_journal, Game* p_game);
+
+// Journal a committed move, p_game is the game after it (a checkpoint is added every JOURNAL_CHECKPOINT_MOVES)
+void recordJournalMove(Journal* p_journal, Game* p_game, const Move* p_move);
+
+// Evolve the game as evolveGameWithSignatures does (p_table optional: evolveGame) and journal the move the call
+// completed, once the other player is to play: en passant and castling steps are not journaled on their own.
+// Returns true if a move was completed. p_changed (optional) tells whether the call changed the game: evolveGame
+// follows one removed or placed square per call, the call is repeated with the same sensors until it does not.
+bool evolveJournaledGame(Journal* p_journal, SignatureTable* p_table, Game* p_game, uint64_t p_sensors, bool* p_changed);
+
+// Write pending bytes as long as the storage is ready, returns true if bytes are still pending
+bool serviceJournal(Journal* p_journal);
+
+// Write all pending bytes, waiting for the storage
+void flushJournal(Journal* p_journal);
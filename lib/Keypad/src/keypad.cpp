@@ -0,0 +1,96 @@
+#include "keypad.h"
+
+// Keep event accesses on their side of the head/tail updates
+#define KEYPAD_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+//-----------------------------------------------------------------------------
+LCD_KEY getKeyFromAdc(uint16_t p_value)
+//-----------------------------------------------------------------------------
+{
+    // Values are not exact but sufficiently precise
+    if (p_value < 100)
+        return LCD_KEY::Right;
+    else if (p_value < 250)
+        return LCD_KEY::Up;
+    else if (p_value < 380)
+        return LCD_KEY::Down;
+    else if (p_value < 600)
+        return LCD_KEY::Left;
+    else if (p_value < 900)
+        return LCD_KEY::Select;
+    else
+        return LCD_KEY::None;
+}
+
+//-----------------------------------------------------------------------------
+void initializeKeypad(Keypad* p_keypad)
+//-----------------------------------------------------------------------------
+{
+    p_keypad->candidate        = LCD_KEY::None;
+    p_keypad->candidateSamples = 0;
+    p_keypad->heldSamples      = 0;
+    p_keypad->key              = LCD_KEY::None;
+    p_keypad->head             = 0;
+    p_keypad->tail             = 0;
+    p_keypad->dropped          = 0;
+}
+
+//-----------------------------------------------------------------------------
+static void pushEvent(Keypad* p_keypad, LCD_KEY p_key, EKeypadEvent p_type)
+//-----------------------------------------------------------------------------
+{
+    // Single producer: the head is only published once the event is written
+    const uint8_t head = p_keypad->head;
+    if ((uint8_t)(head - p_keypad->tail) >= KEYPAD_QUEUE_SIZE) {
+        if (p_keypad->dropped < 0xFF)
+            p_keypad->dropped++;
+        return;
+    }
+    p_keypad->events[head & (KEYPAD_QUEUE_SIZE - 1)] = {p_key, p_type};
+    KEYPAD_BARRIER();
+    p_keypad->head = head + 1;
+}
+
+//-----------------------------------------------------------------------------
+void updateKeypad(Keypad* p_keypad, uint16_t p_value)
+//-----------------------------------------------------------------------------
+{
+    const LCD_KEY sampled = getKeyFromAdc(p_value);
+    if (sampled != p_keypad->candidate) {
+        p_keypad->candidate        = sampled;
+        p_keypad->candidateSamples = 1;
+    } else if (p_keypad->candidateSamples < KEYPAD_DEBOUNCE_SAMPLES) {
+        p_keypad->candidateSamples++;
+    }
+
+    const LCD_KEY key = p_keypad->key;
+    if (p_keypad->candidateSamples >= KEYPAD_DEBOUNCE_SAMPLES && sampled != key) {
+        // The ladder goes through other values between keys: the previous key is released first
+        if (LCD_KEY::None != key)
+            pushEvent(p_keypad, key, KeypadRelease);
+        if (LCD_KEY::None != sampled)
+            pushEvent(p_keypad, sampled, KeypadPress);
+        p_keypad->key         = sampled;
+        p_keypad->heldSamples = 0;
+        return;
+    }
+
+    if (LCD_KEY::None != key && p_keypad->heldSamples < KEYPAD_LONG_PRESS_SAMPLES) {
+        if (++p_keypad->heldSamples == KEYPAD_LONG_PRESS_SAMPLES)
+            pushEvent(p_keypad, key, KeypadLongPress);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool popKeypadEvent(Keypad* p_keypad, KeypadEvent* p_event)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t tail = p_keypad->tail;
+    if (tail == p_keypad->head)
+        return false;
+
+    *p_event = p_keypad->events[tail & (KEYPAD_QUEUE_SIZE - 1)];
+    KEYPAD_BARRIER();
+    p_keypad->tail = tail + 1;
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+// LCD buttons
+enum LCD_KEY {
+    None = 0,
+    Select,
+    Up,
+    Down,
+    Left,
+    Right,
+};
+
+// LCD keypad on a resistor ladder, sampled by a free-running ADC: samples are debounced from the ADC
+// interrupt and key edges are queued for the main loop. Portable, the firmware feeds it ADC values.
+constexpr uint16_t KEYPAD_SAMPLE_HZ          = 326;              // Samples given to updateKeypad
+constexpr uint8_t KEYPAD_DEBOUNCE_SAMPLES    = 6;                // Same key for 18 ms
+constexpr uint16_t KEYPAD_LONG_PRESS_SAMPLES = KEYPAD_SAMPLE_HZ; // Held for 1 s
+constexpr uint8_t KEYPAD_QUEUE_SIZE          = 8;                // Power of 2
+
+typedef enum {
+    KeypadPress = 0,
+    KeypadRelease,
+    KeypadLongPress,
+} EKeypadEvent;
+
+typedef struct {
+    LCD_KEY key;
+    EKeypadEvent type;
+} KeypadEvent;
+
+typedef struct {
+    // Debouncing, from the interrupt only
+    LCD_KEY candidate;
+    uint8_t candidateSamples;
+    uint16_t heldSamples;
+
+    volatile LCD_KEY key; // Debounced key
+    KeypadEvent events[KEYPAD_QUEUE_SIZE];
+    volatile uint8_t head; // Written by updateKeypad
+    volatile uint8_t tail; // Written by popKeypadEvent
+    volatile uint8_t dropped;
+} Keypad;
+
+// Key of a 10-bit ADC value of the ladder
+LCD_KEY getKeyFromAdc(uint16_t p_value);
+
+void initializeKeypad(Keypad* p_keypad);
+
+// Debounce one sample (ADC interrupt), queues press, release and long press events
+void updateKeypad(Keypad* p_keypad, uint16_t p_value);
+
+// Next event for the main loop, false if there is none
+bool popKeypadEvent(Keypad* p_keypad, KeypadEvent* p_event);
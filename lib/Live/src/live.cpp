@@ -0,0 +1,196 @@
+#include "live.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+static_assert(0 == sizeof(LiveSlot) % 64, "Slots take whole cache lines");
+
+constexpr uint16_t LIVE_SPINS_BEFORE_YIELD = 64;
+
+//-----------------------------------------------------------------------------
+static size_t getRegionSize(uint16_t p_boardCount)
+//-----------------------------------------------------------------------------
+{
+    return sizeof(LiveHeader) + (size_t)p_boardCount * sizeof(LiveSlot);
+}
+
+//-----------------------------------------------------------------------------
+static void mapRegion(LiveRegion* p_region, void* p_address, size_t p_size)
+//-----------------------------------------------------------------------------
+{
+    p_region->header = static_cast<LiveHeader*>(p_address);
+    p_region->slots  = reinterpret_cast<LiveSlot*>(static_cast<uint8_t*>(p_address) + sizeof(LiveHeader));
+    p_region->size   = p_size;
+}
+
+//-----------------------------------------------------------------------------
+bool createLiveRegion(LiveRegion* p_region, const char* p_name, uint16_t p_boardCount)
+//-----------------------------------------------------------------------------
+{
+    memset(p_region, 0, sizeof(LiveRegion));
+
+    // A region left by a previous writer is retired, its readers reopen the new one
+    LiveRegion previous;
+    if (openLiveRegion(&previous, p_name)) {
+        closeLiveRegion(&previous);
+        const int fd = shm_open(p_name, O_RDWR, 0);
+        if (fd >= 0) {
+            void* address = mmap(nullptr, sizeof(LiveHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (MAP_FAILED != address) {
+                static_cast<LiveHeader*>(address)->magic.store(0, std::memory_order_release);
+                munmap(address, sizeof(LiveHeader));
+            }
+            close(fd);
+        }
+    }
+    shm_unlink(p_name);
+
+    const int fd = shm_open(p_name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        return false;
+
+    const size_t size = getRegionSize(p_boardCount);
+    if (0 != ftruncate(fd, (off_t)size)) {
+        close(fd);
+        shm_unlink(p_name);
+        return false;
+    }
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == address)
+        return false;
+
+    // The file starts zeroed: every slot is at sequence 0, version 0
+    mapRegion(p_region, address, size);
+    p_region->header->version    = LIVE_VERSION;
+    p_region->header->boardCount = p_boardCount;
+    p_region->header->slotSize   = sizeof(LiveSlot);
+    p_region->header->magic.store(LIVE_MAGIC, std::memory_order_release);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool openLiveRegion(LiveRegion* p_region, const char* p_name)
+//-----------------------------------------------------------------------------
+{
+    memset(p_region, 0, sizeof(LiveRegion));
+    const int fd = shm_open(p_name, O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    if (0 != fstat(fd, &status) || (size_t)status.st_size < sizeof(LiveHeader)) {
+        close(fd);
+        return false;
+    }
+    const size_t size = (size_t)status.st_size;
+    void* address     = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == address)
+        return false;
+
+    mapRegion(p_region, address, size);
+    const LiveHeader* header = p_region->header;
+    if (LIVE_MAGIC != header->magic.load(std::memory_order_acquire) || LIVE_VERSION != header->version || sizeof(LiveSlot) != header->slotSize ||
+        size < getRegionSize(header->boardCount)) {
+        closeLiveRegion(p_region);
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void closeLiveRegion(LiveRegion* p_region)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr != p_region->header)
+        munmap(p_region->header, p_region->size);
+    memset(p_region, 0, sizeof(LiveRegion));
+}
+
+//-----------------------------------------------------------------------------
+void removeLiveRegion(const char* p_name)
+//-----------------------------------------------------------------------------
+{
+    shm_unlink(p_name);
+}
+
+//-----------------------------------------------------------------------------
+void publishLiveBoard(LiveRegion* p_region, uint16_t p_board, Game* p_game, uint64_t p_time_ns)
+//-----------------------------------------------------------------------------
+{
+    if (p_board >= p_region->header->boardCount)
+        return;
+
+    // Prepared outside of the update, readers only retry for the copy
+    LiveSlot* slot          = &p_region->slots[p_board];
+    const uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    LiveBoard snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.version    = sequence / 2 + 1;
+    snapshot.updated_ns = p_time_ns;
+    memcpy(snapshot.board, p_game->board, sizeof(snapshot.board));
+    snapshot.state         = p_game->state;
+    snapshot.lastMoveW     = p_game->lastMoveW;
+    snapshot.lastMoveB     = p_game->lastMoveB;
+    snapshot.fullmoveClock = p_game->fullmoveClock;
+    snapshot.halfmoveClock = p_game->halfmoveClock;
+    writeToFEN(p_game, snapshot.fen);
+
+    // Odd sequence, ordered before the copy by the fence
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot->board, &snapshot, sizeof(LiveBoard));
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+bool readLiveBoard(const LiveRegion* p_region, uint16_t p_board, LiveBoard* p_snapshot, uint16_t* p_attempts)
+//-----------------------------------------------------------------------------
+{
+    if (p_board >= p_region->header->boardCount)
+        return false;
+
+    const LiveSlot* slot = &p_region->slots[p_board];
+    for (uint16_t attempt = 1; attempt <= LIVE_READ_ATTEMPTS; attempt++) {
+        const uint32_t before = slot->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            // The writer may have been preempted in the middle of the update, let it run
+            if (0 == attempt % LIVE_SPINS_BEFORE_YIELD)
+                std::this_thread::yield();
+            continue;
+        }
+
+        // The copy may be torn, it is only kept if the sequence did not change meanwhile
+        memcpy(p_snapshot, &slot->board, sizeof(LiveBoard));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (before == slot->sequence.load(std::memory_order_relaxed)) {
+            if (p_attempts)
+                *p_attempts = attempt;
+            return true;
+        }
+    }
+    if (p_attempts)
+        *p_attempts = LIVE_READ_ATTEMPTS;
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+bool isLiveRegionCurrent(const LiveRegion* p_region)
+//-----------------------------------------------------------------------------
+{
+    return LIVE_MAGIC == p_region->header->magic.load(std::memory_order_acquire);
+}
+
+//-----------------------------------------------------------------------------
+uint32_t getLiveBoardVersion(const LiveRegion* p_region, uint16_t p_board)
+//-----------------------------------------------------------------------------
+{
+    if (p_board >= p_region->header->boardCount)
+        return 0;
+    return p_region->slots[p_board].sequence.load(std::memory_order_acquire) / 2;
+}
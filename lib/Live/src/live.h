@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chess.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Live state of the boards published in POSIX shared memory on the host, one fixed-layout slot per board.
+// Each slot is a seqlock: the writer makes its sequence odd while it updates the slot, readers copy the slot
+// and try again if the sequence was odd or changed meanwhile. Readers take no lock and make no syscall,
+// any number of reader processes can map the region. One writer per slot. Readers only yield their time slice
+// while an update stays in progress, when the writer was preempted in the middle of it.
+constexpr uint32_t LIVE_MAGIC         = 0x4556494C; // "LIVE"
+constexpr uint16_t LIVE_VERSION       = 2;
+constexpr uint8_t LIVE_FEN_SIZE       = 96;
+constexpr uint16_t LIVE_READ_ATTEMPTS = 10000; // Then the writer is taken as stopped in the middle of an update
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Sequences are shared between processes");
+
+// Snapshot of a board
+typedef struct {
+    uint32_t version;    // Updates of the slot, 0 before the first one
+    uint64_t updated_ns; // Writer clock of the update
+    EPiece board[64];
+    State state;
+    Move lastMoveW;
+    Move lastMoveB;
+    uint8_t fullmoveClock;
+    uint8_t halfmoveClock;
+    char fen[LIVE_FEN_SIZE]; // Of the position, written once by the writer
+} LiveBoard;
+
+// Slots start on their own cache line, readers of a board do not contend with updates of the next one
+typedef struct {
+    alignas(64) std::atomic<uint32_t> sequence; // Odd while the writer updates the slot
+    LiveBoard board;
+} LiveSlot;
+
+typedef struct {
+    alignas(64) std::atomic<uint32_t> magic; // Set last once the slots are ready, cleared when a new writer replaces the region
+    uint16_t version;
+    uint16_t boardCount;
+    uint32_t slotSize; // Regions of another build layout are rejected
+} LiveHeader;
+
+// Mapping of the region in this process
+typedef struct {
+    LiveHeader* header;
+    LiveSlot* slots;
+    size_t size;
+} LiveRegion;
+
+// Writer: create the region p_name ("/name") for p_boardCount boards, replacing the one of a previous writer.
+// false on error (errno set)
+bool createLiveRegion(LiveRegion* p_region, const char* p_name, uint16_t p_boardCount);
+
+// Readers: map the region read-only. false if it does not exist (yet) or has another layout
+bool openLiveRegion(LiveRegion* p_region, const char* p_name);
+
+void closeLiveRegion(LiveRegion* p_region);
+
+// Remove the name of the region, mappings stay valid until closed
+void removeLiveRegion(const char* p_name);
+
+// Writer: publish p_game as board p_board, p_time_ns from the writer clock
+void publishLiveBoard(LiveRegion* p_region, uint16_t p_board, Game* p_game, uint64_t p_time_ns);
+
+// Readers: consistent snapshot of board p_board. false if out of range or if the writer stopped in the middle
+// of an update. p_attempts (optional) is set to the copies made
+bool readLiveBoard(const LiveRegion* p_region, uint16_t p_board, LiveBoard* p_snapshot, uint16_t* p_attempts = nullptr);
+
+// Readers: false once a new writer replaced the region, it is then to be reopened
+bool isLiveRegionCurrent(const LiveRegion* p_region);
+
+// Readers: updates of board p_board, to skip the copy of unchanged boards
+uint32_t getLiveBoardVersion(const LiveRegion* p_region, uint16_t p_board);
@@ -0,0 +1,208 @@
+#include "oled.h"
+
+#include <flash.h>
+#include <string.h>
+
+// Piece glyphs indexed by EPiece: 8 pixel columns of 4 pixels (bit 0 = top row).
+// White pieces are drawn as a shape, black pieces as the same shape cut out of a box.
+static const uint8_t s_glyphs[16][8] PROGMEM = {
+    {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0}, // Empty
+    {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0}, // (unused)
+    {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0}, // (unused)
+    {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0}, // (unused)
+    {0x0, 0x0, 0x8, 0xE, 0xE, 0x8, 0x0, 0x0}, // WPawn
+    {0x0, 0xF, 0x7, 0x1, 0x1, 0x7, 0xF, 0x0}, // BPawn
+    {0x0, 0xA, 0xA, 0xF, 0xF, 0xA, 0xA, 0x0}, // WKing
+    {0x0, 0x5, 0x5, 0x0, 0x0, 0x5, 0x5, 0x0}, // BKing
+    {0x0, 0x2, 0xB, 0xF, 0xF, 0x8, 0x0, 0x0}, // WKnight
+    {0x0, 0xD, 0x4, 0x0, 0x0, 0x7, 0xF, 0x0}, // BKnight
+    {0x0, 0xB, 0xF, 0xE, 0xE, 0xF, 0xB, 0x0}, // WRook
+    {0x0, 0x4, 0x0, 0x1, 0x1, 0x0, 0x4, 0x0}, // BRook
+    {0x0, 0x0, 0xA, 0xD, 0xD, 0xA, 0x0, 0x0}, // WBishop
+    {0x0, 0xF, 0x5, 0x2, 0x2, 0x5, 0xF, 0x0}, // BBishop
+    {0x0, 0x9, 0xA, 0xF, 0xF, 0xA, 0x9, 0x0}, // WQueen
+    {0x0, 0x6, 0x5, 0x0, 0x0, 0x5, 0x6, 0x0}, // BQueen
+};
+
+// Vertical lines at pixel columns 30 and 97, on both sides of the board
+static const uint8_t s_leftBorderTile[OLED_TILE_SIZE] PROGMEM  = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00};
+static const uint8_t s_rightBorderTile[OLED_TILE_SIZE] PROGMEM = {0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+//-----------------------------------------------------------------------------
+void initializeOledRenderer(OledRenderer* p_renderer)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_renderer)
+        return;
+
+    memset(p_renderer->drawn, OLED_UNDRAWN_SQUARE, sizeof(p_renderer->drawn));
+    p_renderer->frame    = 0;
+    p_renderer->barDrawn = OLED_UNDRAWN_SQUARE;
+}
+
+//-----------------------------------------------------------------------------
+static void drawOledFrame(OledRenderer* p_renderer, OledTileWriter p_writer, void* p_context)
+//-----------------------------------------------------------------------------
+{
+    uint8_t left[OLED_TILE_SIZE];
+    uint8_t right[OLED_TILE_SIZE];
+    for (uint8_t i = 0; i < OLED_TILE_SIZE; i++) {
+        left[i]  = pgm_read_byte(&s_leftBorderTile[i]);
+        right[i] = pgm_read_byte(&s_rightBorderTile[i]);
+    }
+
+    for (uint8_t y = 0; y < OLED_TILE_ROWS; y++) {
+        const uint8_t leftBit  = 1 << (2 * y);
+        const uint8_t rightBit = leftBit << 1;
+        if (!(p_renderer->frame & leftBit) && p_writer(p_context, OLED_BOARD_TILE_X - 1, y, 1, left))
+            p_renderer->frame |= leftBit;
+        if (!(p_renderer->frame & rightBit) && p_writer(p_context, OLED_BOARD_TILE_X + 8, y, 1, right))
+            p_renderer->frame |= rightBit;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void buildOledBoardTile(Game* p_game, uint8_t p_file, uint8_t p_tileRow, uint8_t* p_tile)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t upperRank = 7 - 2 * p_tileRow;
+    const uint8_t upper     = p_game->board[8 * upperRank + p_file] & 0x0F;
+    const uint8_t lower     = p_game->board[8 * (upperRank - 1) + p_file] & 0x0F;
+
+    for (uint8_t i = 0; i < OLED_TILE_SIZE; i++) {
+        p_tile[i] = pgm_read_byte(&s_glyphs[upper][i]) | (pgm_read_byte(&s_glyphs[lower][i]) << 4);
+    }
+}
+
+//-----------------------------------------------------------------------------
+uint8_t renderOledBoard(OledRenderer* p_renderer, Game* p_game, OledTileWriter p_writer, void* p_context)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_renderer || nullptr == p_game || nullptr == p_writer)
+        return 0;
+
+    if (p_renderer->frame != 0xFF)
+        drawOledFrame(p_renderer, p_writer, p_context);
+
+    uint8_t sent = 0;
+    uint8_t run[8 * OLED_TILE_SIZE]; // Consecutive changed tiles of a row, sent in a single transfer
+
+    for (uint8_t y = 0; y < OLED_TILE_ROWS; y++) {
+        uint8_t runStart  = 0;
+        uint8_t runLength = 0;
+
+        for (uint8_t file = 0; file <= 8; file++) {
+            bool changed = false;
+            if (file < 8) {
+                const uint8_t upper = 8 * (7 - 2 * y) + file;
+                const uint8_t lower = upper - 8;
+                changed             = (p_renderer->drawn[upper] != p_game->board[upper]) || (p_renderer->drawn[lower] != p_game->board[lower]);
+
+                if (changed) {
+                    if (0 == runLength)
+                        runStart = file;
+                    buildOledBoardTile(p_game, file, y, &run[runLength * OLED_TILE_SIZE]);
+                    runLength++;
+                }
+            }
+
+            if (!changed && runLength > 0) {
+                // End of a run of changed tiles (or end of the row)
+                if (p_writer(p_context, OLED_BOARD_TILE_X + runStart, y, runLength, run)) {
+                    for (uint8_t i = runStart; i < runStart + runLength; i++) {
+                        const uint8_t upper          = 8 * (7 - 2 * y) + i;
+                        p_renderer->drawn[upper]     = p_game->board[upper];
+                        p_renderer->drawn[upper - 8] = p_game->board[upper - 8];
+                    }
+                    sent += runLength;
+                }
+                runLength = 0;
+            }
+        }
+    }
+
+    return sent;
+}
+
+//-----------------------------------------------------------------------------
+bool isOledBoardDrawn(OledRenderer* p_renderer, Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_renderer || nullptr == p_game || p_renderer->frame != 0xFF)
+        return false;
+
+    for (uint8_t i = 0; i < 64; i++) {
+        if (p_renderer->drawn[i] != p_game->board[i])
+            return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t getOledEvalBarHeight(int16_t p_evaluation)
+//-----------------------------------------------------------------------------
+{
+    // Never completely empty nor full: the bar shows which side is ahead
+    const int16_t clamped = (p_evaluation > OLED_EVAL_BAR_RANGE) ? OLED_EVAL_BAR_RANGE : (p_evaluation < -OLED_EVAL_BAR_RANGE ? -OLED_EVAL_BAR_RANGE : p_evaluation);
+    const int16_t height  = OLED_EVAL_BAR_HEIGHT / 2 + (int32_t)clamped * (OLED_EVAL_BAR_HEIGHT / 2) / OLED_EVAL_BAR_RANGE;
+    return (height < 1) ? 1 : (height > OLED_EVAL_BAR_HEIGHT - 1 ? OLED_EVAL_BAR_HEIGHT - 1 : height);
+}
+
+//-----------------------------------------------------------------------------
+void buildOledEvalBarTile(uint8_t p_height, uint8_t p_tileRow, uint8_t* p_tile)
+//-----------------------------------------------------------------------------
+{
+    // Box outline at pixel columns 1 and 6 and on the top and bottom rows, filled inside up to the height
+    const uint8_t top   = OLED_EVAL_BAR_HEIGHT - p_height;
+    uint8_t fill        = 0;
+    uint8_t outline     = 0;
+    const uint8_t first = p_tileRow * OLED_TILE_SIZE;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        const uint8_t y = first + bit;
+        if (y >= top)
+            fill |= 1 << bit;
+        if (0 == y || OLED_EVAL_BAR_HEIGHT - 1 == y)
+            outline |= 1 << bit;
+    }
+
+    p_tile[0] = 0;
+    p_tile[1] = 0xFF;
+    for (uint8_t i = 2; i < 6; i++)
+        p_tile[i] = fill | outline;
+    p_tile[6] = 0xFF;
+    p_tile[7] = 0;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t renderOledEvalBar(OledRenderer* p_renderer, int16_t p_evaluation, OledTileWriter p_writer, void* p_context)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_renderer || nullptr == p_writer)
+        return 0;
+
+    const uint8_t height = getOledEvalBarHeight(p_evaluation);
+    if (height == p_renderer->barDrawn)
+        return 0;
+
+    // Only the tile rows between the old and new heights change
+    uint8_t sent  = 0;
+    bool complete = true;
+    uint8_t tile[OLED_TILE_SIZE];
+    uint8_t drawn[OLED_TILE_SIZE];
+    for (uint8_t y = 0; y < OLED_TILE_ROWS; y++) {
+        buildOledEvalBarTile(height, y, tile);
+        if (OLED_UNDRAWN_SQUARE != p_renderer->barDrawn) {
+            buildOledEvalBarTile(p_renderer->barDrawn, y, drawn);
+            if (0 == memcmp(tile, drawn, OLED_TILE_SIZE))
+                continue;
+        }
+        if (p_writer(p_context, OLED_EVAL_BAR_TILE_X, y, 1, tile))
+            sent++;
+        else
+            complete = false;
+    }
+
+    // Tiles that could not be sent are all pushed again on next render
+    p_renderer->barDrawn = complete ? height : OLED_UNDRAWN_SQUARE;
+    return sent;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chess.h>
+#include <stdint.h>
+
+// The 128x32 OLED is addressed in 8x8 pixel tiles (16 columns, 4 rows), each tile being 8 bytes
+// with one byte per pixel column (bit 0 = top pixel). Squares are 8x4 pixels, so one tile holds
+// one file over two ranks, and the board covers tile columns 4 to 11.
+constexpr uint8_t OLED_TILE_COLUMNS   = 16;
+constexpr uint8_t OLED_TILE_ROWS      = 4;
+constexpr uint8_t OLED_TILE_SIZE      = 8;
+constexpr uint8_t OLED_BOARD_TILE_X   = 4;
+constexpr uint8_t OLED_UNDRAWN_SQUARE = 0xFF;
+
+// Evaluation bar in tile column 1, left of the board: white fills it from the bottom,
+// half of it for an even position and all of it from OLED_EVAL_BAR_RANGE centipawns
+constexpr uint8_t OLED_EVAL_BAR_TILE_X = 1;
+constexpr uint8_t OLED_EVAL_BAR_HEIGHT = OLED_TILE_ROWS * OLED_TILE_SIZE;
+constexpr int16_t OLED_EVAL_BAR_RANGE  = 800;
+
+// Sends p_count consecutive tiles starting at tile column p_x of tile row p_y,
+// returns false if they cannot be sent now (they are sent again on next render)
+typedef bool (*OledTileWriter)(void* p_context, uint8_t p_x, uint8_t p_y, uint8_t p_count, const uint8_t* p_tiles);
+
+typedef struct {
+    uint8_t drawn[64]; // Piece last pushed to the screen for each square, OLED_UNDRAWN_SQUARE if unknown
+    uint8_t frame;     // Border tiles around the board that have been pushed, one bit per tile
+    uint8_t barDrawn;  // White height of the evaluation bar last pushed, OLED_UNDRAWN_SQUARE if unknown
+} OledRenderer;
+
+// Forget what has been drawn, next render pushes the whole screen
+void initializeOledRenderer(OledRenderer* p_renderer);
+
+// Push the board borders if needed and the tiles whose squares changed since last render,
+// returns the number of board tiles sent
+uint8_t renderOledBoard(OledRenderer* p_renderer, Game* p_game, OledTileWriter p_writer, void* p_context);
+
+// Whether the whole screen shows the game board
+bool isOledBoardDrawn(OledRenderer* p_renderer, Game* p_game);
+
+// Build the tile of a file over two ranks (p_tileRow 0 = ranks 8 and 7)
+void buildOledBoardTile(Game* p_game, uint8_t p_file, uint8_t p_tileRow, uint8_t* p_tile);
+
+// White height of the evaluation bar for an evaluation from white point of view
+uint8_t getOledEvalBarHeight(int16_t p_evaluation);
+
+// Push the evaluation bar tiles that changed since last render, returns the number of tiles sent
+uint8_t renderOledEvalBar(OledRenderer* p_renderer, int16_t p_evaluation, OledTileWriter p_writer, void* p_context);
+
+// Build a tile of the evaluation bar (p_tileRow 0 = top)
+void buildOledEvalBarTile(uint8_t p_height, uint8_t p_tileRow, uint8_t* p_tile);
@@ -0,0 +1,69 @@
+#include "power.h"
+
+//-----------------------------------------------------------------------------
+void initializeScanPolicy(ScanPolicy* p_policy, uint64_t p_sensors, uint32_t p_now_us)
+//-----------------------------------------------------------------------------
+{
+    p_policy->sensors           = p_sensors;
+    p_policy->lastActivity_us   = p_now_us;
+    p_policy->period_us         = SCAN_ACTIVE_PERIOD_US;
+    p_policy->idle              = false;
+    p_policy->windowStart_us    = p_now_us;
+    p_policy->windowScans       = 0;
+    p_policy->windowSleep_us    = 0;
+    p_policy->scansPerSecond    = 0;
+    p_policy->sleepPerSecond_us = 0;
+    p_policy->totalSleep_ms     = 0;
+    p_policy->sleepRemainder_us = 0;
+    p_policy->idleCount         = 0;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t updateScanPolicy(ScanPolicy* p_policy, uint64_t p_sensors, uint32_t p_now_us)
+//-----------------------------------------------------------------------------
+{
+    p_policy->windowScans++;
+    const uint32_t window_us = p_now_us - p_policy->windowStart_us;
+    if (window_us >= SCAN_STATS_WINDOW_US) {
+        // Per second, whatever the scan that closed the window
+        p_policy->scansPerSecond    = (uint16_t)((uint64_t)p_policy->windowScans * SCAN_STATS_WINDOW_US / window_us);
+        p_policy->sleepPerSecond_us = (uint32_t)((uint64_t)p_policy->windowSleep_us * SCAN_STATS_WINDOW_US / window_us);
+        p_policy->windowStart_us    = p_now_us;
+        p_policy->windowScans       = 0;
+        p_policy->windowSleep_us    = 0;
+    }
+
+    if (p_sensors != p_policy->sensors) {
+        p_policy->sensors = p_sensors;
+        return wakeScanPolicy(p_policy, p_now_us);
+    }
+
+    if (!p_policy->idle && p_now_us - p_policy->lastActivity_us >= SCAN_IDLE_DELAY_US) {
+        p_policy->idle      = true;
+        p_policy->period_us = SCAN_IDLE_PERIOD_US;
+        p_policy->idleCount++;
+    }
+    return p_policy->period_us;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t wakeScanPolicy(ScanPolicy* p_policy, uint32_t p_now_us)
+//-----------------------------------------------------------------------------
+{
+    p_policy->lastActivity_us = p_now_us;
+    p_policy->idle            = false;
+    p_policy->period_us       = SCAN_ACTIVE_PERIOD_US;
+    return p_policy->period_us;
+}
+
+//-----------------------------------------------------------------------------
+void addScanPolicySleep(ScanPolicy* p_policy, uint32_t p_sleep_us)
+//-----------------------------------------------------------------------------
+{
+    p_policy->windowSleep_us += p_sleep_us;
+
+    // Sleeps are often shorter than a millisecond: the remainder is carried to the next one
+    p_policy->sleepRemainder_us += p_sleep_us;
+    p_policy->totalSleep_ms += p_policy->sleepRemainder_us / 1000;
+    p_policy->sleepRemainder_us %= 1000;
+}
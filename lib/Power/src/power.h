@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+// Adaptive scan rate: the board is scanned at full rate while it changes, then at a low rate once it has been
+// static for a while, so that the MCU sleeps between scans. The first changed bit or a button press brings
+// the full rate back. Portable: the firmware feeds it scans and sleep times, tests a virtual clock.
+constexpr uint32_t SCAN_ACTIVE_PERIOD_US = 2000;    // 500 Hz
+constexpr uint32_t SCAN_IDLE_PERIOD_US   = 50000;   // 20 Hz
+constexpr uint32_t SCAN_IDLE_DELAY_US    = 5000000; // Static board and buttons before slowing down
+constexpr uint32_t SCAN_STATS_WINDOW_US  = 1000000;
+
+typedef struct {
+    uint64_t sensors;         // Last scanned sensors
+    uint32_t lastActivity_us; // Last changed bit or button press
+    uint32_t period_us;       // Period until the next scan
+    bool idle;
+
+    // Statistics of the last completed window, and of the current one
+    uint32_t windowStart_us;
+    uint16_t windowScans;
+    uint32_t windowSleep_us;
+    uint16_t scansPerSecond;
+    uint32_t sleepPerSecond_us;
+    uint32_t totalSleep_ms;
+    uint32_t sleepRemainder_us;
+    uint16_t idleCount; // Times the board went idle
+} ScanPolicy;
+
+void initializeScanPolicy(ScanPolicy* p_policy, uint64_t p_sensors, uint32_t p_now_us);
+
+// Record a scan, returns the period until the next one
+uint32_t updateScanPolicy(ScanPolicy* p_policy, uint64_t p_sensors, uint32_t p_now_us);
+
+// Record activity other than sensors (button press), returns the period until the next scan
+uint32_t wakeScanPolicy(ScanPolicy* p_policy, uint32_t p_now_us);
+
+// Record time the MCU spent asleep
+void addScanPolicySleep(ScanPolicy* p_policy, uint32_t p_sleep_us);
@@ -0,0 +1,218 @@
+#include "profiler.h"
+
+#include <flash.h>
+#include <string.h>
+
+#ifdef ARDUINO_ARCH_AVR
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+static LatencyHistogram s_stages[StageCount];
+
+static const char s_stageNames[StageCount][10] PROGMEM = {
+    "read",
+    "stabilize",
+    "evolve",
+    "check",
+    "validate",
+    "lcd",
+    "oled",
+    "move",
+};
+
+//-----------------------------------------------------------------------------
+void initializeLatencyHistogram(LatencyHistogram* p_histogram)
+//-----------------------------------------------------------------------------
+{
+    memset(p_histogram, 0, sizeof(LatencyHistogram));
+}
+
+//-----------------------------------------------------------------------------
+void recordLatency(LatencyHistogram* p_histogram, uint32_t p_latency_us)
+//-----------------------------------------------------------------------------
+{
+    // Bucket is the bit length of the latency
+    uint8_t bucket = 0;
+    for (uint32_t value = p_latency_us; value != 0 && bucket < LATENCY_BUCKETS - 1; value >>= 1)
+        bucket++;
+
+    // Counters saturate so that percentiles stay meaningful
+    if (0xFFFF == p_histogram->buckets[bucket] || 0xFFFF == p_histogram->count)
+        return;
+
+    p_histogram->buckets[bucket]++;
+    p_histogram->count++;
+    if (p_latency_us > p_histogram->max_us)
+        p_histogram->max_us = p_latency_us;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t getLatencyPercentile(LatencyHistogram* p_histogram, uint8_t p_percent)
+//-----------------------------------------------------------------------------
+{
+    if (0 == p_histogram->count)
+        return 0;
+
+    const uint32_t rank = ((uint32_t)p_histogram->count * p_percent + 99) / 100;
+    uint32_t seen       = 0;
+    for (uint8_t i = 0; i < LATENCY_BUCKETS - 1; i++) {
+        seen += p_histogram->buckets[i];
+        if (seen >= rank && seen > 0)
+            return (1uL << i) - 1;
+    }
+    return p_histogram->max_us;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t getProfilerTime_us()
+//-----------------------------------------------------------------------------
+{
+#ifdef ARDUINO_ARCH_AVR
+    return micros();
+#else
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void resetProfiler()
+//-----------------------------------------------------------------------------
+{
+    for (uint8_t i = 0; i < StageCount; i++)
+        initializeLatencyHistogram(&s_stages[i]);
+}
+
+//-----------------------------------------------------------------------------
+LatencyHistogram* getStageHistogram(EProfileStage p_stage)
+//-----------------------------------------------------------------------------
+{
+    return (p_stage < StageCount) ? &s_stages[p_stage] : nullptr;
+}
+
+#ifndef PROFILER_DISABLE_STAGES
+//-----------------------------------------------------------------------------
+uint32_t beginStage()
+//-----------------------------------------------------------------------------
+{
+    return getProfilerTime_us();
+}
+
+//-----------------------------------------------------------------------------
+void endStage(EProfileStage p_stage, uint32_t p_start_us)
+//-----------------------------------------------------------------------------
+{
+    if (p_stage < StageCount)
+        recordLatency(&s_stages[p_stage], getProfilerTime_us() - p_start_us);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+void initializeMoveLatencyTracker(MoveLatencyTracker* p_tracker)
+//-----------------------------------------------------------------------------
+{
+    memset(p_tracker, 0, sizeof(MoveLatencyTracker));
+}
+
+//-----------------------------------------------------------------------------
+void trackSensorEdges(MoveLatencyTracker* p_tracker, uint64_t p_raw, uint64_t p_lastStable, uint64_t p_stable, uint32_t p_now_us)
+//-----------------------------------------------------------------------------
+{
+    if (p_stable != p_lastStable) {
+        // Stable board changed: it started with the first edge seen (or now without debouncing)
+        p_tracker->change_us = p_tracker->edge ? p_tracker->edge_us : p_now_us;
+        p_tracker->edge      = false;
+    }
+
+    if (p_raw == p_stable) {
+        // Sensors back to the stable board (bounce), or change completed
+        p_tracker->edge = false;
+    } else if (!p_tracker->edge) {
+        p_tracker->edge    = true;
+        p_tracker->edge_us = p_now_us;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void markMoveCommitted(MoveLatencyTracker* p_tracker)
+//-----------------------------------------------------------------------------
+{
+    // A move not displayed yet keeps its start: the next one is displayed with it
+    if (p_tracker->move)
+        return;
+
+    p_tracker->move    = true;
+    p_tracker->move_us = p_tracker->change_us;
+}
+
+//-----------------------------------------------------------------------------
+bool markMoveDisplayed(MoveLatencyTracker* p_tracker, uint32_t p_now_us)
+//-----------------------------------------------------------------------------
+{
+    if (!p_tracker->move)
+        return false;
+
+    recordLatency(&s_stages[StageMove], p_now_us - p_tracker->move_us);
+    p_tracker->move = false;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static char* appendNumber(char* p_buffer, uint32_t p_value)
+//-----------------------------------------------------------------------------
+{
+    char digits[10];
+    uint8_t count = 0;
+    do {
+        digits[count++] = '0' + (p_value % 10);
+        p_value /= 10;
+    } while (p_value != 0);
+
+    while (count > 0)
+        *p_buffer++ = digits[--count];
+    *p_buffer = 0;
+    return p_buffer;
+}
+
+//-----------------------------------------------------------------------------
+static char* appendString(char* p_buffer, const char* p_flashString)
+//-----------------------------------------------------------------------------
+{
+    strcpy_P(p_buffer, p_flashString);
+    return p_buffer + strlen(p_buffer);
+}
+
+//-----------------------------------------------------------------------------
+void dumpProfiler(ProfilerPrinter p_printer)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_printer)
+        return;
+
+    // Longest line: name, 4 numbers and LATENCY_BUCKETS counters
+    char line[16 + 4 * 16 + LATENCY_BUCKETS * 6];
+    for (uint8_t stage = 0; stage < StageCount; stage++) {
+        LatencyHistogram* histogram = &s_stages[stage];
+
+        char* end = appendString(line, s_stageNames[stage]);
+        end       = appendString(end, PSTR(" n="));
+        end       = appendNumber(end, histogram->count);
+        end       = appendString(end, PSTR(" p50="));
+        end       = appendNumber(end, getLatencyPercentile(histogram, 50));
+        end       = appendString(end, PSTR(" p90="));
+        end       = appendNumber(end, getLatencyPercentile(histogram, 90));
+        end       = appendString(end, PSTR(" p99="));
+        end       = appendNumber(end, getLatencyPercentile(histogram, 99));
+        end       = appendString(end, PSTR(" max="));
+        end       = appendNumber(end, histogram->max_us);
+        end       = appendString(end, PSTR(" |"));
+        for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+            end = appendString(end, PSTR(" "));
+            end = appendNumber(end, histogram->buckets[i]);
+        }
+
+        p_printer(line);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+
+// Latency histograms with log2 buckets: bucket 0 counts 0 us, bucket i counts [2^(i-1), 2^i) us,
+// the last bucket also counts everything above.
+constexpr uint8_t LATENCY_BUCKETS = 22;
+
+typedef struct {
+    uint16_t buckets[LATENCY_BUCKETS];
+    uint16_t count;
+    uint32_t max_us;
+} LatencyHistogram;
+
+typedef enum {
+    StageReadBoard = 0,
+    StageStabilizeBoard,
+    StageEvolveGame, // Includes updateCheckState
+    StageUpdateCheck,
+    StageValidateMove, // Legality of a committed move, part of StageEvolveGame
+    StageLcd,
+    StageOled,
+    StageMove, // First sensor edge of a move to its display on both screens
+    StageCount
+} EProfileStage;
+
+// Time a move has been waiting for, from sensors to displays
+typedef struct {
+    uint32_t edge_us;   // First raw sensor change not part of the stable board yet
+    uint32_t change_us; // First sensor edge of the last stable board change
+    uint32_t move_us;   // First sensor edge of the move waiting to be displayed
+    bool edge;
+    bool move;
+} MoveLatencyTracker;
+
+typedef void (*ProfilerPrinter)(const char* p_line);
+
+void initializeLatencyHistogram(LatencyHistogram* p_histogram);
+void recordLatency(LatencyHistogram* p_histogram, uint32_t p_latency_us);
+
+// Upper bound of the bucket holding the given percentile of recorded latencies
+uint32_t getLatencyPercentile(LatencyHistogram* p_histogram, uint8_t p_percent);
+
+// micros() on target, steady clock on native
+uint32_t getProfilerTime_us();
+
+// Stage histograms (held in RAM), PROFILER_DISABLE_STAGES turns stage timing into no-ops
+// for native tools that run games from several threads
+void resetProfiler();
+LatencyHistogram* getStageHistogram(EProfileStage p_stage);
+#ifdef PROFILER_DISABLE_STAGES
+inline uint32_t beginStage() { return 0; }
+inline void endStage(EProfileStage, uint32_t) {}
+#else
+uint32_t beginStage();
+void endStage(EProfileStage p_stage, uint32_t p_start_us);
+#endif
+
+void initializeMoveLatencyTracker(MoveLatencyTracker* p_tracker);
+
+// Follow raw and stable sensor states, p_lastStable is the stable state before p_stable
+void trackSensorEdges(MoveLatencyTracker* p_tracker, uint64_t p_raw, uint64_t p_lastStable, uint64_t p_stable, uint32_t p_now_us);
+
+// Last stable board change completed a move
+void markMoveCommitted(MoveLatencyTracker* p_tracker);
+
+// Move is visible on displays, record its latency (StageMove), returns false if no move was waiting
+bool markMoveDisplayed(MoveLatencyTracker* p_tracker, uint32_t p_now_us);
+
+// Print one line per stage: count, max, percentiles and bucket counts
+void dumpProfiler(ProfilerPrinter p_printer);
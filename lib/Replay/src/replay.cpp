@@ -0,0 +1,164 @@
+#include "replay.h"
+
+#include <stddef.h>
+
+// FNV-1a
+constexpr uint32_t CHECKSUM_BASIS = 2166136261u;
+constexpr uint32_t CHECKSUM_PRIME = 16777619u;
+
+//-----------------------------------------------------------------------------
+uint32_t compileSensorScript(const char* p_script, uint8_t* p_events, uint32_t p_capacity, uint32_t* p_errorOffset)
+//-----------------------------------------------------------------------------
+{
+    uint32_t count  = 0;
+    const char* ptr = p_script;
+
+    while (nullptr != ptr && *ptr != 0) {
+        const char* start = ptr;
+        const char action = *ptr;
+        uint8_t event     = 0;
+
+        switch (action) {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            ptr++;
+            continue;
+        case '#':
+            while (*ptr != 0 && *ptr != '\n')
+                ptr++;
+            continue;
+        case '_':
+            event = REPLAY_EVENT_STEP;
+            ptr++;
+            break;
+        case '+':
+        case '-': {
+            // Same parsing as the test scripts: case-insensitive file, then rank
+            const uint8_t file = ((uint8_t)ptr[1] & 0b11011111) - (uint8_t)'A';
+            const uint8_t rank = (uint8_t)ptr[2] - (uint8_t)'1';
+            if (ptr[1] == 0 || file >= 8 || rank >= 8) {
+                count = REPLAY_INVALID;
+                break;
+            }
+            event = (file + 8 * rank) | ((action == '+') ? REPLAY_EVENT_PLACED : 0);
+            ptr += 3;
+            break;
+        }
+        default:
+            count = REPLAY_INVALID;
+            break;
+        }
+
+        if (REPLAY_INVALID == count || count >= p_capacity) {
+            if (nullptr != p_errorOffset)
+                *p_errorOffset = (uint32_t)(start - p_script);
+            return REPLAY_INVALID;
+        }
+
+        p_events[count++] = event;
+    }
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+static inline uint32_t hashByte(uint32_t p_hash, uint8_t p_byte)
+//-----------------------------------------------------------------------------
+{
+    return (p_hash ^ p_byte) * CHECKSUM_PRIME;
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t hashMove(uint32_t p_hash, const Move* p_move)
+//-----------------------------------------------------------------------------
+{
+    p_hash = hashByte(p_hash, p_move->start);
+    p_hash = hashByte(p_hash, p_move->end);
+    p_hash = hashByte(p_hash, (uint8_t)p_move->piece);
+    return hashByte(p_hash, (p_move->captured << 0) | (p_move->check << 1) | (p_move->promotion << 2) | (p_move->checkmate << 3));
+}
+
+//-----------------------------------------------------------------------------
+uint32_t getGameChecksum(Game* p_game)
+//-----------------------------------------------------------------------------
+{
+    // Field by field: padding bytes are not part of the state
+    uint32_t hash = CHECKSUM_BASIS;
+    for (uint8_t i = 0; i < 64; i++)
+        hash = hashByte(hash, (uint8_t)p_game->board[i]);
+
+    const State* state = &p_game->state;
+    hash               = hashByte(hash, state->removed_1.index);
+    hash               = hashByte(hash, (uint8_t)state->removed_1.piece);
+    hash               = hashByte(hash, state->removed_2.index);
+    hash               = hashByte(hash, (uint8_t)state->removed_2.piece);
+    hash               = hashByte(hash, state->en_passant);
+    hash               = hashByte(hash, state->status);
+    hash               = hashByte(hash, (state->castlingK[0] << 0) | (state->castlingK[1] << 1) | (state->castlingQ[0] << 2) | (state->castlingQ[1] << 3));
+    hash               = hashMove(hash, &p_game->lastMoveW);
+    hash               = hashMove(hash, &p_game->lastMoveB);
+    hash               = hashByte(hash, p_game->fullmoveClock);
+    return hashByte(hash, p_game->halfmoveClock);
+}
+
+//-----------------------------------------------------------------------------
+ReplayResult replaySensorEvents(Game* p_game, uint64_t p_sensors, const uint8_t* p_events, uint32_t p_count, uint32_t* p_checksums)
+//-----------------------------------------------------------------------------
+{
+    uint64_t sensors = p_sensors;
+    for (uint32_t i = 0; i < p_count; i++) {
+        const uint8_t event = p_events[i];
+        if (0 == (event & REPLAY_EVENT_STEP)) {
+            const uint64_t mask = 1uLL << (event & REPLAY_SQUARE_MASK);
+            sensors             = (event & REPLAY_EVENT_PLACED) ? (sensors | mask) : (sensors & ~mask);
+        }
+
+        evolveGame(p_game, sensors);
+        if (nullptr != p_checksums)
+            p_checksums[i] = getGameChecksum(p_game);
+    }
+
+    return {p_count, getGameChecksum(p_game), sensors};
+}
+
+//-----------------------------------------------------------------------------
+uint8_t getMoveSensorEvents(Game* p_game, Move p_move, bool p_capturedFirst, uint8_t* p_events)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t start = p_move.start;
+    const uint8_t end   = p_move.end;
+    const uint8_t diff  = (start > end) ? start - end : end - start;
+
+    if (isKing(p_move.piece) && 2 == diff) {
+        // Castling: king two squares away, then the rook over it
+        const bool kingSide   = end > start;
+        const uint8_t rook    = kingSide ? start + 3 : start - 4;
+        const uint8_t rookEnd = kingSide ? start + 1 : start - 1;
+        p_events[0]           = start;
+        p_events[1]           = end | REPLAY_EVENT_PLACED;
+        p_events[2]           = rook;
+        p_events[3]           = rookEnd | REPLAY_EVENT_PLACED;
+        return 4;
+    }
+
+    if (p_move.captured && Empty == p_game->board[end]) {
+        // En passant: the captured pawn is removed once the capturing one is placed
+        p_events[0] = start;
+        p_events[1] = end | REPLAY_EVENT_PLACED;
+        p_events[2] = (start / 8) * 8 + (end % 8);
+        return 3;
+    }
+
+    if (p_move.captured) {
+        p_events[0] = p_capturedFirst ? end : start;
+        p_events[1] = p_capturedFirst ? start : end;
+        p_events[2] = end | REPLAY_EVENT_PLACED;
+        return 3;
+    }
+
+    p_events[0] = start;
+    p_events[1] = end | REPLAY_EVENT_PLACED;
+    return 2;
+}
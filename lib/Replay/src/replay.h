@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chess.h>
+#include <stdint.h>
+
+// Sensor scripts ("-e2 +e4 _ # comment") compiled to one byte per event:
+// bit 7 set when a piece is placed, bits 0-5 the square, REPLAY_EVENT_STEP for a step without change.
+constexpr uint8_t REPLAY_EVENT_PLACED = 0x80;
+constexpr uint8_t REPLAY_EVENT_STEP   = 0x40;
+constexpr uint8_t REPLAY_SQUARE_MASK  = 0x3F;
+
+constexpr uint32_t REPLAY_INVALID = 0xFFFFFFFF;
+
+typedef struct {
+    uint32_t events;   // Events replayed
+    uint32_t checksum; // Checksum of the game after the last event
+    uint64_t sensors;  // Sensors state after the last event
+} ReplayResult;
+
+// Compile a script, returns the number of events or REPLAY_INVALID (p_errorOffset is set to the invalid action)
+uint32_t compileSensorScript(const char* p_script, uint8_t* p_events, uint32_t p_capacity, uint32_t* p_errorOffset);
+
+// Checksum of the game state (board, status, castling rights, last moves and clocks)
+uint32_t getGameChecksum(Game* p_game);
+
+// Apply events to sensors and evolve the game after each one, p_checksums (optional) gets one checksum per event
+ReplayResult replaySensorEvents(Game* p_game, uint64_t p_sensors, const uint8_t* p_events, uint32_t p_count, uint32_t* p_checksums);
+
+// Most events a single move takes (castling)
+constexpr uint8_t REPLAY_MAX_MOVE_EVENTS = 4;
+
+// Events of a move as a player makes it on the board, p_capturedFirst lifts the captured piece before
+// the capturing one. Castling moves the king then the rook, en passant removes the captured pawn last.
+uint8_t getMoveSensorEvents(Game* p_game, Move p_move, bool p_capturedFirst, uint8_t* p_events);
@@ -0,0 +1,98 @@
+#include "scan.h"
+
+#include <flash.h>
+
+// Each chain covers a quarter of the board, file by file from its d or h file down
+const uint8_t SCAN_LAYOUT_REV_A[64] PROGMEM = {
+    15, 11, 7,  3,  31, 27, 23, 19, // rank 1
+    14, 10, 6,  2,  30, 26, 22, 18, // rank 2
+    13, 9,  5,  1,  29, 25, 21, 17, // rank 3
+    12, 8,  4,  0,  28, 24, 20, 16, // rank 4
+    47, 43, 39, 35, 63, 59, 55, 51, // rank 5
+    46, 42, 38, 34, 62, 58, 54, 50, // rank 6
+    45, 41, 37, 33, 61, 57, 53, 49, // rank 7
+    44, 40, 36, 32, 60, 56, 52, 48, // rank 8
+};
+
+static const uint8_t s_bitMasks[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+
+//-----------------------------------------------------------------------------
+static uint64_t packRaw(const uint8_t* p_raw)
+//-----------------------------------------------------------------------------
+{
+    uint64_t raw = 0;
+    for (int8_t i = SCAN_RAW_BYTES - 1; i >= 0; i--)
+        raw = (raw << 8) | p_raw[i];
+    return raw;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t mapRawBoard(const uint8_t* p_raw, const uint8_t* p_layout)
+//-----------------------------------------------------------------------------
+{
+    // Byte operations only: variable shifts of 64-bit values are loops on 8-bit targets
+    uint8_t squares[8];
+    for (uint8_t rank = 0; rank < 8; rank++) {
+        uint8_t value         = 0;
+        const uint8_t* layout = &p_layout[rank * 8];
+        for (uint8_t file = 0; file < 8; file++) {
+            const uint8_t bit = layout[file];
+            if (p_raw[bit >> 3] & s_bitMasks[bit & 7])
+                value |= s_bitMasks[file];
+        }
+        squares[rank] = value;
+    }
+    return packRaw(squares);
+}
+
+//-----------------------------------------------------------------------------
+void loadScanLayout(uint8_t* p_layout, const uint8_t* p_flashLayout)
+//-----------------------------------------------------------------------------
+{
+    for (uint8_t square = 0; square < 64; square++)
+        p_layout[square] = pgm_read_byte(&p_flashLayout[square]);
+}
+
+//-----------------------------------------------------------------------------
+bool isScanLayoutValid(const uint8_t* p_layout)
+//-----------------------------------------------------------------------------
+{
+    uint64_t used = 0;
+    for (uint8_t square = 0; square < 64; square++) {
+        if (p_layout[square] >= 64 || ((used >> p_layout[square]) & 1))
+            return false;
+        used |= (1uLL << p_layout[square]);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void startScanCalibration(ScanCalibration* p_calibration, const uint8_t* p_raw)
+//-----------------------------------------------------------------------------
+{
+    p_calibration->raw      = packRaw(p_raw);
+    p_calibration->assigned = 0;
+    p_calibration->square   = 0;
+}
+
+//-----------------------------------------------------------------------------
+bool updateScanCalibration(ScanCalibration* p_calibration, const uint8_t* p_raw)
+//-----------------------------------------------------------------------------
+{
+    if (p_calibration->square >= 64)
+        return true;
+
+    // Only a single new bit is learnt: several squares at once or a learnt square are ignored
+    const uint64_t raw   = packRaw(p_raw);
+    const uint64_t added = raw & ~p_calibration->raw & ~p_calibration->assigned;
+    p_calibration->raw   = raw;
+    if (0 == added || 0 != (added & (added - 1)))
+        return false;
+
+    uint8_t bit = 0;
+    while (0 == ((added >> bit) & 1))
+        bit++;
+    p_calibration->layout[p_calibration->square++] = bit;
+    p_calibration->assigned |= added;
+    return p_calibration->square >= 64;
+}
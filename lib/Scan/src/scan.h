@@ -0,0 +1,170 @@
+#pragma once
+
+#include <stdint.h>
+
+// Board scan as a template over the board revision (wiring of the shift registers) and the GPIO access,
+// so that each revision compiles to a loop with constant pins, and the same loop runs natively.
+//
+// Raw bits are numbered in scan order: bit r is read at clock r % ClocksPerScan of chain r / ClocksPerScan.
+// They are gathered one byte per chain and 8 clocks, then sorted into squares through a layout: the raw
+// bit of each square (a1 = 0, b1 = 1... h8 = 63). Layouts of known revisions are in flash, others are
+// learnt by calibration.
+//
+// Revision policy:
+//   DataLines, ClocksPerScan: daisy chains read in parallel and clocks to shift them out (multiple of 8)
+//   getLine(i):  connector data line (0-3) of chain i
+//   getLayout(): raw bit of each square, in flash
+// GPIO policy:
+//   powerOn() / powerOff(): hall sensors supply, including the settling delay
+//   load(): latch the sensors into the shift registers
+//   isDataHigh<Line>(): current output of a data line
+//   clock(): shift the registers by one bit
+constexpr uint8_t SCAN_RAW_BYTES = 8;
+
+// Layouts in flash
+extern const uint8_t SCAN_LAYOUT_REV_A[64];
+
+// Four chains of 16 sensors, one per data line
+struct BoardRevA {
+    static constexpr uint8_t DataLines     = 4;
+    static constexpr uint8_t ClocksPerScan = 16;
+    static constexpr uint8_t getLine(uint8_t p_chain) { return p_chain; }
+    static const uint8_t* getLayout() { return SCAN_LAYOUT_REV_A; }
+};
+
+// Chains jumped two by two: 32 sensors on data lines 0 and 2, raw bits in the same order as revision A
+struct BoardRevAJumped {
+    static constexpr uint8_t DataLines     = 2;
+    static constexpr uint8_t ClocksPerScan = 32;
+    static constexpr uint8_t getLine(uint8_t p_chain) { return p_chain * 2; }
+    static const uint8_t* getLayout() { return SCAN_LAYOUT_REV_A; }
+};
+
+// Shift one bit of each chain into its byte (first bit read ends as bit 0), unrolled at compile time
+template <class Revision, class Gpio, uint8_t Chain, bool Done = (Chain >= Revision::DataLines)>
+struct ScanChains {
+    static inline void shift(uint8_t* p_bytes) {
+        p_bytes[Chain] = (p_bytes[Chain] >> 1) | (Gpio::template isDataHigh<Revision::getLine(Chain)>() ? 0x80 : 0);
+        ScanChains<Revision, Gpio, Chain + 1>::shift(p_bytes);
+    }
+};
+
+template <class Revision, class Gpio, uint8_t Chain>
+struct ScanChains<Revision, Gpio, Chain, true> {
+    static inline void shift(uint8_t*) {}
+};
+
+// Raw bits in scan order, SCAN_RAW_BYTES bytes
+template <class Revision, class Gpio>
+void scanRawBoard(uint8_t* p_raw) {
+    // Sensors are only powered while they are latched
+    Gpio::powerOn();
+    Gpio::load();
+    Gpio::powerOff();
+
+    constexpr uint8_t bytesPerChain = Revision::ClocksPerScan / 8;
+    for (uint8_t group = 0; group < bytesPerChain; group++) {
+        uint8_t bytes[Revision::DataLines] = {0};
+        for (uint8_t i = 0; i < 8; i++) {
+            ScanChains<Revision, Gpio, 0>::shift(bytes);
+            Gpio::clock();
+        }
+        for (uint8_t chain = 0; chain < Revision::DataLines; chain++)
+            p_raw[chain * bytesPerChain + group] = bytes[chain];
+    }
+}
+
+// Sensors state from raw bits and a layout in RAM, LSB = a1, b1... MSB = h8
+uint64_t mapRawBoard(const uint8_t* p_raw, const uint8_t* p_layout);
+
+template <class Revision, class Gpio>
+uint64_t scanBoard(const uint8_t* p_layout) {
+    uint8_t raw[SCAN_RAW_BYTES];
+    scanRawBoard<Revision, Gpio>(raw);
+    return mapRawBoard(raw, p_layout);
+}
+
+// Copy a layout from flash
+void loadScanLayout(uint8_t* p_layout, const uint8_t* p_flashLayout);
+
+// Whether each raw bit is used by exactly one square
+bool isScanLayoutValid(const uint8_t* p_layout);
+
+// Learns the layout of an unknown wiring: starting from an empty board, a piece is placed on a1, b1... h8
+// in turn (lifting it in between or not). Each newly set raw bit is the one of the next square.
+typedef struct {
+    uint8_t layout[64];
+    uint64_t raw;      // Raw bits of the last scan
+    uint64_t assigned; // Raw bits already learnt
+    uint8_t square;    // Next square to learn, 64 once done
+} ScanCalibration;
+
+void startScanCalibration(ScanCalibration* p_calibration, const uint8_t* p_raw);
+
+// Follow a stable raw scan, returns true once every square has been learnt
+bool updateScanCalibration(ScanCalibration* p_calibration, const uint8_t* p_raw);
+
+// Native GPIO policy: shift registers wired as the revision layout says, loaded from a sensors state.
+// Counts pin operations, so that scans can be compared without the target.
+template <class Revision>
+struct MockShiftRegisters {
+    static uint64_t sensors; // Board seen by the hall sensors
+    static uint32_t registers[4];
+    static bool powered;
+    static uint32_t loads;
+    static uint32_t reads;
+    static uint32_t clocks;
+
+    static void reset(uint64_t p_sensors) {
+        sensors = p_sensors;
+        powered = false;
+        loads   = 0;
+        reads   = 0;
+        clocks  = 0;
+        for (uint8_t line = 0; line < 4; line++)
+            registers[line] = 0;
+    }
+
+    static void powerOn() { powered = true; }
+    static void powerOff() { powered = false; }
+
+    static void load() {
+        // Unpowered sensors read as empty squares
+        loads++;
+        for (uint8_t line = 0; line < 4; line++)
+            registers[line] = 0;
+        uint8_t layout[64];
+        loadScanLayout(layout, Revision::getLayout());
+        for (uint8_t square = 0; square < 64; square++) {
+            if (powered && ((sensors >> square) & 1)) {
+                const uint8_t chain = layout[square] / Revision::ClocksPerScan;
+                registers[Revision::getLine(chain)] |= (1uL << (layout[square] % Revision::ClocksPerScan));
+            }
+        }
+    }
+
+    template <uint8_t Line>
+    static bool isDataHigh() {
+        reads++;
+        return registers[Line] & 1;
+    }
+
+    static void clock() {
+        clocks++;
+        for (uint8_t line = 0; line < 4; line++)
+            registers[line] >>= 1;
+    }
+};
+
+template <class Revision>
+uint64_t MockShiftRegisters<Revision>::sensors = 0;
+template <class Revision>
+uint32_t MockShiftRegisters<Revision>::registers[4] = {0, 0, 0, 0};
+template <class Revision>
+bool MockShiftRegisters<Revision>::powered = false;
+template <class Revision>
+uint32_t MockShiftRegisters<Revision>::loads = 0;
+template <class Revision>
+uint32_t MockShiftRegisters<Revision>::reads = 0;
+template <class Revision>
+uint32_t MockShiftRegisters<Revision>::clocks = 0;
@@ -0,0 +1,136 @@
+#include "scheduler.h"
+
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+void initializeScheduler(Scheduler* p_scheduler, SchedulerClock p_clock)
+//-----------------------------------------------------------------------------
+{
+    p_scheduler->count = 0;
+    p_scheduler->clock = p_clock;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t addTask(Scheduler* p_scheduler, TaskFunction p_run, void* p_context, uint32_t p_period_us, uint32_t p_deadline_us)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_run || p_scheduler->count >= SCHEDULER_MAX_TASKS)
+        return SCHEDULER_NO_TASK;
+
+    Task* task        = &p_scheduler->tasks[p_scheduler->count];
+    task->run         = p_run;
+    task->context     = p_context;
+    task->period_us   = p_period_us;
+    task->deadline_us = p_deadline_us;
+    task->release_us  = p_scheduler->clock() + p_period_us;
+    task->released    = false;
+    task->runs        = 0;
+    task->overruns    = 0;
+    task->skipped     = 0;
+
+    return p_scheduler->count++;
+}
+
+//-----------------------------------------------------------------------------
+void triggerTask(Scheduler* p_scheduler, uint8_t p_task)
+//-----------------------------------------------------------------------------
+{
+    if (p_task >= p_scheduler->count)
+        return;
+
+    Task* task = &p_scheduler->tasks[p_task];
+    if (task->released)
+        return;
+
+    task->release_us = p_scheduler->clock();
+    task->released   = true;
+}
+
+//-----------------------------------------------------------------------------
+static bool isReleased(Task* p_task, uint32_t p_now_us)
+//-----------------------------------------------------------------------------
+{
+    if (0 == p_task->period_us)
+        return p_task->released;
+
+    return (int32_t)(p_now_us - p_task->release_us) >= 0;
+}
+
+//-----------------------------------------------------------------------------
+void setTaskPeriod(Scheduler* p_scheduler, uint8_t p_task, uint32_t p_period_us)
+//-----------------------------------------------------------------------------
+{
+    if (p_task >= p_scheduler->count || 0 == p_period_us)
+        return;
+
+    Task* task = &p_scheduler->tasks[p_task];
+    if (0 == task->period_us || task->period_us == p_period_us)
+        return;
+
+    // Released one new period from now at most (from its own run, the next release follows the new period)
+    const uint32_t release = p_scheduler->clock() + p_period_us;
+    if ((int32_t)(release - task->release_us) < 0)
+        task->release_us = release;
+    task->period_us   = p_period_us;
+    task->deadline_us = p_period_us;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t getSchedulerIdleTime(Scheduler* p_scheduler)
+//-----------------------------------------------------------------------------
+{
+    const uint32_t now = p_scheduler->clock();
+    uint32_t idle      = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < p_scheduler->count; i++) {
+        const Task* task = &p_scheduler->tasks[i];
+        if (0 == task->period_us) {
+            if (task->released)
+                return 0;
+            continue;
+        }
+
+        const int32_t wait = (int32_t)(task->release_us - now);
+        if (wait <= 0)
+            return 0;
+        if ((uint32_t)wait < idle)
+            idle = wait;
+    }
+    return idle;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t runScheduler(Scheduler* p_scheduler)
+//-----------------------------------------------------------------------------
+{
+    uint8_t ran = 0;
+
+    for (uint8_t i = 0; i < p_scheduler->count; i++) {
+        Task* task           = &p_scheduler->tasks[i];
+        const uint32_t start = p_scheduler->clock();
+        if (!isReleased(task, start))
+            continue;
+
+        const uint32_t release = task->release_us;
+        task->released         = false;
+        task->run(task->context, start);
+        task->runs++;
+        ran++;
+
+        const uint32_t end = p_scheduler->clock();
+        if (end - release > task->deadline_us && task->overruns < 0xFFFF)
+            task->overruns++;
+
+        if (task->period_us > 0) {
+            // Keep a fixed rate, but do not try to catch up on whole periods missed
+            task->release_us += task->period_us;
+            const uint32_t late = end - task->release_us;
+            if ((int32_t)late >= 0 && late >= task->period_us) {
+                const uint32_t missed = late / task->period_us;
+                task->skipped         = (task->skipped + missed > 0xFFFF) ? 0xFFFF : task->skipped + missed;
+                task->release_us += missed * task->period_us;
+            }
+        }
+    }
+
+    return ran;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+// Cooperative scheduler: tasks run to completion from the main loop, in registration order.
+// Periodic tasks are released every period, triggered tasks (period 0) when triggerTask() is called.
+// A task overruns when it finishes more than its deadline after its release.
+
+constexpr uint8_t SCHEDULER_MAX_TASKS = 8;
+constexpr uint8_t SCHEDULER_NO_TASK   = 0xFF;
+
+// Task body, p_now_us is the time the task has been started
+typedef void (*TaskFunction)(void* p_context, uint32_t p_now_us);
+
+// Time source, micros() on target and a virtual clock in tests
+typedef uint32_t (*SchedulerClock)();
+
+typedef struct {
+    TaskFunction run;
+    void* context;
+    uint32_t period_us;   // 0 for triggered tasks
+    uint32_t deadline_us; // Allowed time between release and end of the task
+    uint32_t release_us;  // Next (or pending) release
+    bool released;        // Triggered task waiting to run
+    uint32_t runs;
+    uint16_t overruns; // Runs that finished after their deadline
+    uint16_t skipped;  // Periodic releases missed because the task was late by a whole period
+} Task;
+
+typedef struct {
+    Task tasks[SCHEDULER_MAX_TASKS];
+    uint8_t count;
+    SchedulerClock clock;
+} Scheduler;
+
+void initializeScheduler(Scheduler* p_scheduler, SchedulerClock p_clock);
+
+// Register a task, first release is one period from now (or on first trigger),
+// returns its index or SCHEDULER_NO_TASK if the scheduler is full
+uint8_t addTask(Scheduler* p_scheduler, TaskFunction p_run, void* p_context, uint32_t p_period_us, uint32_t p_deadline_us);
+
+// Release a task on next scheduler pass, nothing if it is already released
+void triggerTask(Scheduler* p_scheduler, uint8_t p_task);
+
+// Change the period (and deadline) of a periodic task, a shorter period brings
+// its next release forward to one period from now
+void setTaskPeriod(Scheduler* p_scheduler, uint8_t p_task, uint32_t p_period_us);
+
+// Time until the next release, 0 when a task is released: how long the MCU may sleep
+uint32_t getSchedulerIdleTime(Scheduler* p_scheduler);
+
+// Run released tasks once each, returns the number of tasks run
+uint8_t runScheduler(Scheduler* p_scheduler);
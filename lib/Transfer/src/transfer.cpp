@@ -0,0 +1,313 @@
+#include "transfer.h"
+
+#include <stddef.h>
+
+// Keep buffer accesses on their side of the head/tail updates
+#define TRANSFER_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+//-----------------------------------------------------------------------------
+void initializeTransferRing(TransferRing* p_ring, uint8_t* p_buffer, uint16_t p_capacity)
+//-----------------------------------------------------------------------------
+{
+    p_ring->buffer  = p_buffer;
+    p_ring->mask    = (uint8_t)(p_capacity - 1);
+    p_ring->head    = 0;
+    p_ring->tail    = 0;
+    p_ring->pending = 0;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t getTransferCount(TransferRing* p_ring)
+//-----------------------------------------------------------------------------
+{
+    return (uint8_t)(p_ring->head - p_ring->tail) & p_ring->mask;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t getTransferSpace(TransferRing* p_ring)
+//-----------------------------------------------------------------------------
+{
+    return p_ring->mask - ((uint8_t)(p_ring->pending - p_ring->tail) & p_ring->mask);
+}
+
+//-----------------------------------------------------------------------------
+static inline void pushTransfer(TransferRing* p_ring, uint8_t p_value)
+//-----------------------------------------------------------------------------
+{
+    p_ring->buffer[p_ring->pending & p_ring->mask] = p_value;
+    p_ring->pending                                = (p_ring->pending + 1) & p_ring->mask;
+}
+
+//-----------------------------------------------------------------------------
+static inline void commitTransfers(TransferRing* p_ring)
+//-----------------------------------------------------------------------------
+{
+    TRANSFER_BARRIER();
+    p_ring->head = p_ring->pending;
+}
+
+//-----------------------------------------------------------------------------
+static inline uint8_t popTransfer(TransferRing* p_ring)
+//-----------------------------------------------------------------------------
+{
+    const uint8_t tail  = p_ring->tail;
+    const uint8_t value = p_ring->buffer[tail];
+    TRANSFER_BARRIER();
+    p_ring->tail = (tail + 1) & p_ring->mask;
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+void initializeDisplayTransfers(DisplayTransfers* p_transfers, uint8_t* p_lcdBuffer, uint16_t p_lcdCapacity, uint8_t* p_i2cBuffer, uint16_t p_i2cCapacity)
+//-----------------------------------------------------------------------------
+{
+    initializeTransferRing(&p_transfers->lcd, p_lcdBuffer, p_lcdCapacity);
+    initializeTransferRing(&p_transfers->i2c, p_i2cBuffer, p_i2cCapacity);
+    p_transfers->lcdReadyAt_us    = 0;
+    p_transfers->i2cFrameStart    = 0;
+    p_transfers->i2cFrameOverflow = false;
+    p_transfers->i2cRemaining     = 0;
+    p_transfers->i2cInFrame       = false;
+}
+
+//-----------------------------------------------------------------------------
+static void pushLcdByte(DisplayTransfers* p_transfers, uint8_t p_value, uint8_t p_flags)
+//-----------------------------------------------------------------------------
+{
+    // 4-bit mode: high nibble first
+    pushTransfer(&p_transfers->lcd, (p_value >> 4) | (p_flags & LCD_OP_DATA));
+    pushTransfer(&p_transfers->lcd, (p_value & 0x0F) | p_flags | LCD_OP_LAST);
+}
+
+//-----------------------------------------------------------------------------
+bool queueLcdCommand(DisplayTransfers* p_transfers, uint8_t p_command)
+//-----------------------------------------------------------------------------
+{
+    if (getTransferSpace(&p_transfers->lcd) < 2)
+        return false;
+
+    // Clear display (0x01) and return home (0x02/0x03) are much slower than other instructions
+    pushLcdByte(p_transfers, p_command, (p_command <= 0x03) ? LCD_OP_SLOW : 0);
+    commitTransfers(&p_transfers->lcd);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool queueLcdData(DisplayTransfers* p_transfers, uint8_t p_data)
+//-----------------------------------------------------------------------------
+{
+    if (getTransferSpace(&p_transfers->lcd) < 2)
+        return false;
+
+    pushLcdByte(p_transfers, p_data, LCD_OP_DATA);
+    commitTransfers(&p_transfers->lcd);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool queueLcdSetCursor(DisplayTransfers* p_transfers, uint8_t p_col, uint8_t p_row)
+//-----------------------------------------------------------------------------
+{
+    // Set DDRAM address, second row starts at 0x40
+    return queueLcdCommand(p_transfers, 0x80 | (p_col + (p_row ? 0x40 : 0x00)));
+}
+
+//-----------------------------------------------------------------------------
+bool queueLcdString(DisplayTransfers* p_transfers, const char* p_string)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr == p_string)
+        return false;
+
+    uint16_t length = 0;
+    while (p_string[length] != 0)
+        length++;
+
+    // Whole string or nothing
+    if (getTransferSpace(&p_transfers->lcd) < 2 * length)
+        return false;
+
+    for (uint16_t i = 0; i < length; i++)
+        pushLcdByte(p_transfers, p_string[i], LCD_OP_DATA);
+    commitTransfers(&p_transfers->lcd);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool beginI2cFrame(DisplayTransfers* p_transfers, uint8_t p_address)
+//-----------------------------------------------------------------------------
+{
+    TransferRing* ring = &p_transfers->i2c;
+    if (getTransferSpace(ring) < 2) {
+        p_transfers->i2cFrameOverflow = true;
+        return false;
+    }
+
+    p_transfers->i2cFrameStart    = ring->pending;
+    p_transfers->i2cFrameOverflow = false;
+    pushTransfer(ring, 0); // Length, written by endI2cFrame()
+    pushTransfer(ring, p_address);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool queueI2cByte(DisplayTransfers* p_transfers, uint8_t p_byte)
+//-----------------------------------------------------------------------------
+{
+    TransferRing* ring   = &p_transfers->i2c;
+    const uint8_t length = ((uint8_t)(ring->pending - p_transfers->i2cFrameStart) & ring->mask) - 2;
+    const bool frameFull = (length >= I2C_MAX_FRAME);
+    if (p_transfers->i2cFrameOverflow || frameFull || 0 == getTransferSpace(ring)) {
+        p_transfers->i2cFrameOverflow = true;
+        return false;
+    }
+
+    pushTransfer(ring, p_byte);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool endI2cFrame(DisplayTransfers* p_transfers)
+//-----------------------------------------------------------------------------
+{
+    TransferRing* ring = &p_transfers->i2c;
+    if (p_transfers->i2cFrameOverflow) {
+        // Drop the incomplete frame, it has never been published
+        ring->pending                 = ring->head;
+        p_transfers->i2cFrameOverflow = false;
+        return false;
+    }
+
+    const uint8_t start = p_transfers->i2cFrameStart;
+    ring->buffer[start] = ((uint8_t)(ring->pending - start) & ring->mask) - 2;
+    commitTransfers(ring);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+uint8_t getOledTransferSize(uint8_t p_count)
+//-----------------------------------------------------------------------------
+{
+    // Each frame takes 2 bytes of header (length, address) and starts with a control byte
+    const uint16_t data = p_count * 8;
+    return (2 + 1 + 3) + data + 3 * ((data + OLED_DATA_FRAME - 1) / OLED_DATA_FRAME);
+}
+
+//-----------------------------------------------------------------------------
+bool beginWaitingI2cFrame(DisplayTransfers* p_transfers, uint8_t p_address, I2cSpaceWaiter p_wait)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr != p_wait && getTransferSpace(&p_transfers->i2c) < 2)
+        p_wait(2);
+    return beginI2cFrame(p_transfers, p_address);
+}
+
+//-----------------------------------------------------------------------------
+bool queueWaitingI2cBytes(DisplayTransfers* p_transfers, const uint8_t* p_bytes, uint8_t p_count, I2cSpaceWaiter p_wait)
+//-----------------------------------------------------------------------------
+{
+    if (nullptr != p_wait && getTransferSpace(&p_transfers->i2c) < p_count)
+        p_wait(p_count);
+
+    bool queued = true;
+    while (p_count-- > 0)
+        queued &= queueI2cByte(p_transfers, *p_bytes++);
+    return queued;
+}
+
+//-----------------------------------------------------------------------------
+uint16_t serviceLcdTransfer(DisplayTransfers* p_transfers, uint32_t p_now_us, LcdNibbleWriter p_writer)
+//-----------------------------------------------------------------------------
+{
+    if (0 == getTransferCount(&p_transfers->lcd))
+        return 0;
+
+    if ((int32_t)(p_now_us - p_transfers->lcdReadyAt_us) < 0)
+        return 0; // Controller still busy with the previous instruction
+
+    const uint8_t op = popTransfer(&p_transfers->lcd);
+    p_writer(op & 0x0F, 0 != (op & LCD_OP_DATA));
+
+    uint16_t busy = 0;
+    if (op & LCD_OP_SLOW)
+        busy = LCD_SLOW_BUSY_US;
+    else if (op & LCD_OP_LAST)
+        busy = LCD_BUSY_US;
+    p_transfers->lcdReadyAt_us = p_now_us + LCD_NIBBLE_US + busy;
+
+    return LCD_NIBBLE_US;
+}
+
+//-----------------------------------------------------------------------------
+EI2cAction nextI2cAction(DisplayTransfers* p_transfers, uint8_t* p_byte)
+//-----------------------------------------------------------------------------
+{
+    TransferRing* ring = &p_transfers->i2c;
+
+    if (!p_transfers->i2cInFrame) {
+        if (0 == getTransferCount(ring))
+            return I2cIdle;
+
+        p_transfers->i2cRemaining = popTransfer(ring);
+        *p_byte                   = popTransfer(ring);
+        p_transfers->i2cInFrame   = true;
+        return I2cStart;
+    }
+
+    if (p_transfers->i2cRemaining > 0) {
+        *p_byte = popTransfer(ring);
+        p_transfers->i2cRemaining--;
+        return I2cWrite;
+    }
+
+    p_transfers->i2cInFrame = false;
+    return I2cStop;
+}
+
+//-----------------------------------------------------------------------------
+void abortI2cFrame(DisplayTransfers* p_transfers)
+//-----------------------------------------------------------------------------
+{
+    // Keep the frame open: its stop condition is the next action
+    while (p_transfers->i2cRemaining > 0) {
+        popTransfer(&p_transfers->i2c);
+        p_transfers->i2cRemaining--;
+    }
+}
+
+//-----------------------------------------------------------------------------
+uint16_t serviceTransferSlice(DisplayTransfers* p_transfers, uint32_t p_now_us, uint16_t p_budget_us, const DisplayBus* p_bus)
+//-----------------------------------------------------------------------------
+{
+    uint16_t spent = 0;
+
+    // Never start an operation that could overrun the budget
+    while (spent + TRANSFER_MAX_OP_US <= p_budget_us) {
+        uint16_t used = serviceLcdTransfer(p_transfers, p_now_us + spent, p_bus->writeLcdNibble);
+
+        if (0 == used) {
+            // LCD is idle or busy: use the time for I2C
+            uint8_t byte            = 0;
+            const EI2cAction action = nextI2cAction(p_transfers, &byte);
+            if (I2cIdle == action)
+                break;
+
+            p_bus->writeI2c(action, byte);
+            switch (action) {
+            case I2cStart:
+                used = I2C_CONDITION_US + I2C_BYTE_US;
+                break;
+            case I2cWrite:
+                used = I2C_BYTE_US;
+                break;
+            default:
+                used = I2C_CONDITION_US;
+                break;
+            }
+        }
+
+        spent += used;
+    }
+
+    return spent;
+}
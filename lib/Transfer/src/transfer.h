@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+
+// Display bus operations are queued by the main loop and sent in the background, either from
+// interrupts or by small polled slices, so that the game loop never waits on a display bus.
+
+// Bus timings (HD44780 in 4-bit mode, I2C at 400 kHz)
+constexpr uint16_t LCD_NIBBLE_US    = 2;    // Data setup and enable pulse
+constexpr uint16_t LCD_BUSY_US      = 40;   // Execution time of most instructions
+constexpr uint16_t LCD_SLOW_BUSY_US = 1600; // Execution time of clear and home
+constexpr uint16_t I2C_BYTE_US      = 23;   // 9 clocks
+constexpr uint16_t I2C_CONDITION_US = 3;    // Start or stop condition
+
+// Longest single operation (start condition and address byte)
+constexpr uint16_t TRANSFER_MAX_OP_US = I2C_CONDITION_US + I2C_BYTE_US;
+
+// LCD queue entries: a nibble with flags
+constexpr uint8_t LCD_OP_DATA = 0b00010000; // RS high (data register)
+constexpr uint8_t LCD_OP_LAST = 0b00100000; // Second nibble of a byte: controller is busy afterwards
+constexpr uint8_t LCD_OP_SLOW = 0b01000000; // Instruction with a long execution time
+
+// I2C queue entries are frames: [length] [address] [length bytes]
+constexpr uint8_t I2C_MAX_FRAME = 32;
+
+// SSD1306 tiles sent by u8x8 (u8x8_cad_ssd13xx_fast_i2c): one command frame (control byte, column high and low,
+// page), then data frames of up to OLED_DATA_FRAME bytes after their control byte
+constexpr uint8_t OLED_DATA_FRAME = 24;
+
+typedef enum {
+    I2cIdle = 0,
+    I2cStart, // Start condition then address byte
+    I2cWrite,
+    I2cStop,
+} EI2cAction;
+
+// Single producer / single consumer byte ring, capacity is a power of 2 up to 256
+typedef struct {
+    uint8_t* buffer;
+    uint8_t mask;
+    volatile uint8_t head; // Published by the producer
+    volatile uint8_t tail; // Advanced by the consumer
+    uint8_t pending;       // Producer write position, published by commitTransfers()
+} TransferRing;
+
+typedef struct {
+    TransferRing lcd;
+    TransferRing i2c;
+    uint32_t lcdReadyAt_us; // Consumer: LCD controller busy until then
+    uint8_t i2cFrameStart;  // Producer: position of the length byte of the frame being written
+    bool i2cFrameOverflow;  // Producer: the frame being written did not fit
+    uint8_t i2cRemaining;   // Consumer: bytes left in the frame being sent
+    bool i2cInFrame;        // Consumer: a frame is being sent
+} DisplayTransfers;
+
+typedef void (*LcdNibbleWriter)(uint8_t p_nibble, bool p_data);
+typedef void (*I2cActionWriter)(EI2cAction p_action, uint8_t p_byte);
+
+typedef struct {
+    LcdNibbleWriter writeLcdNibble;
+    I2cActionWriter writeI2c;
+} DisplayBus;
+
+void initializeTransferRing(TransferRing* p_ring, uint8_t* p_buffer, uint16_t p_capacity);
+
+// Published entries not consumed yet
+uint8_t getTransferCount(TransferRing* p_ring);
+
+// Entries the producer can still write
+uint8_t getTransferSpace(TransferRing* p_ring);
+
+void initializeDisplayTransfers(DisplayTransfers* p_transfers, uint8_t* p_lcdBuffer, uint16_t p_lcdCapacity, uint8_t* p_i2cBuffer, uint16_t p_i2cCapacity);
+
+// Producer side (main loop), nothing is queued when there is not enough space
+bool queueLcdCommand(DisplayTransfers* p_transfers, uint8_t p_command);
+bool queueLcdData(DisplayTransfers* p_transfers, uint8_t p_data);
+bool queueLcdSetCursor(DisplayTransfers* p_transfers, uint8_t p_col, uint8_t p_row);
+bool queueLcdString(DisplayTransfers* p_transfers, const char* p_string);
+bool beginI2cFrame(DisplayTransfers* p_transfers, uint8_t p_address);
+bool queueI2cByte(DisplayTransfers* p_transfers, uint8_t p_byte);
+bool endI2cFrame(DisplayTransfers* p_transfers);
+
+// Queue space needed to send p_count tiles to the SSD1306, frame headers included
+uint8_t getOledTransferSize(uint8_t p_count);
+
+// Start a frame or queue bytes for the u8x8 byte procedure. p_wait (optional) is called when the queue is short of the
+// space of this write, and of this write only: tiles admitted with getOledTransferSize() are queued without waiting.
+typedef void (*I2cSpaceWaiter)(uint8_t p_space);
+bool beginWaitingI2cFrame(DisplayTransfers* p_transfers, uint8_t p_address, I2cSpaceWaiter p_wait);
+bool queueWaitingI2cBytes(DisplayTransfers* p_transfers, const uint8_t* p_bytes, uint8_t p_count, I2cSpaceWaiter p_wait);
+
+// Consumer side (interrupts or polled slices)
+// Send the next LCD nibble if the controller is ready, returns the bus time used (0 if nothing sent)
+uint16_t serviceLcdTransfer(DisplayTransfers* p_transfers, uint32_t p_now_us, LcdNibbleWriter p_writer);
+
+// Get the next I2C action to perform
+EI2cAction nextI2cAction(DisplayTransfers* p_transfers, uint8_t* p_byte);
+
+// Drop the rest of the frame being sent (bus error), next action is its stop condition
+void abortI2cFrame(DisplayTransfers* p_transfers);
+
+// Poll both buses for at most p_budget_us, returns the bus time used
+uint16_t serviceTransferSlice(DisplayTransfers* p_transfers, uint32_t p_now_us, uint16_t p_budget_us, const DisplayBus* p_bus);
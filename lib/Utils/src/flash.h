@@ -0,0 +1,27 @@
+#pragma once
+
+// Constant strings and tables kept in flash: the Leonardo only has 2.5 KB of SRAM and its constants
+// are otherwise copied to RAM at startup. Natively, flash reads are plain reads of the constants.
+//   static const uint8_t s_table[4] PROGMEM = {...};  read with pgm_read_byte(&s_table[i])
+//   strcpy_P(buffer, PSTR("text"));                    copy a flash string to a RAM buffer
+#ifdef ARDUINO_ARCH_AVR
+#include <avr/pgmspace.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(p_string) (p_string)
+#define pgm_read_byte(p_address) (*(const uint8_t*)(p_address))
+#define pgm_read_word(p_address) (*(const uint16_t*)(p_address))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strcat_P strcat
+#define strlen_P strlen
+#define sprintf_P sprintf
+#define sscanf_P sscanf
+#endif
+
+// Signed bytes of a flash table
+#define pgm_read_int8(p_address) ((int8_t)pgm_read_byte(p_address))
@@ -2,102 +2,406 @@
 #include <LiquidCrystal.h>
 #include <U8g2lib.h>
 
+#include <book.h>
 #include <chess.h>
+#include <eval.h>
+#include <flash.h>
 #include <hardware.h>
+#include <journal.h>
+#include <oled.h>
+#include <power.h>
+#include <profiler.h>
+#include <scan.h>
+#include <scheduler.h>
+#include <signature.h>
+#include <string.h>
+
+// Task periods and deadlines
+constexpr uint32_t BUTTONS_PERIOD_US  = 20000; // 50 Hz
+constexpr uint32_t DISPLAY_PERIOD_US  = 66667; // 15 Hz
+constexpr uint32_t TRANSFER_PERIOD_US = 1000;
+constexpr uint32_t JOURNAL_PERIOD_US  = 4000; // EEPROM byte write takes 3.3 ms
+constexpr uint32_t GAME_DEADLINE_US   = 10000;
+constexpr uint16_t TRANSFER_SLICE_US  = 500;  // Time given to display transfers when they are not sent from interrupts
+constexpr uint32_t SLEEP_MIN_US       = 1100; // Idle time worth sleeping: timer 0 wakes the MCU every 1024 us
 
 LiquidCrystal lcd(PIN_LCD_RS, PIN_LCD_EN,
                   PIN_LCD_D0, PIN_LCD_D1, PIN_LCD_D2, PIN_LCD_D3);
 
-U8G2_SSD1306_128X32_UNIVISION_1_HW_I2C oled(U8G2_R0);
+// Tile-based u8x8 interface: no page buffer, only changed tiles are queued
+U8X8_SSD1306_128X32_UNIVISION_QUEUED_I2C oled;
+OledRenderer oledRenderer;
+
+// Text last queued for each LCD line, only changed lines are sent
+char lcdLines[2][17];
 
 Game game;
+SignatureTable signatures; // Legal moves of the position, to commit moves made between two scans
+uint16_t opening = BOOK_NO_OPENING; // Last book position reached, kept once out of book
+Journal journal; // Committed moves in EEPROM, to resume the game after a power loss
 
 uint64_t lastBoardState = DEFAULT_SENSORS_STATE;
 
-void setup() {
-    initChessboard();
-    lcd.begin(16, 2);
-    oled.begin();
-    Serial.begin(115200);
-    initializeGame(&game, lastBoardState);
+Scheduler scheduler;
+uint8_t scanTask = SCHEDULER_NO_TASK; // Period set by the scan policy
+uint8_t gameTask = SCHEDULER_NO_TASK;
+ScanPolicy scanPolicy;
+
+// Sensors layout learnt from pieces placed on a1, b1... h8 (serial command 'C' or long press on Select)
+ScanCalibration calibration;
+bool calibrating       = false;
+bool selectLongPressed = false; // Select release does not reset the game after a long press
+
+// Sensor to display latency of moves
+MoveLatencyTracker moveLatency;
+bool moveDisplayPending = false; // Committed move not queued to both displays yet
+
+bool writeOledTiles(void* p_context, uint8_t p_x, uint8_t p_y, uint8_t p_count, const uint8_t* p_tiles) {
+    // Never wait for the bus: tiles are drawn again on next loop
+    if (getTransferSpace(&getDisplayTransfers()->i2c) < getOledTransferSize(p_count))
+        return false;
+
+    oled.drawTile(p_x, p_y, p_count, const_cast<uint8_t*>(p_tiles));
+    return true;
 }
 
-void loop() {
-    const LCD_KEY keyPressed = getLastLcdKeyPressed();
+bool writeLcdLine(uint8_t p_row, const char* p_text) {
+    char line[17];
+    uint8_t length = 0;
+    for (; length < 16 && p_text[length] != 0; length++)
+        line[length] = p_text[length];
+    for (; length < 16; length++)
+        line[length] = ' ';
+    line[16] = 0;
 
-#ifdef USE_SERIAL_CHESSBOARD
-    uint64_t boardState = lastBoardState;
-
-    {
-        int c = Serial.read();
-        if ((c == '+' || c == '-') && Serial.available() >= 2) {
-            char buffer[2];
-            Serial.readBytes(buffer, 2);
-            uint8_t square = getSquareFromStr(buffer);
-            if (c == '+') {
-                boardState |= (1uLL << square);
-            } else {
-                boardState &= ~(1uLL << square);
-            }
-        }
-        if (c == '=' && Serial.available() >= 16) {
-            char hexBuffer[17];
-            if (16 == Serial.readBytes(hexBuffer, 16)) {
-                hexBuffer[16] = 0;
-                uint32_t low  = strtoul(&hexBuffer[8], nullptr, 16);
-                hexBuffer[8]  = 0;
-                uint32_t high = strtoul(hexBuffer, nullptr, 16);
-                boardState    = ((uint64_t)high << 32) | low;
-            }
+    if (0 == strcmp(line, lcdLines[p_row]))
+        return true;
+
+    // Cursor and text are queued together, or the line is written again on next loop
+    DisplayTransfers* transfers = getDisplayTransfers();
+    if (getTransferSpace(&transfers->lcd) < 2 + 2 * 16)
+        return false;
+
+    queueLcdSetCursor(transfers, 0, p_row);
+    queueLcdString(transfers, line);
+    kickLcdTransfers();
+    strcpy(lcdLines[p_row], line);
+    return true;
+}
+
+void printSerialLine(const char* p_line) {
+    Serial.println(p_line);
+}
+
+void startNewGame(uint64_t p_boardState) {
+    initializeGame(&game, p_boardState);
+    resetSignatureTable(&signatures);
+    opening = BOOK_NO_OPENING;
+    recordJournalCheckpoint(&journal, &game);
+}
+
+#ifndef USE_SERIAL_CHESSBOARD
+void startCalibration() {
+    // Calibration starts from an empty board, asking again cancels it
+    uint8_t raw[SCAN_RAW_BYTES];
+    readRawChessboard(raw);
+    startScanCalibration(&calibration, raw);
+    calibrating = !calibrating;
+}
+#endif
+
+void handleSerialCommand(int p_command) {
+    // Latency histograms on demand
+    if (p_command == 'H')
+        dumpProfiler(&printSerialLine);
+
+    // Scan rate and sleep statistics
+    if (p_command == 'S') {
+        char line[96];
+        char number[11];
+        strcpy_P(line, scanPolicy.idle ? PSTR("scan idle ") : PSTR("scan active "));
+        strcat(line, utoa(scanPolicy.scansPerSecond, number, 10));
+        strcat_P(line, PSTR("/s sleep "));
+        strcat(line, ultoa(scanPolicy.sleepPerSecond_us, number, 10));
+        strcat_P(line, PSTR("us/s total "));
+        strcat(line, ultoa(scanPolicy.totalSleep_ms, number, 10));
+        strcat_P(line, PSTR("ms idle "));
+        strcat(line, utoa(scanPolicy.idleCount, number, 10));
+        strcat_P(line, PSTR(" keys lost "));
+        strcat(line, utoa(getLcdKeyDroppedCount(), number, 10));
+        printSerialLine(line);
+    }
+
+    // RAM left between heap and stack, constants left out of flash are part of data
+    // The stack peak covers the game task: evolveJournaledGame has no recursion nor move arrays (tools/stackdepth)
+    if (p_command == 'M') {
+        RamUsage usage;
+        getRamUsage(&usage);
+        char line[64];
+        char number[6];
+        strcpy_P(line, PSTR("ram data "));
+        strcat(line, utoa(usage.data, number, 10));
+        strcat_P(line, PSTR(" bss "));
+        strcat(line, utoa(usage.bss, number, 10));
+        strcat_P(line, PSTR(" heap "));
+        strcat(line, utoa(usage.heap, number, 10));
+        strcat_P(line, PSTR(" free "));
+        strcat(line, utoa(usage.free, number, 10));
+        strcat_P(line, PSTR(" stack peak "));
+        strcat(line, utoa(usage.stackPeak, number, 10));
+        printSerialLine(line);
+    }
+
+#ifndef USE_SERIAL_CHESSBOARD
+    if (p_command == 'C')
+        startCalibration();
+#endif
+}
+
+uint64_t readSerialChessboard(uint64_t p_boardState) {
+    uint64_t boardState = p_boardState;
+
+    int c = Serial.read();
+    if ((c == '+' || c == '-') && Serial.available() >= 2) {
+        char buffer[2];
+        Serial.readBytes(buffer, 2);
+        uint8_t square = getSquareFromStr(buffer);
+        if (c == '+') {
+            boardState |= (1uLL << square);
+        } else {
+            boardState &= ~(1uLL << square);
         }
-        if (c == 'Z') {
-            boardState = DEFAULT_SENSORS_STATE;
-            initializeGame(&game, boardState);
+    }
+    if (c == '=' && Serial.available() >= 16) {
+        char hexBuffer[17];
+        if (16 == Serial.readBytes(hexBuffer, 16)) {
+            hexBuffer[16] = 0;
+            uint32_t low  = strtoul(&hexBuffer[8], nullptr, 16);
+            hexBuffer[8]  = 0;
+            uint32_t high = strtoul(hexBuffer, nullptr, 16);
+            boardState    = ((uint64_t)high << 32) | low;
         }
     }
+    if (c == 'Z') {
+        boardState = DEFAULT_SENSORS_STATE;
+        startNewGame(boardState);
+    }
+    handleSerialCommand(c);
+
+    return boardState;
+}
+
+#ifndef USE_SERIAL_CHESSBOARD
+void runCalibration() {
+    // Raw bits debounced as a board state
+    uint8_t raw[SCAN_RAW_BYTES];
+    readRawChessboard(raw);
+    uint64_t state;
+    memcpy(&state, raw, sizeof(raw));
+    state = stabilizeBoardState(state);
+    memcpy(raw, &state, sizeof(raw));
+
+    if (updateScanCalibration(&calibration, raw)) {
+        calibrating = false;
+        Serial.println(saveChessboardLayout(calibration.layout) ? F("Calibration saved") : F("Calibration failed"));
+    }
+}
+#endif
+
+void runScanTask(void* p_context, uint32_t p_now_us) {
+#ifdef USE_SERIAL_CHESSBOARD
+    const uint64_t rawState   = readSerialChessboard(lastBoardState);
+    const uint64_t boardState = rawState;
 #else
-    const uint64_t boardState = stabilizeBoardState(readChessboard());
+    if (calibrating) {
+        runCalibration();
+        return;
+    }
+
+    uint32_t start_us       = beginStage();
+    const uint64_t rawState = readChessboard();
+    endStage(StageReadBoard, start_us);
+
+    start_us                  = beginStage();
+    const uint64_t boardState = stabilizeBoardState(rawState);
+    endStage(StageStabilizeBoard, start_us);
 #endif
+    trackSensorEdges(&moveLatency, rawState, lastBoardState, boardState, p_now_us);
 
-    if (keyPressed == LCD_KEY::Select)
-        initializeGame(&game, boardState);
+    // Full rate from the first changed bit, low rate once the board has been static for a while
+    setTaskPeriod(&scheduler, scanTask, updateScanPolicy(&scanPolicy, rawState, p_now_us));
 
-        // Update game
-#ifdef USE_SERIAL_CHESSBOARD
-    if (boardState != lastBoardState)
+    // Game only evolves when the board changes
+    if (boardState != lastBoardState) {
+        lastBoardState = boardState;
+        triggerTask(&scheduler, gameTask);
+    }
+
+    // Move is displayed once both screens have been updated and their transfers sent
+    DisplayTransfers* transfers = getDisplayTransfers();
+    if (!moveDisplayPending && 0 == getTransferCount(&transfers->lcd) && 0 == getTransferCount(&transfers->i2c))
+        markMoveDisplayed(&moveLatency, p_now_us);
+}
+
+void runGameTask(void* p_context, uint32_t p_now_us) {
+    // Completed moves are journaled
+    const uint32_t start_us = beginStage();
+    bool changed            = false;
+    const bool moved        = evolveJournaledGame(&journal, &signatures, &game, lastBoardState, &changed);
+    endStage(StageEvolveGame, start_us);
+
+    // One square is followed per call: run again until the game has caught up with the board (lift and placement
+    // in one scan, moves left to evolveGame steps)
+    if (changed)
+        triggerTask(&scheduler, gameTask);
+
+    if (moved) {
+        markMoveCommitted(&moveLatency);
+        moveDisplayPending = true;
+
+        const uint16_t found = findOpening(getBuiltinOpeningBook(), getPositionKey(&game));
+        if (BOOK_NO_OPENING != found)
+            opening = found;
+    }
+}
+
+void runButtonsTask(void* p_context, uint32_t p_now_us) {
+    // Events are queued by the ADC interrupt, none is missed between two runs
+    KeypadEvent event;
+    while (getLcdKeyEvent(&event)) {
+        if (KeypadPress == event.type)
+            setTaskPeriod(&scheduler, scanTask, wakeScanPolicy(&scanPolicy, p_now_us));
+
+        if (LCD_KEY::Select != event.key)
+            continue;
+
+        // Short press resets the game, long press (re)starts calibration
+        if (KeypadPress == event.type) {
+            selectLongPressed = false;
+        } else if (KeypadLongPress == event.type) {
+            selectLongPressed = true;
+#ifndef USE_SERIAL_CHESSBOARD
+            startCalibration();
+#endif
+        } else if (!selectLongPressed) {
+            startNewGame(lastBoardState);
+        }
+    }
+
+#ifndef USE_SERIAL_CHESSBOARD
+    if (Serial.available() > 0)
+        handleSerialCommand(Serial.read());
 #endif
-    {
-        evolveGame(&game, boardState);
+}
+
+void runDisplayTask(void* p_context, uint32_t p_now_us) {
+    if (calibrating) {
+        char text[17];
+        strcpy_P(text, PSTR("Calibration"));
+        writeLcdLine(0, text);
+        strcpy_P(text, PSTR("Place piece: "));
+        writeSquareToStr(calibration.square, &text[13]);
+        text[15] = 0;
+        writeLcdLine(1, text);
+        return;
     }
 
     // Display moves on LCD screen
-    lcd.setCursor(0, 0);
-    lcd.print(game.fullmoveClock);
-    lcd.write(". ");
-    if (game.state.status == (bits::White | bits::ToPlay)) {
-        if (game.lastMoveW.piece != EPiece::Empty) {
-            lcd.write(getMoveStr(game.lastMoveW));
-            lcd.write(" ");
-            lcd.write(getMoveStr(game.lastMoveB));
+    uint32_t start_us      = beginStage();
+    bool lcdQueued         = true;
+    const bool whiteToPlay = (game.state.status == (bits::White | bits::ToPlay));
+    const bool blackToPlay = (game.state.status == (bits::Black | bits::ToPlay));
+    if (whiteToPlay || blackToPlay) {
+        char text[24];
+        utoa(game.fullmoveClock, text, 10);
+        strcat_P(text, PSTR(". "));
+        if (blackToPlay) {
+            strcat(text, getMoveStr(game.lastMoveW));
+        } else if (game.lastMoveW.piece != EPiece::Empty) {
+            // Move strings share a static buffer: append them one by one
+            strcat(text, getMoveStr(game.lastMoveW));
+            strcat_P(text, PSTR(" "));
+            strcat(text, getMoveStr(game.lastMoveB));
         }
-    } else if (game.state.status == (bits::Black | bits::ToPlay)) {
-        lcd.write(getMoveStr(game.lastMoveW));
-        lcd.write("             ");
+        lcdQueued &= writeLcdLine(0, text);
+    }
+
+    // Opening while waiting for a move, game status otherwise
+    if ((whiteToPlay || blackToPlay) && BOOK_NO_OPENING != opening) {
+        const OpeningBook* book = getBuiltinOpeningBook();
+        char text[17];
+        writeOpeningEco(book, opening, text);
+        text[BOOK_ECO_LENGTH] = ' ';
+        writeOpeningName(book, opening, &text[BOOK_ECO_LENGTH + 1], sizeof(text) - BOOK_ECO_LENGTH - 1);
+        lcdQueued &= writeLcdLine(1, text);
+    } else {
+        lcdQueued &= writeLcdLine(1, getStatusStr(game.state.status));
+    }
+    endStage(StageLcd, start_us);
+
+    // Display pieces on OLED screen, only changed squares are sent
+    start_us = beginStage();
+    renderOledBoard(&oledRenderer, &game, &writeOledTiles, nullptr);
+    renderOledEvalBar(&oledRenderer, getEvaluation(&game.evaluation), &writeOledTiles, nullptr);
+    endStage(StageOled, start_us);
+
+    if (lcdQueued && isOledBoardDrawn(&oledRenderer, &game))
+        moveDisplayPending = false;
+}
+
+void runTransferTask(void* p_context, uint32_t p_now_us) {
+    serviceDisplayTransfers(TRANSFER_SLICE_US);
+}
+
+void runJournalTask(void* p_context, uint32_t p_now_us) {
+    // One byte per EEPROM write time, the game loop never waits for the EEPROM
+    serviceJournal(&journal);
+}
+
+void setup() {
+    paintStack();
+    initChessboard();
+    lcd.begin(16, 2);
+    initDisplayTransfers();
+    oled.begin();
+    initializeOledRenderer(&oledRenderer);
+    Serial.begin(115200);
+
+    // Game journaled before the board was switched off, if its pieces are still in place
+#ifdef USE_SERIAL_CHESSBOARD
+    const uint64_t sensors = lastBoardState;
+#else
+    const uint64_t sensors = readChessboard();
+#endif
+    if (resumeJournal(&journal, getJournalStorage(), &game, sensors)) {
+        lastBoardState = sensors;
+        resetSignatureTable(&signatures);
+    } else {
+        startNewGame(lastBoardState);
+    }
+    resetProfiler();
+    initializeMoveLatencyTracker(&moveLatency);
+    initializeScanPolicy(&scanPolicy, lastBoardState, micros());
+
+    // Tasks run in registration order when released together
+    initializeScheduler(&scheduler, &micros);
+    scanTask = addTask(&scheduler, &runScanTask, nullptr, SCAN_ACTIVE_PERIOD_US, SCAN_ACTIVE_PERIOD_US);
+    gameTask = addTask(&scheduler, &runGameTask, nullptr, 0, GAME_DEADLINE_US);
+    addTask(&scheduler, &runButtonsTask, nullptr, BUTTONS_PERIOD_US, BUTTONS_PERIOD_US);
+    addTask(&scheduler, &runDisplayTask, nullptr, DISPLAY_PERIOD_US, DISPLAY_PERIOD_US);
+    addTask(&scheduler, &runJournalTask, nullptr, JOURNAL_PERIOD_US, JOURNAL_PERIOD_US);
+#if !defined(USE_DISPLAY_INTERRUPTS)
+    addTask(&scheduler, &runTransferTask, nullptr, TRANSFER_PERIOD_US, TRANSFER_PERIOD_US);
+#endif
+}
+
+void loop() {
+    runScheduler(&scheduler);
+
+    // Static board: sleep until the next interrupt when no task is due before
+    if (scanPolicy.idle && getSchedulerIdleTime(&scheduler) > SLEEP_MIN_US) {
+        const uint32_t start_us = micros();
+        sleepUntilInterrupt();
+        addScanPolicySleep(&scanPolicy, micros() - start_us);
     }
-    lcd.setCursor(0, 1);
-    lcd.print(getStatusStr(game.state.status));
-
-    // Display board state on OLED screen
-    oled.firstPage();
-    do {
-        oled.drawLine(30, 0, 30, 31);
-        oled.drawLine(97, 0, 97, 31);
-
-        for (byte lx = 0; lx < 8; lx++)
-            for (byte ly = 0; ly < 8; ly++)
-                if (boardState & (1uLL << ((7 - ly) * 8 + lx)))
-                    oled.drawBox(lx * 8 + 32, ly * 4, 8, 4);
-    } while (oled.nextPage());
-
-    lastBoardState = boardState;
 }
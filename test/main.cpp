@@ -17,4 +17,21 @@ int main(int argc, char** argv) {
     RUN_MODULE(run_check);
     RUN_MODULE(run_moves);
     RUN_MODULE(run_utils);
+    RUN_MODULE(run_oled);
+    RUN_MODULE(run_transfer);
+    RUN_MODULE(run_scheduler);
+    RUN_MODULE(run_profiler);
+    RUN_MODULE(run_replay);
+    RUN_MODULE(run_movegen);
+    RUN_MODULE(run_book);
+    RUN_MODULE(run_engine);
+    RUN_MODULE(run_eval);
+    RUN_MODULE(run_illegal);
+    RUN_MODULE(run_signature);
+    RUN_MODULE(run_power);
+    RUN_MODULE(run_scan);
+    RUN_MODULE(run_keypad);
+    RUN_MODULE(run_journal);
+    RUN_MODULE(run_live);
+    RUN_MODULE(run_gamelog);
 }
\ No newline at end of file
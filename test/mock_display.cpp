@@ -0,0 +1,139 @@
+#include "mock_display.h"
+
+#include <string.h>
+
+static MockDisplayBus s_bus;
+
+//-----------------------------------------------------------------------------
+MockDisplayBus* getMockDisplayBus()
+//-----------------------------------------------------------------------------
+{
+    return &s_bus;
+}
+
+//-----------------------------------------------------------------------------
+void initializeMockDisplayBus()
+//-----------------------------------------------------------------------------
+{
+    memset(&s_bus, 0, sizeof(MockDisplayBus));
+    memset(s_bus.lcd[0], ' ', 16);
+    memset(s_bus.lcd[1], ' ', 16);
+}
+
+//-----------------------------------------------------------------------------
+static void executeLcdByte(uint8_t p_byte, bool p_data)
+//-----------------------------------------------------------------------------
+{
+    if (p_data) {
+        const uint8_t row = (s_bus.lcdAddress >= 0x40) ? 1 : 0;
+        const uint8_t col = s_bus.lcdAddress & 0x3F;
+        if (col < 16)
+            s_bus.lcd[row][col] = (char)p_byte;
+        s_bus.lcdAddress++;
+    } else if (p_byte & 0x80) {
+        s_bus.lcdAddress = p_byte & 0x7F;
+    }
+}
+
+//-----------------------------------------------------------------------------
+static void writeMockLcdNibble(uint8_t p_nibble, bool p_data)
+//-----------------------------------------------------------------------------
+{
+    if (!s_bus.lcdSecondNibble) {
+        s_bus.lcdHighNibble   = p_nibble;
+        s_bus.lcdSecondNibble = true;
+        return;
+    }
+
+    s_bus.lcdSecondNibble = false;
+    executeLcdByte((s_bus.lcdHighNibble << 4) | p_nibble, p_data);
+}
+
+//-----------------------------------------------------------------------------
+static void executeOledFrame()
+//-----------------------------------------------------------------------------
+{
+    if (s_bus.i2cLength < 2 || s_bus.i2cFrame[0] != MOCK_OLED_ADDRESS)
+        return;
+
+    const uint8_t control = s_bus.i2cFrame[1];
+    for (uint8_t i = 2; i < s_bus.i2cLength; i++) {
+        const uint8_t byte = s_bus.i2cFrame[i];
+        if (control == 0x40) {
+            if (s_bus.oledColumn < 128)
+                s_bus.oled[s_bus.oledPage][s_bus.oledColumn++] = byte;
+        } else if ((byte & 0xF0) == 0x10) {
+            s_bus.oledColumn = (s_bus.oledColumn & 0x0F) | ((byte & 0x0F) << 4);
+        } else if ((byte & 0xF0) == 0x00) {
+            s_bus.oledColumn = (s_bus.oledColumn & 0xF0) | byte;
+        } else if ((byte & 0xF8) == 0xB0) {
+            s_bus.oledPage = byte & 0x03;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+static void writeMockI2c(EI2cAction p_action, uint8_t p_byte)
+//-----------------------------------------------------------------------------
+{
+    switch (p_action) {
+    case I2cStart:
+        if (s_bus.i2cStarted)
+            s_bus.i2cErrors++;
+        s_bus.i2cStarted  = true;
+        s_bus.i2cFrame[0] = p_byte;
+        s_bus.i2cLength   = 1;
+        break;
+    case I2cWrite:
+        if (!s_bus.i2cStarted || s_bus.i2cLength >= sizeof(s_bus.i2cFrame)) {
+            s_bus.i2cErrors++;
+            break;
+        }
+        s_bus.i2cFrame[s_bus.i2cLength++] = p_byte;
+        break;
+    case I2cStop:
+        if (!s_bus.i2cStarted) {
+            s_bus.i2cErrors++;
+            break;
+        }
+        executeOledFrame();
+        s_bus.i2cStarted = false;
+        s_bus.i2cFrames++;
+        break;
+    default:
+        break;
+    }
+}
+
+static const DisplayBus s_writers = {&writeMockLcdNibble, &writeMockI2c};
+
+//-----------------------------------------------------------------------------
+const DisplayBus* getMockDisplayBusWriters()
+//-----------------------------------------------------------------------------
+{
+    return &s_writers;
+}
+
+//-----------------------------------------------------------------------------
+bool queueMockOledTiles(DisplayTransfers* p_transfers, uint8_t p_x, uint8_t p_y, uint8_t p_count, const uint8_t* p_tiles, I2cSpaceWaiter p_wait)
+//-----------------------------------------------------------------------------
+{
+    // Byte procedure messages of u8x8_cad_ssd13xx_fast_i2c, as u8x8_byte_queued_i2c forwards them
+    const uint8_t column     = p_x * 8;
+    const uint8_t command[4] = {0x00, (uint8_t)(0x10 | (column >> 4)), (uint8_t)(column & 0x0F), (uint8_t)(0xB0 | p_y)};
+    bool queued              = beginWaitingI2cFrame(p_transfers, MOCK_OLED_ADDRESS, p_wait);
+    for (uint8_t i = 0; i < sizeof(command); i++)
+        queued &= queueWaitingI2cBytes(p_transfers, &command[i], 1, p_wait);
+    queued &= endI2cFrame(p_transfers);
+
+    const uint8_t control = 0x40;
+    const uint16_t length = p_count * 8;
+    for (uint16_t offset = 0; offset < length; offset += OLED_DATA_FRAME) {
+        const uint8_t count = (length - offset < OLED_DATA_FRAME) ? length - offset : OLED_DATA_FRAME;
+        queued &= beginWaitingI2cFrame(p_transfers, MOCK_OLED_ADDRESS, p_wait);
+        queued &= queueWaitingI2cBytes(p_transfers, &control, 1, p_wait);
+        queued &= queueWaitingI2cBytes(p_transfers, &p_tiles[offset], count, p_wait);
+        queued &= endI2cFrame(p_transfers);
+    }
+    return queued;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include <transfer.h>
+
+// Simulated HD44780 (4-bit mode) and SSD1306 (I2C) at the other end of the display transfer queues
+
+constexpr uint8_t MOCK_OLED_ADDRESS = 0x78;
+
+typedef struct {
+    char lcd[2][17];                     // DDRAM content of both lines
+    uint8_t lcdAddress;                  // DDRAM address counter
+    uint8_t lcdHighNibble;               // First nibble of the byte being received
+    bool lcdSecondNibble;                // Next nibble completes a byte
+    uint8_t oled[4][128];                // SSD1306 page layout
+    uint8_t oledColumn;                  // Column of the next data byte
+    uint8_t oledPage;                    // Page of the next data bytes
+    uint8_t i2cFrame[2 + I2C_MAX_FRAME]; // Address and bytes of the frame being received
+    uint8_t i2cLength;
+    bool i2cStarted;
+    uint32_t i2cFrames;
+    uint32_t i2cErrors; // Writes or stops outside of a frame, starts inside a frame
+} MockDisplayBus;
+
+// Bus callbacks have no context: they all work on a single simulated bus
+MockDisplayBus* getMockDisplayBus();
+void initializeMockDisplayBus();
+const DisplayBus* getMockDisplayBusWriters();
+
+// Queue tiles the way u8x8 does through u8x8_byte_queued_i2c: one positioning command frame, then data frames of up
+// to OLED_DATA_FRAME bytes. p_wait (optional) is called as the firmware waits for queue space.
+bool queueMockOledTiles(DisplayTransfers* p_transfers, uint8_t p_x, uint8_t p_y, uint8_t p_count, const uint8_t* p_tiles, I2cSpaceWaiter p_wait);
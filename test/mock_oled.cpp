@@ -0,0 +1,44 @@
+#include "mock_oled.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+void initializeMockOled(MockOled* p_oled)
+//-----------------------------------------------------------------------------
+{
+    memset(p_oled, 0, sizeof(MockOled));
+}
+
+//-----------------------------------------------------------------------------
+bool mockOledWriteTiles(void* p_context, uint8_t p_x, uint8_t p_y, uint8_t p_count, const uint8_t* p_tiles)
+//-----------------------------------------------------------------------------
+{
+    MockOled* oled = static_cast<MockOled*>(p_context);
+    if (nullptr == oled) {
+        printf("Unable to write tiles to null OLED\n");
+        return false;
+    }
+
+    if (p_y >= OLED_TILE_ROWS || p_x + p_count > OLED_TILE_COLUMNS) {
+        printf("Unable to write %d tiles at (%d, %d): out of screen\n", p_count, p_x, p_y);
+        return false;
+    }
+
+    const uint32_t bytes = MOCK_OLED_I2C_OVERHEAD + p_count * OLED_TILE_SIZE;
+    if (oled->i2cCapacity > 0 && oled->i2cBytes + bytes > oled->i2cCapacity)
+        return false;
+
+    memcpy(&oled->framebuffer[p_y][p_x * OLED_TILE_SIZE], p_tiles, p_count * OLED_TILE_SIZE);
+    oled->i2cBytes += bytes;
+    oled->transfers++;
+    oled->tiles += p_count;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool getMockOledPixel(MockOled* p_oled, uint8_t p_x, uint8_t p_y)
+//-----------------------------------------------------------------------------
+{
+    return (p_oled->framebuffer[p_y / 8][p_x] >> (p_y % 8)) & 0x01;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <oled.h>
+#include <stdint.h>
+
+// Approximate I2C framing of a u8x8 SSD1306 tile transfer: address + control + 3 positioning
+// commands, then address + control before the data bytes
+constexpr uint8_t MOCK_OLED_I2C_OVERHEAD = 7;
+
+typedef struct {
+    uint8_t framebuffer[OLED_TILE_ROWS][OLED_TILE_COLUMNS * OLED_TILE_SIZE]; // SSD1306 page layout
+    uint32_t i2cBytes;
+    uint32_t transfers;
+    uint32_t tiles;
+    uint32_t i2cCapacity; // Writes are refused once i2cBytes would exceed it, 0 = unlimited
+} MockOled;
+
+void initializeMockOled(MockOled* p_oled);
+bool mockOledWriteTiles(void* p_context, uint8_t p_x, uint8_t p_y, uint8_t p_count, const uint8_t* p_tiles);
+bool getMockOledPixel(MockOled* p_oled, uint8_t p_x, uint8_t p_y);
@@ -0,0 +1,109 @@
+#include "utils.h"
+#include <book.h>
+#include <chess.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+static void test_bookBuiltin() {
+    const OpeningBook* book = getBuiltinOpeningBook();
+    TEST_ASSERT_NOT_NULL(book);
+
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    TEST_ASSERT_EQUAL_HEX16(BOOK_NO_OPENING, findOpening(book, getPositionKey(&game)));
+
+    uint64_t sensors = EXEC(&game, "-e2 +e4 -c7 +c5", DEFAULT_SENSORS_STATE);
+    uint16_t opening = findOpening(book, getPositionKey(&game));
+    char eco[BOOK_ECO_LENGTH + 1];
+    char name[17];
+    writeOpeningEco(book, opening, eco);
+    writeOpeningName(book, opening, name, sizeof(name));
+    TEST_ASSERT_EQUAL_STRING("B20", eco);
+    TEST_ASSERT_EQUAL_STRING("Sicilian Defense", name);
+
+    // Out of book
+    sensors = EXEC(&game, "-h2 +h3", sensors);
+    TEST_ASSERT_EQUAL_HEX16(BOOK_NO_OPENING, findOpening(book, getPositionKey(&game)));
+
+    // Castling is part of the position
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    EXEC(&game, "-e2 +e4 -e7 +e5 -g1 +f3 -b8 +c6 -f1 +b5 -a7 +a6 -b5 +a4 -g8 +f6 -e1 +g1 -h1 +f1 -f8 +e7", DEFAULT_SENSORS_STATE);
+    opening = findOpening(book, getPositionKey(&game));
+    writeOpeningEco(book, opening, eco);
+    TEST_ASSERT_EQUAL_STRING("C84", eco);
+    TEST_ASSERT_EQUAL(10, writeOpeningName(book, opening, name, 11));
+    TEST_ASSERT_EQUAL_STRING("Ruy Lopez:", name);
+}
+
+static void test_bookEncoding() {
+    // Several blocks, lookups hit every entry and miss keys in between
+    BookEntry entries[50];
+    for (uint16_t i = 0; i < 50; i++)
+        entries[i] = {1000u + i * i * 997u, (uint16_t)(i % 3)};
+    const uint16_t ecos[3]     = {0, 220, 499};
+    const char* const names[3] = {"Polish", "Sicilian", "King's Indian"};
+
+    uint8_t blob[512];
+    const uint32_t size = encodeOpeningBook(entries, 50, ecos, names, 3, 2, blob, sizeof(blob));
+    TEST_ASSERT_GREATER_THAN(0, size);
+
+    OpeningBook book;
+    TEST_ASSERT_TRUE(initializeOpeningBook(&book, blob, size));
+    TEST_ASSERT_EQUAL(13, book.blockCount);
+    for (uint16_t i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL(i % 3, findOpening(&book, entries[i].key));
+        TEST_ASSERT_EQUAL_HEX16(BOOK_NO_OPENING, findOpening(&book, entries[i].key + 1));
+    }
+    TEST_ASSERT_EQUAL_HEX16(BOOK_NO_OPENING, findOpening(&book, 0));
+    TEST_ASSERT_EQUAL_HEX16(BOOK_NO_OPENING, findOpening(&book, 0xFFFFFFFF));
+
+    char eco[BOOK_ECO_LENGTH + 1];
+    writeOpeningEco(&book, 1, eco);
+    TEST_ASSERT_EQUAL_STRING("C20", eco);
+    writeOpeningEco(&book, 2, eco);
+    TEST_ASSERT_EQUAL_STRING("E99", eco);
+
+    // Unsorted entries, small buffers and corrupted blobs are rejected
+    const BookEntry unsorted[2] = {{2, 0}, {1, 0}};
+    TEST_ASSERT_EQUAL(0, encodeOpeningBook(unsorted, 2, ecos, names, 3, 2, blob, sizeof(blob)));
+    TEST_ASSERT_EQUAL(0, encodeOpeningBook(entries, 50, ecos, names, 3, 2, blob, 100));
+    blob[0] = 'X';
+    TEST_ASSERT_FALSE(initializeOpeningBook(&book, blob, size));
+}
+
+static void test_bookFile() {
+    const BookEntry entries[3] = {{10, 0}, {20, 1}, {30, 0}};
+    const uint16_t ecos[2]     = {120, 260};
+    const char* const names[2] = {"Caro-Kann Defense", "French Defense"};
+    uint8_t blob[128];
+    const uint32_t size = encodeOpeningBook(entries, 3, ecos, names, 2, 3, blob, sizeof(blob));
+
+    const char* path = "test_book.bin";
+    FILE* file       = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    fwrite(blob, 1, size, file);
+    fclose(file);
+
+    OpeningBook book;
+    TEST_ASSERT_TRUE(openOpeningBookFile(&book, path));
+    TEST_ASSERT_EQUAL(1, findOpening(&book, 20));
+    char name[32];
+    writeOpeningName(&book, 1, name, sizeof(name));
+    TEST_ASSERT_EQUAL_STRING("French Defense", name);
+    closeOpeningBookFile(&book);
+    TEST_ASSERT_EQUAL_HEX16(BOOK_NO_OPENING, findOpening(&book, 20));
+    remove(path);
+
+    TEST_ASSERT_FALSE(openOpeningBookFile(&book, "missing_book.bin"));
+}
+
+void run_book() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bookBuiltin);
+    RUN_TEST(test_bookEncoding);
+    RUN_TEST(test_bookFile);
+
+    UNITY_END();
+}
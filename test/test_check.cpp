@@ -1,6 +1,10 @@
 #include "utils.h"
 #include <chess.h>
+#include <movegen.h>
+#include <replay.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unity.h>
 
 static void test_check() {
@@ -20,6 +24,8 @@ static void test_check() {
         "1q5k/8/8/Ppnn4/1nKn4/1nnn4/8/8 w - b6 0 1",                                // En-passant saving checkmate
         "1q5k/8/8/1pPn4/1nKn4/1nnn4/8/8 w - b6 0 1",                                // En-passant saving checkmate
         "8/8/8/8/8/2K5/8/1k5R b - - 0 1",                                           // King can escape
+        "k6R/8/P7/8/8/8/8/4K3 b - - 0 1",                                           // King can escape in front of a pawn
+        "7k/1n6/8/8/4B3/8/6PP/r6K w - - 0 1",                                       // Intercepting piece with a knight behind it
     };
 
     for (uint8_t i = 0; i < sizeof(fens) / sizeof(fens[0]); i++) {
@@ -100,6 +106,150 @@ static void test_checkmate_bnilsou() {
     fclose(file);
 }
 
+static void test_squareAttackers() {
+    Game game;
+    initializeFromFEN(&game, "4k3/8/8/3p4/8/1n6/3P4/R3K2B w - - 0 1");
+    TEST_ASSERT_EQUAL_HEX64(1uLL << 0, attackersTo<bits::White>(&game, 56 /* a8 */));                // a1 rook
+    TEST_ASSERT_EQUAL_HEX64(1uLL << 7, attackersTo<bits::White>(&game, 35 /* d5 */));                // h1 bishop
+    TEST_ASSERT_EQUAL_HEX64(1uLL << 11, attackersTo<bits::White>(&game, 18 /* c3 */));               // d2 pawn
+    TEST_ASSERT_EQUAL_HEX64((1uLL << 0) | (1uLL << 4), attackersTo<bits::White>(&game, 3 /* d1 */)); // Rook and king
+    TEST_ASSERT_EQUAL_HEX64(1uLL << 17, attackersTo<bits::Black>(&game, 2 /* c1 */));                // b3 knight
+
+    // Movers: pawns only capture opponent pieces and push forward
+    TEST_ASSERT_EQUAL_HEX64(1uLL << 11, moversTo<bits::White>(&game, 27 /* d4 */));
+    TEST_ASSERT_EQUAL_HEX64(0, moversTo<bits::White>(&game, 18 /* c3 */));
+    TEST_ASSERT_EQUAL_HEX64((1uLL << 0) | (1uLL << 4), moversTo<bits::White>(&game, 3 /* d1 */));
+
+    // The king only goes to undefended squares
+    initializeFromFEN(&game, "4k3/8/8/8/8/5n2/8/4K3 w - - 0 1");
+    TEST_ASSERT_EQUAL_HEX64(0, moversTo<bits::White>(&game, 11 /* d2 */));
+    TEST_ASSERT_EQUAL_HEX64(1uLL << 4, moversTo<bits::White>(&game, 12 /* e2 */));
+
+    // Same squares as the move generator, in random games
+    uint32_t seed = 2024;
+    for (uint8_t g = 0; g < 10; g++) {
+        initializeGame(&game, DEFAULT_SENSORS_STATE);
+        for (uint16_t ply = 0; ply < 150; ply++) {
+            for (uint8_t square = 0; square < 64; square++) {
+                TEST_ASSERT_EQUAL(isSquareAttacked(game.board, square, bits::White), 0 != attackersTo<bits::White>(&game, square));
+                TEST_ASSERT_EQUAL(isSquareAttacked(game.board, square, bits::Black), 0 != attackersTo<bits::Black>(&game, square));
+                TEST_ASSERT_EQUAL(isSquareAttacked(game.board, square, bits::White), isAttacked<bits::White>(&game, square));
+                TEST_ASSERT_EQUAL(isSquareAttacked(game.board, square, bits::Black), isAttacked<bits::Black>(&game, square));
+            }
+            TEST_ASSERT_EQUAL(PositionCheckmate == classifyPosition(&game), isCheckmate(&game));
+
+            Move moves[MOVEGEN_MAX_MOVES];
+            const uint8_t count = generateLegalMoves(&game, moves);
+            if (0 == count)
+                break;
+            seed = seed * 1103515245u + 12345u;
+            playMove(&game, moves[(seed >> 16) % count]);
+        }
+    }
+}
+
+// Pieces of the player to play whose removal uncovers an attack on their king
+static uint64_t findPinnedPieces(Game* p_game) {
+    const uint8_t player = p_game->state.status & bits::ColorMask;
+    uint8_t king         = 0;
+    while ((player | bits::King) != p_game->board[king])
+        king++;
+
+    uint64_t pinned         = 0;
+    const uint64_t checkers = (bits::White == player) ? attackersTo<bits::Black>(p_game, king) : attackersTo<bits::White>(p_game, king);
+    for (uint8_t square = 0; square < 64; square++) {
+        const EPiece piece = p_game->board[square];
+        if (Empty == piece || isKing(piece) || player != (piece & bits::ColorMask))
+            continue;
+        p_game->board[square]    = Empty;
+        const uint64_t attackers = (bits::White == player) ? attackersTo<bits::Black>(p_game, king) : attackersTo<bits::White>(p_game, king);
+        p_game->board[square]    = piece;
+        if (attackers != checkers)
+            pinned |= (1uLL << square);
+    }
+    return pinned;
+}
+
+static void test_checkersAndPins() {
+    // Pins stop at the first piece behind the pinned one: the knight behind the bishop pins nothing
+    Game game;
+    initializeFromFEN(&game, "7k/1n6/8/8/4B3/8/6PP/r6K w - - 0 1");
+    TEST_ASSERT_EQUAL_HEX64(1uLL << 0 /* a1 */, game.state.checkers);
+    TEST_ASSERT_EQUAL_HEX64(0, game.state.pinned);
+
+    // Rook on the king file and bishop on its diagonal, each behind a white piece; a black knight shields the king from the a1 rook
+    initializeFromFEN(&game, "4r2k/8/8/b7/8/8/3NR3/r2nK3 w - - 0 1");
+    TEST_ASSERT_EQUAL_HEX64(0, game.state.checkers);
+    TEST_ASSERT_EQUAL_HEX64((1uLL << 11 /* d2 */) | (1uLL << 12 /* e2 */), game.state.pinned);
+    TEST_ASSERT_TRUE(isLegalMove(&game, BUILD_MOVE(12, 20 /* e3 */, WRook)));
+    TEST_ASSERT_FALSE(isLegalMove(&game, BUILD_MOVE(12, 13 /* f2 */, WRook)));
+    TEST_ASSERT_FALSE(isLegalMove(&game, BUILD_MOVE(11, 26 /* c4 */, WKnight)));
+
+    // Black to play after the rook move: in check, the cache follows the player to play
+    playMove(&game, BUILD_MOVE(12, 20, WRook));
+    TEST_ASSERT_EQUAL_HEX64(0, game.state.checkers);
+    TEST_ASSERT_EQUAL_HEX64(0, game.state.pinned);
+    playMove(&game, BUILD_MOVE(60, 52 /* e7 */, BRook));
+    TEST_ASSERT_EQUAL_HEX64((1uLL << 11) | (1uLL << 20 /* e3 */), game.state.pinned);
+}
+
+static void test_attackMaps() {
+    // Maps of the starting position: counted by hand
+    Game game;
+    memset(&game, 0, sizeof(game));
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    TEST_ASSERT_EQUAL(0, getAttackCount(&game, 0 /* a1 */, bits::White));
+    TEST_ASSERT_EQUAL(1, getAttackCount(&game, 3 /* d1 */, bits::White));
+    TEST_ASSERT_EQUAL(4, getAttackCount(&game, 11 /* d2 */, bits::White));
+    TEST_ASSERT_EQUAL(3, getAttackCount(&game, 21 /* f3 */, bits::White));
+    TEST_ASSERT_EQUAL(0, getAttackCount(&game, 21 /* f3 */, bits::Black));
+    TEST_ASSERT_EQUAL(3, getAttackCount(&game, 42 /* c6 */, bits::Black));
+
+    // Random games played on the sensors: the maps follow every commit (castling, en passant and promotions included)
+    uint32_t seed = 77;
+    for (uint8_t g = 0; g < 20; g++) {
+        uint64_t sensors = DEFAULT_SENSORS_STATE;
+        memset(&game, 0, sizeof(game));
+        initializeGame(&game, sensors);
+        for (uint16_t ply = 0; ply < 200 && game.halfmoveClock < 100; ply++) {
+            Move moves[MOVEGEN_MAX_MOVES];
+            const uint8_t count = generateLegalMoves(&game, moves);
+            if (0 == count)
+                break;
+
+            // Castling and en passant are rare in random games: played whenever possible
+            seed        = seed * 1103515245u + 12345u;
+            Move chosen = moves[(seed >> 16) % count];
+            for (uint8_t i = 0; i < count; i++) {
+                const bool castling  = isKing(moves[i].piece) && 2 == abs(moves[i].start - moves[i].end);
+                const bool enPassant = isPawn(moves[i].piece) && moves[i].end == game.state.en_passant;
+                if (castling || enPassant)
+                    chosen = moves[i];
+            }
+            uint8_t events[REPLAY_MAX_MOVE_EVENTS];
+            const uint8_t eventCount = getMoveSensorEvents(&game, chosen, 0 != (seed & 0x100), events);
+            for (uint8_t i = 0; i < eventCount; i++) {
+                const uint64_t mask = 1uLL << (events[i] & REPLAY_SQUARE_MASK);
+                sensors             = (events[i] & REPLAY_EVENT_PLACED) ? (sensors | mask) : (sensors & ~mask);
+                evolveGame(&game, sensors);
+            }
+            TEST_ASSERT_EQUAL(bits::ToPlay, game.state.status & bits::MoveMask);
+            TEST_ASSERT_TRUE(checkAttackMaps(&game));
+            TEST_ASSERT_EQUAL_HEX64(findPinnedPieces(&game), game.state.pinned);
+            for (uint8_t square = 0; square < 64; square++) {
+                TEST_ASSERT_EQUAL(__builtin_popcountll(attackersTo<bits::White>(&game, square)), getAttackCount(&game, square, bits::White));
+                TEST_ASSERT_EQUAL(__builtin_popcountll(attackersTo<bits::Black>(&game, square)), getAttackCount(&game, square, bits::Black));
+            }
+        }
+    }
+
+    // The check is against the board: a piece put there behind the back of the maps is seen
+    game.board[getSquareFromStr("e4")] = (EPiece::Empty == game.board[getSquareFromStr("e4")]) ? WQueen : EPiece::Empty;
+    TEST_ASSERT_FALSE(checkAttackMaps(&game));
+    initializeAttackMaps(&game);
+    TEST_ASSERT_TRUE(checkAttackMaps(&game));
+}
+
 void run_check() {
     UNITY_BEGIN();
 
@@ -107,6 +257,9 @@ void run_check() {
     RUN_TEST(test_notCheck);
     RUN_TEST(test_checkmate);
     RUN_TEST(test_checkmate_bnilsou);
+    RUN_TEST(test_squareAttackers);
+    RUN_TEST(test_attackMaps);
+    RUN_TEST(test_checkersAndPins);
 
     UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <chess.h>
+#include <engine.h>
+#include <movegen.h>
+#include <thread>
+#include <unity.h>
+
+static bool isLegal(Game* p_game, Move p_move) {
+    Move moves[MOVEGEN_MAX_MOVES];
+    const uint8_t count = generateLegalMoves(p_game, moves);
+    for (uint8_t i = 0; i < count; i++) {
+        if (moves[i].start == p_move.start && moves[i].end == p_move.end && moves[i].piece == p_move.piece)
+            return true;
+    }
+    return false;
+}
+
+static void test_engineEvaluation() {
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    TEST_ASSERT_EQUAL(0, evaluatePosition(&game));
+
+    // Same position with the other player to play
+    Game other;
+    initializeFromFEN(&game, "4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1");
+    initializeFromFEN(&other, "4k3/8/8/3q4/8/8/3R4/4K3 b - - 0 1");
+    TEST_ASSERT_LESS_THAN(-300, evaluatePosition(&game));
+    TEST_ASSERT_EQUAL(-evaluatePosition(&game), evaluatePosition(&other));
+    TEST_ASSERT_NOT_EQUAL(getZobristKey(&game), getZobristKey(&other));
+}
+
+static void test_engineBestMove() {
+    Engine engine;
+    initializeEngine(&engine, 1, 1);
+    const SearchLimits limits = {0, 0, 4};
+    SearchResult result;
+
+    // Back rank mate
+    Game game;
+    initializeFromFEN(&game, "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+    TEST_ASSERT_TRUE(searchPosition(&engine, &game, &limits, &result));
+    TEST_ASSERT_EQUAL(0, result.best.start);
+    TEST_ASSERT_EQUAL(56, result.best.end);
+    TEST_ASSERT_EQUAL(ENGINE_MATE_SCORE - 1, result.score);
+    TEST_ASSERT_FALSE(result.stopped);
+    playMove(&game, result.best);
+    TEST_ASSERT_EQUAL(PositionCheckmate, classifyPosition(&game));
+
+    // Free queen
+    initializeFromFEN(&game, "4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1");
+    TEST_ASSERT_TRUE(searchPosition(&engine, &game, &limits, &result));
+    TEST_ASSERT_EQUAL(11, result.best.start);
+    TEST_ASSERT_EQUAL(35, result.best.end);
+    TEST_ASSERT_TRUE(result.best.captured);
+    TEST_ASSERT_GREATER_THAN(300, result.score);
+
+    // No legal move
+    initializeFromFEN(&game, "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    TEST_ASSERT_FALSE(searchPosition(&engine, &game, &limits, &result));
+    TEST_ASSERT_EQUAL(Empty, result.best.piece);
+}
+
+static void test_engineThreads() {
+    Engine engine;
+    initializeEngine(&engine, 4, 4);
+    const SearchLimits limits = {0, 20000, 0};
+    SearchResult result;
+
+    Game game;
+    initializeFromFEN(&game, "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5Q2/PPPP1PPP/RNB1K1NR w KQkq - 4 4");
+    TEST_ASSERT_TRUE(searchPosition(&engine, &game, &limits, &result));
+    TEST_ASSERT_EQUAL(21, result.best.start); // Qxf7#
+    TEST_ASSERT_EQUAL(53, result.best.end);
+    TEST_ASSERT_EQUAL(ENGINE_MATE_SCORE - 1, result.score);
+    TEST_ASSERT_GREATER_THAN(0, result.nodes);
+}
+
+static void test_engineStop() {
+    Engine engine;
+    initializeEngine(&engine, 2, 1);
+    const SearchLimits limits = {0, 0, 0};
+    SearchResult result;
+
+    // Unlimited search, stopped as if the board position changed
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    bool found = false;
+    std::thread worker([&]() { found = searchPosition(&engine, &game, &limits, &result); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stopSearch(&engine);
+    worker.join();
+
+    TEST_ASSERT_TRUE(found);
+    TEST_ASSERT_TRUE(result.stopped);
+    TEST_ASSERT_TRUE(isLegal(&game, result.best));
+
+    // Time limit
+    const SearchLimits timed = {20, 0, 0};
+    TEST_ASSERT_TRUE(searchPosition(&engine, &game, &timed, &result));
+    TEST_ASSERT_TRUE(result.stopped);
+    TEST_ASSERT_LESS_THAN(1000, result.time_ms);
+    TEST_ASSERT_TRUE(isLegal(&game, result.best));
+}
+
+void run_engine() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_engineEvaluation);
+    RUN_TEST(test_engineBestMove);
+    RUN_TEST(test_engineThreads);
+    RUN_TEST(test_engineStop);
+
+    UNITY_END();
+}
@@ -0,0 +1,74 @@
+#include "utils.h"
+#include <chess.h>
+#include <eval.h>
+#include <unity.h>
+
+static void assertEvaluationInSync(Game* p_game) {
+    Evaluation evaluation;
+    initializeEvaluation(&evaluation, p_game->board);
+    TEST_ASSERT_EQUAL(evaluation.middlegame, p_game->evaluation.middlegame);
+    TEST_ASSERT_EQUAL(evaluation.endgame, p_game->evaluation.endgame);
+    TEST_ASSERT_EQUAL(evaluation.phase, p_game->evaluation.phase);
+}
+
+static void test_evalInitial() {
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    TEST_ASSERT_EQUAL(0, getEvaluation(&game.evaluation));
+    TEST_ASSERT_EQUAL(EVAL_MAX_PHASE, game.evaluation.phase);
+
+    // Missing pieces are not counted
+    initializeGame(&game, DEFAULT_SENSORS_STATE & ~(1uLL << 3));
+    TEST_ASSERT_LESS_THAN(-900, getEvaluation(&game.evaluation));
+    TEST_ASSERT_EQUAL(EVAL_MAX_PHASE - 4, game.evaluation.phase);
+
+    // Same value from FEN, mirrored positions are opposite
+    Game white, black;
+    initializeFromFEN(&white, "4k3/8/8/8/8/8/3P4/4K3 w - - 0 1");
+    initializeFromFEN(&black, "4k3/3p4/8/8/8/8/8/4K3 b - - 0 1");
+    TEST_ASSERT_GREATER_THAN(0, getEvaluation(&white.evaluation));
+    TEST_ASSERT_EQUAL(getEvaluation(&white.evaluation), -getEvaluation(&black.evaluation));
+    TEST_ASSERT_EQUAL(getPlayerEvaluation(&white), getPlayerEvaluation(&black));
+}
+
+static void test_evalIncremental() {
+    // Updated on committed moves only, whatever happens while pieces are lifted
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    uint64_t sensors = EXEC(&game, "-e2", DEFAULT_SENSORS_STATE);
+    TEST_ASSERT_EQUAL(0, getEvaluation(&game.evaluation));
+    sensors = EXEC(&game, "+e4", sensors);
+    TEST_ASSERT_GREATER_THAN(0, getEvaluation(&game.evaluation));
+    assertEvaluationInSync(&game);
+
+    // Captures in both orders, en passant, castling
+    sensors = EXEC(&game, "-d7 +d5 -d5 -e4 +d5 -c7 +c5 -d5 +c6 -c5 -b7 -c6 +c6 -g1 +f3 -g8 +f6 -f1 +c4 -e7 +e6 -e1 +g1 -h1 +f1", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+    assertEvaluationInSync(&game);
+
+    initializeFromFEN(&game, "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1");
+    EXEC(&game, "-e5 +d6 -d5", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+    assertEvaluationInSync(&game);
+}
+
+static void test_evalPromotion() {
+    Game game;
+    initializeFromFEN(&game, "4k3/6P1/8/8/8/8/8/4K3 w - - 0 1");
+    const int16_t before = getEvaluation(&game.evaluation);
+    EXEC(&game, "-g7 +g8", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL(WQueen, game.board[62]);
+    TEST_ASSERT_GREATER_THAN(before + 700, getEvaluation(&game.evaluation));
+    TEST_ASSERT_EQUAL(4, game.evaluation.phase);
+    assertEvaluationInSync(&game);
+}
+
+void run_eval() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_evalInitial);
+    RUN_TEST(test_evalIncremental);
+    RUN_TEST(test_evalPromotion);
+
+    UNITY_END();
+}
@@ -100,12 +100,27 @@ static void test_writeToFen_game() {
     TEST_ASSERT_EQUAL_STRING("r2qk2r/pb1n1p1p/2pp1npQ/1p2p3/3PP3/P1N2P2/1PP1N1PP/2KR1B1R b kq - 1 11", fenBuffer);
 }
 
+static void test_initFromFen_malformed() {
+    Game game;
+    TEST_ASSERT_TRUE(initializeFromFEN(&game, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+
+    // Malformed boards are rejected without writing out of the board
+    TEST_ASSERT_FALSE(initializeFromFEN(&game, "rnbqkbnrr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+    TEST_ASSERT_FALSE(initializeFromFEN(&game, "rnbqkbnr/pppppppp/44/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+    TEST_ASSERT_FALSE(initializeFromFEN(&game, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKB w KQkq - 0 1"));
+    TEST_ASSERT_FALSE(initializeFromFEN(&game, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN"));
+    TEST_ASSERT_FALSE(initializeFromFEN(&game, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1"));
+    TEST_ASSERT_FALSE(initializeFromFEN(&game, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - bm e4;"));
+    TEST_ASSERT_FALSE(initializeFromFEN(&game, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkqKQkqKQkq - 0 1"));
+}
+
 void run_fen() {
     UNITY_BEGIN();
 
     RUN_TEST(test_initFromFen_castling);
     RUN_TEST(test_writeToFen_castling);
     RUN_TEST(test_writeToFen_game);
+    RUN_TEST(test_initFromFen_malformed);
 
     UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include <chess.h>
+#include <gamelog.h>
+#include <movegen.h>
+#include <replay.h>
+#include <signature.h>
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+// Game and sensors after each logged call, by history index
+typedef struct {
+    uint32_t index;
+    uint32_t checksum;
+    int16_t middlegame;
+    uint64_t sensors;
+} LoggedGame;
+
+static void startGame(Game* p_game) {
+    memset(p_game, 0, sizeof(Game));
+    initializeGame(p_game, DEFAULT_SENSORS_STATE);
+}
+
+// Random games made on the board through the log, some moves seen in a single scan (signature commits)
+static void playLoggedGames(GameLog* p_log, SignatureTable* p_table, Game* p_game, uint32_t p_seed, uint16_t p_plies, std::vector<LoggedGame>* p_games) {
+    uint64_t sensors = DEFAULT_SENSORS_STATE;
+    uint32_t tick    = 0;
+    for (uint16_t ply = 0; ply < p_plies; ply++) {
+        Move moves[MOVEGEN_MAX_MOVES];
+        const uint8_t count = generateLegalMoves(p_game, moves);
+        if (0 == count || p_game->halfmoveClock >= 100)
+            return;
+
+        p_seed = p_seed * 1103515245u + 12345u;
+        uint8_t events[REPLAY_MAX_MOVE_EVENTS];
+        const Move move          = moves[(p_seed >> 16) % count];
+        const bool capturedFirst = (0 != (p_seed & 0x100));
+        const uint8_t eventCount = getMoveSensorEvents(p_game, move, capturedFirst, events);
+        const bool singleScan    = (nullptr != p_table) && (0 != (p_seed & 0x200)) && (!move.captured || capturedFirst);
+        for (uint8_t i = 0; i < eventCount; i++) {
+            const uint64_t mask = 1uLL << (events[i] & REPLAY_SQUARE_MASK);
+            sensors             = (events[i] & REPLAY_EVENT_PLACED) ? (sensors | mask) : (sensors & ~mask);
+
+            // The rest of a capture is seen in a single scan once the captured piece has been lifted
+            if (singleScan && i + 1 < eventCount && !(move.captured && 0 == i))
+                continue;
+
+            evolveLoggedGame(p_log, p_table, p_game, sensors, tick++);
+            p_games->push_back({getGameLogEnd(p_log), getGameChecksum(p_game), p_game->evaluation.middlegame, sensors});
+        }
+        TEST_ASSERT_EQUAL(bits::ToPlay, p_game->state.status & bits::MoveMask);
+    }
+}
+
+static void checkRebuiltGames(const GameLog* p_log, const std::vector<LoggedGame>& p_games) {
+    uint32_t rebuilt = 0;
+    for (const LoggedGame& logged : p_games) {
+        Game game;
+        uint64_t sensors = 0;
+        if (!rebuildLoggedGame(p_log, logged.index, &game, &sensors)) {
+            TEST_ASSERT_LESS_THAN(getGameLogStart(p_log), logged.index);
+            continue;
+        }
+        TEST_ASSERT_EQUAL_HEX32(logged.checksum, getGameChecksum(&game));
+        TEST_ASSERT_EQUAL(logged.middlegame, game.evaluation.middlegame);
+        TEST_ASSERT_EQUAL_HEX64(logged.sensors, sensors);
+        rebuilt++;
+    }
+    TEST_ASSERT_GREATER_THAN(0, rebuilt);
+}
+
+static void test_gamelogRebuild() {
+    // Every game of the history is rebuilt, with moves made step by step or seen in a single scan
+    for (uint8_t signatures = 0; signatures < 2; signatures++) {
+        static GameEvent events[2048];
+        SignatureTable table;
+        resetSignatureTable(&table);
+        Game game;
+        startGame(&game);
+        GameLog log;
+        startGameLog(&log, events, 2048, &game, DEFAULT_SENSORS_STATE);
+
+        std::vector<LoggedGame> games;
+        playLoggedGames(&log, signatures ? &table : nullptr, &game, 4242 + signatures, 200, &games);
+        TEST_ASSERT_EQUAL(0, getGameLogStart(&log));
+        checkRebuiltGames(&log, games);
+
+        // Events of a call: statuses, sensor changes and the completed move on the last one
+        uint16_t joined = 0;
+        for (uint32_t i = getGameLogStart(&log); i < getGameLogEnd(&log); i++) {
+            const GameEvent* event = getGameLogEvent(&log, i);
+            if (GAMELOG_JOINED == event->moveStart) {
+                TEST_ASSERT_EQUAL(event->tick, getGameLogEvent(&log, i + 1)->tick);
+                joined++;
+            } else if (GAMELOG_NO_MOVE != event->moveStart) {
+                TEST_ASSERT_NOT_EQUAL(event->fromStatus & bits::ColorMask, event->toStatus & bits::ColorMask);
+                TEST_ASSERT_LESS_THAN(64, event->moveEnd);
+            }
+        }
+        TEST_ASSERT_NULL(getGameLogEvent(&log, getGameLogEnd(&log)));
+        TEST_ASSERT_EQUAL(signatures, joined > 0);
+    }
+}
+
+static void test_gamelogRing() {
+    // Once the ring is full, the snapshot follows the oldest event: the games of the ring are still rebuilt
+    static GameEvent events[24];
+    SignatureTable table;
+    resetSignatureTable(&table);
+    Game game;
+    startGame(&game);
+    GameLog log;
+    startGameLog(&log, events, 24, &game, DEFAULT_SENSORS_STATE);
+
+    std::vector<LoggedGame> games;
+    playLoggedGames(&log, &table, &game, 77, 120, &games);
+    TEST_ASSERT_GREATER_THAN(0, getGameLogStart(&log));
+    TEST_ASSERT_LESS_OR_EQUAL(24, getGameLogEnd(&log) - getGameLogStart(&log));
+    TEST_ASSERT_FALSE(rebuildLoggedGame(&log, getGameLogStart(&log) - 1, &game, nullptr));
+    TEST_ASSERT_FALSE(rebuildLoggedGame(&log, getGameLogEnd(&log) + 1, &game, nullptr));
+    checkRebuiltGames(&log, games);
+
+    // Calls changing more squares than the ring holds start the log again
+    Game empty;
+    memset(&empty, 0, sizeof(empty));
+    initializeGame(&empty, 0);
+    startGameLog(&log, events, 24, &empty, 0);
+    evolveLoggedGame(&log, nullptr, &empty, DEFAULT_SENSORS_STATE, 0);
+    TEST_ASSERT_EQUAL(32, getGameLogStart(&log));
+    TEST_ASSERT_EQUAL(32, getGameLogEnd(&log));
+    Game rebuilt;
+    uint64_t sensors = 0;
+    TEST_ASSERT_TRUE(rebuildLoggedGame(&log, 32, &rebuilt, &sensors));
+    TEST_ASSERT_EQUAL_HEX32(getGameChecksum(&empty), getGameChecksum(&rebuilt));
+    TEST_ASSERT_EQUAL_HEX64(DEFAULT_SENSORS_STATE, sensors);
+}
+
+static void test_gamelogSteps() {
+    // Unchanged sensors are logged when the call changes the game: a lift and a placement seen at once
+    static GameEvent events[16];
+    Game game;
+    startGame(&game);
+    GameLog log;
+    startGameLog(&log, events, 16, &game, DEFAULT_SENSORS_STATE);
+
+    const uint64_t sensors = (DEFAULT_SENSORS_STATE & ~(1uLL << getSquareFromStr("g1"))) | (1uLL << getSquareFromStr("f3"));
+    evolveLoggedGame(&log, nullptr, &game, sensors, 10);
+    evolveLoggedGame(&log, nullptr, &game, sensors, 11);
+    evolveLoggedGame(&log, nullptr, &game, sensors, 12);
+    TEST_ASSERT_EQUAL(bits::Black | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(3, getGameLogEnd(&log));
+
+    const GameEvent* step = getGameLogEvent(&log, 2);
+    TEST_ASSERT_EQUAL(GAMELOG_STEP, step->square);
+    TEST_ASSERT_EQUAL(11, step->tick);
+    TEST_ASSERT_EQUAL(bits::White | bits::Playing, step->fromStatus);
+    TEST_ASSERT_EQUAL(getSquareFromStr("g1"), step->moveStart);
+    TEST_ASSERT_EQUAL(getSquareFromStr("f3"), step->moveEnd);
+
+    Game rebuilt;
+    TEST_ASSERT_TRUE(rebuildLoggedGame(&log, 2, &rebuilt, nullptr));
+    TEST_ASSERT_EQUAL(bits::White | bits::Playing, rebuilt.state.status);
+    TEST_ASSERT_TRUE(rebuildLoggedGame(&log, 3, &rebuilt, nullptr));
+    TEST_ASSERT_EQUAL_HEX32(getGameChecksum(&game), getGameChecksum(&rebuilt));
+}
+
+void run_gamelog() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_gamelogRebuild);
+    RUN_TEST(test_gamelogRing);
+    RUN_TEST(test_gamelogSteps);
+
+    UNITY_END();
+}
@@ -0,0 +1,101 @@
+#include "mock_sensors.h"
+#include "utils.h"
+#include <chess.h>
+#include <unity.h>
+
+static void test_illegalPattern() {
+    // Bishop moved like a knight
+    Game game;
+    initializeFromFEN(&game, "4k3/8/8/8/8/8/8/2B1K3 w - - 0 1");
+    const int16_t middlegame = game.evaluation.middlegame;
+    uint64_t sensors         = EXEC(&game, "-c1 +d3", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay | bits::Illegal, game.state.status);
+    TEST_ASSERT_EQUAL_STRING("Illegal: undo  ", getStatusStr(game.state.status));
+    TEST_ASSERT_EQUAL(Empty, game.board[19]);
+    TEST_ASSERT_EQUAL(Empty, game.lastMoveW.piece);
+    TEST_ASSERT_EQUAL(middlegame, game.evaluation.middlegame);
+
+    // Other changes are ignored until the bishop is back
+    sensors = EXEC(&game, "-e1 +e1 -d3", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay | bits::Illegal, game.state.status);
+    sensors = EXEC(&game, "+c1", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WBishop, game.board[2]);
+
+    // Then the game goes on
+    EXEC(&game, "-c1 +e3", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WBishop, game.board[20]);
+
+    // Opponent piece moved
+    initializeFromFEN(&game, "4k3/8/8/8/8/8/8/2B1K3 w - - 0 1");
+    EXEC(&game, "-e8 +d8", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay | bits::Illegal, game.state.status);
+}
+
+static void test_illegalKingSafety() {
+    // Pinned bishop
+    Game game;
+    initializeFromFEN(&game, "4k3/4r3/8/8/8/8/4B3/4K3 w - - 0 1");
+    uint64_t sensors = EXEC(&game, "-e2 +d3", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay | bits::Illegal, game.state.status);
+    sensors = EXEC(&game, "+e2 -d3", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WBishop, game.board[12]);
+
+    // Castling through an attacked square
+    initializeFromFEN(&game, "4kr2/8/8/8/8/8/8/4K2R w K - 0 1");
+    sensors = EXEC(&game, "-e1 +g1", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay | bits::Illegal, game.state.status);
+    sensors = EXEC(&game, "-g1 +e1", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WKing, game.board[4]);
+}
+
+static void test_illegalCapture() {
+    // Pawn capturing forward, both pieces are put back
+    Game game;
+    initializeFromFEN(&game, "4k3/8/8/8/8/4p3/4P3/4K3 w - - 0 1");
+    uint64_t sensors = EXEC(&game, "-e2 -e3 +e3", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay | bits::Illegal, game.state.status);
+    sensors = EXEC(&game, "+e2", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WPawn, game.board[12]);
+    TEST_ASSERT_EQUAL(BPawn, game.board[20]);
+
+    // Captured piece lifted first, legal capture
+    initializeFromFEN(&game, "4k3/8/8/8/8/3p4/4P3/4K3 w - - 0 1");
+    EXEC(&game, "-d3 -e2 +d3", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WPawn, game.board[19]);
+}
+
+static void test_illegalCastlingRook() {
+    // Rook placed on the wrong square: only the rook is put back, castling goes on
+    Game game;
+    initializeFromFEN(&game, "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+    uint64_t sensors = EXEC(&game, "-e1 +g1 -h1 +e1", extractSensorsState(&game));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::Castling | bits::Illegal, game.state.status);
+    sensors = EXEC(&game, "-e1 +h1", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::Castling, game.state.status);
+    TEST_ASSERT_EQUAL(WRook, game.board[7]);
+
+    // Rook put back then castling completed
+    sensors = EXEC(&game, "-h1 +h1", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::Castling, game.state.status);
+    EXEC(&game, "-h1 +f1", sensors);
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WRook, game.board[5]);
+    TEST_ASSERT_EQUAL(WKing, game.board[6]);
+}
+
+void run_illegal() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_illegalPattern);
+    RUN_TEST(test_illegalKingSafety);
+    RUN_TEST(test_illegalCapture);
+    RUN_TEST(test_illegalCastlingRook);
+
+    UNITY_END();
+}
@@ -0,0 +1,364 @@
+#include "mock_sensors.h"
+#include <chess.h>
+#include <journal.h>
+#include <movegen.h>
+#include <replay.h>
+#include <string.h>
+#include <unity.h>
+
+// Simulated EEPROM: writes can be cut by a power loss, the byte being written is then left erased
+constexpr uint16_t EEPROM_SIZE    = 1024;
+constexpr uint16_t JOURNAL_OFFSET = 96;
+constexpr int32_t UNLIMITED       = -1;
+constexpr int32_t POWER_LOST      = -2;
+
+static uint8_t s_eeprom[EEPROM_SIZE];
+static uint16_t s_writes[EEPROM_SIZE];
+static int32_t s_writeBudget = UNLIMITED; // Bytes written before the power loss
+static bool s_ready          = true;
+
+static uint8_t readEeprom(uint16_t p_address) {
+    TEST_ASSERT_LESS_THAN(EEPROM_SIZE, p_address);
+    return s_eeprom[p_address];
+}
+
+static void writeEeprom(uint16_t p_address, uint8_t p_value) {
+    TEST_ASSERT_GREATER_OR_EQUAL(JOURNAL_OFFSET, p_address);
+    TEST_ASSERT_LESS_THAN(JOURNAL_OFFSET + JOURNAL_SIZE, p_address);
+    if (POWER_LOST == s_writeBudget)
+        return;
+
+    if (0 == s_writeBudget) {
+        s_eeprom[p_address] = 0xFF;
+        s_writeBudget       = POWER_LOST;
+        return;
+    }
+    if (UNLIMITED != s_writeBudget)
+        s_writeBudget--;
+    s_eeprom[p_address] = p_value;
+    s_writes[p_address]++;
+}
+
+static bool isEepromReady() {
+    return s_ready;
+}
+
+static const JournalStorage s_storage = {&readEeprom, &writeEeprom, &isEepromReady, JOURNAL_OFFSET};
+
+static void eraseEeprom() {
+    memset(s_eeprom, 0xFF, sizeof(s_eeprom));
+    memset(s_writes, 0, sizeof(s_writes));
+    s_writeBudget = UNLIMITED;
+    s_ready       = true;
+}
+
+// Game as the firmware starts it: a global, its last moves are zeroed
+static void startGame(Game* p_game) {
+    memset(p_game, 0, sizeof(Game));
+    initializeGame(p_game, DEFAULT_SENSORS_STATE);
+}
+
+// Next random move, played as the firmware commits it
+static bool playRandomMove(Game* p_game, uint32_t* p_seed, Move* p_move) {
+    Move moves[MOVEGEN_MAX_MOVES];
+    const uint8_t count = generateLegalMoves(p_game, moves);
+    if (0 == count)
+        return false;
+
+    *p_seed          = *p_seed * 1103515245u + 12345u;
+    const bool white = (bits::White == (p_game->state.status & bits::ColorMask));
+    playMove(p_game, moves[(*p_seed >> 16) % count]);
+    Move* lastMove = white ? &p_game->lastMoveW : &p_game->lastMoveB;
+    updateCheckState(p_game, lastMove);
+    *p_move = *lastMove;
+    return true;
+}
+
+static void assertSameGame(Game* p_expected, Game* p_game) {
+    TEST_ASSERT_EQUAL_HEX32(getGameChecksum(p_expected), getGameChecksum(p_game));
+    TEST_ASSERT_EQUAL(p_expected->evaluation.middlegame, p_game->evaluation.middlegame);
+    TEST_ASSERT_EQUAL(p_expected->evaluation.endgame, p_game->evaluation.endgame);
+    TEST_ASSERT_EQUAL(p_expected->evaluation.phase, p_game->evaluation.phase);
+}
+
+static void test_journalEmpty() {
+    // Nothing to resume from an erased EEPROM
+    eraseEeprom();
+    Journal journal;
+    Game game;
+    startGame(&game);
+    TEST_ASSERT_FALSE(resumeJournal(&journal, &s_storage, &game, DEFAULT_SENSORS_STATE));
+
+    // A new game is resumed once its checkpoint is written
+    recordJournalCheckpoint(&journal, &game);
+    flushJournal(&journal);
+    Game resumed;
+    TEST_ASSERT_TRUE(resumeJournal(&journal, &s_storage, &resumed, DEFAULT_SENSORS_STATE));
+    assertSameGame(&game, &resumed);
+
+    // Pieces moved while switched off: the journal is not used, the game is left replayed
+    memset(&resumed, 0, sizeof(resumed));
+    TEST_ASSERT_FALSE(resumeJournal(&journal, &s_storage, &resumed, DEFAULT_SENSORS_STATE & ~(1uLL << 12)));
+    TEST_ASSERT_EQUAL(WRook, resumed.board[0]);
+}
+
+static void test_journalResume() {
+    // Random games over many rounds of both rings, resumed after every move
+    eraseEeprom();
+    Journal journal;
+    Game game;
+    startGame(&game);
+    resumeJournal(&journal, &s_storage, &game, DEFAULT_SENSORS_STATE);
+    recordJournalCheckpoint(&journal, &game);
+
+    uint32_t seed   = 31337;
+    uint16_t played = 0;
+    for (uint8_t g = 0; g < 8; g++) {
+        for (uint16_t ply = 0; ply < 150; ply++) {
+            Move move;
+            if (!playRandomMove(&game, &seed, &move))
+                break;
+            recordJournalMove(&journal, &game, &move);
+            flushJournal(&journal);
+            played++;
+
+            Journal resumedJournal;
+            Game resumed;
+            TEST_ASSERT_TRUE(resumeJournal(&resumedJournal, &s_storage, &resumed, extractSensorsState(&game)));
+            assertSameGame(&game, &resumed);
+            TEST_ASSERT_EQUAL(journal.sequence, resumedJournal.sequence);
+            TEST_ASSERT_EQUAL(journal.moveSlot, resumedJournal.moveSlot);
+            TEST_ASSERT_EQUAL(journal.checkpointSlot, resumedJournal.checkpointSlot);
+            TEST_ASSERT_LESS_THAN(JOURNAL_CHECKPOINT_MOVES, resumedJournal.movesSinceCheckpoint);
+        }
+
+        // Next game
+        startGame(&game);
+        recordJournalCheckpoint(&journal, &game);
+    }
+    TEST_ASSERT_GREATER_THAN(2 * JOURNAL_MOVE_SLOTS, played);
+
+    // Wear is spread over the whole journal
+    uint16_t least = 0xFFFF;
+    uint16_t most  = 0;
+    for (uint16_t i = JOURNAL_OFFSET; i < JOURNAL_OFFSET + JOURNAL_SIZE; i++) {
+        least = (s_writes[i] < least) ? s_writes[i] : least;
+        most  = (s_writes[i] > most) ? s_writes[i] : most;
+    }
+    TEST_ASSERT_GREATER_THAN(0, least);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * played / JOURNAL_MOVE_SLOTS + 2, most);
+}
+
+static void test_journalTornWrites() {
+    // Power lost at each byte of the records of a move: the game is the one before or after the move
+    for (uint8_t checkpointMove = 0; checkpointMove < 2; checkpointMove++) {
+        eraseEeprom();
+        Journal journal;
+        Game game;
+        startGame(&game);
+        resumeJournal(&journal, &s_storage, &game, DEFAULT_SENSORS_STATE);
+        recordJournalCheckpoint(&journal, &game);
+        flushJournal(&journal);
+
+        // Up to the move before the next checkpoint, or the move before that one
+        uint32_t seed       = 2718;
+        const uint8_t moves = JOURNAL_CHECKPOINT_MOVES - (checkpointMove ? 1 : 2);
+        Move move;
+        for (uint8_t i = 0; i < moves; i++) {
+            TEST_ASSERT_TRUE(playRandomMove(&game, &seed, &move));
+            recordJournalMove(&journal, &game, &move);
+            flushJournal(&journal);
+        }
+
+        const Game before       = game;
+        const Journal unchanged = journal;
+        uint8_t saved[EEPROM_SIZE];
+        memcpy(saved, s_eeprom, sizeof(saved));
+        TEST_ASSERT_TRUE(playRandomMove(&game, &seed, &move));
+        const uint8_t recordSize = JOURNAL_MOVE_SIZE + (checkpointMove ? JOURNAL_CHECKPOINT_SIZE : 0);
+
+        for (uint8_t cut = 0; cut < recordSize; cut++) {
+            memcpy(s_eeprom, saved, sizeof(saved));
+            journal       = unchanged;
+            s_writeBudget = cut;
+            recordJournalMove(&journal, &game, &move);
+            flushJournal(&journal);
+            s_writeBudget = UNLIMITED;
+
+            // The move is kept once its record is complete
+            const bool moved = (cut >= JOURNAL_MOVE_SIZE);
+            Game expected    = moved ? game : before;
+            Journal resumedJournal;
+            Game resumed;
+            TEST_ASSERT_TRUE(resumeJournal(&resumedJournal, &s_storage, &resumed, extractSensorsState(&expected)));
+            assertSameGame(&expected, &resumed);
+
+            // Recording goes on from there
+            Game next = expected;
+            Move nextMove;
+            TEST_ASSERT_TRUE(playRandomMove(&next, &seed, &nextMove));
+            recordJournalMove(&resumedJournal, &next, &nextMove);
+            flushJournal(&resumedJournal);
+            TEST_ASSERT_TRUE(resumeJournal(&resumedJournal, &s_storage, &resumed, extractSensorsState(&next)));
+            assertSameGame(&next, &resumed);
+        }
+    }
+}
+
+static void test_journalBackground() {
+    // Bytes are only written while the storage is ready
+    eraseEeprom();
+    Journal journal;
+    Game game;
+    startGame(&game);
+    resumeJournal(&journal, &s_storage, &game, DEFAULT_SENSORS_STATE);
+    recordJournalCheckpoint(&journal, &game);
+
+    s_ready = false;
+    TEST_ASSERT_TRUE(serviceJournal(&journal));
+    TEST_ASSERT_EQUAL(JOURNAL_MOVE_SIZE, journal.pendingIndex);
+
+    s_ready = true;
+    TEST_ASSERT_FALSE(serviceJournal(&journal));
+    Game resumed;
+    TEST_ASSERT_TRUE(resumeJournal(&journal, &s_storage, &resumed, DEFAULT_SENSORS_STATE));
+
+    // A record queued before the previous one is written waits for it
+    uint32_t seed = 1;
+    Move move;
+    playRandomMove(&game, &seed, &move);
+    s_ready = false;
+    recordJournalMove(&journal, &game, &move);
+    playRandomMove(&game, &seed, &move);
+    recordJournalMove(&journal, &game, &move);
+    s_ready = true;
+    serviceJournal(&journal);
+    TEST_ASSERT_TRUE(resumeJournal(&journal, &s_storage, &resumed, extractSensorsState(&game)));
+    assertSameGame(&game, &resumed);
+}
+
+// Move made on the sensors and followed by the journaled game: exactly one call completes it
+static void playSensorMove(Journal* p_journal, Game* p_game, uint64_t* p_sensors, const char* p_start, const char* p_end) {
+    // Legal move, captures flagged
+    Move moves[MOVEGEN_MAX_MOVES];
+    const uint8_t count = generateLegalMoves(p_game, moves);
+    uint8_t index       = 0;
+    while (index < count && (moves[index].start != getSquareFromStr(p_start) || moves[index].end != getSquareFromStr(p_end)))
+        index++;
+    TEST_ASSERT_TRUE_MESSAGE(index < count, p_start);
+
+    uint8_t events[REPLAY_MAX_MOVE_EVENTS];
+    const uint8_t eventCount = getMoveSensorEvents(p_game, moves[index], false, events);
+    uint8_t completed        = 0;
+    for (uint8_t i = 0; i < eventCount; i++) {
+        const uint64_t mask = 1uLL << (events[i] & REPLAY_SQUARE_MASK);
+        *p_sensors          = (events[i] & REPLAY_EVENT_PLACED) ? (*p_sensors | mask) : (*p_sensors & ~mask);
+        completed += evolveJournaledGame(p_journal, nullptr, p_game, *p_sensors, nullptr) ? 1 : 0;
+    }
+    TEST_ASSERT_EQUAL_MESSAGE(1, completed, p_start);
+    flushJournal(p_journal);
+}
+
+static void test_journalSensorMoves() {
+    // En passant and a castling giving check change the last move on an intermediate step: one record per move
+    const char* moves[][2][3] = {
+        {{"e2", "e4"}, {"a7", "a6"}},
+        {{"e4", "e5"}, {"d7", "d5"}},
+        {{"e5", "d6"}, {"g8", "f6"}}, // En passant
+    };
+    eraseEeprom();
+    Journal journal;
+    Game game;
+    startGame(&game);
+    resumeJournal(&journal, &s_storage, &game, DEFAULT_SENSORS_STATE);
+    recordJournalCheckpoint(&journal, &game);
+    flushJournal(&journal);
+    uint64_t sensors = DEFAULT_SENSORS_STATE;
+    for (uint8_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        playSensorMove(&journal, &game, &sensors, moves[i][0][0], moves[i][0][1]);
+        playSensorMove(&journal, &game, &sensors, moves[i][1][0], moves[i][1][1]);
+    }
+    TEST_ASSERT_TRUE(game.lastMoveW.captured);
+    TEST_ASSERT_EQUAL(6, journal.movesSinceCheckpoint);
+
+    Journal resumedJournal;
+    Game resumed;
+    TEST_ASSERT_TRUE(resumeJournal(&resumedJournal, &s_storage, &resumed, sensors));
+    assertSameGame(&game, &resumed);
+    TEST_ASSERT_EQUAL(journal.sequence, resumedJournal.sequence);
+
+    // Castling giving check, then the reply
+    eraseEeprom();
+    memset(&game, 0, sizeof(game));
+    TEST_ASSERT_TRUE(initializeFromFEN(&game, "5k2/8/8/8/8/8/8/4K2R w K - 0 1"));
+    resumeJournal(&journal, &s_storage, &game, DEFAULT_SENSORS_STATE);
+    recordJournalCheckpoint(&journal, &game);
+    flushJournal(&journal);
+    sensors = extractSensorsState(&game);
+    playSensorMove(&journal, &game, &sensors, "e1", "g1");
+    TEST_ASSERT_TRUE(game.lastMoveW.check);
+    playSensorMove(&journal, &game, &sensors, "f8", "e7");
+    TEST_ASSERT_EQUAL(2, journal.movesSinceCheckpoint);
+
+    TEST_ASSERT_TRUE(resumeJournal(&resumedJournal, &s_storage, &resumed, sensors));
+    assertSameGame(&game, &resumed);
+    TEST_ASSERT_EQUAL(journal.sequence, resumedJournal.sequence);
+}
+
+// Game task of the firmware: called again with the same sensors as long as the game changes
+static uint8_t evolveUntilUnchanged(Journal* p_journal, SignatureTable* p_table, Game* p_game, uint64_t p_sensors) {
+    uint8_t completed = 0;
+    uint8_t calls     = 0;
+    bool changed      = true;
+    while (changed && calls++ < 8)
+        completed += evolveJournaledGame(p_journal, p_table, p_game, p_sensors, &changed) ? 1 : 0;
+    TEST_ASSERT_FALSE(changed);
+    return completed;
+}
+
+static void test_journalSameScanChanges() {
+    // Lift and placement seen in one scan: evolveGame follows one square per call, the second call commits
+    eraseEeprom();
+    Journal journal;
+    Game game;
+    startGame(&game);
+    resumeJournal(&journal, &s_storage, &game, DEFAULT_SENSORS_STATE);
+    recordJournalCheckpoint(&journal, &game);
+    uint64_t sensors = (DEFAULT_SENSORS_STATE & ~(1uLL << getSquareFromStr("e2"))) | (1uLL << getSquareFromStr("e4"));
+    bool changed     = false;
+    TEST_ASSERT_FALSE(evolveJournaledGame(&journal, nullptr, &game, sensors, &changed));
+    TEST_ASSERT_TRUE(changed);
+    TEST_ASSERT_EQUAL(1, evolveUntilUnchanged(&journal, nullptr, &game, sensors));
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WPawn, game.board[getSquareFromStr("e4")]);
+    TEST_ASSERT_EQUAL(1, journal.movesSinceCheckpoint);
+
+    // Illegal lift and placement in one scan, then pieces put back in one scan
+    const uint64_t legal = sensors;
+    sensors              = (legal & ~(1uLL << getSquareFromStr("a7"))) | (1uLL << getSquareFromStr("a4"));
+    TEST_ASSERT_EQUAL(0, evolveUntilUnchanged(&journal, nullptr, &game, sensors));
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay | bits::Illegal, game.state.status);
+    TEST_ASSERT_EQUAL(0, evolveUntilUnchanged(&journal, nullptr, &game, legal));
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+
+    // Same with the signature table of the position
+    SignatureTable table;
+    resetSignatureTable(&table);
+    sensors = (legal & ~(1uLL << getSquareFromStr("d7"))) | (1uLL << getSquareFromStr("d5"));
+    TEST_ASSERT_EQUAL(1, evolveUntilUnchanged(&journal, &table, &game, sensors));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(2, journal.movesSinceCheckpoint);
+}
+
+void run_journal() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_journalEmpty);
+    RUN_TEST(test_journalResume);
+    RUN_TEST(test_journalTornWrites);
+    RUN_TEST(test_journalBackground);
+    RUN_TEST(test_journalSensorMoves);
+    RUN_TEST(test_journalSameScanChanges);
+
+    UNITY_END();
+}
@@ -0,0 +1,135 @@
+#include <keypad.h>
+#include <unity.h>
+
+// ADC values in the middle of each key range
+static const uint16_t ADC_NONE   = 1023;
+static const uint16_t ADC_SELECT = 740;
+static const uint16_t ADC_UP     = 145;
+static const uint16_t ADC_LEFT   = 505;
+
+static void feed(Keypad* p_keypad, uint16_t p_value, uint16_t p_samples) {
+    for (uint16_t i = 0; i < p_samples; i++)
+        updateKeypad(p_keypad, p_value);
+}
+
+static void checkEvent(Keypad* p_keypad, LCD_KEY p_key, EKeypadEvent p_type) {
+    KeypadEvent event;
+    TEST_ASSERT_TRUE(popKeypadEvent(p_keypad, &event));
+    TEST_ASSERT_EQUAL(p_key, event.key);
+    TEST_ASSERT_EQUAL(p_type, event.type);
+}
+
+static void test_keypadThresholds() {
+    TEST_ASSERT_EQUAL(LCD_KEY::Right, getKeyFromAdc(0));
+    TEST_ASSERT_EQUAL(LCD_KEY::Right, getKeyFromAdc(99));
+    TEST_ASSERT_EQUAL(LCD_KEY::Up, getKeyFromAdc(100));
+    TEST_ASSERT_EQUAL(LCD_KEY::Up, getKeyFromAdc(249));
+    TEST_ASSERT_EQUAL(LCD_KEY::Down, getKeyFromAdc(250));
+    TEST_ASSERT_EQUAL(LCD_KEY::Down, getKeyFromAdc(379));
+    TEST_ASSERT_EQUAL(LCD_KEY::Left, getKeyFromAdc(380));
+    TEST_ASSERT_EQUAL(LCD_KEY::Left, getKeyFromAdc(599));
+    TEST_ASSERT_EQUAL(LCD_KEY::Select, getKeyFromAdc(600));
+    TEST_ASSERT_EQUAL(LCD_KEY::Select, getKeyFromAdc(899));
+    TEST_ASSERT_EQUAL(LCD_KEY::None, getKeyFromAdc(900));
+    TEST_ASSERT_EQUAL(LCD_KEY::None, getKeyFromAdc(1023));
+}
+
+static void test_keypadDebounce() {
+    Keypad keypad;
+    initializeKeypad(&keypad);
+    KeypadEvent event;
+
+    // Contact bounces: nothing until the key is stable
+    for (uint8_t i = 0; i < 10; i++) {
+        feed(&keypad, ADC_UP, KEYPAD_DEBOUNCE_SAMPLES - 1);
+        feed(&keypad, ADC_NONE, 1);
+    }
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+    TEST_ASSERT_EQUAL(LCD_KEY::None, keypad.key);
+
+    feed(&keypad, ADC_UP, KEYPAD_DEBOUNCE_SAMPLES - 1);
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+    feed(&keypad, ADC_UP, 1);
+    TEST_ASSERT_EQUAL(LCD_KEY::Up, keypad.key);
+    checkEvent(&keypad, LCD_KEY::Up, KeypadPress);
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+
+    // Held: one press only, then the release
+    feed(&keypad, ADC_UP, 50);
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+    feed(&keypad, ADC_NONE, KEYPAD_DEBOUNCE_SAMPLES);
+    checkEvent(&keypad, LCD_KEY::Up, KeypadRelease);
+    TEST_ASSERT_EQUAL(LCD_KEY::None, keypad.key);
+
+    // Values crossed by the ladder on the way to another key are not seen as keys
+    feed(&keypad, ADC_SELECT, KEYPAD_DEBOUNCE_SAMPLES);
+    feed(&keypad, ADC_LEFT, 2);
+    feed(&keypad, ADC_UP, KEYPAD_DEBOUNCE_SAMPLES);
+    checkEvent(&keypad, LCD_KEY::Select, KeypadPress);
+    checkEvent(&keypad, LCD_KEY::Select, KeypadRelease);
+    checkEvent(&keypad, LCD_KEY::Up, KeypadPress);
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+}
+
+static void test_keypadLongPress() {
+    Keypad keypad;
+    initializeKeypad(&keypad);
+    KeypadEvent event;
+
+    feed(&keypad, ADC_SELECT, KEYPAD_DEBOUNCE_SAMPLES);
+    checkEvent(&keypad, LCD_KEY::Select, KeypadPress);
+    feed(&keypad, ADC_SELECT, KEYPAD_LONG_PRESS_SAMPLES - 1);
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+    feed(&keypad, ADC_SELECT, 1);
+    checkEvent(&keypad, LCD_KEY::Select, KeypadLongPress);
+
+    // Only once however long the key is held
+    feed(&keypad, ADC_SELECT, 3 * KEYPAD_LONG_PRESS_SAMPLES);
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+    feed(&keypad, ADC_NONE, KEYPAD_DEBOUNCE_SAMPLES);
+    checkEvent(&keypad, LCD_KEY::Select, KeypadRelease);
+
+    // Counted again from the next press
+    feed(&keypad, ADC_SELECT, KEYPAD_DEBOUNCE_SAMPLES + KEYPAD_LONG_PRESS_SAMPLES - 1);
+    checkEvent(&keypad, LCD_KEY::Select, KeypadPress);
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+}
+
+static void test_keypadQueue() {
+    // Main loop late: events beyond the queue are dropped and counted, the first ones are kept in order
+    Keypad keypad;
+    initializeKeypad(&keypad);
+    for (uint8_t i = 0; i < KEYPAD_QUEUE_SIZE; i++) {
+        feed(&keypad, ADC_LEFT, KEYPAD_DEBOUNCE_SAMPLES);
+        feed(&keypad, ADC_NONE, KEYPAD_DEBOUNCE_SAMPLES);
+    }
+    TEST_ASSERT_EQUAL(KEYPAD_QUEUE_SIZE, keypad.dropped);
+    TEST_ASSERT_EQUAL(LCD_KEY::None, keypad.key);
+
+    for (uint8_t i = 0; i < KEYPAD_QUEUE_SIZE / 2; i++) {
+        checkEvent(&keypad, LCD_KEY::Left, KeypadPress);
+        checkEvent(&keypad, LCD_KEY::Left, KeypadRelease);
+    }
+    KeypadEvent event;
+    TEST_ASSERT_FALSE(popKeypadEvent(&keypad, &event));
+
+    // Queue indexes wrap around
+    for (uint16_t i = 0; i < 300; i++) {
+        feed(&keypad, ADC_UP, KEYPAD_DEBOUNCE_SAMPLES);
+        checkEvent(&keypad, LCD_KEY::Up, KeypadPress);
+        feed(&keypad, ADC_NONE, KEYPAD_DEBOUNCE_SAMPLES);
+        checkEvent(&keypad, LCD_KEY::Up, KeypadRelease);
+    }
+    TEST_ASSERT_EQUAL(KEYPAD_QUEUE_SIZE, keypad.dropped);
+}
+
+void run_keypad() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_keypadThresholds);
+    RUN_TEST(test_keypadDebounce);
+    RUN_TEST(test_keypadLongPress);
+    RUN_TEST(test_keypadQueue);
+
+    UNITY_END();
+}
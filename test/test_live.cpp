@@ -0,0 +1,140 @@
+#include <atomic>
+#include <chess.h>
+#include <live.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <unity.h>
+
+static const char* s_fens[2] = {
+    "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+};
+
+// Region named after the process, tests running side by side do not share it
+static void getRegionName(char* p_name) {
+    sprintf(p_name, "/chessboard-test-%d", (int)getpid());
+}
+
+static void loadGame(Game* p_game, uint8_t p_index) {
+    memset(p_game, 0, sizeof(Game));
+    TEST_ASSERT_TRUE(initializeFromFEN(p_game, s_fens[p_index]));
+}
+
+static void test_livePublish() {
+    char name[64];
+    getRegionName(name);
+    LiveRegion writer;
+    TEST_ASSERT_TRUE(createLiveRegion(&writer, name, 4));
+
+    // Boards are empty until published
+    LiveRegion reader;
+    TEST_ASSERT_TRUE(openLiveRegion(&reader, name));
+    LiveBoard snapshot;
+    TEST_ASSERT_TRUE(readLiveBoard(&reader, 2, &snapshot));
+    TEST_ASSERT_EQUAL(0, snapshot.version);
+    TEST_ASSERT_FALSE(readLiveBoard(&reader, 4, &snapshot));
+
+    Game game;
+    loadGame(&game, 1);
+    game.lastMoveW = BUILD_MOVE(3, 12, WBishop);
+    publishLiveBoard(&writer, 2, &game, 1234);
+    TEST_ASSERT_EQUAL(1, getLiveBoardVersion(&reader, 2));
+    TEST_ASSERT_EQUAL(0, getLiveBoardVersion(&reader, 1));
+
+    uint16_t attempts = 0;
+    TEST_ASSERT_TRUE(readLiveBoard(&reader, 2, &snapshot, &attempts));
+    TEST_ASSERT_EQUAL(1, attempts);
+    TEST_ASSERT_EQUAL(1, snapshot.version);
+    TEST_ASSERT_EQUAL(1234, snapshot.updated_ns);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(game.board, snapshot.board, sizeof(game.board));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&game.state, &snapshot.state, sizeof(State));
+    TEST_ASSERT_EQUAL(12, snapshot.lastMoveW.end);
+    TEST_ASSERT_EQUAL(game.fullmoveClock, snapshot.fullmoveClock);
+    TEST_ASSERT_EQUAL_STRING(s_fens[1], snapshot.fen);
+
+    // A new writer retires the region of the previous one
+    TEST_ASSERT_TRUE(isLiveRegionCurrent(&reader));
+    LiveRegion next;
+    TEST_ASSERT_TRUE(createLiveRegion(&next, name, 8));
+    TEST_ASSERT_FALSE(isLiveRegionCurrent(&reader));
+    closeLiveRegion(&reader);
+    TEST_ASSERT_TRUE(openLiveRegion(&reader, name));
+    TEST_ASSERT_EQUAL(8, reader.header->boardCount);
+    TEST_ASSERT_EQUAL(0, getLiveBoardVersion(&reader, 2));
+
+    closeLiveRegion(&reader);
+    closeLiveRegion(&next);
+    closeLiveRegion(&writer);
+    removeLiveRegion(name);
+    TEST_ASSERT_FALSE(openLiveRegion(&reader, name));
+}
+
+static void test_liveStoppedWriter() {
+    // A writer stopped in the middle of an update: readers give up instead of spinning
+    char name[64];
+    getRegionName(name);
+    LiveRegion region;
+    TEST_ASSERT_TRUE(createLiveRegion(&region, name, 1));
+    region.slots[0].sequence.store(3);
+    LiveBoard snapshot;
+    uint16_t attempts = 0;
+    TEST_ASSERT_FALSE(readLiveBoard(&region, 0, &snapshot, &attempts));
+    TEST_ASSERT_EQUAL(LIVE_READ_ATTEMPTS, attempts);
+    closeLiveRegion(&region);
+    removeLiveRegion(name);
+}
+
+static void test_liveConcurrentReads() {
+    // One writer alternating two positions at full rate: every snapshot is one of them, never a mix
+    char name[64];
+    getRegionName(name);
+    LiveRegion writer;
+    TEST_ASSERT_TRUE(createLiveRegion(&writer, name, 1));
+    Game games[2];
+    loadGame(&games[0], 0);
+    loadGame(&games[1], 1);
+    publishLiveBoard(&writer, 0, &games[0], 0);
+
+    std::atomic<bool> done(false);
+    std::thread publisher([&]() {
+        for (uint32_t i = 1; !done.load(std::memory_order_relaxed); i++)
+            publishLiveBoard(&writer, 0, &games[i & 1], i);
+    });
+
+    LiveRegion reader;
+    TEST_ASSERT_TRUE(openLiveRegion(&reader, name));
+    uint32_t torn    = 0;
+    uint32_t last    = 0;
+    uint32_t changes = 0;
+    for (uint32_t i = 0; i < 200000; i++) {
+        LiveBoard snapshot;
+        if (!readLiveBoard(&reader, 0, &snapshot))
+            continue;
+        const uint8_t index = (snapshot.version - 1) & 1;
+        if (0 != memcmp(games[index].board, snapshot.board, sizeof(snapshot.board)) || 0 != strcmp(s_fens[index], snapshot.fen) ||
+            snapshot.updated_ns + 1 != snapshot.version)
+            torn++;
+        changes += (snapshot.version != last) ? 1 : 0;
+        last = snapshot.version;
+    }
+    done = true;
+    publisher.join();
+
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_GREATER_THAN(1, changes);
+    closeLiveRegion(&reader);
+    closeLiveRegion(&writer);
+    removeLiveRegion(name);
+}
+
+void run_live() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_livePublish);
+    RUN_TEST(test_liveStoppedWriter);
+    RUN_TEST(test_liveConcurrentReads);
+
+    UNITY_END();
+}
@@ -0,0 +1,187 @@
+#include <chess.h>
+#include <eval.h>
+#include <movegen.h>
+#include <replay.h>
+#include <unity.h>
+
+static uint8_t countMoves(const char* p_fen) {
+    Game game;
+    initializeFromFEN(&game, p_fen);
+    Move moves[MOVEGEN_MAX_MOVES];
+    return generateLegalMoves(&game, moves);
+}
+
+static void test_movegenCounts() {
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    Move moves[MOVEGEN_MAX_MOVES];
+    TEST_ASSERT_EQUAL(20, generateLegalMoves(&game, moves));
+
+    // Reference positions (castling, en passant, pins)
+    TEST_ASSERT_EQUAL(48, countMoves("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+    TEST_ASSERT_EQUAL(14, countMoves("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"));
+    TEST_ASSERT_EQUAL(6, countMoves("8/8/8/K2pP2r/8/8/8/7k w - d6 0 1")); // exd6 would expose the king
+
+    // 44 with under-promotions, the board only promotes to queens
+    TEST_ASSERT_EQUAL(41, countMoves("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"));
+
+    // Checkmate and stalemate
+    TEST_ASSERT_EQUAL(0, countMoves("rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3"));
+    TEST_ASSERT_EQUAL(0, countMoves("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"));
+
+    // No move while a move is being played
+    uint64_t sensors = DEFAULT_SENSORS_STATE & ~(1uLL << 12);
+    evolveGame(&game, sensors);
+    TEST_ASSERT_EQUAL(0, generateLegalMoves(&game, moves));
+}
+
+static void test_movegenAttacks() {
+    Game game;
+    initializeFromFEN(&game, "4k3/8/8/3p4/8/8/8/R3K2B w - - 0 1");
+    TEST_ASSERT_TRUE(isSquareAttacked(game.board, 56, bits::White));  // a8 by the rook
+    TEST_ASSERT_TRUE(isSquareAttacked(game.board, 35, bits::White));  // d5 by the bishop
+    TEST_ASSERT_FALSE(isSquareAttacked(game.board, 42, bits::White)); // c6 is behind the pawn
+    TEST_ASSERT_TRUE(isSquareAttacked(game.board, 26, bits::Black));  // c4 by the pawn
+    TEST_ASSERT_FALSE(isSquareAttacked(game.board, 27, bits::Black)); // d4 is in front of the pawn
+    TEST_ASSERT_TRUE(isSquareAttacked(game.board, 51, bits::Black));  // d7 by the king
+}
+
+static void test_movegenClassify() {
+    const struct {
+        const char* fen;
+        EPosition expected;
+    } positions[] = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",        PositionNormal   },
+        {"7k/8/8/8/8/8/8/K6Q b - - 0 1",                                    PositionCheck    },
+        {"rnb1kbnr/pppppppp/8/8/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3",     PositionCheckmate},
+        {"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1",                                  PositionStalemate},
+        {"7k/8/8/8/8/8/8/K6Q w - - 0 1",                                    PositionIllegal  }, // Player not to play in check
+        {"8/8/8/8/8/8/8/K6Q w - - 0 1",                                     PositionIllegal  }, // No black king
+        {"P6k/8/8/8/8/8/8/K7 w - - 0 1",                                    PositionIllegal  }, // Pawn on the last rank
+    };
+
+    for (const auto& position : positions) {
+        Game game;
+        initializeFromFEN(&game, position.fen);
+        TEST_ASSERT_EQUAL_MESSAGE(position.expected, classifyPosition(&game), position.fen);
+    }
+}
+
+static void test_movegenSensorEvents() {
+    uint8_t events[REPLAY_MAX_MOVE_EVENTS];
+
+    Game game;
+    initializeFromFEN(&game, "r3k2r/8/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1");
+    Move castling = BUILD_MOVE(4, 2, WKing);
+    TEST_ASSERT_EQUAL(4, getMoveSensorEvents(&game, castling, false, events));
+    TEST_ASSERT_EQUAL_HEX8(4, events[0]);
+    TEST_ASSERT_EQUAL_HEX8(REPLAY_EVENT_PLACED | 2, events[1]);
+    TEST_ASSERT_EQUAL_HEX8(0, events[2]);
+    TEST_ASSERT_EQUAL_HEX8(REPLAY_EVENT_PLACED | 3, events[3]);
+
+    Move enPassant     = BUILD_MOVE(36, 43, WPawn);
+    enPassant.captured = true;
+    TEST_ASSERT_EQUAL(3, getMoveSensorEvents(&game, enPassant, true, events));
+    TEST_ASSERT_EQUAL_HEX8(36, events[0]);
+    TEST_ASSERT_EQUAL_HEX8(REPLAY_EVENT_PLACED | 43, events[1]);
+    TEST_ASSERT_EQUAL_HEX8(35, events[2]);
+
+    Move capture     = BUILD_MOVE(0, 56, WRook);
+    capture.captured = true;
+    TEST_ASSERT_EQUAL(3, getMoveSensorEvents(&game, capture, true, events));
+    TEST_ASSERT_EQUAL_HEX8(56, events[0]);
+    TEST_ASSERT_EQUAL_HEX8(0, events[1]);
+    TEST_ASSERT_EQUAL_HEX8(REPLAY_EVENT_PLACED | 56, events[2]);
+}
+
+static void test_movegenRandomGames() {
+    // Generated sensor events keep the game in sync, whatever the capture order
+    uint32_t seed = 12345;
+    for (uint8_t g = 0; g < 20; g++) {
+        Game game;
+        initializeGame(&game, DEFAULT_SENSORS_STATE);
+        uint64_t sensors = DEFAULT_SENSORS_STATE;
+
+        for (uint16_t ply = 0; ply < 200; ply++) {
+            Move moves[MOVEGEN_MAX_MOVES];
+            const uint8_t count = generateLegalMoves(&game, moves);
+            if (0 == count)
+                break;
+
+            seed                = seed * 1103515245u + 12345u;
+            const Move move     = moves[(seed >> 16) % count];
+            const uint8_t color = game.state.status & bits::ColorMask;
+
+            Game played = game;
+            playMove(&played, move);
+
+            uint8_t events[REPLAY_MAX_MOVE_EVENTS];
+            const uint8_t eventCount  = getMoveSensorEvents(&game, move, 0 != (seed & 0x100), events);
+            const ReplayResult result = replaySensorEvents(&game, sensors, events, eventCount, nullptr);
+            sensors                   = result.sensors;
+
+            TEST_ASSERT_EQUAL_HEX8((color ^ bits::ColorMask) | bits::ToPlay, game.state.status);
+            TEST_ASSERT_EQUAL(move.promotion ? (color | bits::Queen) : move.piece, game.board[move.end]);
+            TEST_ASSERT_EQUAL(Empty, game.board[move.start]);
+
+            // Playing the move directly gives the same game, check flags aside
+            const Move* lastMove       = (bits::White == color) ? &game.lastMoveW : &game.lastMoveB;
+            const Move* playedLastMove = (bits::White == color) ? &played.lastMoveW : &played.lastMoveB;
+            TEST_ASSERT_EQUAL_MEMORY(game.board, played.board, sizeof(game.board));
+            TEST_ASSERT_EQUAL_MEMORY(&game.state, &played.state, sizeof(game.state));
+            TEST_ASSERT_EQUAL(game.fullmoveClock, played.fullmoveClock);
+            TEST_ASSERT_EQUAL(game.halfmoveClock, played.halfmoveClock);
+            TEST_ASSERT_EQUAL(lastMove->start, playedLastMove->start);
+            TEST_ASSERT_EQUAL(lastMove->end, playedLastMove->end);
+            TEST_ASSERT_EQUAL(lastMove->captured, playedLastMove->captured);
+            TEST_ASSERT_EQUAL(lastMove->promotion, playedLastMove->promotion);
+
+            // Both keep their evaluation in sync with the board
+            Evaluation evaluation;
+            initializeEvaluation(&evaluation, game.board);
+            TEST_ASSERT_EQUAL(evaluation.middlegame, game.evaluation.middlegame);
+            TEST_ASSERT_EQUAL(evaluation.endgame, game.evaluation.endgame);
+            TEST_ASSERT_EQUAL(evaluation.phase, game.evaluation.phase);
+            TEST_ASSERT_EQUAL(getEvaluation(&evaluation), getEvaluation(&played.evaluation));
+        }
+    }
+}
+
+static void test_movegenIsLegal() {
+    // Single move validation agrees with the generated moves
+    const char* fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "8/8/8/K2pP2r/8/8/8/7k w - d6 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 b kq - 0 1",
+    };
+    for (uint8_t f = 0; f < sizeof(fens) / sizeof(fens[0]); f++) {
+        Game game;
+        initializeFromFEN(&game, fens[f]);
+        Move moves[MOVEGEN_MAX_MOVES];
+        const uint8_t count = generateLegalMoves(&game, moves);
+
+        for (uint8_t start = 0; start < 64; start++) {
+            for (uint8_t end = 0; end < 64; end++) {
+                bool generated = false;
+                for (uint8_t i = 0; i < count; i++)
+                    generated |= (moves[i].start == start && moves[i].end == end);
+                TEST_ASSERT_EQUAL(generated, isLegalMove(&game, BUILD_MOVE(start, end, game.board[start])));
+            }
+        }
+    }
+}
+
+void run_movegen() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_movegenCounts);
+    RUN_TEST(test_movegenAttacks);
+    RUN_TEST(test_movegenClassify);
+    RUN_TEST(test_movegenSensorEvents);
+    RUN_TEST(test_movegenRandomGames);
+    RUN_TEST(test_movegenIsLegal);
+
+    UNITY_END();
+}
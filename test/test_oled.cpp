@@ -0,0 +1,166 @@
+#include "mock_oled.h"
+#include "mock_sensors.h"
+#include "utils.h"
+#include <chess.h>
+#include <oled.h>
+#include <string.h>
+#include <unity.h>
+
+static void test_oledFirstRender() {
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    OledRenderer renderer;
+    initializeOledRenderer(&renderer);
+    MockOled oled;
+    initializeMockOled(&oled);
+
+    // Whole board is pushed, one transfer per tile row, after the 8 frame tiles
+    TEST_ASSERT_EQUAL(32, renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled));
+    TEST_ASSERT_EQUAL(8 + 4, oled.transfers);
+    TEST_ASSERT_EQUAL(8 * (MOCK_OLED_I2C_OVERHEAD + OLED_TILE_SIZE) + 4 * (MOCK_OLED_I2C_OVERHEAD + 8 * OLED_TILE_SIZE), oled.i2cBytes);
+
+    // Nothing changed: nothing sent
+    TEST_ASSERT_EQUAL(0, renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled));
+    TEST_ASSERT_EQUAL(8 + 4, oled.transfers);
+}
+
+static void test_oledGlyphs() {
+    Game game;
+    initializeFromFEN(&game, "4k3/8/8/8/8/8/8/R3K3 w - - 0 1");
+    OledRenderer renderer;
+    initializeOledRenderer(&renderer);
+    MockOled oled;
+    initializeMockOled(&oled);
+    renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled);
+
+    // a1 is the bottom-left square: pixels x = 32..39, y = 28..31
+    uint8_t a1Pixels = 0;
+    for (uint8_t x = 32; x < 40; x++)
+        for (uint8_t y = 28; y < 32; y++)
+            a1Pixels += getMockOledPixel(&oled, x, y);
+    TEST_ASSERT_GREATER_THAN(0, a1Pixels);
+
+    // b1 is empty
+    for (uint8_t x = 40; x < 48; x++)
+        for (uint8_t y = 28; y < 32; y++)
+            TEST_ASSERT_FALSE(getMockOledPixel(&oled, x, y));
+
+    // Same tile content for a given piece wherever it is
+    uint8_t e1Tile[OLED_TILE_SIZE];
+    uint8_t e8Tile[OLED_TILE_SIZE];
+    buildOledBoardTile(&game, 4, 3, e1Tile); // e2 + e1
+    buildOledBoardTile(&game, 4, 0, e8Tile); // e8 + e7
+    for (uint8_t i = 0; i < OLED_TILE_SIZE; i++) {
+        TEST_ASSERT_EQUAL(0, e1Tile[i] & 0x0F); // e2 is empty
+        TEST_ASSERT_EQUAL(0, e8Tile[i] >> 4);   // e7 is empty
+    }
+}
+
+static void test_oledOnlyChangedTiles() {
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    uint64_t sensorsState = DEFAULT_SENSORS_STATE;
+    OledRenderer renderer;
+    initializeOledRenderer(&renderer);
+    MockOled oled;
+    initializeMockOled(&oled);
+    renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled);
+    initializeMockOled(&oled);
+
+    // Lifting e2 changes a single tile (e2 + e1)
+    sensorsState = EXEC(&game, "-e2", sensorsState);
+    TEST_ASSERT_EQUAL(1, renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled));
+
+    // Placing on e4 changes another single tile (e4 + e3)
+    sensorsState = EXEC(&game, "+e4", sensorsState);
+    TEST_ASSERT_EQUAL(1, renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled));
+    TEST_ASSERT_EQUAL(2 * (MOCK_OLED_I2C_OVERHEAD + OLED_TILE_SIZE), oled.i2cBytes);
+
+    // Castling short changes adjacent tiles, sent in one transfer
+    initializeFromFEN(&game, "rnbqk2r/pppppppp/8/8/8/8/PPPPPPPP/RNBQK2R w KQkq - 0 1");
+    sensorsState = extractSensorsState(&game);
+    renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled);
+    initializeMockOled(&oled);
+
+    sensorsState = EXEC(&game, "-e1 +g1 -h1 +f1", sensorsState);
+    TEST_ASSERT_EQUAL(4, renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled));
+    TEST_ASSERT_EQUAL(1, oled.transfers);
+    TEST_ASSERT_EQUAL(MOCK_OLED_I2C_OVERHEAD + 4 * OLED_TILE_SIZE, oled.i2cBytes);
+}
+
+static void test_oledFrame() {
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    OledRenderer renderer;
+    initializeOledRenderer(&renderer);
+    MockOled oled;
+    initializeMockOled(&oled);
+    renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled);
+
+    for (uint8_t y = 0; y < 32; y++) {
+        TEST_ASSERT_TRUE(getMockOledPixel(&oled, 30, y));
+        TEST_ASSERT_TRUE(getMockOledPixel(&oled, 97, y));
+        TEST_ASSERT_FALSE(getMockOledPixel(&oled, 31, y));
+        TEST_ASSERT_FALSE(getMockOledPixel(&oled, 96, y));
+    }
+}
+
+static void test_oledRefusedTiles() {
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    OledRenderer renderer;
+    initializeOledRenderer(&renderer);
+    MockOled reference;
+    initializeMockOled(&reference);
+    renderOledBoard(&renderer, &game, &mockOledWriteTiles, &reference);
+
+    // Transfer queue only has room for the frame and one row of tiles
+    initializeOledRenderer(&renderer);
+    MockOled oled;
+    initializeMockOled(&oled);
+    oled.i2cCapacity = 8 * (MOCK_OLED_I2C_OVERHEAD + OLED_TILE_SIZE) + MOCK_OLED_I2C_OVERHEAD + 8 * OLED_TILE_SIZE;
+    TEST_ASSERT_EQUAL(8, renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled));
+    TEST_ASSERT_EQUAL(0, renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled));
+
+    // Refused tiles are sent again once there is room, frame is not
+    oled.i2cCapacity = 0;
+    TEST_ASSERT_EQUAL(24, renderOledBoard(&renderer, &game, &mockOledWriteTiles, &oled));
+    TEST_ASSERT_EQUAL(8 + 4, oled.transfers);
+    TEST_ASSERT_EQUAL(0, memcmp(reference.framebuffer, oled.framebuffer, sizeof(oled.framebuffer)));
+}
+
+static void test_oledEvalBar() {
+    OledRenderer renderer;
+    initializeOledRenderer(&renderer);
+    MockOled oled;
+    initializeMockOled(&oled);
+
+    // Even position: bottom half filled, whole bar pushed once
+    TEST_ASSERT_EQUAL(OLED_EVAL_BAR_HEIGHT / 2, getOledEvalBarHeight(0));
+    TEST_ASSERT_EQUAL(OLED_TILE_ROWS, renderOledEvalBar(&renderer, 0, &mockOledWriteTiles, &oled));
+    const uint8_t x = OLED_EVAL_BAR_TILE_X * OLED_TILE_SIZE + 3;
+    TEST_ASSERT_FALSE(getMockOledPixel(&oled, x, OLED_EVAL_BAR_HEIGHT / 2 - 1));
+    TEST_ASSERT_TRUE(getMockOledPixel(&oled, x, OLED_EVAL_BAR_HEIGHT / 2));
+    TEST_ASSERT_EQUAL(0, renderOledEvalBar(&renderer, 0, &mockOledWriteTiles, &oled));
+
+    // A small advantage changes a single tile, large ones saturate
+    TEST_ASSERT_EQUAL(1, renderOledEvalBar(&renderer, 100, &mockOledWriteTiles, &oled));
+    TEST_ASSERT_TRUE(getMockOledPixel(&oled, x, OLED_EVAL_BAR_HEIGHT / 2 - 2));
+    TEST_ASSERT_EQUAL(OLED_EVAL_BAR_HEIGHT - 1, getOledEvalBarHeight(5000));
+    TEST_ASSERT_EQUAL(1, getOledEvalBarHeight(-5000));
+    TEST_ASSERT_EQUAL(2, renderOledEvalBar(&renderer, -200, &mockOledWriteTiles, &oled));
+    TEST_ASSERT_FALSE(getMockOledPixel(&oled, x, OLED_EVAL_BAR_HEIGHT / 2));
+}
+
+void run_oled() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_oledFirstRender);
+    RUN_TEST(test_oledGlyphs);
+    RUN_TEST(test_oledOnlyChangedTiles);
+    RUN_TEST(test_oledFrame);
+    RUN_TEST(test_oledRefusedTiles);
+    RUN_TEST(test_oledEvalBar);
+
+    UNITY_END();
+}
@@ -0,0 +1,135 @@
+#include <chess.h>
+#include <power.h>
+#include <scheduler.h>
+#include <unity.h>
+
+// Virtual clock and sensors: the firmware loop is simulated around the scan policy
+static uint32_t s_now_us = 0;
+
+static uint32_t getVirtualTime() {
+    return s_now_us;
+}
+
+typedef struct {
+    uint32_t time_us;
+    uint64_t sensors;
+} SensorChange;
+
+typedef struct {
+    Scheduler scheduler;
+    ScanPolicy policy;
+    uint8_t scanTask;
+    const SensorChange* changes; // Mock sensor source, sorted by time
+    uint8_t changeCount;
+    uint32_t scans;
+    uint32_t lastChangeSeen_us; // First scan showing the last sensor change
+} Board;
+
+static uint64_t readMockSensors(const Board* p_board) {
+    uint64_t sensors = DEFAULT_SENSORS_STATE;
+    for (uint8_t i = 0; i < p_board->changeCount && (int32_t)(s_now_us - p_board->changes[i].time_us) >= 0; i++)
+        sensors = p_board->changes[i].sensors;
+    return sensors;
+}
+
+static void runScan(void* p_context, uint32_t p_now_us) {
+    Board* board           = static_cast<Board*>(p_context);
+    const uint64_t sensors = readMockSensors(board);
+    if (sensors != board->policy.sensors)
+        board->lastChangeSeen_us = p_now_us;
+    board->scans++;
+    setTaskPeriod(&board->scheduler, board->scanTask, updateScanPolicy(&board->policy, sensors, p_now_us));
+    s_now_us += 150; // Scan work
+}
+
+static void initializeBoard(Board* p_board, const SensorChange* p_changes, uint8_t p_count) {
+    s_now_us = 0;
+    initializeScheduler(&p_board->scheduler, &getVirtualTime);
+    initializeScanPolicy(&p_board->policy, DEFAULT_SENSORS_STATE, s_now_us);
+    p_board->scanTask          = addTask(&p_board->scheduler, &runScan, p_board, SCAN_ACTIVE_PERIOD_US, SCAN_ACTIVE_PERIOD_US);
+    p_board->changes           = p_changes;
+    p_board->changeCount       = p_count;
+    p_board->scans             = 0;
+    p_board->lastChangeSeen_us = 0;
+}
+
+// Loop of the firmware: run the scheduler, then sleep until the next interrupt (timer 0) once idle
+static void runBoard(Board* p_board, uint32_t p_end_us) {
+    while ((int32_t)(p_end_us - s_now_us) > 0) {
+        runScheduler(&p_board->scheduler);
+        const uint32_t idle_us = getSchedulerIdleTime(&p_board->scheduler);
+        if (p_board->policy.idle && idle_us > 1100) {
+            s_now_us += 1024;
+            addScanPolicySleep(&p_board->policy, 1024);
+        } else {
+            s_now_us += 10;
+        }
+    }
+}
+
+static void test_powerIdle() {
+    // Static board: full rate, then the low rate once the idle delay is over
+    Board board;
+    initializeBoard(&board, nullptr, 0);
+    runBoard(&board, SCAN_IDLE_DELAY_US - 100000);
+    TEST_ASSERT_FALSE(board.policy.idle);
+    TEST_ASSERT_INT_WITHIN(5, 500, board.policy.scansPerSecond);
+    TEST_ASSERT_EQUAL(0, board.policy.sleepPerSecond_us);
+
+    runBoard(&board, SCAN_IDLE_DELAY_US + 3000000);
+    TEST_ASSERT_TRUE(board.policy.idle);
+    TEST_ASSERT_EQUAL(1, board.policy.idleCount);
+    TEST_ASSERT_INT_WITHIN(1, 1000000 / SCAN_IDLE_PERIOD_US, board.policy.scansPerSecond);
+    TEST_ASSERT_GREATER_THAN(900000, board.policy.sleepPerSecond_us);
+    TEST_ASSERT_GREATER_THAN(2700, board.policy.totalSleep_ms);
+    TEST_ASSERT_EQUAL(0, board.scheduler.tasks[board.scanTask].skipped);
+}
+
+static void test_powerWakeOnChange() {
+    // First changed bit: seen within an idle period, then full rate until the board is static again
+    const uint32_t lift_us        = SCAN_IDLE_DELAY_US + 1234567;
+    const uint64_t lifted         = DEFAULT_SENSORS_STATE & ~(1uLL << 12);
+    const SensorChange changes[2] = {{lift_us, lifted}, {lift_us + 300000, lifted | (1uLL << 28)}};
+    Board board;
+    initializeBoard(&board, changes, 2);
+    runBoard(&board, lift_us);
+    TEST_ASSERT_TRUE(board.policy.idle);
+
+    runBoard(&board, lift_us + 100000);
+    TEST_ASSERT_FALSE(board.policy.idle);
+    TEST_ASSERT_LESS_OR_EQUAL(SCAN_IDLE_PERIOD_US + 1100, board.lastChangeSeen_us - lift_us);
+
+    // The placement is seen at full rate
+    runBoard(&board, lift_us + 400000);
+    TEST_ASSERT_LESS_OR_EQUAL(SCAN_ACTIVE_PERIOD_US + 200, board.lastChangeSeen_us - (lift_us + 300000));
+
+    runBoard(&board, lift_us + 300000 + SCAN_IDLE_DELAY_US + 100000);
+    TEST_ASSERT_TRUE(board.policy.idle);
+    TEST_ASSERT_EQUAL(2, board.policy.idleCount);
+}
+
+static void test_powerWakeOnButton() {
+    // Button press: the next scan comes one active period later instead of at the end of the idle period
+    Board board;
+    initializeBoard(&board, nullptr, 0);
+    runBoard(&board, SCAN_IDLE_DELAY_US + 500000);
+    TEST_ASSERT_TRUE(board.policy.idle);
+
+    const uint32_t press_us = s_now_us;
+    const uint32_t scans    = board.scans;
+    setTaskPeriod(&board.scheduler, board.scanTask, wakeScanPolicy(&board.policy, press_us));
+    TEST_ASSERT_FALSE(board.policy.idle);
+    TEST_ASSERT_LESS_OR_EQUAL(SCAN_ACTIVE_PERIOD_US, getSchedulerIdleTime(&board.scheduler));
+    runBoard(&board, press_us + 100000);
+    TEST_ASSERT_INT_WITHIN(2, 50, board.scans - scans);
+}
+
+void run_power() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_powerIdle);
+    RUN_TEST(test_powerWakeOnChange);
+    RUN_TEST(test_powerWakeOnButton);
+
+    UNITY_END();
+}
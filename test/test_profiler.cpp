@@ -0,0 +1,118 @@
+#include "mock_sensors.h"
+#include "utils.h"
+#include <chess.h>
+#include <profiler.h>
+#include <string.h>
+#include <unity.h>
+
+static void test_profilerBuckets() {
+    LatencyHistogram histogram;
+    initializeLatencyHistogram(&histogram);
+
+    recordLatency(&histogram, 0);
+    recordLatency(&histogram, 1);
+    recordLatency(&histogram, 3);
+    recordLatency(&histogram, 4);
+    recordLatency(&histogram, 0xFFFFFFFF);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[0]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[1]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[2]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[3]);
+    TEST_ASSERT_EQUAL(1, histogram.buckets[LATENCY_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL(5, histogram.count);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, histogram.max_us);
+}
+
+static void test_profilerPercentiles() {
+    LatencyHistogram histogram;
+    initializeLatencyHistogram(&histogram);
+    TEST_ASSERT_EQUAL(0, getLatencyPercentile(&histogram, 50));
+
+    // 90 fast samples, 10 slow ones
+    for (uint8_t i = 0; i < 90; i++)
+        recordLatency(&histogram, 100);
+    for (uint8_t i = 0; i < 10; i++)
+        recordLatency(&histogram, 5000);
+
+    TEST_ASSERT_EQUAL(127, getLatencyPercentile(&histogram, 50));
+    TEST_ASSERT_EQUAL(127, getLatencyPercentile(&histogram, 90));
+    TEST_ASSERT_EQUAL(8191, getLatencyPercentile(&histogram, 99));
+    TEST_ASSERT_EQUAL(8191, getLatencyPercentile(&histogram, 100));
+}
+
+static void test_profilerMoveLatency() {
+    resetProfiler();
+    MoveLatencyTracker tracker;
+    initializeMoveLatencyTracker(&tracker);
+    LatencyHistogram* moves = getStageHistogram(StageMove);
+
+    // Sensor bounce back to the stable board is forgotten
+    trackSensorEdges(&tracker, 0b01, 0b00, 0b00, 1000);
+    trackSensorEdges(&tracker, 0b00, 0b00, 0b00, 2000);
+
+    // Piece lands at 10 ms, stable board changes at 260 ms
+    trackSensorEdges(&tracker, 0b10, 0b00, 0b00, 10000);
+    trackSensorEdges(&tracker, 0b10, 0b00, 0b00, 12000);
+    trackSensorEdges(&tracker, 0b10, 0b00, 0b10, 260000);
+    markMoveCommitted(&tracker);
+
+    // Displays are up to date at 300 ms
+    TEST_ASSERT_TRUE(markMoveDisplayed(&tracker, 300000));
+    TEST_ASSERT_FALSE(markMoveDisplayed(&tracker, 400000));
+    TEST_ASSERT_EQUAL(1, moves->count);
+    TEST_ASSERT_EQUAL_UINT32(290000, moves->max_us);
+
+    // Without debouncing the change starts when it is seen
+    trackSensorEdges(&tracker, 0b11, 0b10, 0b11, 500000);
+    markMoveCommitted(&tracker);
+    TEST_ASSERT_TRUE(markMoveDisplayed(&tracker, 500100));
+    TEST_ASSERT_EQUAL(2, moves->count);
+    TEST_ASSERT_EQUAL(1, moves->buckets[7]);
+}
+
+static void test_profilerStages() {
+    resetProfiler();
+
+    // updateCheckState is timed on each committed move
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    EXEC(&game, "-e2 +e4 -e7 +e5", DEFAULT_SENSORS_STATE);
+    TEST_ASSERT_EQUAL(2, getStageHistogram(StageUpdateCheck)->count);
+
+    const uint32_t start_us = beginStage();
+    endStage(StageLcd, start_us);
+    TEST_ASSERT_EQUAL(1, getStageHistogram(StageLcd)->count);
+    TEST_ASSERT_NULL(getStageHistogram(StageCount));
+}
+
+static char s_dump[StageCount][256];
+static uint8_t s_dumpLines = 0;
+
+static void captureLine(const char* p_line) {
+    if (s_dumpLines < StageCount)
+        strncpy(s_dump[s_dumpLines], p_line, sizeof(s_dump[0]) - 1);
+    s_dumpLines++;
+}
+
+static void test_profilerDump() {
+    resetProfiler();
+    recordLatency(getStageHistogram(StageOled), 1500);
+
+    s_dumpLines = 0;
+    dumpProfiler(&captureLine);
+    TEST_ASSERT_EQUAL(StageCount, s_dumpLines);
+    TEST_ASSERT_EQUAL_STRING("read n=0 p50=0 p90=0 p99=0 max=0 | 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0", s_dump[StageReadBoard]);
+    TEST_ASSERT_EQUAL_STRING("oled n=1 p50=2047 p90=2047 p99=2047 max=1500 | 0 0 0 0 0 0 0 0 0 0 0 1 0 0 0 0 0 0 0 0 0 0", s_dump[StageOled]);
+}
+
+void run_profiler() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_profilerBuckets);
+    RUN_TEST(test_profilerPercentiles);
+    RUN_TEST(test_profilerMoveLatency);
+    RUN_TEST(test_profilerStages);
+    RUN_TEST(test_profilerDump);
+
+    UNITY_END();
+}
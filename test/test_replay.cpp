@@ -0,0 +1,81 @@
+#include "mock_sensors.h"
+#include "utils.h"
+#include <chess.h>
+#include <replay.h>
+#include <unity.h>
+
+static void test_replayCompile() {
+    uint8_t events[16];
+    uint32_t errorOffset = 0;
+
+    // Whitespace and comments produce no event, '_' is a step without change
+    TEST_ASSERT_EQUAL(4, compileSensorScript("-e2 +E4 # comment -a1\n _\t+h8", events, sizeof(events), &errorOffset));
+    TEST_ASSERT_EQUAL_HEX8(12, events[0]);
+    TEST_ASSERT_EQUAL_HEX8(REPLAY_EVENT_PLACED | 28, events[1]);
+    TEST_ASSERT_EQUAL_HEX8(REPLAY_EVENT_STEP, events[2]);
+    TEST_ASSERT_EQUAL_HEX8(REPLAY_EVENT_PLACED | 63, events[3]);
+    TEST_ASSERT_EQUAL(0, compileSensorScript("# only a comment", events, sizeof(events), &errorOffset));
+
+    // Invalid actions and overflows are reported
+    TEST_ASSERT_EQUAL_UINT32(REPLAY_INVALID, compileSensorScript("-e2 +i4", events, sizeof(events), &errorOffset));
+    TEST_ASSERT_EQUAL(4, errorOffset);
+    TEST_ASSERT_EQUAL_UINT32(REPLAY_INVALID, compileSensorScript("-e2 *e4", events, sizeof(events), &errorOffset));
+    TEST_ASSERT_EQUAL(4, errorOffset);
+    TEST_ASSERT_EQUAL_UINT32(REPLAY_INVALID, compileSensorScript("-e", events, sizeof(events), &errorOffset));
+    TEST_ASSERT_EQUAL_UINT32(REPLAY_INVALID, compileSensorScript("-e2 +e4 -e7", events, 2, &errorOffset));
+    TEST_ASSERT_EQUAL(8, errorOffset);
+}
+
+static void test_replayMatchesScripts() {
+    const char* scripts[] = {
+        "-e2 +e4 -e7 +e5 -f1 +c4 -b8 +c6 -d1 +h5 -g8 +f6 -f7 -h5 +f7",                                             // Checkmate
+        "-e2 +e4 -d7 +d5 -d5 -e4 +d5 -d5 -d8 +d5 -b1 +c3 -d5 +a5 -g1 +f3 -g8 +f6 -f1 +e2 -c8 +f5 -e1 +g1 -h1 +f1", // Castling
+        "-e2 +e4 -a7 +a6 -e4 +e5 -d7 +d5 -e5 +d6 -d5 -a8 +a7 -c7 -d6 +c7 -a7 +a8 -d8 -c7 +d8 -d8 -e8 +d8",         // En passant, promotion
+        "-e2 +e4 -e7 -e7 +e7 +e5 # lifted twice\n -g1 _ +f3",                                                      // Sensor noise
+    };
+
+    for (const char* script : scripts) {
+        Game expected;
+        initializeGame(&expected, DEFAULT_SENSORS_STATE);
+        const uint64_t expectedSensors = EXEC(&expected, script, DEFAULT_SENSORS_STATE);
+
+        uint8_t events[64];
+        const uint32_t count = compileSensorScript(script, events, sizeof(events), nullptr);
+        TEST_ASSERT_NOT_EQUAL(REPLAY_INVALID, count);
+
+        Game game;
+        initializeGame(&game, DEFAULT_SENSORS_STATE);
+        uint32_t checksums[64];
+        const ReplayResult result = replaySensorEvents(&game, DEFAULT_SENSORS_STATE, events, count, checksums);
+
+        TEST_ASSERT_EQUAL(count, result.events);
+        TEST_ASSERT_EQUAL_UINT64(expectedSensors, result.sensors);
+        TEST_ASSERT_EQUAL_HEX32(getGameChecksum(&expected), result.checksum);
+        TEST_ASSERT_EQUAL_HEX32(result.checksum, checksums[count - 1]);
+        TEST_ASSERT_EQUAL_MEMORY(expected.board, game.board, sizeof(game.board));
+    }
+}
+
+static void test_replayChecksum() {
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    const uint32_t initial = getGameChecksum(&game);
+
+    // Lifting a piece changes the state, putting it back restores it
+    uint8_t events[4];
+    const uint32_t count = compileSensorScript("-e2 +e2", events, sizeof(events), nullptr);
+    uint32_t checksums[4];
+    replaySensorEvents(&game, DEFAULT_SENSORS_STATE, events, count, checksums);
+    TEST_ASSERT_NOT_EQUAL(initial, checksums[0]);
+    TEST_ASSERT_EQUAL_HEX32(initial, checksums[1]);
+}
+
+void run_replay() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_replayCompile);
+    RUN_TEST(test_replayMatchesScripts);
+    RUN_TEST(test_replayChecksum);
+
+    UNITY_END();
+}
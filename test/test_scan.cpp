@@ -0,0 +1,116 @@
+#include <chess.h>
+#include <scan.h>
+#include <unity.h>
+
+// Wiring of an unknown board, for calibration
+static uint8_t s_shuffledLayout[64];
+
+struct BoardShuffled {
+    static constexpr uint8_t DataLines     = 4;
+    static constexpr uint8_t ClocksPerScan = 16;
+    static constexpr uint8_t getLine(uint8_t p_chain) { return 3 - p_chain; }
+    static const uint8_t* getLayout() { return s_shuffledLayout; }
+};
+
+// Scans through the mock shift registers give back the sensors, with the expected pin operations
+template <class Revision>
+static void checkScan() {
+    typedef MockShiftRegisters<Revision> Gpio;
+    uint8_t layout[64];
+    loadScanLayout(layout, Revision::getLayout());
+    TEST_ASSERT_TRUE(isScanLayoutValid(layout));
+
+    uint64_t sensors = 0x0123456789ABCDEFuLL;
+    for (uint16_t i = 0; i < 200; i++) {
+        sensors = sensors * 6364136223846793005uLL + 1442695040888963407uLL;
+        Gpio::reset(sensors);
+        TEST_ASSERT_EQUAL_HEX64(sensors, (scanBoard<Revision, Gpio>(layout)));
+        TEST_ASSERT_FALSE(Gpio::powered);
+        TEST_ASSERT_EQUAL(1, Gpio::loads);
+        TEST_ASSERT_EQUAL(Revision::ClocksPerScan, Gpio::clocks);
+        TEST_ASSERT_EQUAL(Revision::ClocksPerScan * Revision::DataLines, Gpio::reads);
+    }
+
+    Gpio::reset(DEFAULT_SENSORS_STATE);
+    TEST_ASSERT_EQUAL_HEX64(DEFAULT_SENSORS_STATE, (scanBoard<Revision, Gpio>(layout)));
+}
+
+static void test_scanRevisions() {
+    checkScan<BoardRevA>();
+    checkScan<BoardRevAJumped>();
+
+    // First clock of the first chain reads d4, jumped chains read revision A chains one after the other
+    typedef MockShiftRegisters<BoardRevAJumped> Gpio;
+    uint8_t raw[SCAN_RAW_BYTES];
+    Gpio::reset((1uLL << getSquareFromStr("d4")) | (1uLL << getSquareFromStr("h8")));
+    scanRawBoard<BoardRevAJumped, Gpio>(raw);
+    const uint8_t expected[SCAN_RAW_BYTES] = {0x01, 0, 0, 0, 0, 0, 0x01, 0};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, raw, SCAN_RAW_BYTES);
+}
+
+static void test_scanUnpowered() {
+    // Latching without power reads an empty board
+    typedef MockShiftRegisters<BoardRevA> Gpio;
+    Gpio::reset(DEFAULT_SENSORS_STATE);
+    Gpio::load();
+    TEST_ASSERT_EQUAL_HEX32(0, Gpio::registers[0] | Gpio::registers[1] | Gpio::registers[2] | Gpio::registers[3]);
+}
+
+static void test_scanCalibration() {
+    // Random wiring
+    for (uint8_t i = 0; i < 64; i++)
+        s_shuffledLayout[i] = i;
+    uint32_t seed = 99;
+    for (uint8_t i = 63; i > 0; i--) {
+        seed                  = seed * 1103515245u + 12345u;
+        const uint8_t j       = (seed >> 16) % (i + 1);
+        const uint8_t swapped = s_shuffledLayout[i];
+        s_shuffledLayout[i]   = s_shuffledLayout[j];
+        s_shuffledLayout[j]   = swapped;
+    }
+
+    typedef MockShiftRegisters<BoardShuffled> Gpio;
+    uint8_t raw[SCAN_RAW_BYTES];
+    Gpio::reset(0);
+    scanRawBoard<BoardShuffled, Gpio>(raw);
+    ScanCalibration calibration;
+    startScanCalibration(&calibration, raw);
+
+    // A piece moved from square to square, with mistakes along the way
+    for (uint8_t square = 0; square < 64; square++) {
+        Gpio::reset(1uLL << square);
+        scanRawBoard<BoardShuffled, Gpio>(raw);
+        TEST_ASSERT_EQUAL(63 == square, updateScanCalibration(&calibration, raw));
+
+        if (10 == square) {
+            // Two pieces at once, then the piece put back on a learnt square: nothing learnt
+            Gpio::reset(3uLL << 20);
+            scanRawBoard<BoardShuffled, Gpio>(raw);
+            TEST_ASSERT_FALSE(updateScanCalibration(&calibration, raw));
+            Gpio::reset(1uLL << 5);
+            scanRawBoard<BoardShuffled, Gpio>(raw);
+            TEST_ASSERT_FALSE(updateScanCalibration(&calibration, raw));
+            TEST_ASSERT_EQUAL(11, calibration.square);
+        }
+    }
+    TEST_ASSERT_TRUE(isScanLayoutValid(calibration.layout));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(s_shuffledLayout, calibration.layout, 64);
+
+    // The learnt layout reads the board
+    Gpio::reset(DEFAULT_SENSORS_STATE);
+    TEST_ASSERT_EQUAL_HEX64(DEFAULT_SENSORS_STATE, (scanBoard<BoardShuffled, Gpio>(calibration.layout)));
+
+    // Layouts using a raw bit twice are rejected
+    calibration.layout[1] = calibration.layout[0];
+    TEST_ASSERT_FALSE(isScanLayoutValid(calibration.layout));
+}
+
+void run_scan() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scanRevisions);
+    RUN_TEST(test_scanUnpowered);
+    RUN_TEST(test_scanCalibration);
+
+    UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <scheduler.h>
+#include <unity.h>
+
+// Virtual clock, advanced by tests and by simulated task work
+static uint32_t s_now_us = 0;
+
+static uint32_t getVirtualTime() {
+    return s_now_us;
+}
+
+typedef struct {
+    uint32_t work_us; // Time spent by each run
+    uint32_t runs;
+    uint32_t lastStart_us;
+} TestTask;
+
+static void runTestTask(void* p_context, uint32_t p_now_us) {
+    TestTask* task     = static_cast<TestTask*>(p_context);
+    task->lastStart_us = p_now_us;
+    task->runs++;
+    s_now_us += task->work_us;
+}
+
+// Run the scheduler every p_step_us until p_end_us
+static void runUntil(Scheduler* p_scheduler, uint32_t p_end_us, uint32_t p_step_us) {
+    while ((int32_t)(p_end_us - s_now_us) > 0) {
+        runScheduler(p_scheduler);
+        s_now_us += p_step_us;
+    }
+}
+
+static void test_schedulerRates() {
+    s_now_us = 0;
+    Scheduler scheduler;
+    initializeScheduler(&scheduler, &getVirtualTime);
+
+    // Board scan at 500 Hz, buttons at 50 Hz, displays at 15 Hz
+    TestTask scan    = {100, 0, 0};
+    TestTask buttons = {50, 0, 0};
+    TestTask display = {1000, 0, 0};
+    TEST_ASSERT_EQUAL(0, addTask(&scheduler, &runTestTask, &scan, 2000, 2000));
+    TEST_ASSERT_EQUAL(1, addTask(&scheduler, &runTestTask, &buttons, 20000, 20000));
+    TEST_ASSERT_EQUAL(2, addTask(&scheduler, &runTestTask, &display, 66666, 66666));
+
+    runUntil(&scheduler, 1000000, 10);
+    TEST_ASSERT_INT_WITHIN(1, 500, scan.runs);
+    TEST_ASSERT_INT_WITHIN(1, 50, buttons.runs);
+    TEST_ASSERT_INT_WITHIN(1, 15, display.runs);
+
+    // Plenty of idle time: no overrun, nothing skipped
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(0, scheduler.tasks[i].overruns);
+        TEST_ASSERT_EQUAL(0, scheduler.tasks[i].skipped);
+    }
+}
+
+static void test_schedulerTrigger() {
+    s_now_us = 0;
+    Scheduler scheduler;
+    initializeScheduler(&scheduler, &getVirtualTime);
+
+    TestTask game        = {200, 0, 0};
+    const uint8_t gameId = addTask(&scheduler, &runTestTask, &game, 0, 1000);
+
+    // Not released until triggered
+    runUntil(&scheduler, 10000, 100);
+    TEST_ASSERT_EQUAL(0, game.runs);
+
+    // Several triggers before the task runs only release it once
+    triggerTask(&scheduler, gameId);
+    triggerTask(&scheduler, gameId);
+    TEST_ASSERT_EQUAL(1, runScheduler(&scheduler));
+    TEST_ASSERT_EQUAL(0, runScheduler(&scheduler));
+    TEST_ASSERT_EQUAL(1, game.runs);
+
+    // Unknown tasks are ignored
+    triggerTask(&scheduler, SCHEDULER_NO_TASK);
+    TEST_ASSERT_EQUAL(0, runScheduler(&scheduler));
+}
+
+static void test_schedulerOverruns() {
+    s_now_us = 0;
+    Scheduler scheduler;
+    initializeScheduler(&scheduler, &getVirtualTime);
+
+    // The slow task delays the scan beyond its deadline
+    TestTask scan = {100, 0, 0};
+    TestTask slow = {9000, 0, 0};
+    addTask(&scheduler, &runTestTask, &scan, 2000, 1000);
+    addTask(&scheduler, &runTestTask, &slow, 20000, 20000);
+
+    runUntil(&scheduler, 100000, 10);
+    TEST_ASSERT_EQUAL(4, slow.runs);
+    TEST_ASSERT_EQUAL(0, scheduler.tasks[1].overruns);
+    TEST_ASSERT_GREATER_OR_EQUAL(4, scheduler.tasks[0].overruns);
+
+    // Whole periods missed are skipped instead of run back to back
+    TEST_ASSERT_GREATER_OR_EQUAL(4, scheduler.tasks[0].skipped);
+    TEST_ASSERT_LESS_THAN(50, scan.runs);
+    TEST_ASSERT_GREATER_THAN(40, scan.runs);
+}
+
+static void test_schedulerClockOverflow() {
+    s_now_us = 0xFFFFFFFF - 5000;
+    Scheduler scheduler;
+    initializeScheduler(&scheduler, &getVirtualTime);
+
+    TestTask scan = {100, 0, 0};
+    addTask(&scheduler, &runTestTask, &scan, 2000, 2000);
+    runUntil(&scheduler, 15000, 10);
+    TEST_ASSERT_INT_WITHIN(1, 10, scan.runs);
+    TEST_ASSERT_EQUAL(0, scheduler.tasks[0].overruns);
+}
+
+static void test_schedulerFull() {
+    s_now_us = 0;
+    Scheduler scheduler;
+    initializeScheduler(&scheduler, &getVirtualTime);
+
+    TestTask task = {0, 0, 0};
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++)
+        TEST_ASSERT_EQUAL(i, addTask(&scheduler, &runTestTask, &task, 1000, 1000));
+    TEST_ASSERT_EQUAL(SCHEDULER_NO_TASK, addTask(&scheduler, &runTestTask, &task, 1000, 1000));
+    TEST_ASSERT_EQUAL(SCHEDULER_NO_TASK, addTask(&scheduler, nullptr, &task, 1000, 1000));
+}
+
+static void test_schedulerPeriodChange() {
+    s_now_us = 0;
+    Scheduler scheduler;
+    initializeScheduler(&scheduler, &getVirtualTime);
+
+    TestTask scan        = {100, 0, 0};
+    TestTask game        = {100, 0, 0};
+    const uint8_t scanId = addTask(&scheduler, &runTestTask, &scan, 50000, 50000);
+    const uint8_t gameId = addTask(&scheduler, &runTestTask, &game, 0, 1000);
+    TEST_ASSERT_EQUAL(50000, getSchedulerIdleTime(&scheduler));
+
+    // A shorter period releases the task one new period from now
+    s_now_us = 10000;
+    setTaskPeriod(&scheduler, scanId, 2000);
+    TEST_ASSERT_EQUAL(2000, getSchedulerIdleTime(&scheduler));
+    TEST_ASSERT_EQUAL(2000, scheduler.tasks[scanId].deadline_us);
+    runUntil(&scheduler, 20000, 10);
+    TEST_ASSERT_EQUAL(4, scan.runs);
+
+    // A longer one keeps the pending release
+    setTaskPeriod(&scheduler, scanId, 50000);
+    TEST_ASSERT_LESS_OR_EQUAL(2000, getSchedulerIdleTime(&scheduler));
+    runUntil(&scheduler, 100000, 10);
+    TEST_ASSERT_EQUAL(6, scan.runs);
+    TEST_ASSERT_EQUAL(0, scheduler.tasks[scanId].skipped);
+
+    // Triggered tasks and released tasks leave no idle time, triggered tasks have no period to change
+    triggerTask(&scheduler, gameId);
+    TEST_ASSERT_EQUAL(0, getSchedulerIdleTime(&scheduler));
+    setTaskPeriod(&scheduler, gameId, 1000);
+    TEST_ASSERT_EQUAL(0, scheduler.tasks[gameId].period_us);
+    runScheduler(&scheduler);
+    s_now_us = scheduler.tasks[scanId].release_us;
+    TEST_ASSERT_EQUAL(0, getSchedulerIdleTime(&scheduler));
+}
+
+void run_scheduler() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_schedulerRates);
+    RUN_TEST(test_schedulerTrigger);
+    RUN_TEST(test_schedulerOverruns);
+    RUN_TEST(test_schedulerClockOverflow);
+    RUN_TEST(test_schedulerFull);
+    RUN_TEST(test_schedulerPeriodChange);
+
+    UNITY_END();
+}
@@ -0,0 +1,177 @@
+#include "mock_sensors.h"
+#include <chess.h>
+#include <eval.h>
+#include <movegen.h>
+#include <signature.h>
+#include <unity.h>
+
+#define SQUARE(p_name) (1uLL << getSquareFromStr(p_name))
+
+static void test_signatureQuickMove() {
+    // Lift and placement in the same scan
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    SignatureTable table;
+    TEST_ASSERT_EQUAL(20, buildSignatureTable(&table, &game));
+
+    uint64_t sensors = (DEFAULT_SENSORS_STATE & ~SQUARE("e2")) | SQUARE("e4");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WPawn, game.board[getSquareFromStr("e4")]);
+    TEST_ASSERT_EQUAL(getSquareFromStr("e3"), game.state.en_passant);
+    TEST_ASSERT_EQUAL(getSquareFromStr("e2"), game.lastMoveW.start);
+
+    // The table follows the game
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, table.status);
+    sensors = (sensors & ~SQUARE("g8")) | SQUARE("f6");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL(BKnight, game.board[getSquareFromStr("f6")]);
+
+    // Step by step moves still work
+    sensors &= ~SQUARE("d2");
+    TEST_ASSERT_FALSE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::Playing, game.state.status);
+    sensors |= SQUARE("d4");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL(WPawn, game.board[getSquareFromStr("d4")]);
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+}
+
+static void test_signatureCapture() {
+    // Both pieces lifted in the same scan: evolveGame alone only keeps one of them
+    Game game;
+    initializeFromFEN(&game, "k7/3r4/8/8/8/8/8/n2R3K w - - 0 1");
+    SignatureTable table;
+    resetSignatureTable(&table);
+    uint64_t sensors = extractSensorsState(&game) & ~SQUARE("d1") & ~SQUARE("d7");
+    TEST_ASSERT_FALSE(evolveGameWithSignatures(&table, &game, sensors));
+    sensors |= SQUARE("d7");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL_HEX8(bits::Black | bits::ToPlay, game.state.status);
+    TEST_ASSERT_EQUAL(WRook, game.board[getSquareFromStr("d7")]);
+    TEST_ASSERT_EQUAL(Empty, game.board[getSquareFromStr("d1")]);
+    TEST_ASSERT_EQUAL(BKnight, game.board[getSquareFromStr("a1")]);
+    TEST_ASSERT_TRUE(game.lastMoveW.captured);
+
+    // Lifting a piece that can capture looks like the capture: nothing is committed
+    initializeFromFEN(&game, "k7/3r4/8/8/8/8/8/n2R3K w - - 0 1");
+    resetSignatureTable(&table);
+    sensors = extractSensorsState(&game) & ~SQUARE("d1");
+    TEST_ASSERT_FALSE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::Playing, game.state.status);
+
+    // Then the captured piece chosen among both, lifted and placed in the same scan
+    sensors &= ~SQUARE("a1");
+    TEST_ASSERT_FALSE(evolveGameWithSignatures(&table, &game, sensors));
+    sensors |= SQUARE("a1");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL(WRook, game.board[getSquareFromStr("a1")]);
+    TEST_ASSERT_EQUAL(BRook, game.board[getSquareFromStr("d7")]);
+    TEST_ASSERT_EQUAL(Empty, game.board[getSquareFromStr("d1")]);
+
+    // A captured piece put back is forgotten
+    initializeFromFEN(&game, "k7/3r4/8/8/8/8/8/n2R3K w - - 0 1");
+    resetSignatureTable(&table);
+    sensors = extractSensorsState(&game) & ~SQUARE("d7");
+    evolveGameWithSignatures(&table, &game, sensors);
+    sensors |= SQUARE("d7");
+    evolveGameWithSignatures(&table, &game, sensors);
+    sensors &= ~SQUARE("d1");
+    TEST_ASSERT_FALSE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::Playing, game.state.status);
+}
+
+static void test_signatureSpecialMoves() {
+    // Castling in one scan
+    Game game;
+    SignatureTable table;
+    initializeFromFEN(&game, "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+    resetSignatureTable(&table);
+    uint64_t sensors = (extractSensorsState(&game) & ~SQUARE("e1") & ~SQUARE("h1")) | SQUARE("g1") | SQUARE("f1");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL(WKing, game.board[getSquareFromStr("g1")]);
+    TEST_ASSERT_EQUAL(WRook, game.board[getSquareFromStr("f1")]);
+    TEST_ASSERT_FALSE(game.state.castlingK[bits::White]);
+    TEST_ASSERT_FALSE(game.state.castlingQ[bits::White]);
+
+    // Queen side, from the lifted king
+    sensors &= ~SQUARE("e8");
+    TEST_ASSERT_FALSE(evolveGameWithSignatures(&table, &game, sensors));
+    sensors = (sensors & ~SQUARE("a8")) | SQUARE("c8") | SQUARE("d8");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL(BKing, game.board[getSquareFromStr("c8")]);
+    TEST_ASSERT_EQUAL(BRook, game.board[getSquareFromStr("d8")]);
+    TEST_ASSERT_EQUAL_HEX8(bits::White | bits::ToPlay, game.state.status);
+
+    // En passant in one scan
+    initializeFromFEN(&game, "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1");
+    resetSignatureTable(&table);
+    sensors = (extractSensorsState(&game) & ~SQUARE("e5") & ~SQUARE("d5")) | SQUARE("d6");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL(WPawn, game.board[getSquareFromStr("d6")]);
+    TEST_ASSERT_EQUAL(Empty, game.board[getSquareFromStr("d5")]);
+    TEST_ASSERT_TRUE(game.lastMoveW.captured);
+
+    // Promotion, giving check
+    initializeFromFEN(&game, "7k/P7/8/8/8/8/8/4K3 w - - 0 1");
+    resetSignatureTable(&table);
+    sensors = (extractSensorsState(&game) & ~SQUARE("a7")) | SQUARE("a8");
+    TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL(WQueen, game.board[getSquareFromStr("a8")]);
+    TEST_ASSERT_TRUE(game.lastMoveW.promotion);
+    TEST_ASSERT_TRUE(game.lastMoveW.check);
+
+    // Illegal moves are not in the table
+    initializeFromFEN(&game, "4k3/4r3/8/8/8/8/4B3/4K3 w - - 0 1");
+    resetSignatureTable(&table);
+    sensors = (extractSensorsState(&game) & ~SQUARE("e2")) | SQUARE("d3");
+    TEST_ASSERT_FALSE(evolveGameWithSignatures(&table, &game, sensors));
+    TEST_ASSERT_EQUAL(Empty, game.lastMoveW.piece);
+}
+
+static void test_signatureRandomGames() {
+    // Each move in at most two scans (both lifts of a capture, then the placement) gives the game playMove does
+    uint32_t seed = 4321;
+    for (uint8_t g = 0; g < 20; g++) {
+        Game game;
+        initializeGame(&game, DEFAULT_SENSORS_STATE);
+        SignatureTable table;
+        resetSignatureTable(&table);
+        uint64_t sensors = DEFAULT_SENSORS_STATE;
+
+        for (uint16_t ply = 0; ply < 200; ply++) {
+            Move moves[MOVEGEN_MAX_MOVES];
+            const uint8_t count = generateLegalMoves(&game, moves);
+            if (0 == count)
+                break;
+
+            seed            = seed * 1103515245u + 12345u;
+            const Move move = moves[(seed >> 16) % count];
+            Game played     = game;
+            playMove(&played, move);
+
+            const uint64_t expected = extractSensorsState(&played);
+            if (Empty != game.board[move.end])
+                TEST_ASSERT_FALSE(evolveGameWithSignatures(&table, &game, sensors & ~(1uLL << move.start) & ~(1uLL << move.end)));
+            TEST_ASSERT_TRUE(evolveGameWithSignatures(&table, &game, expected));
+            sensors = expected;
+
+            TEST_ASSERT_EQUAL_MEMORY(game.board, played.board, sizeof(game.board));
+            TEST_ASSERT_EQUAL_MEMORY(&game.state, &played.state, sizeof(game.state));
+            TEST_ASSERT_EQUAL(played.halfmoveClock, game.halfmoveClock);
+            TEST_ASSERT_EQUAL(played.evaluation.middlegame, game.evaluation.middlegame);
+            TEST_ASSERT_EQUAL(played.evaluation.endgame, game.evaluation.endgame);
+        }
+    }
+}
+
+void run_signature() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_signatureQuickMove);
+    RUN_TEST(test_signatureCapture);
+    RUN_TEST(test_signatureSpecialMoves);
+    RUN_TEST(test_signatureRandomGames);
+
+    UNITY_END();
+}
@@ -0,0 +1,223 @@
+#include "mock_display.h"
+#include "mock_oled.h"
+#include "mock_sensors.h"
+#include "utils.h"
+#include <chess.h>
+#include <oled.h>
+#include <string.h>
+#include <transfer.h>
+#include <unity.h>
+
+constexpr uint16_t TEST_QUEUE_SIZE = 128;
+constexpr uint16_t TEST_SLICE_US   = 500;
+constexpr uint16_t TEST_LOOP_US    = 2000; // Game loop work between slices
+
+static uint8_t s_lcdQueue[TEST_QUEUE_SIZE];
+static uint8_t s_i2cQueue[TEST_QUEUE_SIZE];
+
+static bool writeQueuedTiles(void* p_context, uint8_t p_x, uint8_t p_y, uint8_t p_count, const uint8_t* p_tiles) {
+    // Admission of writeOledTiles in the firmware
+    DisplayTransfers* transfers = static_cast<DisplayTransfers*>(p_context);
+    if (getTransferSpace(&transfers->i2c) < getOledTransferSize(p_count))
+        return false;
+    return queueMockOledTiles(transfers, p_x, p_y, p_count, p_tiles, nullptr);
+}
+
+static void test_transferRing() {
+    DisplayTransfers transfers;
+    initializeDisplayTransfers(&transfers, s_lcdQueue, TEST_QUEUE_SIZE, s_i2cQueue, TEST_QUEUE_SIZE);
+    TEST_ASSERT_EQUAL(0, getTransferCount(&transfers.lcd));
+    TEST_ASSERT_EQUAL(TEST_QUEUE_SIZE - 1, getTransferSpace(&transfers.lcd));
+
+    // Two nibbles per byte
+    TEST_ASSERT_TRUE(queueLcdSetCursor(&transfers, 0, 1));
+    TEST_ASSERT_TRUE(queueLcdString(&transfers, "abc"));
+    TEST_ASSERT_EQUAL(8, getTransferCount(&transfers.lcd));
+
+    // Whole string or nothing
+    char longString[64];
+    memset(longString, 'x', sizeof(longString) - 1);
+    longString[sizeof(longString) - 1] = 0;
+    TEST_ASSERT_FALSE(queueLcdString(&transfers, longString));
+    TEST_ASSERT_EQUAL(8, getTransferCount(&transfers.lcd));
+
+    // Wrap around the ring many times
+    initializeMockDisplayBus();
+    uint32_t now_us = 0;
+    char text[]     = "Move 0";
+    for (uint16_t i = 0; i < 100; i++) {
+        text[5] = '0' + i % 10;
+        TEST_ASSERT_TRUE(queueLcdSetCursor(&transfers, 0, 0));
+        TEST_ASSERT_TRUE(queueLcdString(&transfers, text));
+        while (getTransferCount(&transfers.lcd) > 0)
+            now_us += 1 + serviceTransferSlice(&transfers, now_us, TEST_SLICE_US, getMockDisplayBusWriters());
+    }
+    TEST_ASSERT_EQUAL_STRING_LEN("Move 9", getMockDisplayBus()->lcd[0], 6);
+    TEST_ASSERT_EQUAL_STRING_LEN("abc", getMockDisplayBus()->lcd[1], 3);
+}
+
+static void test_transferI2cFrames() {
+    DisplayTransfers transfers;
+    initializeDisplayTransfers(&transfers, s_lcdQueue, TEST_QUEUE_SIZE, s_i2cQueue, TEST_QUEUE_SIZE);
+
+    // Frames are only visible once ended
+    TEST_ASSERT_TRUE(beginI2cFrame(&transfers, MOCK_OLED_ADDRESS));
+    TEST_ASSERT_TRUE(queueI2cByte(&transfers, 0x40));
+    TEST_ASSERT_EQUAL(0, getTransferCount(&transfers.i2c));
+    TEST_ASSERT_TRUE(endI2cFrame(&transfers));
+    TEST_ASSERT_EQUAL(3, getTransferCount(&transfers.i2c));
+
+    // Frames longer than I2C_MAX_FRAME are dropped
+    TEST_ASSERT_TRUE(beginI2cFrame(&transfers, MOCK_OLED_ADDRESS));
+    for (uint8_t i = 0; i <= I2C_MAX_FRAME; i++)
+        queueI2cByte(&transfers, i);
+    TEST_ASSERT_FALSE(endI2cFrame(&transfers));
+    TEST_ASSERT_EQUAL(3, getTransferCount(&transfers.i2c));
+    TEST_ASSERT_EQUAL(TEST_QUEUE_SIZE - 1 - 3, getTransferSpace(&transfers.i2c));
+
+    // Frames that do not fit in the queue are dropped
+    uint8_t frames = 1;
+    while (beginI2cFrame(&transfers, MOCK_OLED_ADDRESS)) {
+        bool queued = true;
+        for (uint8_t i = 0; i < I2C_MAX_FRAME; i++)
+            queued &= queueI2cByte(&transfers, i);
+        if (endI2cFrame(&transfers))
+            frames++;
+        if (!queued)
+            break;
+    }
+    TEST_ASSERT_EQUAL(4, frames);
+    TEST_ASSERT_EQUAL(3 + 3 * (2 + I2C_MAX_FRAME), getTransferCount(&transfers.i2c));
+
+    // Aborted frames end with their stop condition, next frames are untouched
+    uint8_t byte = 0;
+    TEST_ASSERT_EQUAL(I2cStart, nextI2cAction(&transfers, &byte));
+    TEST_ASSERT_EQUAL(MOCK_OLED_ADDRESS, byte);
+    TEST_ASSERT_EQUAL(I2cWrite, nextI2cAction(&transfers, &byte));
+    TEST_ASSERT_EQUAL(0x40, byte);
+    TEST_ASSERT_EQUAL(I2cStop, nextI2cAction(&transfers, &byte));
+    for (uint8_t frame = 1; frame < frames; frame++) {
+        TEST_ASSERT_EQUAL(I2cStart, nextI2cAction(&transfers, &byte));
+        TEST_ASSERT_EQUAL(I2cWrite, nextI2cAction(&transfers, &byte));
+        abortI2cFrame(&transfers);
+        TEST_ASSERT_EQUAL(I2cStop, nextI2cAction(&transfers, &byte));
+    }
+    TEST_ASSERT_EQUAL(I2cIdle, nextI2cAction(&transfers, &byte));
+}
+
+static DisplayTransfers* s_waitTransfers = nullptr;
+static uint8_t s_waits                   = 0;
+static uint32_t s_wait_us                = 0;
+
+static void waitMockI2cSpace(uint8_t p_space) {
+    // As the firmware does before displays are admitted: the bus is serviced until there is space
+    s_waits++;
+    while (getTransferSpace(&s_waitTransfers->i2c) < p_space)
+        s_wait_us += 1 + serviceTransferSlice(s_waitTransfers, s_wait_us, TEST_SLICE_US, getMockDisplayBusWriters());
+}
+
+// Queue frames to another device until p_space is left
+static void fillI2cQueue(DisplayTransfers* p_transfers, uint8_t p_space) {
+    while (getTransferSpace(&p_transfers->i2c) > p_space) {
+        const uint8_t extra = getTransferSpace(&p_transfers->i2c) - p_space;
+        const uint8_t bytes = (extra <= 2 + I2C_MAX_FRAME) ? extra - 2 : ((extra - 5 < I2C_MAX_FRAME) ? extra - 5 : I2C_MAX_FRAME);
+        TEST_ASSERT_TRUE(beginI2cFrame(p_transfers, 0x10));
+        for (uint8_t i = 0; i < bytes; i++)
+            TEST_ASSERT_TRUE(queueI2cByte(p_transfers, i));
+        TEST_ASSERT_TRUE(endI2cFrame(p_transfers));
+    }
+}
+
+static void test_transferOledAdmission() {
+    // Tiles admitted with getOledTransferSize() go through the u8x8 byte procedure path without waiting for space
+    static DisplayTransfers transfers; // Serviced by waitMockI2cSpace
+    s_waitTransfers = &transfers;
+    uint8_t tiles[4 * OLED_TILE_SIZE];
+    for (uint8_t i = 0; i < sizeof(tiles); i++)
+        tiles[i] = 0x80 | i;
+
+    for (uint8_t count = 1; count <= 4; count++) {
+        const uint8_t size = getOledTransferSize(count);
+        for (uint8_t shortBy = 0; shortBy <= 1; shortBy++) {
+            initializeDisplayTransfers(&transfers, s_lcdQueue, TEST_QUEUE_SIZE, s_i2cQueue, TEST_QUEUE_SIZE);
+            initializeMockDisplayBus();
+            fillI2cQueue(&transfers, size - shortBy);
+            s_waits = 0;
+            TEST_ASSERT_TRUE(queueMockOledTiles(&transfers, 3, 1, count, tiles, &waitMockI2cSpace));
+            if (0 == shortBy) {
+                TEST_ASSERT_EQUAL(0, s_waits);
+                TEST_ASSERT_EQUAL(0, getTransferSpace(&transfers.i2c));
+            } else {
+                TEST_ASSERT_TRUE(s_waits > 0);
+            }
+
+            // Whole tiles received by the display
+            while (getTransferCount(&transfers.i2c) > 0)
+                s_wait_us += 1 + serviceTransferSlice(&transfers, s_wait_us, TEST_SLICE_US, getMockDisplayBusWriters());
+            TEST_ASSERT_EQUAL(0, getMockDisplayBus()->i2cErrors);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(tiles, &getMockDisplayBus()->oled[1][3 * OLED_TILE_SIZE], count * OLED_TILE_SIZE);
+        }
+    }
+}
+
+static void test_transferGameLoop() {
+    DisplayTransfers transfers;
+    initializeDisplayTransfers(&transfers, s_lcdQueue, TEST_QUEUE_SIZE, s_i2cQueue, TEST_QUEUE_SIZE);
+    initializeMockDisplayBus();
+
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    uint64_t sensorsState = DEFAULT_SENSORS_STATE;
+    OledRenderer renderer;
+    initializeOledRenderer(&renderer);
+
+    // Every loop: game update, displays update (queued only), then a bounded transfer slice
+    const char* actions = "-e2 +e4 -e7 +e5 -g1 +f3 -b8 +c6 -f1 +b5 -a7 +a6 -b5 +a4 -g8 +f6 -e1 +g1 -h1 +f1";
+    uint32_t now_us     = 0;
+    uint16_t loops      = 0;
+    bool lineQueued     = true;
+    while (*actions != 0 || getTransferCount(&transfers.lcd) > 0 || getTransferCount(&transfers.i2c) > 0 || !lineQueued) {
+        if (*actions != 0 && lineQueued) {
+            sensorsState = EXEC_ONE(&game, actions, sensorsState);
+            lineQueued   = false;
+        }
+        now_us += TEST_LOOP_US;
+
+        if (!lineQueued && queueLcdSetCursor(&transfers, 0, 1))
+            lineQueued = queueLcdString(&transfers, getStatusStr(game.state.status));
+        renderOledBoard(&renderer, &game, &writeQueuedTiles, &transfers);
+
+        const uint16_t spent = serviceTransferSlice(&transfers, now_us, TEST_SLICE_US, getMockDisplayBusWriters());
+        TEST_ASSERT_LESS_OR_EQUAL(TEST_SLICE_US, spent);
+        now_us += spent;
+        loops++;
+    }
+    renderOledBoard(&renderer, &game, &writeQueuedTiles, &transfers);
+    while (getTransferCount(&transfers.i2c) > 0)
+        serviceTransferSlice(&transfers, now_us, TEST_SLICE_US, getMockDisplayBusWriters());
+
+    // Displays end up with the final game state
+    MockDisplayBus* bus = getMockDisplayBus();
+    TEST_ASSERT_EQUAL(0, bus->i2cErrors);
+    const char* status = getStatusStr(game.state.status);
+    TEST_ASSERT_EQUAL_STRING_LEN(status, bus->lcd[1], strlen(status));
+
+    MockOled reference;
+    initializeMockOled(&reference);
+    OledRenderer referenceRenderer;
+    initializeOledRenderer(&referenceRenderer);
+    renderOledBoard(&referenceRenderer, &game, &mockOledWriteTiles, &reference);
+    TEST_ASSERT_EQUAL(0, memcmp(reference.framebuffer, bus->oled, sizeof(bus->oled)));
+    TEST_ASSERT_GREATER_THAN(20, loops);
+}
+
+void run_transfer() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_transferRing);
+    RUN_TEST(test_transferI2cFrames);
+    RUN_TEST(test_transferOledAdmission);
+    RUN_TEST(test_transferGameLoop);
+
+    UNITY_END();
+}
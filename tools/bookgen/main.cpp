@@ -0,0 +1,407 @@
+// Generate the opening book from PGN files with ECO and Opening (optional Variation) tags, from the project root:
+//   pio run -e bookgen && .pio/build/bookgen/program [options] <pgn...>
+// The position reached by the moves of each game gets the opening of the game. Moves are played through
+// evolveGame with the sensor sequences of a real board, so that keys match the positions of the firmware.
+// Options:
+//   --header <path>   write the built-in book (C header, PROGMEM table)
+//   --out <path>      write the book as a binary file (native lookups map it)
+//   --plies <n>       moves read per game (default: 40)
+//   --block <shift>   2^shift entries per search block (default: 3)
+//   --budget <bytes>  fail if the book is larger (default: BOOK_FLASH_BUDGET with --header)
+// The built-in book is regenerated with:
+//   .pio/build/bookgen/program --header lib/Book/src/book_data.h tools/bookgen/eco.pgn
+
+#include <algorithm>
+#include <book.h>
+#include <chess.h>
+#include <map>
+#include <movegen.h>
+#include <replay.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+typedef struct {
+    uint16_t eco;
+    std::string name;
+} Opening;
+
+typedef struct {
+    uint16_t opening;
+    std::string board; // Position written as FEN, to detect key collisions
+} Position;
+
+typedef struct {
+    std::string eco;
+    std::string opening;
+    std::string variation;
+    std::vector<std::string> moves;
+    uint32_t line;
+} PgnGame;
+
+typedef struct {
+    std::vector<Opening> openings;
+    std::map<std::string, uint16_t> openingIds;
+    std::map<uint32_t, Position> positions;
+    uint32_t games;
+    uint32_t skipped;
+    uint32_t transpositions;
+    uint32_t collisions;
+    uint16_t plies;
+} BookBuilder;
+
+//-----------------------------------------------------------------------------
+static bool parseEco(const std::string& p_eco, uint16_t* p_value)
+//-----------------------------------------------------------------------------
+{
+    if (p_eco.size() != 3 || p_eco[0] < 'A' || p_eco[0] > 'E' || !isdigit((unsigned char)p_eco[1]) || !isdigit((unsigned char)p_eco[2]))
+        return false;
+    *p_value = (p_eco[0] - 'A') * 100 + (p_eco[1] - '0') * 10 + (p_eco[2] - '0');
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static bool findSanMove(Game* p_game, const std::string& p_san, Move* p_move)
+//-----------------------------------------------------------------------------
+{
+    std::string san = p_san;
+    while (!san.empty() && strchr("+#!?", san.back()))
+        san.pop_back();
+
+    Move moves[MOVEGEN_MAX_MOVES];
+    const uint8_t count = generateLegalMoves(p_game, moves);
+
+    if (san == "O-O" || san == "O-O-O" || san == "0-0" || san == "0-0-0") {
+        const bool kingSide = (san.size() == 3);
+        for (uint8_t i = 0; i < count; i++) {
+            if (isKing(moves[i].piece) && moves[i].end == (kingSide ? moves[i].start + 2 : moves[i].start - 2)) {
+                *p_move = moves[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Promotions: the board only promotes to queens
+    const size_t promotion = san.find('=');
+    if (std::string::npos != promotion) {
+        if (san.substr(promotion) != "=Q")
+            return false;
+        san.resize(promotion);
+    }
+
+    uint8_t type = bits::Pawn;
+    size_t start = 0;
+    if (!san.empty() && strchr("NBRQK", san[0])) {
+        const char* types       = "NBRQK";
+        const uint8_t values[5] = {bits::Knight, bits::Bishop, bits::Rook, bits::Queen, bits::King};
+        type                    = values[strchr(types, san[0]) - types];
+        start                   = 1;
+    }
+    if (san.size() < start + 2)
+        return false;
+
+    const uint8_t target = getSquareFromStr(san.c_str() + san.size() - 2);
+    int8_t fromFile      = -1;
+    int8_t fromRank      = -1;
+    for (size_t i = start; i < san.size() - 2; i++) {
+        if (san[i] >= 'a' && san[i] <= 'h')
+            fromFile = san[i] - 'a';
+        else if (san[i] >= '1' && san[i] <= '8')
+            fromRank = san[i] - '1';
+        else if (san[i] != 'x')
+            return false;
+    }
+
+    uint8_t found = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const Move& move = moves[i];
+        if ((move.piece & bits::TypeMask) != type || move.end != target)
+            continue;
+        if ((fromFile >= 0 && move.start % 8 != fromFile) || (fromRank >= 0 && move.start / 8 != fromRank))
+            continue;
+        if (move.promotion != (std::string::npos != promotion))
+            continue;
+        *p_move = move;
+        found++;
+    }
+    return 1 == found;
+}
+
+//-----------------------------------------------------------------------------
+static void addGame(BookBuilder* p_builder, const PgnGame& p_pgn, const char* p_path)
+//-----------------------------------------------------------------------------
+{
+    if (p_pgn.moves.empty() && p_pgn.eco.empty())
+        return;
+
+    p_builder->games++;
+    uint16_t eco = 0;
+    if (!parseEco(p_pgn.eco, &eco) || p_pgn.opening.empty()) {
+        printf("%s:%u: missing ECO or Opening tag, game skipped\n", p_path, p_pgn.line);
+        p_builder->skipped++;
+        return;
+    }
+
+    Game game;
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+    uint64_t sensors = DEFAULT_SENSORS_STATE;
+    for (size_t i = 0; i < p_pgn.moves.size() && i < p_builder->plies; i++) {
+        Move move;
+        if (!findSanMove(&game, p_pgn.moves[i], &move)) {
+            printf("%s:%u: unsupported or illegal move %s, game skipped\n", p_path, p_pgn.line, p_pgn.moves[i].c_str());
+            p_builder->skipped++;
+            return;
+        }
+
+        uint8_t events[REPLAY_MAX_MOVE_EVENTS];
+        const uint8_t eventCount = getMoveSensorEvents(&game, move, false, events);
+        sensors                  = replaySensorEvents(&game, sensors, events, eventCount, nullptr).sensors;
+    }
+
+    std::string name = p_pgn.opening;
+    if (!p_pgn.variation.empty())
+        name += ": " + p_pgn.variation;
+    if (name.size() > BOOK_MAX_NAME_LENGTH)
+        name.resize(BOOK_MAX_NAME_LENGTH);
+
+    const std::string openingKey = p_pgn.eco + name;
+    auto opening                 = p_builder->openingIds.find(openingKey);
+    if (p_builder->openingIds.end() == opening) {
+        opening = p_builder->openingIds.emplace(openingKey, (uint16_t)p_builder->openings.size()).first;
+        p_builder->openings.push_back({eco, name});
+    }
+
+    // Board, player and castling rights
+    char fen[96];
+    writeToFEN(&game, fen);
+    std::string board = fen;
+    board.resize(board.find(' ', board.find(' ', board.find(' ') + 1) + 1));
+
+    const uint32_t key = getPositionKey(&game);
+    auto position      = p_builder->positions.find(key);
+    if (p_builder->positions.end() == position) {
+        p_builder->positions.emplace(key, Position{opening->second, board});
+    } else if (position->second.board != board) {
+        printf("%s:%u: key %08x collides with another position\n", p_path, p_pgn.line, key);
+        p_builder->collisions++;
+    } else {
+        p_builder->transpositions++; // First opening reaching the position is kept
+    }
+}
+
+//-----------------------------------------------------------------------------
+static bool readPgn(BookBuilder* p_builder, const char* p_path)
+//-----------------------------------------------------------------------------
+{
+    FILE* file = fopen(p_path, "r");
+    if (nullptr == file) {
+        printf("Unable to open %s\n", p_path);
+        return false;
+    }
+
+    PgnGame game;
+    game.line     = 1;
+    bool inMoves  = false;
+    int comment   = 0; // Inside {} comments
+    int variation = 0; // Inside () variations
+    uint32_t line = 0;
+    char text[4096];
+
+    while (nullptr != fgets(text, sizeof(text), file)) {
+        line++;
+        if (0 == comment && (text[0] == ';' || text[0] == '%'))
+            continue;
+
+        if (0 == comment && text[0] == '[') {
+            if (inMoves) {
+                // Tags of the next game
+                addGame(p_builder, game, p_path);
+                game    = PgnGame();
+                inMoves = false;
+            }
+            if (game.eco.empty() && game.opening.empty() && game.variation.empty())
+                game.line = line;
+
+            char tag[64];
+            char value[256];
+            if (2 == sscanf(text, "[%63s \"%255[^\"]\"]", tag, value)) {
+                if (0 == strcmp(tag, "ECO"))
+                    game.eco = value;
+                else if (0 == strcmp(tag, "Opening"))
+                    game.opening = value;
+                else if (0 == strcmp(tag, "Variation"))
+                    game.variation = value;
+            }
+            continue;
+        }
+
+        // Movetext
+        for (char* token = strtok(text, " \t\r\n"); nullptr != token; token = strtok(nullptr, " \t\r\n")) {
+            std::string word = token;
+            while (!word.empty()) {
+                if (comment > 0) {
+                    const size_t end = word.find('}');
+                    if (std::string::npos == end)
+                        break;
+                    comment--;
+                    word.erase(0, end + 1);
+                } else if (word[0] == '{') {
+                    comment++;
+                    word.erase(0, 1);
+                } else if (word[0] == '(') {
+                    variation++;
+                    word.erase(0, 1);
+                } else if (word[0] == ')') {
+                    variation = std::max(0, variation - 1);
+                    word.erase(0, 1);
+                } else if (word[0] == ';') {
+                    word.clear();
+                    token = nullptr;
+                    break;
+                } else {
+                    const size_t end = word.find_first_of("{()");
+                    std::string move = word.substr(0, end);
+                    word.erase(0, (std::string::npos == end) ? word.size() : end);
+
+                    // Move numbers, annotations and results
+                    const size_t digits = move.find_first_not_of("0123456789");
+                    if (digits != std::string::npos && digits > 0 && move[digits] == '.')
+                        move.erase(0, move.find_first_not_of('.', digits));
+                    else if (std::string::npos == digits)
+                        move.clear();
+                    if (move.empty() || move[0] == '$' || variation > 0)
+                        continue;
+
+                    inMoves = true;
+                    if (move == "1-0" || move == "0-1" || move == "1/2-1/2" || move == "*") {
+                        addGame(p_builder, game, p_path);
+                        game      = PgnGame();
+                        game.line = line + 1;
+                        inMoves   = false;
+                        continue;
+                    }
+                    game.moves.push_back(move);
+                }
+            }
+            if (nullptr == token)
+                break;
+        }
+    }
+    addGame(p_builder, game, p_path);
+    fclose(file);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static bool writeHeader(const char* p_path, const std::vector<uint8_t>& p_blob, const BookBuilder* p_builder, const char* p_sources)
+//-----------------------------------------------------------------------------
+{
+    FILE* file = fopen(p_path, "w");
+    if (nullptr == file) {
+        printf("Unable to write %s\n", p_path);
+        return false;
+    }
+
+    fprintf(file, "// Generated by tools/bookgen from %s, do not edit\n", p_sources);
+    fprintf(file, "// %zu positions, %zu openings, %zu bytes\n", p_builder->positions.size(), p_builder->openings.size(), p_blob.size());
+    fprintf(file, "#pragma once\n\n#include <stdint.h>\n\nstatic const uint8_t s_builtinBook[] PROGMEM = {");
+    for (size_t i = 0; i < p_blob.size(); i++)
+        fprintf(file, "%s0x%02X,", (0 == i % 16) ? "\n    " : " ", p_blob[i]);
+    fprintf(file, "\n};\n");
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* headerPath = nullptr;
+    const char* outPath    = nullptr;
+    uint8_t blockShift     = 3;
+    long budget            = -1;
+    BookBuilder builder    = {};
+    builder.plies          = 40;
+    std::vector<const char*> pgns;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1 < argc);
+        if (0 == strcmp(argv[i], "--header") && hasValue) {
+            headerPath = argv[++i];
+        } else if (0 == strcmp(argv[i], "--out") && hasValue) {
+            outPath = argv[++i];
+        } else if (0 == strcmp(argv[i], "--plies") && hasValue) {
+            builder.plies = (uint16_t)std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--block") && hasValue) {
+            blockShift = (uint8_t)std::min(15, std::max(0, atoi(argv[++i])));
+        } else if (0 == strcmp(argv[i], "--budget") && hasValue) {
+            budget = atol(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            printf("Unknown option %s\n", argv[i]);
+            return 2;
+        } else {
+            pgns.push_back(argv[i]);
+        }
+    }
+
+    if (pgns.empty()) {
+        printf("No PGN to read\n");
+        return 2;
+    }
+    if (budget < 0 && nullptr != headerPath)
+        budget = BOOK_FLASH_BUDGET;
+
+    std::string sources;
+    for (const char* pgn : pgns) {
+        if (!readPgn(&builder, pgn))
+            return 2;
+        sources += (sources.empty() ? "" : " ") + std::string(pgn);
+    }
+
+    if (builder.positions.size() > 0xFFFF || builder.openings.size() > 0xFFFF) {
+        printf("Too many positions or openings for a book\n");
+        return 1;
+    }
+
+    std::vector<BookEntry> entries;
+    for (const auto& position : builder.positions)
+        entries.push_back({position.first, position.second.opening});
+    std::vector<uint16_t> ecos;
+    std::vector<const char*> names;
+    for (const Opening& opening : builder.openings) {
+        ecos.push_back(opening.eco);
+        names.push_back(opening.name.c_str());
+    }
+
+    std::vector<uint8_t> blob(BOOK_HEADER_SIZE + entries.size() * 16 + builder.openings.size() * (BOOK_OPENING_SIZE + BOOK_MAX_NAME_LENGTH + 1));
+    const uint32_t size = encodeOpeningBook(entries.data(), (uint16_t)entries.size(), ecos.data(), names.data(), (uint16_t)names.size(), blockShift,
+                                            blob.data(), (uint32_t)blob.size());
+    if (0 == size) {
+        printf("Book does not fit the format (64 KB sections)\n");
+        return 1;
+    }
+    blob.resize(size);
+
+    printf("%u games (%u skipped), %zu positions (%u transpositions), %zu openings: %u bytes\n", builder.games, builder.skipped,
+           builder.positions.size(), builder.transpositions, builder.openings.size(), size);
+    if (builder.collisions > 0) {
+        printf("%u key collisions\n", builder.collisions);
+        return 1;
+    }
+    if (budget >= 0 && size > (uint32_t)budget) {
+        printf("Book is over its budget of %ld bytes\n", budget);
+        return 1;
+    }
+
+    if (nullptr != headerPath && !writeHeader(headerPath, blob, &builder, sources.c_str()))
+        return 2;
+    if (nullptr != outPath) {
+        FILE* file = fopen(outPath, "wb");
+        if (nullptr == file || size != fwrite(blob.data(), 1, size, file)) {
+            printf("Unable to write %s\n", outPath);
+            return 2;
+        }
+        fclose(file);
+    }
+    return 0;
+}
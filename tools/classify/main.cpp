@@ -0,0 +1,248 @@
+// Classify every position of a FEN or EPD corpus, from the project root:
+//   pio run -e classify && .pio/build/classify/program [options] <corpus>
+// Each line gets one byte in the sidecar file, in corpus order: see EClass.
+// EPD lines (4 fields followed by operations) are read with halfmove and fullmove clocks 0 and 1.
+// Options:
+//   --out <path>     sidecar file (default: <corpus>.cls)
+//   --threads <n>    threads (default: hardware concurrency)
+//   --cross-check    compare isCheck() and isCheckmate() with the legal move count, exits with 1 on disagreement
+//   --report <n>     disagreements printed (default: 20)
+
+#include <algorithm>
+#include <atomic>
+#include <chess.h>
+#include <chrono>
+#include <movegen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// Sidecar file: magic, line count (little endian), one EClass per line
+static const char SIDECAR_MAGIC[4] = {'C', 'C', 'L', 'S'};
+
+// Lines read and classified at once
+constexpr size_t BATCH_LINES = 1 << 16;
+constexpr size_t SHARD_LINES = 256;
+constexpr size_t MAX_LINE    = 256;
+
+typedef enum {
+    ClassInvalid = 0, // Not a FEN/EPD line
+    ClassIllegal,
+    ClassNormal,
+    ClassCheck,
+    ClassCheckmate,
+    ClassStalemate,
+    ClassCount,
+} EClass;
+
+static const char* s_classNames[ClassCount] = {"invalid", "illegal", "legal", "check", "checkmate", "stalemate"};
+
+typedef struct {
+    uint64_t line;
+    EClass expected;
+    bool isCheck;
+    bool isCheckmate;
+} Disagreement;
+
+typedef struct {
+    uint64_t counts[ClassCount];
+    std::vector<Disagreement> disagreements;
+} ClassifyStats;
+
+//-----------------------------------------------------------------------------
+static bool toFEN(const char* p_line, char* p_fen)
+//-----------------------------------------------------------------------------
+{
+    // Board, player, castling, en passant, then clocks if they are numbers
+    const char* fields[6];
+    size_t lengths[6];
+    uint8_t count   = 0;
+    const char* ptr = p_line;
+    while (count < 6) {
+        while (*ptr == ' ' || *ptr == '\t')
+            ptr++;
+        if (*ptr == 0 || *ptr == '\r' || *ptr == '\n')
+            break;
+        fields[count] = ptr;
+        while (*ptr != 0 && *ptr != ' ' && *ptr != '\t' && *ptr != '\r' && *ptr != '\n')
+            ptr++;
+        lengths[count] = ptr - fields[count];
+        count++;
+    }
+    if (count < 4)
+        return false;
+
+    const bool clocks = (6 == count) && (strspn(fields[4], "0123456789") == lengths[4]) && (strspn(fields[5], "0123456789") == lengths[5]);
+    const int written = snprintf(p_fen, MAX_LINE, "%.*s %.*s %.*s %.*s %.*s %.*s", (int)lengths[0], fields[0], (int)lengths[1], fields[1],
+                                 (int)lengths[2], fields[2], (int)lengths[3], fields[3], clocks ? (int)lengths[4] : 1, clocks ? fields[4] : "0",
+                                 clocks ? (int)lengths[5] : 1, clocks ? fields[5] : "1");
+    return written > 0 && written < (int)MAX_LINE;
+}
+
+//-----------------------------------------------------------------------------
+static EClass classifyLine(const char* p_line, uint64_t p_lineNumber, bool p_crossCheck, ClassifyStats* p_stats)
+//-----------------------------------------------------------------------------
+{
+    char fen[MAX_LINE];
+    Game game;
+    if (!toFEN(p_line, fen) || !initializeFromFEN(&game, fen))
+        return ClassInvalid;
+
+    EClass result;
+    switch (classifyPosition(&game)) {
+    case PositionNormal:
+        result = ClassNormal;
+        break;
+    case PositionCheck:
+        result = ClassCheck;
+        break;
+    case PositionCheckmate:
+        result = ClassCheckmate;
+        break;
+    case PositionStalemate:
+        result = ClassStalemate;
+        break;
+    default:
+        return ClassIllegal;
+    }
+
+    if (p_crossCheck) {
+        const bool check     = isCheck(&game);
+        const bool checkmate = isCheckmate(&game);
+        if (check != (ClassCheck == result || ClassCheckmate == result) || checkmate != (ClassCheckmate == result))
+            p_stats->disagreements.push_back({p_lineNumber, result, check, checkmate});
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    uint32_t threads       = std::max(1u, std::thread::hardware_concurrency());
+    bool crossCheck        = false;
+    uint32_t report        = 20;
+    const char* corpusPath = nullptr;
+    const char* outPath    = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1 < argc);
+        if (0 == strcmp(argv[i], "--out") && hasValue) {
+            outPath = argv[++i];
+        } else if (0 == strcmp(argv[i], "--threads") && hasValue) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--cross-check")) {
+            crossCheck = true;
+        } else if (0 == strcmp(argv[i], "--report") && hasValue) {
+            report = (uint32_t)std::max(0, atoi(argv[++i]));
+        } else if (argv[i][0] == '-' || nullptr != corpusPath) {
+            printf("Unexpected argument %s\n", argv[i]);
+            return 2;
+        } else {
+            corpusPath = argv[i];
+        }
+    }
+
+    if (nullptr == corpusPath) {
+        printf("No corpus to classify\n");
+        return 2;
+    }
+
+    FILE* corpus = fopen(corpusPath, "r");
+    if (nullptr == corpus) {
+        printf("Unable to open %s\n", corpusPath);
+        return 2;
+    }
+
+    std::vector<char> defaultOut;
+    if (nullptr == outPath) {
+        defaultOut.resize(strlen(corpusPath) + 5);
+        snprintf(defaultOut.data(), defaultOut.size(), "%s.cls", corpusPath);
+        outPath = defaultOut.data();
+    }
+    FILE* out = fopen(outPath, "wb");
+    if (nullptr == out) {
+        printf("Unable to write %s\n", outPath);
+        fclose(corpus);
+        return 2;
+    }
+    const uint8_t header[8] = {0};
+    fwrite(header, 1, sizeof(header), out); // Written again with the line count at the end
+
+    // Lines are read by batches and classified by shards taken in turn by the threads
+    std::vector<char> lines(BATCH_LINES * MAX_LINE);
+    std::vector<uint8_t> classes(BATCH_LINES);
+    std::vector<ClassifyStats> stats(threads);
+    uint64_t total   = 0;
+    double elapsed_s = 0;
+
+    while (true) {
+        size_t count = 0;
+        while (count < BATCH_LINES && nullptr != fgets(&lines[count * MAX_LINE], MAX_LINE, corpus)) {
+            char* line = &lines[count * MAX_LINE];
+            if (nullptr == strchr(line, '\n') && !feof(corpus)) {
+                // Too long for a position: skip the rest of it
+                int c;
+                while ((c = fgetc(corpus)) != EOF && c != '\n') {
+                }
+                line[0] = 0;
+            }
+            count++;
+        }
+        if (0 == count)
+            break;
+
+        const auto start = std::chrono::steady_clock::now();
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> workers;
+        for (uint32_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for (size_t shard = next++; shard * SHARD_LINES < count; shard = next++) {
+                    const size_t end = std::min(count, (shard + 1) * SHARD_LINES);
+                    for (size_t i = shard * SHARD_LINES; i < end; i++) {
+                        const EClass result = classifyLine(&lines[i * MAX_LINE], total + i + 1, crossCheck, &stats[t]);
+                        classes[i]          = (uint8_t)result;
+                        stats[t].counts[result]++;
+                    }
+                }
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+        elapsed_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        fwrite(classes.data(), 1, count, out);
+        total += count;
+    }
+    fclose(corpus);
+
+    const uint8_t countBytes[4] = {(uint8_t)total, (uint8_t)(total >> 8), (uint8_t)(total >> 16), (uint8_t)(total >> 24)};
+    fseek(out, 0, SEEK_SET);
+    fwrite(SIDECAR_MAGIC, 1, sizeof(SIDECAR_MAGIC), out);
+    fwrite(countBytes, 1, sizeof(countBytes), out);
+    fclose(out);
+
+    uint64_t counts[ClassCount] = {0};
+    std::vector<Disagreement> disagreements;
+    for (ClassifyStats& s : stats) {
+        for (uint8_t i = 0; i < ClassCount; i++)
+            counts[i] += s.counts[i];
+        disagreements.insert(disagreements.end(), s.disagreements.begin(), s.disagreements.end());
+    }
+
+    printf("%llu positions in %.3f s: %.0f positions/s (%u threads), classes in %s\n", (unsigned long long)total, elapsed_s,
+           elapsed_s > 0 ? total / elapsed_s : 0.0, threads, outPath);
+    for (uint8_t i = 0; i < ClassCount; i++)
+        printf("  %-10s %llu\n", s_classNames[i], (unsigned long long)counts[i]);
+
+    if (!crossCheck)
+        return 0;
+
+    std::sort(disagreements.begin(), disagreements.end(), [](const Disagreement& a, const Disagreement& b) { return a.line < b.line; });
+    for (size_t i = 0; i < std::min<size_t>(report, disagreements.size()); i++) {
+        const Disagreement& d = disagreements[i];
+        printf("DISAGREE line %llu: legal moves say %s, isCheck %d, isCheckmate %d\n", (unsigned long long)d.line, s_classNames[d.expected],
+               d.isCheck, d.isCheckmate);
+    }
+    printf("%zu disagreements\n", disagreements.size());
+    return disagreements.empty() ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// Analyze positions reported by boards (writeToFEN), from the project root:
+//   pio run -e engine && .pio/build/engine/program [options] [FEN...]
+// Without FEN arguments, one FEN per line is read from stdin. For each position prints:
+//   bestmove <move> score <cp|mate n> depth <d> nodes <n> nps <n> time <ms>
+// Options:
+//   --threads <n>   search threads (default: hardware concurrency)
+//   --hash <MB>     transposition table size (default: 64)
+//   --time <ms>     time per position (default: 1000 without other limit)
+//   --nodes <n>     nodes per position
+//   --depth <d>     depth per position
+//   --bench         nodes per second on fixed positions and depth (default: 5)
+//   --scaling       time to depth and nodes per second for 1, 2, 4... threads up to --threads
+//   --static        static evaluation only (white point of view), for bulk scoring: eval <cp>
+
+#include <algorithm>
+#include <chess.h>
+#include <engine.h>
+#include <eval.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+static const char* s_benchPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "6k1/5ppp/8/3P4/8/5K2/5PPP/8 w - - 0 40",
+};
+constexpr uint8_t BENCH_POSITIONS = sizeof(s_benchPositions) / sizeof(s_benchPositions[0]);
+
+//-----------------------------------------------------------------------------
+static void writeMove(Move p_move, char* p_buffer)
+//-----------------------------------------------------------------------------
+{
+    // Coordinates, as the board squares are named
+    writeSquareToStr(p_move.start, p_buffer);
+    writeSquareToStr(p_move.end, p_buffer + 2);
+    p_buffer[4] = p_move.promotion || (isPawn(p_move.piece) && (p_move.end < 8 || p_move.end >= 56)) ? 'q' : 0;
+    p_buffer[5] = 0;
+}
+
+//-----------------------------------------------------------------------------
+static void printResult(const SearchResult* p_result)
+//-----------------------------------------------------------------------------
+{
+    char move[6];
+    writeMove(p_result->best, move);
+    char score[16];
+    if (p_result->score >= ENGINE_MATE_SCORE - ENGINE_MAX_DEPTH)
+        snprintf(score, sizeof(score), "mate %d", (ENGINE_MATE_SCORE - p_result->score + 1) / 2);
+    else if (p_result->score <= -(ENGINE_MATE_SCORE - ENGINE_MAX_DEPTH))
+        snprintf(score, sizeof(score), "mate -%d", (ENGINE_MATE_SCORE + p_result->score) / 2);
+    else
+        snprintf(score, sizeof(score), "cp %d", p_result->score);
+
+    const uint64_t nps = p_result->nodes * 1000 / std::max<uint32_t>(1, p_result->time_ms);
+    printf("bestmove %s score %s depth %u nodes %llu nps %llu time %u\n", move, score, p_result->depth, (unsigned long long)p_result->nodes,
+           (unsigned long long)nps, p_result->time_ms);
+}
+
+//-----------------------------------------------------------------------------
+static bool analyze(Engine* p_engine, const char* p_fen, const SearchLimits* p_limits)
+//-----------------------------------------------------------------------------
+{
+    Game game;
+    if (!initializeFromFEN(&game, p_fen)) {
+        printf("invalid %s\n", p_fen);
+        return false;
+    }
+
+    if (nullptr == p_engine) {
+        printf("eval %d\n", getEvaluation(&game.evaluation));
+        return true;
+    }
+
+    SearchResult result;
+    if (!searchPosition(p_engine, &game, p_limits, &result)) {
+        printf("bestmove - score %s\n", isCheck(&game) ? "mate 0" : "cp 0");
+        return true;
+    }
+    printResult(&result);
+    fflush(stdout);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static void runBench(Engine* p_engine, uint8_t p_depth, uint64_t* p_nodes, uint32_t* p_time_ms, bool p_print)
+//-----------------------------------------------------------------------------
+{
+    const SearchLimits limits = {0, 0, p_depth};
+    *p_nodes                  = 0;
+    *p_time_ms                = 0;
+    for (uint8_t i = 0; i < BENCH_POSITIONS; i++) {
+        Game game;
+        initializeFromFEN(&game, s_benchPositions[i]);
+        clearEngine(p_engine);
+        SearchResult result;
+        searchPosition(p_engine, &game, &limits, &result);
+        *p_nodes += result.nodes;
+        *p_time_ms += result.time_ms;
+        if (p_print) {
+            printf("%u: ", i + 1);
+            printResult(&result);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t threads    = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t hash_MB    = 64;
+    SearchLimits limits = {0, 0, 0};
+    bool bench          = false;
+    bool scaling        = false;
+    bool staticOnly     = false;
+    std::vector<const char*> fens;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1 < argc);
+        if (0 == strcmp(argv[i], "--threads") && hasValue) {
+            threads = std::min<uint32_t>(ENGINE_MAX_THREADS, std::max(1, atoi(argv[++i])));
+        } else if (0 == strcmp(argv[i], "--hash") && hasValue) {
+            hash_MB = std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--time") && hasValue) {
+            limits.time_ms = (uint32_t)std::max(0, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--nodes") && hasValue) {
+            limits.nodes = strtoull(argv[++i], nullptr, 10);
+        } else if (0 == strcmp(argv[i], "--depth") && hasValue) {
+            limits.depth = (uint8_t)std::min<int>(ENGINE_MAX_DEPTH, std::max(0, atoi(argv[++i])));
+        } else if (0 == strcmp(argv[i], "--bench")) {
+            bench = true;
+        } else if (0 == strcmp(argv[i], "--scaling")) {
+            scaling = true;
+        } else if (0 == strcmp(argv[i], "--static")) {
+            staticOnly = true;
+        } else if (argv[i][0] == '-') {
+            printf("Unexpected argument %s\n", argv[i]);
+            return 2;
+        } else {
+            fens.push_back(argv[i]);
+        }
+    }
+
+    Engine engine;
+    if (bench || scaling) {
+        const uint8_t depth = (0 == limits.depth) ? 5 : limits.depth;
+        uint64_t nodes;
+        uint32_t time_ms;
+        if (bench) {
+            initializeEngine(&engine, threads, hash_MB);
+            runBench(&engine, depth, &nodes, &time_ms, true);
+            printf("Bench: %u positions, depth %u, %u threads, %llu nodes in %u ms, %llu nodes/s\n", BENCH_POSITIONS, depth, threads,
+                   (unsigned long long)nodes, time_ms, (unsigned long long)(nodes * 1000 / std::max<uint32_t>(1, time_ms)));
+        }
+        if (scaling) {
+            // Lazy SMP searches more nodes per depth as threads are added: time to depth is the speedup that matters
+            printf("%8s %12s %10s %12s %10s %10s\n", "threads", "nodes", "time ms", "nodes/s", "nps x", "speedup");
+            uint64_t baseNps     = 0;
+            uint32_t baseTime_ms = 0;
+            for (uint32_t count = 1; count <= threads; count = (count == threads) ? threads + 1 : std::min(threads, count * 2)) {
+                initializeEngine(&engine, count, hash_MB);
+                runBench(&engine, depth, &nodes, &time_ms, false);
+                const uint64_t nps = nodes * 1000 / std::max<uint32_t>(1, time_ms);
+                if (1 == count) {
+                    baseNps     = std::max<uint64_t>(1, nps);
+                    baseTime_ms = std::max<uint32_t>(1, time_ms);
+                }
+                printf("%8u %12llu %10u %12llu %10.2f %10.2f\n", count, (unsigned long long)nodes, time_ms, (unsigned long long)nps,
+                       (double)nps / baseNps, (double)baseTime_ms / std::max<uint32_t>(1, time_ms));
+            }
+        }
+        return 0;
+    }
+
+    if (0 == limits.time_ms && 0 == limits.nodes && 0 == limits.depth)
+        limits.time_ms = 1000;
+    if (!staticOnly)
+        initializeEngine(&engine, threads, hash_MB);
+    Engine* analyzer = staticOnly ? nullptr : &engine;
+
+    bool valid = true;
+    if (!fens.empty()) {
+        for (const char* fen : fens)
+            valid &= analyze(analyzer, fen, &limits);
+    } else {
+        char line[256];
+        while (nullptr != fgets(line, sizeof(line), stdin)) {
+            line[strcspn(line, "\r\n")] = 0;
+            if (0 != line[0])
+                valid &= analyze(analyzer, line, &limits);
+        }
+    }
+    return valid ? 0 : 1;
+}
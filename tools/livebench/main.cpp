@@ -0,0 +1,192 @@
+// Measure snapshot reads of the live board region while one writer updates it at full rate, from the project root:
+//   pio run -e livebench && .pio/build/livebench/program [options]
+// The writer publishes positions of random games round the boards as fast as it can. Each reader maps the region
+// on its own, as a separate process would, and takes snapshots of the boards in turn. One snapshot out of
+// --check is checked: its FEN cache must be the FEN of its board, a torn snapshot would mix two positions.
+// Options:
+//   --boards <n>    boards in the region (default: 64)
+//   --readers <n>   reader threads (default: hardware concurrency - 1, at least 1)
+//   --seconds <n>   duration (default: 3)
+//   --check <n>     check one snapshot out of n (default: 64)
+
+#include <algorithm>
+#include <atomic>
+#include <chess.h>
+#include <chrono>
+#include <live.h>
+#include <movegen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+constexpr uint16_t POSITION_COUNT = 4096;
+
+typedef struct {
+    uint64_t reads;
+    uint64_t attempts;
+    uint64_t failed;
+    uint64_t checked;
+    uint64_t torn;
+} ReaderStats;
+
+//-----------------------------------------------------------------------------
+static uint64_t getTime_ns()
+//-----------------------------------------------------------------------------
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//-----------------------------------------------------------------------------
+static void generatePositions(std::vector<Game>* p_positions)
+//-----------------------------------------------------------------------------
+{
+    uint32_t seed = 12345;
+    Game game;
+    memset(&game, 0, sizeof(game));
+    initializeGame(&game, DEFAULT_SENSORS_STATE);
+
+    while (p_positions->size() < POSITION_COUNT) {
+        Move moves[MOVEGEN_MAX_MOVES];
+        const uint8_t count = generateLegalMoves(&game, moves);
+        if (0 == count || game.fullmoveClock > 120) {
+            memset(&game, 0, sizeof(game));
+            initializeGame(&game, DEFAULT_SENSORS_STATE);
+            continue;
+        }
+        seed             = seed * 1103515245u + 12345u;
+        const bool white = (bits::White == (game.state.status & bits::ColorMask));
+        playMove(&game, moves[(seed >> 16) % count]);
+        updateCheckState(&game, white ? &game.lastMoveW : &game.lastMoveB);
+        p_positions->push_back(game);
+    }
+}
+
+//-----------------------------------------------------------------------------
+static void runWriter(LiveRegion* p_region, const std::vector<Game>* p_positions, const std::atomic<bool>* p_done, uint64_t* p_updates)
+//-----------------------------------------------------------------------------
+{
+    const uint16_t boards = p_region->header->boardCount;
+    uint64_t updates      = 0;
+    while (!p_done->load(std::memory_order_relaxed)) {
+        Game position = (*p_positions)[updates % p_positions->size()];
+        publishLiveBoard(p_region, (uint16_t)(updates % boards), &position, getTime_ns());
+        updates++;
+    }
+    *p_updates = updates;
+}
+
+//-----------------------------------------------------------------------------
+static void runReader(const char* p_name, uint32_t p_check, const std::atomic<bool>* p_done, ReaderStats* p_stats)
+//-----------------------------------------------------------------------------
+{
+    LiveRegion region;
+    if (!openLiveRegion(&region, p_name)) {
+        p_stats->failed++;
+        return;
+    }
+
+    const uint16_t boards = region.header->boardCount;
+    uint32_t countdown    = p_check;
+    uint16_t board        = 0;
+    while (!p_done->load(std::memory_order_relaxed)) {
+        LiveBoard snapshot;
+        uint16_t attempts = 0;
+        const bool read   = readLiveBoard(&region, board, &snapshot, &attempts);
+        p_stats->failed += read ? 0 : 1;
+        p_stats->reads++;
+        p_stats->attempts += attempts;
+        board = (uint16_t)((board + 1) % boards);
+        if (0 != --countdown)
+            continue;
+
+        countdown = p_check;
+        if (read) {
+            Game game;
+            memset(&game, 0, sizeof(game));
+            memcpy(game.board, snapshot.board, sizeof(game.board));
+            game.state         = snapshot.state;
+            game.fullmoveClock = snapshot.fullmoveClock;
+            game.halfmoveClock = snapshot.halfmoveClock;
+            char fen[LIVE_FEN_SIZE];
+            writeToFEN(&game, fen);
+            p_stats->checked++;
+            p_stats->torn += (0 != strcmp(fen, snapshot.fen)) ? 1 : 0;
+        }
+    }
+    closeLiveRegion(&region);
+}
+
+int main(int argc, char** argv) {
+    uint16_t boards  = 64;
+    uint32_t readers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    double seconds   = 3;
+    uint32_t check   = 64;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1 < argc);
+        if (0 == strcmp(argv[i], "--boards") && hasValue) {
+            boards = (uint16_t)std::min(65535, std::max(1, atoi(argv[++i])));
+        } else if (0 == strcmp(argv[i], "--readers") && hasValue) {
+            readers = std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--seconds") && hasValue) {
+            seconds = std::max(0.1, atof(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--check") && hasValue) {
+            check = std::max(1, atoi(argv[++i]));
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::vector<Game> positions;
+    generatePositions(&positions);
+
+    char name[64];
+    snprintf(name, sizeof(name), "/chessboard-livebench-%d", (int)getpid());
+    LiveRegion region;
+    if (!createLiveRegion(&region, name, boards)) {
+        perror("createLiveRegion");
+        return 1;
+    }
+    for (uint16_t i = 0; i < boards; i++)
+        publishLiveBoard(&region, i, &positions[i % positions.size()], getTime_ns());
+
+    std::atomic<bool> done(false);
+    uint64_t updates = 0;
+    std::vector<ReaderStats> stats(readers, ReaderStats{});
+    const auto start = std::chrono::steady_clock::now();
+    std::thread writer(runWriter, &region, &positions, &done, &updates);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < readers; t++)
+        threads.emplace_back(runReader, name, check, &done, &stats[t]);
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    done = true;
+    writer.join();
+    for (std::thread& thread : threads)
+        thread.join();
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    closeLiveRegion(&region);
+    removeLiveRegion(name);
+
+    ReaderStats total = {};
+    for (const ReaderStats& s : stats) {
+        total.reads += s.reads;
+        total.attempts += s.attempts;
+        total.failed += s.failed;
+        total.checked += s.checked;
+        total.torn += s.torn;
+    }
+
+    printf("%u boards (%zu bytes per slot), 1 writer, %u readers, %.3f s\n", boards, sizeof(LiveSlot), readers, elapsed_s);
+    printf("writer: %llu updates, %.0f updates/s\n", (unsigned long long)updates, updates / elapsed_s);
+    printf("readers: %llu snapshots, %.0f snapshots/s (%.0f per reader), %.4f copies per snapshot, %llu failed\n", (unsigned long long)total.reads,
+           total.reads / elapsed_s, total.reads / elapsed_s / readers, total.reads ? (double)total.attempts / total.reads : 0.0,
+           (unsigned long long)total.failed);
+    printf("checked: %llu snapshots, %llu torn\n", (unsigned long long)total.checked, (unsigned long long)total.torn);
+
+    return (0 == total.torn && 0 == total.failed) ? 0 : 1;
+}
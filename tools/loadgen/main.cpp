@@ -0,0 +1,279 @@
+// Play random legal games through evolveGame with the sensor sequences of a real board, from the project root:
+//   pio run -e loadgen && .pio/build/loadgen/program [options]
+// Each thread keeps a set of games in flight and plays one move in each of them in turn.
+// Games are seeded from their index, so a given seed plays the same games whatever the thread count.
+// Options:
+//   --games <n>       games to play (default: 10000)
+//   --concurrent <n>  games in flight per thread (default: 256)
+//   --threads <n>     threads (default: hardware concurrency)
+//   --seed <n>        seed of the games (default: random, printed)
+//   --plies <n>       plies after which a game is stopped (default: 300)
+//   --sample <n>      time one evolveGame call out of n (default: 8)
+
+#include <algorithm>
+#include <atomic>
+#include <chess.h>
+#include <chrono>
+#include <movegen.h>
+#include <replay.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+typedef enum {
+    OutcomeCheckmate = 0,
+    OutcomeStalemate,
+    OutcomeFiftyMoves,
+    OutcomePlyLimit,
+    OutcomeDesync, // evolveGame did not end up in the expected state
+    OutcomeCount,
+} EOutcome;
+
+static const char* s_outcomeNames[OutcomeCount] = {"checkmate", "stalemate", "fifty moves", "ply limit", "desync"};
+
+typedef struct {
+    Game game;
+    uint64_t sensors;
+    uint64_t rng;
+    uint16_t plies;
+    bool active;
+} LoadGame;
+
+typedef struct {
+    uint64_t moves;
+    uint64_t events;
+    uint64_t captures;
+    uint64_t capturedFirst;
+    uint64_t castlings;
+    uint64_t enPassants;
+    uint64_t promotions;
+    uint64_t outcomes[OutcomeCount];
+    uint32_t checksum; // XOR of the final game checksums, independent of the scheduling
+    std::vector<uint32_t> latencies_ns;
+} LoadStats;
+
+typedef struct {
+    uint32_t games;
+    uint32_t concurrent;
+    uint64_t seed;
+    uint16_t plies;
+    uint32_t sample;
+} LoadConfig;
+
+//-----------------------------------------------------------------------------
+static uint64_t nextRandom(uint64_t* p_state)
+//-----------------------------------------------------------------------------
+{
+    // splitmix64
+    uint64_t z = (*p_state += 0x9E3779B97F4A7C15uLL);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9uLL;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBuLL;
+    return z ^ (z >> 31);
+}
+
+//-----------------------------------------------------------------------------
+static void startGame(LoadGame* p_game, uint64_t p_seed, uint32_t p_index)
+//-----------------------------------------------------------------------------
+{
+    initializeGame(&p_game->game, DEFAULT_SENSORS_STATE);
+    p_game->sensors = DEFAULT_SENSORS_STATE;
+    p_game->rng     = p_seed ^ ((uint64_t)p_index * 0xD1B54A32D192ED03uLL);
+    p_game->plies   = 0;
+    p_game->active  = true;
+}
+
+//-----------------------------------------------------------------------------
+static void endGame(LoadGame* p_game, EOutcome p_outcome, LoadStats* p_stats)
+//-----------------------------------------------------------------------------
+{
+    p_stats->outcomes[p_outcome]++;
+    p_stats->checksum ^= getGameChecksum(&p_game->game);
+    p_game->active = false;
+}
+
+//-----------------------------------------------------------------------------
+static void playMove(LoadGame* p_game, const LoadConfig* p_config, LoadStats* p_stats, uint32_t* p_sampleCountdown)
+//-----------------------------------------------------------------------------
+{
+    Game* game = &p_game->game;
+    Move moves[MOVEGEN_MAX_MOVES];
+    const uint8_t count = generateLegalMoves(game, moves);
+
+    if (0 == count) {
+        uint8_t king = 0;
+        while (king < 63 && !(isKing(game->board[king]) && (game->board[king] & bits::ColorMask) == (game->state.status & bits::ColorMask)))
+            king++;
+        const bool check = isSquareAttacked(game->board, king, (game->state.status & bits::ColorMask) ^ bits::ColorMask);
+        endGame(p_game, check ? OutcomeCheckmate : OutcomeStalemate, p_stats);
+        return;
+    }
+    if (game->halfmoveClock >= 100) {
+        endGame(p_game, OutcomeFiftyMoves, p_stats);
+        return;
+    }
+    if (p_game->plies >= p_config->plies) {
+        endGame(p_game, OutcomePlyLimit, p_stats);
+        return;
+    }
+
+    const uint64_t random    = nextRandom(&p_game->rng);
+    const Move move          = moves[random % count];
+    const bool capturedFirst = (0 != (random & (1uLL << 40)));
+    const uint8_t color      = game->state.status & bits::ColorMask;
+    const bool enPassant     = move.captured && Empty == game->board[move.end];
+    const bool castling      = isKing(move.piece) && (move.start == move.end + 2 || move.end == move.start + 2);
+    uint8_t events[REPLAY_MAX_MOVE_EVENTS];
+    const uint8_t eventCount = getMoveSensorEvents(game, move, capturedFirst, events);
+
+    for (uint8_t i = 0; i < eventCount; i++) {
+        const uint64_t mask = 1uLL << (events[i] & REPLAY_SQUARE_MASK);
+        p_game->sensors     = (events[i] & REPLAY_EVENT_PLACED) ? (p_game->sensors | mask) : (p_game->sensors & ~mask);
+
+        if (0 == --(*p_sampleCountdown)) {
+            *p_sampleCountdown = p_config->sample;
+            const auto start   = std::chrono::steady_clock::now();
+            evolveGame(game, p_game->sensors);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            p_stats->latencies_ns.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        } else {
+            evolveGame(game, p_game->sensors);
+        }
+    }
+
+    p_stats->moves++;
+    p_stats->events += eventCount;
+    p_stats->captures += move.captured ? 1 : 0;
+    p_stats->capturedFirst += (move.captured && !enPassant && capturedFirst) ? 1 : 0;
+    p_stats->castlings += castling ? 1 : 0;
+    p_stats->enPassants += enPassant ? 1 : 0;
+    p_stats->promotions += move.promotion ? 1 : 0;
+    p_game->plies++;
+
+    const EPiece expected = move.promotion ? static_cast<EPiece>(color | bits::Queen) : move.piece;
+    if (game->state.status != ((color ^ bits::ColorMask) | bits::ToPlay) || game->board[move.end] != expected)
+        endGame(p_game, OutcomeDesync, p_stats);
+}
+
+//-----------------------------------------------------------------------------
+static void runWorker(const LoadConfig* p_config, std::atomic<uint32_t>* p_next, LoadStats* p_stats)
+//-----------------------------------------------------------------------------
+{
+    std::vector<LoadGame> games(p_config->concurrent);
+    uint32_t sampleCountdown = p_config->sample;
+    uint32_t active          = 0;
+
+    for (LoadGame& game : games) {
+        const uint32_t index = (*p_next)++;
+        game.active          = false;
+        if (index < p_config->games) {
+            startGame(&game, p_config->seed, index);
+            active++;
+        }
+    }
+
+    // One move per game in flight, finished games are replaced by the next ones
+    while (active > 0) {
+        for (LoadGame& game : games) {
+            if (!game.active)
+                continue;
+
+            playMove(&game, p_config, p_stats, &sampleCountdown);
+            if (!game.active) {
+                const uint32_t index = (*p_next)++;
+                if (index < p_config->games)
+                    startGame(&game, p_config->seed, index);
+                else
+                    active--;
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t getPercentile(std::vector<uint32_t>& p_sorted, double p_percentile)
+//-----------------------------------------------------------------------------
+{
+    if (p_sorted.empty())
+        return 0;
+    const size_t index = std::min(p_sorted.size() - 1, (size_t)(p_percentile / 100.0 * p_sorted.size()));
+    return p_sorted[index];
+}
+
+int main(int argc, char** argv) {
+    LoadConfig config = {10000, 256, 0, 300, 8};
+    uint32_t threads  = std::max(1u, std::thread::hardware_concurrency());
+    bool seeded       = false;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1 < argc);
+        if (0 == strcmp(argv[i], "--games") && hasValue) {
+            config.games = (uint32_t)std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--concurrent") && hasValue) {
+            config.concurrent = (uint32_t)std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--threads") && hasValue) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--seed") && hasValue) {
+            config.seed = strtoull(argv[++i], nullptr, 0);
+            seeded      = true;
+        } else if (0 == strcmp(argv[i], "--plies") && hasValue) {
+            config.plies = (uint16_t)std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--sample") && hasValue) {
+            config.sample = (uint32_t)std::max(1, atoi(argv[++i]));
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (!seeded)
+        config.seed = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+
+    std::atomic<uint32_t> next(0);
+    std::vector<LoadStats> stats(threads);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+        workers.emplace_back(runWorker, &config, &next, &stats[t]);
+    for (std::thread& worker : workers)
+        worker.join();
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LoadStats total = {};
+    for (LoadStats& s : stats) {
+        total.moves += s.moves;
+        total.events += s.events;
+        total.captures += s.captures;
+        total.capturedFirst += s.capturedFirst;
+        total.castlings += s.castlings;
+        total.enPassants += s.enPassants;
+        total.promotions += s.promotions;
+        for (uint8_t i = 0; i < OutcomeCount; i++)
+            total.outcomes[i] += s.outcomes[i];
+        total.checksum ^= s.checksum;
+        total.latencies_ns.insert(total.latencies_ns.end(), s.latencies_ns.begin(), s.latencies_ns.end());
+    }
+    std::sort(total.latencies_ns.begin(), total.latencies_ns.end());
+
+    printf("seed %llu, %u games (%u threads, %u in flight each), checksum %08x\n", (unsigned long long)config.seed, config.games, threads,
+           config.concurrent, total.checksum);
+    printf("%llu moves, %llu events in %.3f s: %.0f moves/s, %.0f events/s\n", (unsigned long long)total.moves, (unsigned long long)total.events,
+           elapsed_s, total.moves / elapsed_s, total.events / elapsed_s);
+    printf("moves: %llu captures (%llu captured piece lifted first), %llu castlings, %llu en passant, %llu promotions\n",
+           (unsigned long long)total.captures, (unsigned long long)total.capturedFirst, (unsigned long long)total.castlings,
+           (unsigned long long)total.enPassants, (unsigned long long)total.promotions);
+    printf("games:");
+    for (uint8_t i = 0; i < OutcomeCount; i++)
+        printf(" %llu %s%s", (unsigned long long)total.outcomes[i], s_outcomeNames[i], (i + 1 < OutcomeCount) ? "," : "\n");
+    uint64_t sum_ns = 0;
+    for (uint32_t latency : total.latencies_ns)
+        sum_ns += latency;
+    const double mean_ns = total.latencies_ns.empty() ? 0.0 : (double)sum_ns / total.latencies_ns.size();
+
+    printf("evolveGame (%zu calls timed): mean %.0f ns, p50 %u ns, p90 %u ns, p99 %u ns, p99.9 %u ns, max %u ns\n", total.latencies_ns.size(),
+           mean_ns, getPercentile(total.latencies_ns, 50), getPercentile(total.latencies_ns, 90), getPercentile(total.latencies_ns, 99),
+           getPercentile(total.latencies_ns, 99.9), total.latencies_ns.empty() ? 0 : total.latencies_ns.back());
+
+    return (0 == total.outcomes[OutcomeDesync]) ? 0 : 1;
+}
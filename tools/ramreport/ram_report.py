@@ -0,0 +1,33 @@
+# RAM report of the AVR firmware, run after each link: sizes of the data and bss sections and their
+# largest symbols. Constants missing PROGMEM show up as data symbols, copied from flash at startup.
+import subprocess
+
+Import("env")
+
+RAM_SIZE    = 2560
+TOP_SYMBOLS = 15
+
+
+def print_ram_report(source, target, env):
+    elf    = str(target[0])
+    output = subprocess.check_output(["avr-nm", "--print-size", "--size-sort", "--reverse-sort", "--demangle", elf],
+                                     env=env["ENV"], universal_newlines=True)
+
+    sections = {"data": [], "bss": []}
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) < 4:
+            continue
+        kind = fields[2].lower()
+        if kind in ("d", "b"):
+            sections["data" if "d" == kind else "bss"].append((int(fields[1], 16), fields[3]))
+
+    data = sum(size for size, _ in sections["data"])
+    bss  = sum(size for size, _ in sections["bss"])
+    print("RAM: data %d bytes, bss %d bytes, %d bytes left for heap and stack" % (data, bss, RAM_SIZE - data - bss))
+    for name in ("data", "bss"):
+        for size, symbol in sections[name][:TOP_SYMBOLS]:
+            print("  %-4s %5d  %s" % (name, size, symbol))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", print_ram_report)
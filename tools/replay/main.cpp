@@ -0,0 +1,236 @@
+// Replay sensor traces through evolveGame at full speed, from the project root:
+//   pio run -e replay && .pio/build/replay/program [options] <traces...>
+// Traces are sensor scripts (same syntax as the tests) or files compiled with --compile.
+// Options:
+//   --compile <script> <trace>  compile a script to a binary trace and exit
+//   --threads <n>               replay threads (default: hardware concurrency)
+//   --repeat <n>                replay each trace n times (throughput measurements)
+//   --steps                     print the checksum after every event
+//   --record <path>             write the final checksum of each trace
+//   --expect <path>             compare final checksums with a --record file, exits with 1 on mismatch
+
+#include <atomic>
+#include <chess.h>
+#include <chrono>
+#include <replay.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// Binary trace: magic, event count (little endian), events
+static const char TRACE_MAGIC[4] = {'C', 'T', 'R', 'C'};
+
+typedef struct {
+    const char* path;
+    std::vector<uint8_t> events;
+    std::vector<uint32_t> checksums; // Per event, with --steps
+    ReplayResult result;
+    bool loaded;
+} Trace;
+
+//-----------------------------------------------------------------------------
+static bool readFile(const char* p_path, std::vector<char>* p_content)
+//-----------------------------------------------------------------------------
+{
+    FILE* file = fopen(p_path, "rb");
+    if (nullptr == file) {
+        printf("Unable to open %s\n", p_path);
+        return false;
+    }
+
+    char buffer[4096];
+    size_t size = 0;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        p_content->insert(p_content->end(), buffer, buffer + size);
+    fclose(file);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static bool loadTrace(Trace* p_trace)
+//-----------------------------------------------------------------------------
+{
+    std::vector<char> content;
+    if (!readFile(p_trace->path, &content))
+        return false;
+
+    if (content.size() >= 8 && 0 == memcmp(content.data(), TRACE_MAGIC, sizeof(TRACE_MAGIC))) {
+        const uint8_t* header = reinterpret_cast<const uint8_t*>(content.data()) + 4;
+        const uint32_t count  = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+        if (content.size() - 8 < count) {
+            printf("Truncated trace %s\n", p_trace->path);
+            return false;
+        }
+        p_trace->events.assign(content.begin() + 8, content.begin() + 8 + count);
+        return true;
+    }
+
+    // Text script: one event per action at most
+    content.push_back(0);
+    p_trace->events.resize(content.size());
+    uint32_t errorOffset = 0;
+    const uint32_t count = compileSensorScript(content.data(), p_trace->events.data(), (uint32_t)p_trace->events.size(), &errorOffset);
+    if (REPLAY_INVALID == count) {
+        printf("Invalid action in %s at offset %u\n", p_trace->path, errorOffset);
+        return false;
+    }
+    p_trace->events.resize(count);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static int compileTrace(const char* p_scriptPath, const char* p_tracePath)
+//-----------------------------------------------------------------------------
+{
+    Trace trace = {p_scriptPath, {}, {}, {}, false};
+    if (!loadTrace(&trace))
+        return 2;
+
+    FILE* file = fopen(p_tracePath, "wb");
+    if (nullptr == file) {
+        printf("Unable to write %s\n", p_tracePath);
+        return 2;
+    }
+
+    const uint32_t count    = (uint32_t)trace.events.size();
+    const uint8_t header[4] = {(uint8_t)count, (uint8_t)(count >> 8), (uint8_t)(count >> 16), (uint8_t)(count >> 24)};
+    fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), file);
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(trace.events.data(), 1, count, file);
+    fclose(file);
+
+    printf("%s: %u events\n", p_tracePath, count);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+static void replayTrace(Trace* p_trace, uint32_t p_repeat, bool p_steps)
+//-----------------------------------------------------------------------------
+{
+    if (p_steps)
+        p_trace->checksums.resize(p_trace->events.size());
+
+    for (uint32_t i = 0; i < p_repeat; i++) {
+        Game game;
+        initializeGame(&game, DEFAULT_SENSORS_STATE);
+        p_trace->result = replaySensorEvents(&game, DEFAULT_SENSORS_STATE, p_trace->events.data(), (uint32_t)p_trace->events.size(), p_steps ? p_trace->checksums.data() : nullptr);
+    }
+}
+
+//-----------------------------------------------------------------------------
+static int compareChecksums(const char* p_path, std::vector<Trace>& p_traces)
+//-----------------------------------------------------------------------------
+{
+    FILE* file = fopen(p_path, "r");
+    if (nullptr == file) {
+        printf("Unable to read %s\n", p_path);
+        return 2;
+    }
+
+    int mismatches = 0;
+    char line[512];
+    while (nullptr != fgets(line, sizeof(line), file)) {
+        char* name              = nullptr;
+        const uint32_t expected = (uint32_t)strtoul(line, &name, 16);
+        if (nullptr == name || *name != ' ')
+            continue;
+        name++;
+        name[strcspn(name, "\r\n")] = 0;
+
+        for (Trace& trace : p_traces) {
+            if (0 != strcmp(trace.path, name))
+                continue;
+            if (!trace.loaded || trace.result.checksum != expected) {
+                printf("MISMATCH %s: expected %08x, got %08x\n", name, expected, trace.result.checksum);
+                mismatches++;
+            }
+        }
+    }
+    fclose(file);
+    return mismatches > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t threads       = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t repeat        = 1;
+    bool steps             = false;
+    const char* recordPath = nullptr;
+    const char* expectPath = nullptr;
+    std::vector<Trace> traces;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1 < argc);
+        if (0 == strcmp(argv[i], "--compile") && i + 2 < argc) {
+            return compileTrace(argv[i + 1], argv[i + 2]);
+        } else if (0 == strcmp(argv[i], "--threads") && hasValue) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--repeat") && hasValue) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else if (0 == strcmp(argv[i], "--steps")) {
+            steps = true;
+        } else if (0 == strcmp(argv[i], "--record") && hasValue) {
+            recordPath = argv[++i];
+        } else if (0 == strcmp(argv[i], "--expect") && hasValue) {
+            expectPath = argv[++i];
+        } else if (argv[i][0] == '-') {
+            printf("Unknown option %s\n", argv[i]);
+            return 2;
+        } else {
+            traces.push_back({argv[i], {}, {}, {}, false});
+        }
+    }
+
+    if (traces.empty()) {
+        printf("No trace to replay\n");
+        return 2;
+    }
+
+    // Traces are loaded and compiled before timing
+    for (Trace& trace : traces)
+        trace.loaded = loadTrace(&trace);
+
+    // Each thread takes the next trace until all are replayed
+    std::atomic<size_t> next(0);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < std::min<size_t>(threads, traces.size()); t++) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < traces.size(); i = next++) {
+                if (traces[i].loaded)
+                    replayTrace(&traces[i], repeat, steps);
+            }
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t events = 0;
+    uint32_t games  = 0;
+    FILE* record    = (nullptr != recordPath) ? fopen(recordPath, "w") : nullptr;
+    for (Trace& trace : traces) {
+        if (!trace.loaded)
+            continue;
+
+        events += (uint64_t)trace.result.events * repeat;
+        games += repeat;
+        printf("%08x %s (%u events)\n", trace.result.checksum, trace.path, trace.result.events);
+        for (size_t i = 0; i < trace.checksums.size(); i++)
+            printf("  %u: %08x\n", (uint32_t)i, trace.checksums[i]);
+        if (nullptr != record)
+            fprintf(record, "%08x %s\n", trace.result.checksum, trace.path);
+    }
+    if (nullptr != record)
+        fclose(record);
+
+    printf("%u games, %llu events in %.3f s: %.0f games/s, %.0f events/s (%u threads)\n", games, (unsigned long long)events, elapsed_s,
+           games / elapsed_s, events / elapsed_s, threads);
+
+    for (const Trace& trace : traces) {
+        if (!trace.loaded)
+            return 2;
+    }
+    return (nullptr != expectPath) ? compareChecksums(expectPath, traces) : 0;
+}
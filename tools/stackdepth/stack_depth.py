@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+# Worst-case stack depth of a call tree, from the call graphs gcc writes with -fcallgraph-info=su (gcc 10+):
+#   g++ -std=c++17 -O2 -DCHESS_DISABLE_LOG -DPROFILER_DISABLE_STAGES -Ilib/Chess/src -Ilib/Profiler/src -Ilib/Utils/src \
+#       -Ilib/Journal/src -c lib/Chess/src/*.cpp lib/Profiler/src/profiler.cpp lib/Journal/src/journal.cpp -fcallgraph-info=su
+#   tools/stackdepth/stack_depth.py evolveJournaledGame *.ci   (game task of the firmware, or evolveGame, resumeJournal...)
+# Prints the deepest path from the root function, fails on recursion or frames of unbounded size.
+import re
+import sys
+
+NODE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+SIZE = re.compile(r'\\n(\d+) bytes \((static|dynamic,bounded|dynamic)\)')
+
+
+def short_title(p_title):
+    # Static functions are prefixed with their file
+    return p_title.split(":")[-1]
+
+
+def load(p_files):
+    frames, names, calls = {}, {}, {}
+    for path in p_files:
+        with open(path) as ci:
+            for line in ci:
+                node = NODE.search(line)
+                if node:
+                    title = short_title(node.group(1))
+                    names[title] = node.group(2).split("\\n")[0]
+                    size = SIZE.search(node.group(2))
+                    if size:
+                        frames[title] = (int(size.group(1)), size.group(2))
+                    continue
+                edge = EDGE.search(line)
+                if edge:
+                    calls.setdefault(short_title(edge.group(1)), set()).add(short_title(edge.group(2)))
+    return frames, names, calls
+
+
+def deepest(p_function, p_frames, p_calls, p_path, p_cache):
+    if p_function in p_path:
+        raise RuntimeError("recursion: " + " -> ".join(p_path + [p_function]))
+    if p_function in p_cache:
+        return p_cache[p_function]
+
+    size, kind = p_frames.get(p_function, (0, "external"))
+    if "dynamic" == kind:
+        raise RuntimeError("unbounded frame: " + p_function)
+    best = (0, [])
+    for callee in sorted(p_calls.get(p_function, ())):
+        depth = deepest(callee, p_frames, p_calls, p_path + [p_function], p_cache)
+        if depth[0] > best[0]:
+            best = depth
+    p_cache[p_function] = (size + best[0], [p_function] + best[1])
+    return p_cache[p_function]
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("usage: stack_depth.py <root function> <.ci files>")
+        return 2
+
+    frames, names, calls = load(sys.argv[2:])
+    roots = [title for title, name in names.items() if re.search(r"\b%s\(" % re.escape(sys.argv[1]), name)]
+    if not roots:
+        print("root function not found: " + sys.argv[1])
+        return 2
+
+    try:
+        depth, path = deepest(roots[0], frames, calls, [], {})
+    except RuntimeError as error:
+        print(error)
+        return 1
+
+    print("%d bytes: %s" % (depth, names[roots[0]]))
+    for function in path:
+        size, kind = frames.get(function, (0, "external"))
+        print("  %5d  %s" % (size, names.get(function, function)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())